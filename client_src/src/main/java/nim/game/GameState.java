@@ -54,6 +54,9 @@ public class GameState {
     private String currentRoomName = "";
     private List<RoomInfo> rooms = new ArrayList<>();
 
+    // Turnaj, do ktereho je hrac prihlaseny (null = zadny)
+    private String tournament = null;
+
     // Stav hry
     private int stones = INITIAL_STONES;
     private boolean myTurn = false;
@@ -64,6 +67,25 @@ public class GameState {
     private String winner = "";
     private String loser = "";
 
+    // Pravidla mistnosti (posila server v GAME_START / GAME_RESUMED)
+    private int minTake = MIN_TAKE;
+    private int maxTake = MAX_TAKE;
+    private int skipsPerPlayer = SKIPS_PER_PLAYER;
+
+    // Velikosti hromadek (klasicka varianta = jedna hromadka)
+    private int[] piles = { INITIAL_STONES };
+
+    // Hraci v poradi tahu a kdo je prave na tahu
+    private List<String> players = new ArrayList<>();
+    private String currentPlayer = "";
+
+    // Hodiny tahu - cas na tah z pravidel a termin hrace na tahu (0 = bez hodin)
+    private int moveSeconds = 0;
+    private long turnDeadline = 0;
+
+    // Sledovani cizi hry (divak nehraje, jen prijima udalosti)
+    private boolean spectating = false;
+
     // Observer
     private Consumer<GameState> stateChangeListener;
 
@@ -128,6 +150,18 @@ public class GameState {
         return currentRoomName;
     }
 
+    public String getTournament() {
+        return tournament;
+    }
+
+    public void enterTournament(String name) {
+        this.tournament = name;
+    }
+
+    public void leaveTournament() {
+        this.tournament = null;
+    }
+
     public List<RoomInfo> getRooms() {
         return new ArrayList<>(rooms);
     }
@@ -168,8 +202,69 @@ public class GameState {
         return mySkipsRemaining > 0;
     }
 
-    public int getMaxTake() {
-        return Math.min(MAX_TAKE, stones);
+    /**
+     * Nejmensi povoleny tah z hromadky; zbyva-li mene nez minimum, bere se zbytek.
+     */
+    public int getMinTake(int pile) {
+        return Math.max(1, Math.min(minTake, getPile(pile)));
+    }
+
+    public int getMaxTake(int pile) {
+        return Math.min(maxTake, getPile(pile));
+    }
+
+    public int[] getPiles() {
+        return piles.clone();
+    }
+
+    public int getPile(int pile) {
+        return pile >= 0 && pile < piles.length ? piles[pile] : 0;
+    }
+
+    public boolean isMultiPile() {
+        return piles.length > 1;
+    }
+
+    public int getSkipsPerPlayer() {
+        return skipsPerPlayer;
+    }
+
+    public List<String> getPlayers() {
+        return new ArrayList<>(players);
+    }
+
+    /**
+     * Vrati prezdivku hrace na tahu (prazdna, pokud neni znama).
+     */
+    public String getCurrentPlayer() {
+        return currentPlayer;
+    }
+
+    /**
+     * Hra s vice nez dvema hraci.
+     */
+    public boolean isMultiPlayer() {
+        return players.size() > 2;
+    }
+
+    public boolean isSpectating() {
+        return spectating;
+    }
+
+    public int getMoveSeconds() {
+        return moveSeconds;
+    }
+
+    public boolean hasTurnClock() {
+        return turnDeadline != 0;
+    }
+
+    /**
+     * Zbyvajici cas hrace na tahu v ms (0 = bez hodin nebo vyprselo).
+     */
+    public long getTurnTimeLeft() {
+        if (turnDeadline == 0) return 0;
+        return Math.max(0, turnDeadline - System.currentTimeMillis());
     }
 
     // ============================================
@@ -219,12 +314,23 @@ public class GameState {
         notifyStateChange();
     }
 
-    public void startGame(int stones, boolean myTurn, String opponent) {
+    public void startGame(int stones, boolean myTurn, String opponent,
+                          int minTake, int maxTake, int skipsPerPlayer, int[] piles,
+                          List<String> players, int moveSeconds) {
         this.stones = stones;
+        this.moveSeconds = moveSeconds;
+        setTurnClock(moveSeconds * 1000);
+        setPiles(piles);
         this.myTurn = myTurn;
         this.opponentNickname = opponent;
-        this.mySkipsRemaining = SKIPS_PER_PLAYER;
-        this.opponentSkipsRemaining = SKIPS_PER_PLAYER;
+        this.players = new ArrayList<>(players);
+        // Hru zacina prvni hrac v poradi
+        this.currentPlayer = players.isEmpty() ? (myTurn ? nickname : opponent) : players.get(0);
+        this.minTake = minTake;
+        this.maxTake = maxTake;
+        this.skipsPerPlayer = skipsPerPlayer;
+        this.mySkipsRemaining = skipsPerPlayer;
+        this.opponentSkipsRemaining = skipsPerPlayer;
         this.opponentStatus = OpponentStatus.CONNECTED;
         this.winner = "";
         this.loser = "";
@@ -232,8 +338,15 @@ public class GameState {
         notifyStateChange();
     }
 
-    public void resumeGame(int stones, boolean myTurn, int mySkips, int oppSkips) {
+    public void resumeGame(int stones, boolean myTurn, int mySkips, int oppSkips,
+                           int minTake, int maxTake, int[] piles, List<String> players) {
         this.stones = stones;
+        setPiles(piles);
+        this.players = new ArrayList<>(players);
+        // Pri vice hracich neni znamo, kdo z ostatnich je na tahu
+        this.currentPlayer = myTurn ? nickname : (isMultiPlayer() ? "" : playerAfter(nickname));
+        this.minTake = minTake;
+        this.maxTake = maxTake;
         this.myTurn = myTurn;
         this.mySkipsRemaining = mySkips;
         this.opponentSkipsRemaining = oppSkips;
@@ -242,34 +355,70 @@ public class GameState {
         notifyStateChange();
     }
 
+    /**
+     * Zacatek sledovani nebo resynchronizace stavu (WATCH_OK).
+     * @param roomName Nazev mistnosti (null = ponechat)
+     * @param current Hrac na tahu (prazdny, pokud hra jeste nezacala)
+     */
+    public void watchGame(int roomId, String roomName, int stones, String current,
+                          int minTake, int maxTake, int[] piles, List<String> players) {
+        this.spectating = true;
+        this.currentRoomId = roomId;
+        if (roomName != null) {
+            this.currentRoomName = roomName;
+        }
+        this.stones = stones;
+        setPiles(piles);
+        this.players = new ArrayList<>(players);
+        this.currentPlayer = current;
+        this.myTurn = false;
+        this.minTake = minTake;
+        this.maxTake = maxTake;
+        this.opponentStatus = OpponentStatus.CONNECTED;
+        this.winner = "";
+        this.loser = "";
+        this.phase = current.isEmpty() ? Phase.IN_ROOM_WAITING : Phase.IN_GAME;
+        notifyStateChange();
+    }
+
     public void updateStones(int remaining, boolean myTurn) {
         this.stones = remaining;
         this.myTurn = myTurn;
         notifyStateChange();
     }
 
-    public void myTakeSucceeded(int remaining, boolean stillMyTurn) {
+    public void myTakeSucceeded(int pile, int remaining, boolean stillMyTurn) {
+        takeFromPile(pile, stones - remaining);
         this.stones = remaining;
         this.myTurn = stillMyTurn;
+        this.currentPlayer = stillMyTurn ? nickname : playerAfter(nickname);
         notifyStateChange();
     }
 
     public void mySkipSucceeded(boolean stillMyTurn) {
         this.mySkipsRemaining--;
         this.myTurn = stillMyTurn;
+        this.currentPlayer = stillMyTurn ? nickname : playerAfter(nickname);
         notifyStateChange();
     }
 
-    public void opponentTook(int count, int remaining) {
+    /**
+     * Tah jineho hrace; next je hrac na tahu po nem (prazdny = my).
+     */
+    public void opponentTook(int pile, int count, int remaining, String next) {
+        takeFromPile(pile, count);
         this.stones = remaining;
-        this.myTurn = true;
+        setCurrentPlayer(next);
         notifyStateChange();
     }
 
-    public void opponentSkipped(int remaining) {
-        this.opponentSkipsRemaining--;
+    public void opponentSkipped(int remaining, String next) {
+        // Pocitadlo preskoceni ma smysl jen pro jedineho soupere
+        if (!isMultiPlayer()) {
+            this.opponentSkipsRemaining--;
+        }
         this.stones = remaining;
-        this.myTurn = true;
+        setCurrentPlayer(next);
         notifyStateChange();
     }
 
@@ -279,6 +428,7 @@ public class GameState {
     }
 
     public void endGame(String winner, String loser) {
+        this.turnDeadline = 0;
         this.winner = winner;
         this.loser = loser;
         this.phase = Phase.GAME_OVER;
@@ -287,12 +437,30 @@ public class GameState {
 
     public void resetGame() {
         this.stones = INITIAL_STONES;
+        this.piles = new int[] { INITIAL_STONES };
         this.myTurn = false;
+        this.minTake = MIN_TAKE;
+        this.maxTake = MAX_TAKE;
+        this.skipsPerPlayer = SKIPS_PER_PLAYER;
         this.mySkipsRemaining = SKIPS_PER_PLAYER;
         this.opponentSkipsRemaining = SKIPS_PER_PLAYER;
         this.winner = "";
         this.loser = "";
         this.opponentStatus = OpponentStatus.CONNECTED;
+        this.players = new ArrayList<>();
+        this.currentPlayer = "";
+        this.spectating = false;
+        this.moveSeconds = 0;
+        this.turnDeadline = 0;
+    }
+
+    /**
+     * Nastavi hodiny hrace na tahu podle zpravy serveru; stav se neoznamuje,
+     * udela to nasledna zmena tahu.
+     * @param clockMs Zbyvajici cas v ms (0 = bez hodin)
+     */
+    public void setTurnClock(int clockMs) {
+        this.turnDeadline = clockMs > 0 ? System.currentTimeMillis() + clockMs : 0;
     }
 
     public void reset() {
@@ -302,16 +470,44 @@ public class GameState {
         this.currentRoomId = -1;
         this.currentRoomName = "";
         this.rooms.clear();
+        this.tournament = null;
         this.opponentNickname = "";
         resetGame();
         notifyStateChange();
     }
 
+    /**
+     * Nastavi hromadky ze zpravy serveru; bez seznamu jde o jedinou hromadku.
+     */
+    private void setPiles(int[] piles) {
+        this.piles = piles != null && piles.length > 1 ? piles.clone() : new int[] { stones };
+    }
+
+    private void setCurrentPlayer(String next) {
+        this.currentPlayer = next == null || next.isEmpty() ? nickname : next;
+        this.myTurn = currentPlayer.equals(nickname);
+    }
+
+    /**
+     * Vrati hrace na tahu po zadanem; bez seznamu hracu je to souper.
+     */
+    private String playerAfter(String player) {
+        int index = players.indexOf(player);
+        if (index < 0) return opponentNickname;
+        return players.get((index + 1) % players.size());
+    }
+
+    private void takeFromPile(int pile, int count) {
+        if (pile >= 0 && pile < piles.length) {
+            piles[pile] = Math.max(0, piles[pile] - count);
+        }
+    }
+
     /**
      * Validuje tah.
      */
-    public boolean isValidTake(int count) {
-        return count >= MIN_TAKE && count <= MAX_TAKE && count <= stones;
+    public boolean isValidTake(int pile, int count) {
+        return count >= getMinTake(pile) && count <= getMaxTake(pile);
     }
 }
 
@@ -1,27 +1,29 @@
 package nim.network;
 
-import javafx.application.Platform;
 import nim.util.Logger;
 
-import java.io.*;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
 import java.net.InetSocketAddress;
-import java.net.Socket;
-import java.net.SocketTimeoutException;
-import java.util.concurrent.*;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
 import java.util.function.Consumer;
 
 /**
  * Sitovy klient pro komunikaci se serverem.
  * Zajistuje pripojeni, odesilani a prijem zprav.
+ * Spojeni, ping i reconnect obsluhuje vlakno transportu - handlery se volaji
+ * na nem a nesmi blokovat. Vic klientu nad jednim transportem (headless
+ * zatezove testy) tak nepotrebuje zadne vlakno navic.
  */
 public class Client {
 
     /** Timeout pro pripojeni (ms) */
     private static final int CONNECT_TIMEOUT = 10000;
     
-    /** Timeout pro cteni (ms) */
-    private static final int READ_TIMEOUT = 2000;
-    
     /** Interval pro reconnect (ms) */
     private static final int RECONNECT_INTERVAL = 3000;
     
@@ -33,17 +35,31 @@ public class Client {
     
     /** Timeout pro PONG odpoved (ms) */
     private static final int PONG_TIMEOUT = 15000;
+    
+    /** Vyjednat binarni rezim protokolu (-Dnim.binary=true) */
+    private static final boolean BINARY_MODE = Boolean.getBoolean("nim.binary");
 
-    private String serverHost;
-    private int serverPort;
+    private final Transport transport;
+    
+    private volatile InetSocketAddress serverAddress;
     private String nickname;
+    
+    /** Session token z LOGIN_OK - pro navrat do rozehrane hry (RESUME) */
+    private volatile String sessionToken;
 
-    private Socket socket;
-    private BufferedReader reader;
-    private PrintWriter writer;
-
-    private ExecutorService receiverThread;
-    private ScheduledExecutorService pingScheduler;
+    private volatile Transport.Connection connection;
+    
+    /** Listener aktualniho spojeni - udalosti starsich spojeni se ignoruji */
+    private volatile ConnectionListener listener;
+    
+    /** Vysledek connect(), dokud se prvni spojeni nenavaze nebo neselze */
+    private volatile CompletableFuture<Boolean> pendingConnect;
+    
+    /** Odchozi zpravy jdou jako binarni ramce (hned po LOGIN/RESUME s priznakem) */
+    private volatile boolean binaryOut = false;
+    
+    private volatile Transport.Timeout pingTimer;
+    private volatile Transport.Timeout reconnectTimer;
     
     private Consumer<Protocol.ParsedMessage> messageHandler;
     private Consumer<ConnectionState> connectionStateHandler;
@@ -56,6 +72,7 @@ public class Client {
     private volatile boolean waitingForPong = false;
     private volatile int invalidMessageCount = 0;
     private volatile boolean disconnectHandlerCalled = false;
+    private int nextRequestId = 1;
 
     /**
      * Stavy pripojeni.
@@ -68,11 +85,17 @@ public class Client {
     }
 
     /**
-     * Vytvori novou instanci klienta.
+     * Vytvori novou instanci klienta nad sdilenym transportem.
      */
     public Client() {
-        this.receiverThread = Executors.newSingleThreadExecutor();
-        this.pingScheduler = Executors.newSingleThreadScheduledExecutor();
+        this(Transport.shared());
+    }
+
+    /**
+     * Vytvori klienta nad danym transportem (vic klientu na jednom vlakne).
+     */
+    public Client(Transport transport) {
+        this.transport = transport;
     }
 
     /**
@@ -97,59 +120,51 @@ public class Client {
     }
 
     /**
-     * Pripoji se k serveru.
+     * Pripoji se k serveru a pocka na vysledek.
+     * Nevolat z vlakna transportu (handleru) - ceka na nej.
      */
     public boolean connect(String host, int port, String nickname) {
-        this.serverHost = host;
-        this.serverPort = port;
-        this.nickname = nickname;
-
-        notifyConnectionState(ConnectionState.CONNECTING);
-        
         try {
-            socket = new Socket();
-            socket.connect(new InetSocketAddress(host, port), CONNECT_TIMEOUT);
-            socket.setSoTimeout(READ_TIMEOUT);
-            
-            // TCP keepalive pro detekci odpojeni
-            socket.setKeepAlive(true);
-            
-            // Zabranit Nagle algoritmu pro rychlejsi odezvu
-            socket.setTcpNoDelay(true);
-            
-            // Vetsi buffer pro prijem
-            socket.setReceiveBufferSize(8192);
-            socket.setSendBufferSize(8192);
-            
-            reader = new BufferedReader(new InputStreamReader(socket.getInputStream(), "UTF-8"));
-            writer = new PrintWriter(new OutputStreamWriter(socket.getOutputStream(), "UTF-8"), true);
-            
-            connected = true;
-            reconnectAttempts = 0;
-            invalidMessageCount = 0;
-            disconnectHandlerCalled = false;
-            
-            // Spust prijimaci vlakno
-            startReceiver();
-            
-            // Spust ping scheduler
-            startPingScheduler();
-            
-            Logger.info("Connected to server %s:%d", host, port);
-            notifyConnectionState(ConnectionState.CONNECTED);
-            
-            // Posli LOGIN
-            send(Protocol.createLogin(nickname));
-            
-            return true;
-            
-        } catch (IOException e) {
+            return connectAsync(host, port, nickname).get(CONNECT_TIMEOUT * 2L, TimeUnit.MILLISECONDS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+            return false;
+        } catch (ExecutionException | TimeoutException e) {
             Logger.error("Failed to connect to server", e);
-            notifyConnectionState(ConnectionState.DISCONNECTED);
             return false;
         }
     }
 
+    /**
+     * Zahaji pripojeni k serveru bez cekani (LOGIN se posle po navazani).
+     * @return Vysledek pripojeni - true po navazani spojeni
+     */
+    public CompletableFuture<Boolean> connectAsync(String host, int port, String nickname) {
+        this.nickname = nickname;
+        this.sessionToken = null;
+
+        CompletableFuture<Boolean> result = new CompletableFuture<>();
+        pendingConnect = result;
+        
+        notifyConnectionState(ConnectionState.CONNECTING);
+        
+        // Preklad jmena muze blokovat - nesmi bezet na vlakne UI ani transportu
+        CompletableFuture.supplyAsync(() -> new InetSocketAddress(host, port))
+                .whenComplete((address, error) -> {
+                    if (pendingConnect != result) return; // Mezitim disconnect()
+                    if (error != null) {
+                        Logger.error("Invalid server address %s:%d", host, port);
+                        pendingConnect = null;
+                        notifyConnectionState(ConnectionState.DISCONNECTED);
+                        result.complete(false);
+                        return;
+                    }
+                    serverAddress = address;
+                    openConnection();
+                });
+        return result;
+    }
+
     /**
      * Odpoji se od serveru.
      */
@@ -171,11 +186,15 @@ public class Client {
         
         connected = false;
         reconnecting = false;
+        sessionToken = null;
         
+        if (reconnectTimer != null) reconnectTimer.cancel();
         stopPingScheduler();
-        stopReceiver();
+        closeConnection();
         
-        closeSocket();
+        CompletableFuture<Boolean> pending = pendingConnect;
+        pendingConnect = null;
+        if (pending != null) pending.complete(false);
         
         notifyConnectionState(ConnectionState.DISCONNECTED);
         Logger.info("Disconnected from server");
@@ -183,19 +202,20 @@ public class Client {
 
     /**
      * Odesle zpravu na server.
+     * Zprava muze obsahovat vic radku - v binarnim rezimu jde kazdy jako ramec.
      */
     public synchronized boolean send(String message) {
-        if (!connected || writer == null) {
+        Transport.Connection conn = connection;
+        if (!connected || conn == null) {
             Logger.warning("Cannot send message - not connected");
             return false;
         }
         
         try {
-            writer.print(message);
-            writer.flush();
-            
-            if (writer.checkError()) {
-                throw new IOException("Write error");
+            if (!conn.send(encode(message))) {
+                // Ztratu spojeni oznami transport (onClosed)
+                Logger.warning("Cannot send message - connection closed");
+                return false;
             }
             
             // Log bez koncoveho \n
@@ -203,18 +223,42 @@ public class Client {
             Logger.debug("Sent: %s", logMsg);
             return true;
             
-        } catch (Exception e) {
+        } catch (IOException e) {
             Logger.error("Failed to send message", e);
             handleConnectionLost();
             return false;
         }
     }
 
+    /**
+     * Odesle nekolik pozadavku najednou (jeden zapis do socketu) bez cekani
+     * na odpovedi. Kazdy dostane ID, ktere server vrati ve svych odpovedich.
+     * Binarni ramce ID nenesou - odpovedi prijdou v poradi pozadavku.
+     * @return ID pozadavku v poradi zprav ("" v binarnim rezimu), nebo null pri chybe
+     */
+    public synchronized String[] sendPipelined(String... messages) {
+        String[] ids = new String[messages.length];
+        StringBuilder batch = new StringBuilder();
+        
+        for (int i = 0; i < messages.length; i++) {
+            if (binaryOut) {
+                ids[i] = "";
+                batch.append(messages[i]);
+                continue;
+            }
+            ids[i] = Integer.toString(nextRequestId++);
+            batch.append(Protocol.withRequestId(ids[i], messages[i]));
+        }
+        
+        return send(batch.toString()) ? ids : null;
+    }
+
     /**
      * Zjisti, zda je klient pripojen.
      */
     public boolean isConnected() {
-        return connected && socket != null && socket.isConnected() && !socket.isClosed();
+        Transport.Connection conn = connection;
+        return connected && conn != null && conn.isOpen();
     }
 
     /**
@@ -229,93 +273,202 @@ public class Client {
     // ============================================
 
     /**
-     * Spusti prijimaci vlakno.
+     * Otevre nove spojeni - kazde spojeni zacina v textovem rezimu.
+     */
+    private void openConnection() {
+        closeConnection();
+        binaryOut = false;
+        
+        ConnectionListener next = new ConnectionListener();
+        listener = next;
+        connection = transport.open(serverAddress, CONNECT_TIMEOUT, next);
+    }
+
+    /**
+     * Posle LOGIN, pripadne s priznakem binarniho rezimu - server ho zapina
+     * hned za LOGIN, dalsi zpravy proto uz jdou jako ramce.
+     */
+    private synchronized void sendLogin() {
+        send(Protocol.createLogin(nickname, BINARY_MODE));
+        binaryOut = binaryOut || BINARY_MODE;
+    }
+
+    /**
+     * Posle RESUME, pripadne s priznakem binarniho rezimu.
      */
-    private void startReceiver() {
-        receiverThread.submit(() -> {
-            Logger.debug("Receiver thread started");
+    private synchronized void sendResume(String token) {
+        send(Protocol.createResume(token, BINARY_MODE));
+        binaryOut = binaryOut || BINARY_MODE;
+    }
+
+    /**
+     * Prevede odchozi zpravy na bajty podle rezimu spojeni.
+     */
+    private byte[] encode(String message) throws IOException {
+        if (!binaryOut) {
+            return message.getBytes(StandardCharsets.UTF_8);
+        }
+        
+        ByteArrayOutputStream frames = new ByteArrayOutputStream();
+        for (String line : message.split(Protocol.TERMINATOR)) {
+            if (line.isEmpty()) continue;
+            byte[] frame = Protocol.encodeBinary(line);
+            if (frame == null) {
+                throw new IOException("Cannot encode message: " + line);
+            }
+            frames.write(frame);
+        }
+        return frames.toByteArray();
+    }
+
+    /**
+     * Udalosti jednoho spojeni z transportu.
+     */
+    private class ConnectionListener implements Transport.Listener {
+
+        @Override
+        public void onConnected(Transport.Connection conn) {
+            if (this != listener) return;
+            connection = conn;
             
-            while (connected && !Thread.currentThread().isInterrupted()) {
-                try {
-                    String line = reader.readLine();
-                    
-                    if (line == null) {
-                        // Server zavrel spojeni
-                        Logger.warning("Server closed connection");
-                        handleConnectionLost();
-                        break;
-                    }
-                    
-                    if (!line.isEmpty()) {
-                        Logger.debug("Received: %s", line);
-                        processMessage(line);
-                    }
-                    
-                } catch (SocketTimeoutException e) {
-                    // Timeout - to je ok, kontrolujeme connected flag
-                    continue;
-                } catch (IOException e) {
-                    if (connected) {
-                        Logger.error("Read error", e);
-                        handleConnectionLost();
-                    }
-                    break;
+            if (reconnecting) {
+                onReconnected();
+            } else {
+                onFirstConnected();
+            }
+        }
+
+        @Override
+        public void onMessage(Transport.Connection conn, byte[] data, int offset, int length, boolean frame) {
+            if (this != listener) return;
+            
+            if (frame) {
+                Protocol.ParsedMessage message = Protocol.parseBinary(data, offset, length);
+                Logger.debug("Received: %s (binary)", message.getRaw());
+                processParsedMessage(message);
+            } else if (length > 0) {
+                String line = new String(data, offset, length, StandardCharsets.UTF_8);
+                if (!line.trim().isEmpty()) {
+                    Logger.debug("Received: %s", line);
+                    processMessage(line);
                 }
             }
+        }
+
+        @Override
+        public void onClosed(Transport.Connection conn, IOException cause) {
+            if (this != listener) return;
             
-            Logger.debug("Receiver thread stopped");
-        });
+            CompletableFuture<Boolean> pending = pendingConnect;
+            if (pending != null) {
+                // Prvni pripojeni se nepovedlo
+                pendingConnect = null;
+                if (cause != null) {
+                    Logger.error("Failed to connect to server", cause);
+                } else {
+                    Logger.error("Failed to connect to server");
+                }
+                notifyConnectionState(ConnectionState.DISCONNECTED);
+                pending.complete(false);
+            } else if (reconnecting) {
+                Logger.warning("Reconnect attempt %d failed: %s", reconnectAttempts,
+                               cause != null ? cause.getMessage() : "connection closed");
+                reconnecting = false;
+                // Zkus znovu
+                attemptReconnect();
+            } else if (connected) {
+                if (cause == null) {
+                    Logger.warning("Server closed connection");
+                } else {
+                    Logger.error("Read error", cause);
+                }
+                handleConnectionLost();
+            }
+        }
     }
 
     /**
-     * Zastavi prijimaci vlakno.
+     * Prvni spojeni je navazane - prihlas se.
      */
-    private void stopReceiver() {
-        receiverThread.shutdownNow();
-        try {
-            receiverThread.awaitTermination(1, TimeUnit.SECONDS);
-        } catch (InterruptedException e) {
-            Thread.currentThread().interrupt();
+    private void onFirstConnected() {
+        connected = true;
+        reconnectAttempts = 0;
+        invalidMessageCount = 0;
+        disconnectHandlerCalled = false;
+        
+        startPingScheduler();
+        
+        Logger.info("Connected to server %s:%d", serverAddress.getHostString(), serverAddress.getPort());
+        notifyConnectionState(ConnectionState.CONNECTED);
+        
+        // Posli LOGIN
+        sendLogin();
+        
+        CompletableFuture<Boolean> pending = pendingConnect;
+        pendingConnect = null;
+        if (pending != null) pending.complete(true);
+    }
+
+    /**
+     * Spojeni je znovu navazane - vrat se do session.
+     */
+    private void onReconnected() {
+        connected = true;
+        reconnecting = false;
+        reconnectAttempts = 0;
+        waitingForPong = false;
+        invalidMessageCount = 0;
+        disconnectHandlerCalled = false;
+        
+        startPingScheduler();
+        
+        Logger.info("Reconnected to server successfully");
+        notifyConnectionState(ConnectionState.CONNECTED);
+        
+        // Vrat se do session podle tokenu, bez nej se prihlas znovu
+        String token = sessionToken;
+        if (token != null && !token.isEmpty()) {
+            sendResume(token);
+        } else {
+            sendLogin();
         }
-        receiverThread = Executors.newSingleThreadExecutor();
     }
 
     /**
-     * Spusti ping scheduler.
+     * Spusti ping scheduler (na vlakne transportu).
      */
     private void startPingScheduler() {
-        pingScheduler.scheduleAtFixedRate(() -> {
-            try {
-                if (connected && !waitingForPong) {
-                    if (send(Protocol.createPing())) {
-                        lastPingTime = System.currentTimeMillis();
-                        waitingForPong = true;
-                    }
-                } else if (waitingForPong) {
-                    // Kontrola PONG timeoutu - pouzij delsi timeout
-                    long elapsed = System.currentTimeMillis() - lastPingTime;
-                    if (elapsed > PONG_TIMEOUT) {
-                        Logger.warning("PONG timeout after %d ms", elapsed);
-                        handleConnectionLost();
-                    }
-                }
-            } catch (Exception e) {
-                Logger.error("Ping scheduler error", e);
+        stopPingScheduler();
+        pingTimer = transport.schedule(this::checkPing, PING_INTERVAL, PING_INTERVAL / 2);
+    }
+
+    /**
+     * Posle PING, pripadne zkontroluje PONG timeout.
+     */
+    private void checkPing() {
+        if (connected && !waitingForPong) {
+            if (send(Protocol.createPing())) {
+                lastPingTime = System.currentTimeMillis();
+                waitingForPong = true;
             }
-        }, PING_INTERVAL, PING_INTERVAL / 2, TimeUnit.MILLISECONDS);
+        } else if (waitingForPong) {
+            // Kontrola PONG timeoutu - pouzij delsi timeout
+            long elapsed = System.currentTimeMillis() - lastPingTime;
+            if (elapsed > PONG_TIMEOUT) {
+                Logger.warning("PONG timeout after %d ms", elapsed);
+                handleConnectionLost();
+            }
+        }
     }
 
     /**
      * Zastavi ping scheduler.
      */
     private void stopPingScheduler() {
-        pingScheduler.shutdownNow();
-        try {
-            pingScheduler.awaitTermination(1, TimeUnit.SECONDS);
-        } catch (InterruptedException e) {
-            Thread.currentThread().interrupt();
+        if (pingTimer != null) {
+            pingTimer.cancel();
+            pingTimer = null;
         }
-        pingScheduler = Executors.newSingleThreadScheduledExecutor();
     }
 
     /**
@@ -345,7 +498,27 @@ public class Client {
             return;
         }
         
-        Protocol.ParsedMessage message = Protocol.parse(rawMessage);
+        processParsedMessage(Protocol.parse(rawMessage));
+    }
+
+    /**
+     * Zpracuje parsovanou zpravu (z radku nebo binarniho ramce).
+     */
+    private void processParsedMessage(Protocol.ParsedMessage message) {
+        // Uz jsme se rozhodli odpojit - ignoruj dalsi zpravy
+        if (disconnectHandlerCalled || !connected) {
+            return;
+        }
+        
+        // Odpoved na LOGIN/RESUME je posledni textova zprava
+        Protocol.MessageType type = message.getType();
+        Transport.Connection conn = connection;
+        if (binaryOut && conn != null && !conn.isFrameMode() && (type == Protocol.MessageType.LOGIN_OK
+                || type == Protocol.MessageType.LOGIN_ERR
+                || type == Protocol.MessageType.RESUME_OK
+                || type == Protocol.MessageType.RESUME_ERR)) {
+            conn.setFrameMode(true);
+        }
         
         // Kontrola UNKNOWN typu (nevalidni prikaz)
         if (message.getType() == Protocol.MessageType.UNKNOWN) {
@@ -354,7 +527,7 @@ public class Client {
             // Loguj jen prvnich par chyb
             if (invalidMessageCount <= Protocol.MAX_INVALID_MESSAGES) {
                 Logger.warning("Unknown message type from server (%d/%d): %s", 
-                              invalidMessageCount, Protocol.MAX_INVALID_MESSAGES, rawMessage);
+                              invalidMessageCount, Protocol.MAX_INVALID_MESSAGES, message.getRaw());
             }
             
             if (invalidMessageCount >= Protocol.MAX_INVALID_MESSAGES) {
@@ -379,6 +552,24 @@ public class Client {
             return;
         }
         
+        // Session token - uloz si ho a predej zpravu dal
+        if (message.getType() == Protocol.MessageType.LOGIN_OK && message.getParamCount() > 0) {
+            sessionToken = message.getParam(0);
+        }
+        
+        // Vysledek RESUME zpracuj lokalne
+        if (message.getType() == Protocol.MessageType.RESUME_OK) {
+            Logger.info("Session resumed");
+            return;
+        }
+        if (message.getType() == Protocol.MessageType.RESUME_ERR) {
+            // Session vyprsela (napr. hrac byl v lobby) - prihlas se znovu
+            Logger.warning("Session resume failed: %s", message.getParam(1));
+            sessionToken = null;
+            sendLogin();
+            return;
+        }
+        
         // Zpracuj SERVER_SHUTDOWN
         if (message.getType() == Protocol.MessageType.SERVER_SHUTDOWN) {
             Logger.info("Server is shutting down");
@@ -403,15 +594,16 @@ public class Client {
         
         Logger.warning("Connection lost");
         connected = false;
-        closeSocket();
+        waitingForPong = false;
+        stopPingScheduler();
+        closeConnection();
         
         // Zkus reconnect
         attemptReconnect();
     }
     
     /**
-     * Zpracuje odpojeni kvuli nevalidnim datum.
-     * Spusti se v samostatnem vlakne, aby nedoslo k deadlocku.
+     * Zpracuje odpojeni kvuli nevalidnim datum (bez reconnectu).
      */
     private void handleInvalidDataDisconnect() {
         // Zabran vicenasobnemu volani
@@ -420,29 +612,17 @@ public class Client {
         }
         disconnectHandlerCalled = true;
         
-        // Spust v novem vlakne - nemuzeme volat disconnect z receiver threadu
-        CompletableFuture.runAsync(() -> {
-            try {
-                // Kratka pauza, aby se receiver thread stihl ukoncit
-                Thread.sleep(100);
-            } catch (InterruptedException e) {
-                Thread.currentThread().interrupt();
-            }
-            
-            // Nastav flag aby receiver thread skoncil
-            connected = false;
-            closeSocket();
-            
-            // Notifikuj o odpojeni
-            notifyConnectionState(ConnectionState.DISCONNECTED);
-            
-            // Zavolej disconnect handler na JavaFX ukazat dialog
-            if (disconnectHandler != null) {
-                Platform.runLater(() -> {
-                    disconnectHandler.run();
-                });
-            }
-        });
+        connected = false;
+        stopPingScheduler();
+        closeConnection();
+        
+        // Notifikuj o odpojeni
+        notifyConnectionState(ConnectionState.DISCONNECTED);
+        
+        // Handler si sam prejde na vlakno UI
+        if (disconnectHandler != null) {
+            disconnectHandler.run();
+        }
     }
 
     /**
@@ -462,79 +642,28 @@ public class Client {
         reconnecting = true;
         reconnectAttempts++;
         
+        // Rostouci odstup - cekej dele s kazdym pokusem (nejvys 3x interval)
+        long waitTime = RECONNECT_INTERVAL * Math.min(reconnectAttempts, 3);
+        
         notifyConnectionState(ConnectionState.RECONNECTING);
         Logger.info("Attempting reconnect %d/%d in %d ms...", 
-                    reconnectAttempts, MAX_RECONNECT_ATTEMPTS, RECONNECT_INTERVAL);
+                    reconnectAttempts, MAX_RECONNECT_ATTEMPTS, waitTime);
         
-        // Spust reconnect ve vlastnim vlakne
-        CompletableFuture.runAsync(() -> {
-            try {
-                // Exponencialni backoff - cekej dele s kazdym pokusem
-                long waitTime = RECONNECT_INTERVAL * Math.min(reconnectAttempts, 3);
-                Thread.sleep(waitTime);
-                
-                if (!reconnecting) return;
-                
-                // Zavri stary socket, pokud existuje
-                closeSocket();
-                
-                socket = new Socket();
-                socket.connect(new InetSocketAddress(serverHost, serverPort), CONNECT_TIMEOUT);
-                socket.setSoTimeout(READ_TIMEOUT);
-                socket.setKeepAlive(true);
-                socket.setTcpNoDelay(true);
-                socket.setReceiveBufferSize(8192);
-                socket.setSendBufferSize(8192);
-                
-                reader = new BufferedReader(new InputStreamReader(socket.getInputStream(), "UTF-8"));
-                writer = new PrintWriter(new OutputStreamWriter(socket.getOutputStream(), "UTF-8"), true);
-                
-                connected = true;
-                reconnecting = false;
-                reconnectAttempts = 0;
-                waitingForPong = false;
-                invalidMessageCount = 0;
-                disconnectHandlerCalled = false;
-                
-                // Spust prijimaci vlakno
-                startReceiver();
-                
-                // Spust ping scheduler
-                startPingScheduler();
-                
-                Logger.info("Reconnected to server successfully");
-                notifyConnectionState(ConnectionState.CONNECTED);
-                
-                // Posli LOGIN pro reconnect
-                send(Protocol.createLogin(nickname));
-                
-            } catch (InterruptedException e) {
-                Logger.info("Reconnect interrupted");
-                reconnecting = false;
-                Thread.currentThread().interrupt();
-            } catch (Exception e) {
-                Logger.warning("Reconnect attempt %d failed: %s", reconnectAttempts, e.getMessage());
-                reconnecting = false;
-                // Zkus znovu
-                attemptReconnect();
+        reconnectTimer = transport.schedule(() -> {
+            if (reconnecting) {
+                openConnection();
             }
-        });
+        }, waitTime);
     }
 
     /**
-     * Zavre socket.
+     * Zavre aktualni spojeni - jeho dalsi udalosti se ignoruji.
      */
-    private void closeSocket() {
-        try {
-            if (reader != null) reader.close();
-            if (writer != null) writer.close();
-            if (socket != null && !socket.isClosed()) socket.close();
-        } catch (IOException e) {
-            // Ignoruj
-        }
-        reader = null;
-        writer = null;
-        socket = null;
+    private void closeConnection() {
+        listener = null;
+        Transport.Connection conn = connection;
+        connection = null;
+        if (conn != null) conn.close();
     }
 
     /**
@@ -551,8 +680,6 @@ public class Client {
      */
     public void shutdown() {
         disconnect(false);
-        receiverThread.shutdownNow();
-        pingScheduler.shutdownNow();
     }
 }
 
@@ -1,7 +1,12 @@
 package nim.network;
 
 import nim.util.Logger;
+import java.io.ByteArrayOutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 
 /**
@@ -21,20 +26,42 @@ public class Protocol {
     
     /** Maximalni pocet nevalidnich zprav pred odpojenim */
     public static final int MAX_INVALID_MESSAGES = 3;
+    
+    /** Uvod volitelneho ID pozadavku (#id;ZPRAVA) - server ho vraci v odpovedich */
+    public static final String REQUEST_ID_PREFIX = "#";
+    
+    /** Priznak binarniho rezimu v LOGIN/RESUME (LOGIN;nick;bin) */
+    public static final String BINARY_CAPABILITY = "bin";
+    
+    /** Delka hlavicky binarniho ramce (delka tela, u16 big-endian) */
+    public static final int BINARY_FRAME_HEADER = 2;
+    
+    /** Pole binarniho ramce: 0x00-0x7F je primo male cislo */
+    private static final int BIN_FIELD_SMALL_MAX = 0x7F;
+    private static final int BIN_FIELD_INT = 0x80;
+    private static final int BIN_FIELD_STRING = 0x81;
 
     /**
      * Typy zprav.
+     * Poradi odpovida MessageType serveru - v binarnim rezimu se typ posila
+     * jako ordinal(), nove typy patri jen pred UNKNOWN.
      */
     public enum MessageType {
         // Klientske zpravy
         LOGIN, LIST_ROOMS, CREATE_ROOM, JOIN_ROOM, LEAVE_ROOM,
-        TAKE, SKIP, PING, LOGOUT,
+        TAKE, SKIP, PING, LOGOUT, RESUME, ADD_BOT, HINT, WATCH, UNWATCH,
+        TOURNAMENT_CREATE, TOURNAMENT_JOIN, TOURNAMENT_LEAVE, TOURNAMENT_START,
+        LEADERBOARD, QUICK_MATCH, QUICK_MATCH_CANCEL,
         
         // Serverove zpravy
         LOGIN_OK, LOGIN_ERR, ROOMS, ROOM_CREATED, ROOM_JOINED, ROOM_ERR,
         LEAVE_OK, GAME_START, TAKE_OK, TAKE_ERR, SKIP_OK, SKIP_ERR,
         OPPONENT_ACTION, GAME_OVER, PONG, PLAYER_STATUS, ERROR,
-        SERVER_SHUTDOWN, WAIT_OPPONENT, GAME_RESUMED,
+        SERVER_SHUTDOWN, WAIT_OPPONENT, GAME_RESUMED, RESUME_OK, RESUME_ERR,
+        HINT_OK, HINT_ERR, WATCH_OK, WATCH_ERR, UNWATCH_OK,
+        TOURNAMENT_OPEN, TOURNAMENT_OK, TOURNAMENT_ERR, TOURNAMENT_LEFT,
+        TOURNAMENT_MATCH, TOURNAMENT_ADVANCE, TOURNAMENT_OVER, LEADERBOARD_OK,
+        QUICK_MATCH_WAIT, QUICK_MATCH_FOUND, QUICK_MATCH_CANCELLED, QUICK_MATCH_ERR,
         
         // Specialni
         UNKNOWN
@@ -63,6 +90,12 @@ public class Protocol {
         SERVER_FULL(16),
         MAX_ROOMS(17),
         GAME_IN_PROGRESS(18),
+        INVALID_SESSION(20),
+        INVALID_RULES(21),
+        NO_TOURNAMENT(22),
+        TOURNAMENT_EXISTS(23),
+        NOT_ORGANIZER(24),
+        TOO_FEW_ENTRANTS(25),
         INTERNAL(99);
 
         private final int code;
@@ -94,6 +127,7 @@ public class Protocol {
         private MessageType type;
         private String[] params;
         private String raw;
+        private String requestId = "";
 
         public ParsedMessage(MessageType type, String[] params, String raw) {
             this.type = type;
@@ -101,6 +135,13 @@ public class Protocol {
             this.raw = raw;
         }
 
+        /**
+         * ID pozadavku, na ktery zprava odpovida ("" = bez ID).
+         */
+        public String getRequestId() {
+            return requestId;
+        }
+
         public MessageType getType() {
             return type;
         }
@@ -124,6 +165,43 @@ public class Protocol {
             }
         }
 
+        /**
+         * Vrati parametr jako cislo, nebo vychozi hodnotu pokud chybi
+         * (volitelne parametry na konci zpravy).
+         */
+        public int getParamAsInt(int index, int defaultValue) {
+            return index < params.length ? getParamAsInt(index) : defaultValue;
+        }
+
+        /**
+         * Vrati parametr jako seznam cisel oddelenych carkou
+         * (prazdne pole, pokud chybi nebo neni platny).
+         */
+        public int[] getParamAsIntList(int index) {
+            String param = getParam(index);
+            if (param.isEmpty()) return new int[0];
+            String[] parts = param.split(",");
+            int[] values = new int[parts.length];
+            try {
+                for (int i = 0; i < parts.length; i++) {
+                    values[i] = Integer.parseInt(parts[i]);
+                }
+            } catch (NumberFormatException e) {
+                return new int[0];
+            }
+            return values;
+        }
+
+        /**
+         * Vrati parametr jako seznam retezcu oddelenych carkou
+         * (prazdny seznam, pokud chybi).
+         */
+        public List<String> getParamAsList(int index) {
+            String param = getParam(index);
+            if (param.isEmpty()) return new ArrayList<>();
+            return new ArrayList<>(Arrays.asList(param.split(",")));
+        }
+
         public boolean getParamAsBoolean(int index) {
             String param = getParam(index);
             return "1".equals(param) || "true".equalsIgnoreCase(param);
@@ -202,6 +280,14 @@ public class Protocol {
         // Odstran \r\n
         String message = rawMessage.trim();
 
+        // Odpoved na pozadavek s ID
+        String requestId = "";
+        if (message.startsWith(REQUEST_ID_PREFIX) && message.contains(DELIMITER)) {
+            int end = message.indexOf(DELIMITER);
+            requestId = message.substring(REQUEST_ID_PREFIX.length(), end);
+            message = message.substring(end + 1);
+        }
+
         // Rozdel na casti
         String[] parts = message.split(DELIMITER, -1);
         if (parts.length == 0) {
@@ -221,7 +307,160 @@ public class Protocol {
         String[] params = new String[parts.length - 1];
         System.arraycopy(parts, 1, params, 0, params.length);
 
-        return new ParsedMessage(type, params, rawMessage);
+        ParsedMessage parsed = new ParsedMessage(type, params, rawMessage);
+        parsed.requestId = requestId;
+        return parsed;
+    }
+
+    /**
+     * Prevede textovou zpravu na binarni ramec: delka tela (u16 big-endian),
+     * typ zpravy, pole - cislo 0-127 jako jeden bajt, jine cele cislo
+     * 0x80 + zigzag varint, retezec 0x81 + varint delka + bajty.
+     * @return Ramec, nebo null pro neznamy typ zpravy
+     */
+    public static byte[] encodeBinary(String message) {
+        String[] parts = message.trim().split(DELIMITER, -1);
+        MessageType type;
+        try {
+            type = MessageType.valueOf(parts[0]);
+        } catch (IllegalArgumentException e) {
+            return null;
+        }
+        if (type == MessageType.UNKNOWN) return null;
+        
+        ByteArrayOutputStream body = new ByteArrayOutputStream();
+        body.write(type.ordinal());
+        
+        for (int i = 1; i < parts.length; i++) {
+            Integer value = fieldToInt(parts[i]);
+            if (value != null && value >= 0 && value <= BIN_FIELD_SMALL_MAX) {
+                body.write(value);
+            } else if (value != null) {
+                body.write(BIN_FIELD_INT);
+                writeVarint(body, (value << 1) ^ (value >> 31));
+            } else {
+                byte[] bytes = parts[i].getBytes(StandardCharsets.UTF_8);
+                body.write(BIN_FIELD_STRING);
+                writeVarint(body, bytes.length);
+                body.write(bytes, 0, bytes.length);
+            }
+        }
+        
+        byte[] frame = new byte[BINARY_FRAME_HEADER + body.size()];
+        frame[0] = (byte) (body.size() >> 8);
+        frame[1] = (byte) body.size();
+        System.arraycopy(body.toByteArray(), 0, frame, BINARY_FRAME_HEADER, body.size());
+        return frame;
+    }
+
+    /**
+     * Parsuje telo binarniho ramce (bez hlavicky delky).
+     * Chybny ramec vrati jako UNKNOWN.
+     */
+    public static ParsedMessage parseBinary(byte[] body) {
+        return parseBinary(body, 0, body.length);
+    }
+
+    /**
+     * Parsuje telo binarniho ramce primo v bufferu prijemce (bez kopie).
+     * @param data Buffer s prijatymi daty
+     * @param offset Zacatek tela ramce
+     * @param length Delka tela ramce
+     */
+    public static ParsedMessage parseBinary(byte[] data, int offset, int length) {
+        MessageType[] types = MessageType.values();
+        if (length == 0 || (data[offset] & 0xFF) >= MessageType.UNKNOWN.ordinal()) {
+            return new ParsedMessage(MessageType.UNKNOWN, new String[0], "(binary)");
+        }
+        
+        List<String> params = new ArrayList<>();
+        int end = offset + length;
+        int pos = offset + 1;
+        try {
+            while (pos < end) {
+                int field = data[pos++] & 0xFF;
+                if (field <= BIN_FIELD_SMALL_MAX) {
+                    params.add(Integer.toString(field));
+                    continue;
+                }
+                
+                long[] varint = readVarint(data, pos, end);
+                pos = (int) varint[1];
+                if (field == BIN_FIELD_INT) {
+                    int zigzag = (int) varint[0];
+                    params.add(Integer.toString((zigzag >>> 1) ^ -(zigzag & 1)));
+                } else if (field == BIN_FIELD_STRING && varint[0] <= end - pos) {
+                    String value = new String(data, pos, (int) varint[0], StandardCharsets.UTF_8);
+                    if (!isValidProtocolData(value) || value.contains(DELIMITER)) {
+                        throw new IllegalArgumentException("Invalid string field");
+                    }
+                    params.add(value);
+                    pos += (int) varint[0];
+                } else {
+                    throw new IllegalArgumentException("Invalid field");
+                }
+            }
+        } catch (IllegalArgumentException e) {
+            Logger.warning("Invalid binary frame: %s", e.getMessage());
+            return new ParsedMessage(MessageType.UNKNOWN, new String[0], "(binary)");
+        }
+        
+        MessageType type = types[data[offset] & 0xFF];
+        String[] values = params.toArray(new String[0]);
+        
+        // Textova podoba jen pro logy a toString()
+        StringBuilder raw = new StringBuilder(type.name());
+        for (String value : values) {
+            raw.append(DELIMITER).append(value);
+        }
+        return new ParsedMessage(type, values, raw.toString());
+    }
+
+    /**
+     * Vrati hodnotu pole, ktere se da poslat jako cislo a prevest zpet
+     * na stejny text (bez uvodnich nul a "-0"), jinak null.
+     */
+    private static Integer fieldToInt(String field) {
+        int start = field.startsWith("-") ? 1 : 0;
+        int digits = field.length() - start;
+        if (digits == 0 || digits > 9) return null;
+        if (field.charAt(start) == '0' && (digits > 1 || start == 1)) return null;
+        for (int i = start; i < field.length(); i++) {
+            char c = field.charAt(i);
+            if (c < '0' || c > '9') return null;
+        }
+        return Integer.parseInt(field);
+    }
+
+    private static void writeVarint(ByteArrayOutputStream out, int value) {
+        while ((value & ~0x7F) != 0) {
+            out.write((value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        out.write(value);
+    }
+
+    /**
+     * Precte varint (nejvys 5 bajtu) pred pozici end.
+     * @return {hodnota, pozice za varintem}
+     */
+    private static long[] readVarint(byte[] data, int pos, int end) {
+        long value = 0;
+        for (int i = 0; i < 5 && pos < end; i++) {
+            int b = data[pos++] & 0xFF;
+            value |= (long) (b & 0x7F) << (7 * i);
+            if ((b & 0x80) == 0) {
+                return new long[] { value & 0xFFFFFFFFL, pos };
+            }
+        }
+        throw new IllegalArgumentException("Invalid varint");
+    }
+
+    /**
+     * Oznaci zpravu ID pozadavku.
+     */
+    public static String withRequestId(String requestId, String message) {
+        return REQUEST_ID_PREFIX + requestId + DELIMITER + message;
     }
 
     // ============================================
@@ -232,6 +471,14 @@ public class Protocol {
         return "LOGIN" + DELIMITER + nickname + TERMINATOR;
     }
 
+    /**
+     * @param binary Vyjednat binarni rezim (dalsi zpravy po odpovedi na LOGIN)
+     */
+    public static String createLogin(String nickname, boolean binary) {
+        return binary ? "LOGIN" + DELIMITER + nickname + DELIMITER + BINARY_CAPABILITY + TERMINATOR
+                      : createLogin(nickname);
+    }
+
     public static String createListRooms() {
         return "LIST_ROOMS" + TERMINATOR;
     }
@@ -240,6 +487,13 @@ public class Protocol {
         return "CREATE_ROOM" + DELIMITER + name + TERMINATOR;
     }
 
+    /**
+     * @param rules Pravidla mistnosti, napr. "preset=quick" nebo "piles=3,4,5"
+     */
+    public static String createCreateRoom(String name, String rules) {
+        return "CREATE_ROOM" + DELIMITER + name + DELIMITER + rules + TERMINATOR;
+    }
+
     public static String createJoinRoom(int roomId) {
         return "JOIN_ROOM" + DELIMITER + roomId + TERMINATOR;
     }
@@ -252,6 +506,10 @@ public class Protocol {
         return "TAKE" + DELIMITER + count + TERMINATOR;
     }
 
+    public static String createTake(int pile, int count) {
+        return "TAKE" + DELIMITER + pile + DELIMITER + count + TERMINATOR;
+    }
+
     public static String createSkip() {
         return "SKIP" + TERMINATOR;
     }
@@ -268,6 +526,59 @@ public class Protocol {
         return "LOGOUT" + TERMINATOR;
     }
 
+    public static String createResume(String token) {
+        return "RESUME" + DELIMITER + token + TERMINATOR;
+    }
+
+    public static String createResume(String token, boolean binary) {
+        return binary ? "RESUME" + DELIMITER + token + DELIMITER + BINARY_CAPABILITY + TERMINATOR
+                      : createResume(token);
+    }
+
+    public static String createAddBot() {
+        return "ADD_BOT" + TERMINATOR;
+    }
+
+    public static String createHint() {
+        return "HINT" + TERMINATOR;
+    }
+
+    public static String createWatch(int roomId) {
+        return "WATCH" + DELIMITER + roomId + TERMINATOR;
+    }
+
+    public static String createUnwatch() {
+        return "UNWATCH" + TERMINATOR;
+    }
+
+    public static String createTournamentCreate(String name, String rules) {
+        return "TOURNAMENT_CREATE" + DELIMITER + name + DELIMITER + rules + TERMINATOR;
+    }
+
+    public static String createTournamentJoin() {
+        return "TOURNAMENT_JOIN" + TERMINATOR;
+    }
+
+    public static String createTournamentLeave() {
+        return "TOURNAMENT_LEAVE" + TERMINATOR;
+    }
+
+    public static String createTournamentStart() {
+        return "TOURNAMENT_START" + TERMINATOR;
+    }
+
+    public static String createLeaderboard(int count) {
+        return "LEADERBOARD" + DELIMITER + count + TERMINATOR;
+    }
+
+    public static String createQuickMatch() {
+        return "QUICK_MATCH" + TERMINATOR;
+    }
+
+    public static String createQuickMatchCancel() {
+        return "QUICK_MATCH_CANCEL" + TERMINATOR;
+    }
+
     /**
      * Vrati textovy popis chyboveho kodu.
      */
@@ -292,6 +603,12 @@ public class Protocol {
             case SERVER_FULL: return "Server je plný";
             case MAX_ROOMS: return "Dosažen limit místností";
             case GAME_IN_PROGRESS: return "Hra již probíhá";
+            case INVALID_SESSION: return "Neplatná nebo vypršená relace";
+            case INVALID_RULES: return "Neplatná pravidla hry";
+            case NO_TOURNAMENT: return "Žádný turnaj neprobíhá";
+            case TOURNAMENT_EXISTS: return "Turnaj již probíhá";
+            case NOT_ORGANIZER: return "Turnaj může spustit jen jeho zakladatel";
+            case TOO_FEW_ENTRANTS: return "Turnaj má málo účastníků";
             case INTERNAL: return "Interní chyba serveru";
             default: return "Neznámá chyba";
         }
@@ -0,0 +1,526 @@
+package nim.network;
+
+import nim.util.Logger;
+
+import java.io.IOException;
+import java.io.UncheckedIOException;
+import java.net.InetSocketAddress;
+import java.net.StandardSocketOptions;
+import java.nio.ByteBuffer;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.SocketChannel;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Iterator;
+import java.util.PriorityQueue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+
+/**
+ * Neblokujici sitova vrstva nad NIO selectorem.
+ * Jedno vlakno obsluhuje libovolny pocet spojeni (pripojeni, cteni, zapis)
+ * i jejich casovace (ping, reconnect) - spojeni nema vlastni vlakno.
+ * Prijata data se deli na zpravy primo v bufferu spojeni, String z nich
+ * vyrobi az prijemce.
+ */
+public class Transport {
+
+    /** Velikost bufferu pro prijem (vic nez nejdelsi zprava) */
+    private static final int RECEIVE_BUFFER_SIZE = 4096;
+
+    /** Velikost socket bufferu v jadre */
+    private static final int SOCKET_BUFFER_SIZE = 8192;
+
+    /** Nejvic bajtu cekajicich na odeslani - pomalejsi spojeni se zavre */
+    private static final int SEND_QUEUE_LIMIT = 64 * 1024;
+
+    /** Sdilena instance (GUI klient) */
+    private static Transport shared;
+
+    private final Selector selector;
+    private final Thread thread;
+
+    /** Ukoly od ostatnich vlaken, spusti je vlakno selectoru */
+    private final ConcurrentLinkedQueue<Runnable> tasks = new ConcurrentLinkedQueue<>();
+
+    /** Casovace podle terminu (jen vlakno selectoru) */
+    private final PriorityQueue<Timeout> timeouts = new PriorityQueue<>();
+
+    private volatile boolean stopped = false;
+
+    /**
+     * Udalosti spojeni. Vola je vlakno selectoru - handler nesmi blokovat.
+     */
+    public interface Listener {
+
+        /**
+         * Spojeni je navazane.
+         */
+        void onConnected(Connection connection);
+
+        /**
+         * Prijata zprava - radek bez \n, v rezimu ramcu telo ramce.
+         * Data plati jen behem volani, buffer se pak prepise.
+         */
+        void onMessage(Connection connection, byte[] data, int offset, int length, boolean frame);
+
+        /**
+         * Spojeni skoncilo (nepovedene pripojeni, konec od serveru, chyba).
+         * Po close() se nevola.
+         * @param cause Chyba, nebo null pokud server spojeni zavrel
+         */
+        void onClosed(Connection connection, IOException cause);
+    }
+
+    /**
+     * Vytvori transport a spusti jeho vlakno.
+     */
+    public Transport() throws IOException {
+        this.selector = Selector.open();
+        this.thread = new Thread(this::run, "nim-transport");
+        this.thread.setDaemon(true);
+        this.thread.start();
+    }
+
+    /**
+     * Vrati sdileny transport (vytvori ho pri prvnim pouziti).
+     */
+    public static synchronized Transport shared() {
+        if (shared == null) {
+            try {
+                shared = new Transport();
+            } catch (IOException e) {
+                throw new UncheckedIOException("Cannot open selector", e);
+            }
+        }
+        return shared;
+    }
+
+    /**
+     * Zahaji neblokujici pripojeni. Vysledek prijde pres onConnected / onClosed.
+     * @param address Adresa serveru (uz prelozena - vlakno selectoru neresi DNS)
+     * @param connectTimeout Nejdelsi doba pripojeni (ms)
+     */
+    public Connection open(InetSocketAddress address, int connectTimeout, Listener listener) {
+        Connection connection = new Connection(listener);
+        // Vzdy az v dalsim pruchodu smycky - volajici si spojeni stihne ulozit
+        execute(() -> connection.start(address, connectTimeout));
+        return connection;
+    }
+
+    /**
+     * Naplanuje jednorazovy ukol na vlakne selectoru.
+     */
+    public Timeout schedule(Runnable task, long delayMs) {
+        return schedule(task, delayMs, 0);
+    }
+
+    /**
+     * Naplanuje ukol na vlakne selectoru, pri periodMs > 0 opakovany.
+     */
+    public Timeout schedule(Runnable task, long delayMs, long periodMs) {
+        Timeout timeout = new Timeout(task, now() + delayMs, periodMs);
+        runOnTransport(() -> timeouts.add(timeout));
+        return timeout;
+    }
+
+    /**
+     * Spusti ukol na vlakne selectoru (z libovolneho vlakna).
+     */
+    public void execute(Runnable task) {
+        tasks.add(task);
+        selector.wakeup();
+    }
+
+    /**
+     * Zastavi vlakno a zavre vsechna spojeni (bez onClosed).
+     */
+    public void close() {
+        stopped = true;
+        selector.wakeup();
+    }
+
+    // ============================================
+    // Casovac
+    // ============================================
+
+    /**
+     * Naplanovany ukol - zrusit ho jde z libovolneho vlakna.
+     */
+    public static class Timeout implements Comparable<Timeout> {
+        private final Runnable task;
+        private final long period;
+        private long deadline;
+        private volatile boolean cancelled = false;
+
+        private Timeout(Runnable task, long deadline, long period) {
+            this.task = task;
+            this.deadline = deadline;
+            this.period = period;
+        }
+
+        public void cancel() {
+            cancelled = true;
+        }
+
+        @Override
+        public int compareTo(Timeout other) {
+            return Long.compare(deadline, other.deadline);
+        }
+    }
+
+    // ============================================
+    // Spojeni
+    // ============================================
+
+    /**
+     * Jedno spojeni na serveru. send() a close() jdou volat z libovolneho vlakna.
+     */
+    public class Connection {
+        private final Listener listener;
+
+        /** Prijata data, ktera jeste netvori celou zpravu (pouziva se porad dokola) */
+        private final ByteBuffer receiveBuffer = ByteBuffer.allocate(RECEIVE_BUFFER_SIZE);
+
+        /** Data, ktera se nevesla do socketu (zamek i pro connected/closed) */
+        private final ArrayDeque<ByteBuffer> sendQueue = new ArrayDeque<>();
+        private int queuedBytes = 0;
+
+        private volatile SocketChannel channel;
+        private SelectionKey key;
+        private Timeout connectTimeout;
+        private boolean connected = false;
+        private volatile boolean closed = false;
+
+        /** Prichozi zpravy jsou binarni ramce (jinak radky) */
+        private volatile boolean frameMode = false;
+
+        private Connection(Listener listener) {
+            this.listener = listener;
+        }
+
+        /**
+         * Odesle data. Co se nevejde do socketu, pocka ve fronte
+         * (stejne tak data poslana jeste pred navazanim spojeni).
+         * @return false pokud je spojeni zavrene nebo fronta plna
+         */
+        public boolean send(byte[] data) {
+            ByteBuffer buffer = ByteBuffer.wrap(data);
+
+            synchronized (sendQueue) {
+                if (closed) return false;
+
+                if (connected && sendQueue.isEmpty()) {
+                    try {
+                        channel.write(buffer);
+                    } catch (IOException e) {
+                        execute(() -> fail(e));
+                        return false;
+                    }
+                    if (!buffer.hasRemaining()) return true;
+                    execute(this::watchWritable);
+                }
+
+                if (queuedBytes + buffer.remaining() > SEND_QUEUE_LIMIT) {
+                    execute(() -> fail(new IOException("Send queue full")));
+                    return false;
+                }
+                sendQueue.add(buffer);
+                queuedBytes += buffer.remaining();
+                return true;
+            }
+        }
+
+        /**
+         * Prepne prijem mezi radky a binarnimi ramci. Volano z onMessage
+         * plati uz pro dalsi zpravu ve stejnem bufferu.
+         */
+        public void setFrameMode(boolean frameMode) {
+            this.frameMode = frameMode;
+        }
+
+        public boolean isFrameMode() {
+            return frameMode;
+        }
+
+        public boolean isOpen() {
+            return !closed;
+        }
+
+        /**
+         * Zavre spojeni (odeslana data se jeste zkusi dopsat).
+         */
+        public void close() {
+            synchronized (sendQueue) {
+                if (closed) return;
+                closed = true;
+            }
+            runOnTransport(this::release);
+        }
+
+        /**
+         * Otevre socket a zahaji pripojeni (vlakno selectoru).
+         */
+        private void start(InetSocketAddress address, int timeoutMs) {
+            if (closed) return;
+
+            try {
+                if (address.isUnresolved()) {
+                    throw new IOException("Unknown host " + address.getHostString());
+                }
+
+                channel = SocketChannel.open();
+                channel.configureBlocking(false);
+                // Zabranit Nagle algoritmu pro rychlejsi odezvu, keepalive pro detekci odpojeni
+                channel.setOption(StandardSocketOptions.TCP_NODELAY, true);
+                channel.setOption(StandardSocketOptions.SO_KEEPALIVE, true);
+                channel.setOption(StandardSocketOptions.SO_RCVBUF, SOCKET_BUFFER_SIZE);
+                channel.setOption(StandardSocketOptions.SO_SNDBUF, SOCKET_BUFFER_SIZE);
+                key = channel.register(selector, SelectionKey.OP_CONNECT, this);
+
+                if (channel.connect(address)) {
+                    finishConnect();
+                } else {
+                    connectTimeout = schedule(() -> fail(new IOException("Connect timed out")), timeoutMs);
+                }
+            } catch (IOException e) {
+                fail(e);
+            }
+        }
+
+        /**
+         * Obslouzi pripravenost socketu (vlakno selectoru).
+         */
+        private void handle() {
+            try {
+                if (key.isValid() && key.isConnectable()) {
+                    finishConnect();
+                    return;
+                }
+                if (key.isValid() && key.isWritable()) {
+                    flush();
+                }
+                if (key.isValid() && key.isReadable()) {
+                    read();
+                }
+            } catch (IOException e) {
+                fail(e);
+            }
+        }
+
+        private void finishConnect() throws IOException {
+            if (!channel.finishConnect()) return;
+            if (connectTimeout != null) connectTimeout.cancel();
+
+            synchronized (sendQueue) {
+                connected = true;
+            }
+            flush();
+            listener.onConnected(this);
+        }
+
+        /**
+         * Precte data a preda vsechny cele zpravy v bufferu.
+         */
+        private void read() throws IOException {
+            if (channel.read(receiveBuffer) < 0) {
+                fail(null);
+                return;
+            }
+
+            byte[] data = receiveBuffer.array();
+            int length = receiveBuffer.position();
+            int start = 0;
+
+            while (!closed) {
+                if (frameMode) {
+                    if (length - start < Protocol.BINARY_FRAME_HEADER) break;
+                    int size = ((data[start] & 0xFF) << 8) | (data[start + 1] & 0xFF);
+                    int end = start + Protocol.BINARY_FRAME_HEADER + size;
+                    if (end > length) break;
+                    listener.onMessage(this, data, start + Protocol.BINARY_FRAME_HEADER, size, true);
+                    start = end;
+                } else {
+                    int end = lineEnd(data, start, length);
+                    if (end < 0) break;
+                    listener.onMessage(this, data, start, end - start, false);
+                    start = end + 1;
+                }
+            }
+            if (closed) return;
+
+            // Nedokoncenou zpravu presun na zacatek bufferu
+            receiveBuffer.flip();
+            receiveBuffer.position(start);
+            receiveBuffer.compact();
+            if (!receiveBuffer.hasRemaining()) {
+                throw new IOException("Message too long");
+            }
+        }
+
+        /**
+         * Zapise cekajici data a podle zbytku nastavi zajem o zapis.
+         */
+        private void flush() throws IOException {
+            synchronized (sendQueue) {
+                while (!sendQueue.isEmpty()) {
+                    ByteBuffer head = sendQueue.peek();
+                    queuedBytes -= channel.write(head);
+                    if (head.hasRemaining()) break;
+                    sendQueue.poll();
+                }
+                key.interestOps(sendQueue.isEmpty() ? SelectionKey.OP_READ
+                        : SelectionKey.OP_READ | SelectionKey.OP_WRITE);
+            }
+        }
+
+        /**
+         * Zacne cekat na moznost zapisu (po castecnem zapisu v send()).
+         */
+        private void watchWritable() {
+            if (!closed && key != null && key.isValid()) {
+                key.interestOps(SelectionKey.OP_READ | SelectionKey.OP_WRITE);
+            }
+        }
+
+        /**
+         * Ukonci spojeni kvuli chybe nebo konci od serveru a oznami to.
+         */
+        private void fail(IOException cause) {
+            synchronized (sendQueue) {
+                if (closed) return;
+                closed = true;
+            }
+            release();
+            listener.onClosed(this, cause);
+        }
+
+        /**
+         * Uvolni socket (vlakno selectoru). Cekajici data zkusi jeste jednou zapsat.
+         */
+        private void release() {
+            if (connectTimeout != null) connectTimeout.cancel();
+            if (key != null) key.cancel();
+            if (channel == null) return;
+
+            synchronized (sendQueue) {
+                try {
+                    while (connected && !sendQueue.isEmpty() && channel.write(sendQueue.peek()) > 0) {
+                        if (!sendQueue.peek().hasRemaining()) sendQueue.poll();
+                    }
+                } catch (IOException e) {
+                    // Ignoruj
+                }
+                connected = false;
+                sendQueue.clear();
+                queuedBytes = 0;
+            }
+
+            try {
+                channel.close();
+            } catch (IOException e) {
+                // Ignoruj
+            }
+        }
+    }
+
+    // ============================================
+    // Privatni metody
+    // ============================================
+
+    /**
+     * Smycka vlakna selectoru: ukoly, casovace, udalosti socketu.
+     */
+    private void run() {
+        Logger.debug("Transport thread started");
+
+        while (!stopped) {
+            try {
+                Runnable task;
+                while ((task = tasks.poll()) != null) {
+                    runSafely(task);
+                }
+
+                // 0 = zadny casovac, select() pak ceka jen na sockety a wakeup()
+                selector.select(runTimeouts());
+
+                Iterator<SelectionKey> keys = selector.selectedKeys().iterator();
+                while (keys.hasNext()) {
+                    SelectionKey key = keys.next();
+                    keys.remove();
+                    Connection connection = (Connection) key.attachment();
+                    runSafely(connection::handle);
+                }
+            } catch (IOException e) {
+                Logger.error("Selector failed", e);
+                break;
+            }
+        }
+
+        for (SelectionKey key : new ArrayList<>(selector.keys())) {
+            ((Connection) key.attachment()).close();
+        }
+        try {
+            selector.close();
+        } catch (IOException e) {
+            // Ignoruj
+        }
+        Logger.debug("Transport thread stopped");
+    }
+
+    /**
+     * Spusti splatne casovace.
+     * @return Cas do dalsiho casovace v ms (alespon 1), 0 pokud zadny neni
+     */
+    private long runTimeouts() {
+        long now = now();
+        Timeout next;
+
+        while ((next = timeouts.peek()) != null && (next.cancelled || next.deadline <= now)) {
+            timeouts.poll();
+            if (next.cancelled) continue;
+            if (next.period > 0) {
+                next.deadline = now + next.period;
+                timeouts.add(next);
+            }
+            runSafely(next.task);
+        }
+        return next == null ? 0 : Math.max(1, next.deadline - now);
+    }
+
+    /**
+     * Spusti ukol - chyba handleru nesmi shodit vlakno ostatnich spojeni.
+     */
+    private void runSafely(Runnable task) {
+        try {
+            task.run();
+        } catch (RuntimeException e) {
+            Logger.error("Transport task failed", e);
+        }
+    }
+
+    /**
+     * Spusti ukol hned, pokud uz bezi vlakno selectoru, jinak ho preda.
+     */
+    private void runOnTransport(Runnable task) {
+        if (Thread.currentThread() == thread) {
+            task.run();
+        } else {
+            execute(task);
+        }
+    }
+
+    /**
+     * Konec prvniho radku v datech (pozice \n), nebo -1.
+     */
+    private static int lineEnd(byte[] data, int start, int end) {
+        for (int i = start; i < end; i++) {
+            if (data[i] == '\n') return i;
+        }
+        return -1;
+    }
+
+    private static long now() {
+        return System.nanoTime() / 1_000_000;
+    }
+}
@@ -33,13 +33,17 @@ public class GameView {
     private FlowPane stonesPane;
     private Label stonesCountLabel;
     private Label turnLabel;
+    private Label clockLabel;
     private Label opponentLabel;
     private Label opponentStatusLabel;
     private Label mySkipsLabel;
     private Label oppSkipsLabel;
     private Spinner<Integer> takeSpinner;
+    private ComboBox<String> pileCombo;
     private Button takeButton;
     private Button skipButton;
+    private Button hintButton;
+    private Label hintLabel;
     private Label statusLabel;
     private Region statusIndicator;
     private VBox gameOverPane;
@@ -48,6 +52,12 @@ public class GameView {
 
     private List<Circle> stoneCircles = new ArrayList<>();
 
+    /** Odpocet hodin tahu (bezi, dokud je obrazovka zobrazena) */
+    private Timeline clockTimeline;
+
+    /** Hromadka posledniho odeslaneho TAKE (TAKE_OK ji neopakuje) */
+    private int lastTakePile = 0;
+
     public GameView(Stage stage, Client client, GameState gameState) {
         this.stage = stage;
         this.client = client;
@@ -75,14 +85,16 @@ public class GameView {
         VBox playersInfo = new VBox(5);
         playersInfo.setAlignment(Pos.CENTER_RIGHT);
         
-        Label myLabel = Components.createText("Vy: " + gameState.getNickname());
-        opponentLabel = Components.createText("Soupeř: " + gameState.getOpponentNickname());
+        Label myLabel = Components.createText(
+                (gameState.isSpectating() ? "Divák: " : "Vy: ") + gameState.getNickname());
+        opponentLabel = Components.createText(opponentText());
         opponentStatusLabel = Components.createTextLight("");
         updateOpponentStatus();
         
         playersInfo.getChildren().addAll(myLabel, opponentLabel, opponentStatusLabel);
         
-        Button leaveButton = Components.createDangerButton("Opustit hru");
+        Button leaveButton = Components.createDangerButton(
+                gameState.isSpectating() ? "Přestat sledovat" : "Opustit hru");
         leaveButton.setOnAction(e -> handleLeaveGame());
         
         header.getChildren().addAll(title, spacer, playersInfo, leaveButton);
@@ -98,10 +110,11 @@ public class GameView {
         
         VBox turnBox = new VBox(5);
         turnBox.setAlignment(Pos.CENTER);
-        turnLabel = Components.createHeading(gameState.isMyTurn() ? "Jste na tahu!" : "Soupeř je na tahu");
+        turnLabel = Components.createHeading(turnText());
         turnLabel.setTextFill(Color.web(gameState.isMyTurn() ? 
                 Components.SUCCESS_COLOR : Components.TEXT_LIGHT));
-        turnBox.getChildren().add(turnLabel);
+        clockLabel = Components.createTextLight("");
+        turnBox.getChildren().addAll(turnLabel, clockLabel);
         
         VBox stonesBox = new VBox(5);
         stonesBox.setAlignment(Pos.CENTER);
@@ -113,6 +126,12 @@ public class GameView {
         skipsBox.setAlignment(Pos.CENTER);
         mySkipsLabel = Components.createText("Vaše přeskočení: " + gameState.getMySkipsRemaining());
         oppSkipsLabel = Components.createText("Soupeřova přeskočení: " + gameState.getOpponentSkipsRemaining());
+        // Pri vice hracich nema pocitadlo jedineho soupere smysl
+        oppSkipsLabel.setVisible(!gameState.isMultiPlayer());
+        oppSkipsLabel.setManaged(!gameState.isMultiPlayer());
+        // Divak nema vlastni pocitadla
+        skipsBox.setVisible(!gameState.isSpectating());
+        skipsBox.setManaged(!gameState.isSpectating());
         skipsBox.getChildren().addAll(mySkipsLabel, oppSkipsLabel);
         
         infoPanel.getChildren().addAll(turnBox, stonesBox, skipsBox);
@@ -126,7 +145,7 @@ public class GameView {
         stonesPane.setAlignment(Pos.CENTER);
         stonesPane.setPrefWrapLength(500);
         
-        createStoneCircles(gameState.getStones());
+        renderStones();
         
         stonesCard.getChildren().add(stonesPane);
 
@@ -139,16 +158,29 @@ public class GameView {
         
         Label takeLabel = Components.createText("Počet kamínků:");
         
-        takeSpinner = new Spinner<>(1, gameState.getMaxTake(), 1);
+        // Vyber hromadky - jen u varianty s vice hromadkami
+        pileCombo = new ComboBox<>();
+        pileCombo.setStyle(Components.STYLE_TEXT_FIELD);
+        pileCombo.setVisible(gameState.isMultiPile());
+        pileCombo.setManaged(gameState.isMultiPile());
+        pileCombo.getSelectionModel().selectedIndexProperty().addListener(
+                (obs, oldIndex, newIndex) -> updateTakeSpinner());
+        
+        int minTake = gameState.getMinTake(0);
+        takeSpinner = new Spinner<>(minTake, Math.max(minTake, gameState.getMaxTake(0)), minTake);
         takeSpinner.setEditable(false);
         takeSpinner.setPrefWidth(80);
         takeSpinner.setStyle(Components.STYLE_TEXT_FIELD);
         
+        if (gameState.isMultiPile()) {
+            updatePileCombo();
+        }
+        
         takeButton = Components.createPrimaryButton("Vzít kamínky");
         takeButton.setOnAction(e -> handleTake());
         takeButton.setDisable(!gameState.isMyTurn());
         
-        takeBox.getChildren().addAll(takeLabel, takeSpinner, takeButton);
+        takeBox.getChildren().addAll(takeLabel, pileCombo, takeSpinner, takeButton);
         
         VBox skipBox = new VBox(10);
         skipBox.setAlignment(Pos.CENTER);
@@ -164,7 +196,26 @@ public class GameView {
         
         skipBox.getChildren().addAll(skipLabel, skipButton, skipNote);
         
-        controlsPanel.getChildren().addAll(takeBox, skipBox);
+        VBox hintBox = new VBox(10);
+        hintBox.setAlignment(Pos.CENTER);
+        
+        Label hintTitle = Components.createText("Nápověda:");
+        
+        hintButton = Components.createSecondaryButton("Poradit tah");
+        hintButton.setOnAction(e -> handleHint());
+        hintButton.setDisable(!gameState.isMyTurn());
+        
+        hintLabel = Components.createTextLight("");
+        hintLabel.setWrapText(true);
+        hintLabel.setMaxWidth(200);
+        
+        hintBox.getChildren().addAll(hintTitle, hintButton, hintLabel);
+        
+        controlsPanel.getChildren().addAll(takeBox, skipBox, hintBox);
+        
+        // Divak hru jen sleduje
+        controlsPanel.setVisible(!gameState.isSpectating());
+        controlsPanel.setManaged(!gameState.isSpectating());
 
         // Game over overlay (skryty)
         gameOverPane = new VBox(20);
@@ -206,10 +257,82 @@ public class GameView {
 
         Scene scene = new Scene(root, 900, 700);
         stage.setScene(scene);
+        startClockTimeline(scene);
 
         Logger.info("Game view displayed");
     }
 
+    /**
+     * Spusti odpocet hodin tahu; zastavi se sam, jakmile obrazovku nahradi jina.
+     */
+    private void startClockTimeline(Scene scene) {
+        updateClockLabel();
+        clockTimeline = new Timeline(new KeyFrame(Duration.millis(200), e -> {
+            if (stage.getScene() != scene) {
+                clockTimeline.stop();
+                return;
+            }
+            updateClockLabel();
+        }));
+        clockTimeline.setCycleCount(Animation.INDEFINITE);
+        clockTimeline.play();
+    }
+
+    /**
+     * Zobrazi zbyvajici cas hrace na tahu (bez hodin je popisek prazdny).
+     */
+    private void updateClockLabel() {
+        if (!gameState.hasTurnClock()) {
+            clockLabel.setText("");
+            return;
+        }
+        long seconds = (gameState.getTurnTimeLeft() + 999) / 1000;
+        clockLabel.setText(String.format("Zbývá %d:%02d", seconds / 60, seconds % 60));
+        clockLabel.setTextFill(Color.web(seconds <= 5 ? Components.DANGER_COLOR
+                                                      : Components.TEXT_LIGHT));
+    }
+
+    /**
+     * Vykresli kameny podle varianty hry (jedna hromadka nebo radky hromadek).
+     */
+    private void renderStones() {
+        if (gameState.isMultiPile()) {
+            createPileRows();
+        } else {
+            createStoneCircles(gameState.getStones());
+        }
+    }
+
+    /**
+     * Vytvori kameny po hromadkach - kazda hromadka na vlastnim radku.
+     */
+    private void createPileRows() {
+        stonesPane.getChildren().clear();
+        stoneCircles.clear();
+        
+        int[] piles = gameState.getPiles();
+        for (int p = 0; p < piles.length; p++) {
+            FlowPane row = new FlowPane(4, 4);
+            row.setAlignment(Pos.CENTER_LEFT);
+            row.setPrefWrapLength(500);
+            row.setMinWidth(500);
+            
+            Label pileLabel = Components.createText((p + 1) + ":");
+            pileLabel.setMinWidth(30);
+            row.getChildren().add(pileLabel);
+            
+            for (int i = 0; i < piles[p]; i++) {
+                Circle circle = new Circle(10);
+                circle.setFill(Color.web(Components.PRIMARY_COLOR));
+                circle.setStroke(Color.web(Components.SECONDARY_COLOR));
+                circle.setStrokeWidth(1);
+                row.getChildren().add(circle);
+            }
+            
+            stonesPane.getChildren().add(row);
+        }
+    }
+
     /**
      * Vytvori vizualni reprezentaci kamenu.
      */
@@ -277,6 +400,33 @@ public class GameView {
         }
     }
 
+    /**
+     * Text s hraci - jediny souper, nebo vsichni hraci v poradi tahu.
+     */
+    private String opponentText() {
+        if (gameState.isMultiPlayer() || gameState.isSpectating()) {
+            return "Hráči: " + String.join(", ", gameState.getPlayers());
+        }
+        return "Soupeř: " + gameState.getOpponentNickname();
+    }
+
+    /**
+     * Text s hracem na tahu.
+     */
+    private String turnText() {
+        if (gameState.isMyTurn()) {
+            return "Jste na tahu!";
+        }
+        if ((gameState.isMultiPlayer() || gameState.isSpectating())
+                && !gameState.getCurrentPlayer().isEmpty()) {
+            return "Na tahu: " + gameState.getCurrentPlayer();
+        }
+        if (gameState.isSpectating()) {
+            return "Čekání na začátek hry";
+        }
+        return "Soupeř je na tahu";
+    }
+
     /**
      * Aktualizuje UI podle stavu hry.
      */
@@ -285,25 +435,74 @@ public class GameView {
         boolean myTurn = gameState.isMyTurn();
         
         stonesCountLabel.setText(String.valueOf(stones));
-        turnLabel.setText(myTurn ? "Jste na tahu!" : "Soupeř je na tahu");
+        opponentLabel.setText(opponentText());
+        turnLabel.setText(turnText());
         turnLabel.setTextFill(Color.web(myTurn ? Components.SUCCESS_COLOR : Components.TEXT_LIGHT));
         
         mySkipsLabel.setText("Vaše přeskočení: " + gameState.getMySkipsRemaining());
         oppSkipsLabel.setText("Soupeřova přeskočení: " + gameState.getOpponentSkipsRemaining());
         
-        // Aktualizuj spinner
-        int maxTake = gameState.getMaxTake();
-        SpinnerValueFactory.IntegerSpinnerValueFactory factory = 
-                new SpinnerValueFactory.IntegerSpinnerValueFactory(1, Math.max(1, maxTake), 1);
-        takeSpinner.setValueFactory(factory);
+        // Aktualizuj vyber hromadky a spinner (rozsah podle pravidel mistnosti)
+        if (gameState.isMultiPile()) {
+            updatePileCombo();
+        }
+        updateTakeSpinner();
         
         // Aktualizuj tlacitka
         takeButton.setDisable(!myTurn || stones == 0);
         skipButton.setDisable(!myTurn || !gameState.canSkip());
+        hintButton.setDisable(!myTurn || stones == 0);
+        if (!myTurn) {
+            hintLabel.setText("");
+        }
         
         updateOpponentStatus();
     }
 
+    /**
+     * Obnovi polozky vyberu hromadky; zachova vyber, pokud hromadka neni prazdna.
+     */
+    private void updatePileCombo() {
+        int[] piles = gameState.getPiles();
+        int selected = Math.max(0, pileCombo.getSelectionModel().getSelectedIndex());
+        
+        List<String> items = new ArrayList<>();
+        for (int i = 0; i < piles.length; i++) {
+            items.add("Hromádka " + (i + 1) + " (" + piles[i] + ")");
+        }
+        pileCombo.getItems().setAll(items);
+        
+        if (selected >= piles.length || piles[selected] == 0) {
+            for (int i = 0; i < piles.length; i++) {
+                if (piles[i] > 0) {
+                    selected = i;
+                    break;
+                }
+            }
+        }
+        pileCombo.getSelectionModel().select(selected);
+    }
+
+    /**
+     * Vrati index vybrane hromadky (klasicka varianta = 0).
+     */
+    private int selectedPile() {
+        if (!gameState.isMultiPile()) return 0;
+        return Math.max(0, pileCombo.getSelectionModel().getSelectedIndex());
+    }
+
+    /**
+     * Nastavi rozsah spinneru podle vybrane hromadky.
+     */
+    private void updateTakeSpinner() {
+        int pile = selectedPile();
+        int minTake = gameState.getMinTake(pile);
+        int maxTake = gameState.getMaxTake(pile);
+        SpinnerValueFactory.IntegerSpinnerValueFactory factory = 
+                new SpinnerValueFactory.IntegerSpinnerValueFactory(minTake, Math.max(minTake, maxTake), minTake);
+        takeSpinner.setValueFactory(factory);
+    }
+
     /**
      * Aktualizuje status protihrace.
      */
@@ -343,6 +542,14 @@ public class GameView {
         String winner = gameState.getWinner();
         boolean iWon = winner.equals(gameState.getNickname());
         
+        if (gameState.isSpectating()) {
+            gameOverTitle.setText("Konec hry!");
+            gameOverTitle.setTextFill(Color.web(Components.PRIMARY_COLOR));
+            gameOverMessage.setText("Vyhrál " + winner);
+            gameOverPane.setVisible(true);
+            return;
+        }
+        
         gameOverTitle.setText(iWon ? "Vyhráli jste!" : "Prohráli jste");
         gameOverTitle.setTextFill(Color.web(iWon ? Components.SUCCESS_COLOR : Components.DANGER_COLOR));
         
@@ -363,17 +570,28 @@ public class GameView {
      * Zpracuje tah - vzeti kamenu.
      */
     private void handleTake() {
+        int pile = selectedPile();
         int count = takeSpinner.getValue();
         
-        if (!gameState.isValidTake(count)) {
+        if (!gameState.isValidTake(pile, count)) {
             Components.showError("Chyba", "Neplatný počet kamínků");
             return;
         }
         
         takeButton.setDisable(true);
         skipButton.setDisable(true);
+        hintButton.setDisable(true);
         
-        client.send(Protocol.createTake(count));
+        lastTakePile = pile;
+        client.send(gameState.isMultiPile() ? Protocol.createTake(pile, count) : Protocol.createTake(count));
+    }
+
+    /**
+     * Pozada server o doporuceny tah.
+     */
+    private void handleHint() {
+        hintButton.setDisable(true);
+        client.send(Protocol.createHint());
     }
 
     /**
@@ -395,6 +613,11 @@ public class GameView {
      * Zpracuje opusteni hry.
      */
     private void handleLeaveGame() {
+        if (gameState.isSpectating()) {
+            client.send(Protocol.createUnwatch());
+            return;
+        }
+        
         if (gameState.getPhase() == GameState.Phase.IN_GAME) {
             boolean confirm = Components.showConfirm("Opustit hru?", 
                     "Opravdu chcete opustit hru? Prohra bude započítána.");
@@ -434,6 +657,7 @@ public class GameView {
                         // Disabluj ovládací prvky
                         takeButton.setDisable(true);
                         skipButton.setDisable(true);
+                        hintButton.setDisable(true);
                         break;
                     case CONNECTING:
                         statusLabel.setText("Připojování...");
@@ -448,6 +672,7 @@ public class GameView {
                         // Disabluj ovládací prvky během reconnectu
                         takeButton.setDisable(true);
                         skipButton.setDisable(true);
+                        hintButton.setDisable(true);
                         break;
                 }
             });
@@ -501,6 +726,14 @@ public class GameView {
                 handleSkipErr(message);
                 break;
                 
+            case HINT_OK:
+                handleHintOk(message);
+                break;
+                
+            case HINT_ERR:
+                handleHintErr(message);
+                break;
+                
             case OPPONENT_ACTION:
                 handleOpponentAction(message);
                 break;
@@ -514,15 +747,40 @@ public class GameView {
                 break;
                 
             case LEAVE_OK:
+            case UNWATCH_OK:
+                // UNWATCH_OK posle server i divakovi zanikle mistnosti
                 gameState.leaveRoom();
                 LobbyView lobbyView = new LobbyView(stage, client, gameState);
                 lobbyView.show();
                 break;
                 
+            case WATCH_OK:
+                handleWatchOk(message);
+                break;
+                
+            case GAME_START:
+                handleGameStart(message);
+                break;
+                
             case GAME_RESUMED:
                 handleGameResumed(message);
                 break;
                 
+            case TOURNAMENT_MATCH:
+                // Dalsi zapas turnaje - obrazovku sestavi nasledujici GAME_START
+                Logger.info("Tournament round %d vs %s", message.getParamAsInt(0),
+                            message.getParam(2));
+                break;
+                
+            case TOURNAMENT_ADVANCE:
+                gameOverMessage.setText("Postupujete do " + message.getParamAsInt(0) +
+                                        ". kola, čekejte na soupeře");
+                break;
+                
+            case TOURNAMENT_OVER:
+                handleTournamentOver(message);
+                break;
+                
             case ERROR:
                 Components.showError("Chyba", "Chyba serveru: " + message.getParam(1));
                 break;
@@ -541,9 +799,14 @@ public class GameView {
         boolean stillMyTurn = message.getParamAsBoolean(1);
         
         int taken = gameState.getStones() - remaining;
-        removeStonesAnimated(taken);
         
-        gameState.myTakeSucceeded(remaining, stillMyTurn);
+        gameState.setTurnClock(message.getParamAsInt(2, 0));
+        gameState.myTakeSucceeded(lastTakePile, remaining, stillMyTurn);
+        if (gameState.isMultiPile()) {
+            createPileRows();
+        } else {
+            removeStonesAnimated(taken);
+        }
     }
 
     /**
@@ -557,11 +820,44 @@ public class GameView {
         updateUI();
     }
 
+    /**
+     * Zobrazi doporuceny tah a predvyplni ho do ovladacich prvku.
+     */
+    private void handleHintOk(Protocol.ParsedMessage message) {
+        int pile = message.getParamAsInt(0);
+        int count = message.getParamAsInt(1);
+        boolean winning = message.getParamAsBoolean(2);
+        
+        String advice;
+        if (count == 0) {
+            advice = "Přeskočte tah";
+        } else if (gameState.isMultiPile()) {
+            pileCombo.getSelectionModel().select(pile);
+            takeSpinner.getValueFactory().setValue(count);
+            advice = "Vezměte " + count + " z hromádky " + (pile + 1);
+        } else {
+            takeSpinner.getValueFactory().setValue(count);
+            advice = "Vezměte " + count;
+        }
+        hintLabel.setText(advice + (winning ? " (vyhraná pozice)" : " (soupeř má výhodu)"));
+        hintButton.setDisable(!gameState.isMyTurn());
+    }
+
+    /**
+     * Zpracuje chybu napovedy.
+     */
+    private void handleHintErr(Protocol.ParsedMessage message) {
+        int errorCode = message.getParamAsInt(0);
+        hintLabel.setText(Protocol.getErrorMessage(Protocol.ErrorCode.fromCode(errorCode)));
+        hintButton.setDisable(!gameState.isMyTurn());
+    }
+
     /**
      * Zpracuje uspesne preskoceni.
      */
     private void handleSkipOk(Protocol.ParsedMessage message) {
         boolean stillMyTurn = message.getParamAsBoolean(0);
+        gameState.setTurnClock(message.getParamAsInt(1, 0));
         gameState.mySkipSucceeded(stillMyTurn);
     }
 
@@ -583,13 +879,20 @@ public class GameView {
         String action = message.getParam(0);
         int param = message.getParamAsInt(1);
         int remaining = message.getParamAsInt(2);
+        int pile = message.getParamAsInt(3, 0);
+        String next = message.getParam(5);
         
+        gameState.setTurnClock(message.getParamAsInt(6, 0));
         if ("TAKE".equals(action)) {
             int taken = gameState.getStones() - remaining;
-            removeStonesAnimated(taken);
-            gameState.opponentTook(param, remaining);
+            gameState.opponentTook(pile, param, remaining, next);
+            if (gameState.isMultiPile()) {
+                createPileRows();
+            } else {
+                removeStonesAnimated(taken);
+            }
         } else if ("SKIP".equals(action)) {
-            gameState.opponentSkipped(remaining);
+            gameState.opponentSkipped(remaining, next);
         }
     }
 
@@ -603,6 +906,17 @@ public class GameView {
         gameState.endGame(winner, loser);
     }
 
+    /**
+     * Zpracuje konec turnaje (hrac uz je zpet v lobby).
+     */
+    private void handleTournamentOver(Protocol.ParsedMessage message) {
+        String winner = message.getParam(1);
+        gameState.leaveTournament();
+        gameOverMessage.setText(winner.isEmpty() ? "Turnaj byl zrušen" :
+                winner.equals(gameState.getNickname()) ? "Vyhráli jste turnaj!" :
+                "Turnaj vyhrál " + winner);
+    }
+
     /**
      * Zpracuje zmenu stavu hrace.
      */
@@ -626,6 +940,37 @@ public class GameView {
         }
     }
 
+    /**
+     * Divak dostal aktualni stav hry (resynchronizace po zahozenych udalostech).
+     */
+    private void handleWatchOk(Protocol.ParsedMessage message) {
+        gameState.setTurnClock(message.getParamAsInt(8, 0));
+        gameState.watchGame(message.getParamAsInt(0), null, message.getParamAsInt(2),
+                            message.getParam(3),
+                            message.getParamAsInt(4, GameState.MIN_TAKE),
+                            message.getParamAsInt(5, GameState.MAX_TAKE),
+                            message.getParamAsIntList(6), message.getParamAsList(7));
+        renderStones();
+        updateUI();
+    }
+
+    /**
+     * Zpracuje zacatek hry, na kterou divak cekal.
+     */
+    private void handleGameStart(Protocol.ParsedMessage message) {
+        gameState.startGame(message.getParamAsInt(0), message.getParamAsBoolean(1),
+                            message.getParam(2),
+                            message.getParamAsInt(3, GameState.MIN_TAKE),
+                            message.getParamAsInt(4, GameState.MAX_TAKE),
+                            message.getParamAsInt(5, GameState.SKIPS_PER_PLAYER),
+                            message.getParamAsIntList(6), message.getParamAsList(7),
+                            message.getParamAsInt(8, 0));
+        
+        // Pravidla a hromadky se mohly zmenit - obrazovka se sestavi znovu
+        GameView gameView = new GameView(stage, client, gameState);
+        gameView.show();
+    }
+
     /**
      * Zpracuje obnoveni hry.
      */
@@ -634,9 +979,14 @@ public class GameView {
         boolean myTurn = message.getParamAsBoolean(1);
         int mySkips = message.getParamAsInt(2);
         int oppSkips = message.getParamAsInt(3);
-        
-        gameState.resumeGame(stones, myTurn, mySkips, oppSkips);
-        createStoneCircles(stones);
+        int minTake = message.getParamAsInt(4, GameState.MIN_TAKE);
+        int maxTake = message.getParamAsInt(5, GameState.MAX_TAKE);
+        int[] piles = message.getParamAsIntList(6);
+        List<String> players = message.getParamAsList(7);
+        
+        gameState.setTurnClock(message.getParamAsInt(8, 0));
+        gameState.resumeGame(stones, myTurn, mySkips, oppSkips, minTake, maxTake, piles, players);
+        renderStones();
         updateUI();
     }
 }
@@ -24,6 +24,21 @@ import java.util.List;
  */
 public class LobbyView {
 
+    /** Pravidla variant hry pro CREATE_ROOM */
+    private static final String[] ROOM_RULES = {
+        "preset=classic", "preset=quick", "preset=long", "piles=3,4,5"
+    };
+
+    /** Cas na tah pro CREATE_ROOM clock=N (0 = bez hodin) */
+    private static final int[] CLOCK_SECONDS = { 0, 15, 30, 60 };
+
+    /** Rozsah poctu hracu v mistnosti (ROOM_MAX_PLAYERS serveru) */
+    private static final int MIN_PLAYERS = 2;
+    private static final int MAX_PLAYERS = 16;
+
+    /** Delka zebricku (LEADERBOARD_SIZE serveru) */
+    private static final int LEADERBOARD_SIZE = 10;
+
     private final Stage stage;
     private final Client client;
     private final GameState gameState;
@@ -33,13 +48,24 @@ public class LobbyView {
     private ObservableList<RoomRow> roomsList;
     private Button refreshButton;
     private Button createButton;
+    private Button quickMatchButton;
+    private Button botButton;
     private Button joinButton;
+    private Button watchButton;
     private TextField roomNameField;
+    private ComboBox<String> presetCombo;
+    private Spinner<Integer> playersSpinner;
+    private ComboBox<String> clockCombo;
+    private Button tournamentCreateButton;
+    private Button tournamentJoinButton;
+    private Button tournamentStartButton;
+    private Label tournamentLabel;
     private Label statusLabel;
     private Region statusIndicator;
     private Label errorLabel;
     private Label waitingLabel;
     private VBox waitingPane;
+    private boolean quickMatchQueued;
 
     /**
      * Radek tabulky mistnosti.
@@ -85,10 +111,12 @@ public class LobbyView {
         Label title = Components.createHeading("Lobby");
         Region spacer = Components.createSpacer();
         Label userLabel = Components.createText("Hráč: " + gameState.getNickname());
+        Button leaderboardButton = Components.createSecondaryButton("Žebříček");
+        leaderboardButton.setOnAction(e -> client.send(Protocol.createLeaderboard(LEADERBOARD_SIZE)));
         Button logoutButton = Components.createSecondaryButton("Odhlásit");
         logoutButton.setOnAction(e -> handleLogout());
         
-        header.getChildren().addAll(title, spacer, userLabel, logoutButton);
+        header.getChildren().addAll(title, spacer, userLabel, leaderboardButton, logoutButton);
 
         // Hlavni obsah
         HBox mainContent = new HBox(20);
@@ -122,7 +150,11 @@ public class LobbyView {
         joinButton.setOnAction(e -> handleJoinRoom());
         joinButton.setDisable(true);
         
-        roomButtons.getChildren().addAll(refreshButton, joinButton);
+        watchButton = Components.createSecondaryButton("Sledovat");
+        watchButton.setOnAction(e -> handleWatchRoom());
+        watchButton.setDisable(true);
+        
+        roomButtons.getChildren().addAll(refreshButton, joinButton, watchButton);
 
         // Chybova zprava
         errorLabel = Components.createErrorLabel("");
@@ -142,10 +174,61 @@ public class LobbyView {
         roomNameField = Components.createTextField("Název místnosti");
         roomNameField.setOnAction(e -> handleCreateRoom());
 
+        // Varianta hry - poradi odpovida ROOM_RULES
+        presetCombo = new ComboBox<>(FXCollections.observableArrayList(
+                "Klasická (21 kamínků, 1-3)",
+                "Rychlá (11 kamínků, 1-2)",
+                "Dlouhá (41 kamínků, 1-5)",
+                "Více hromádek (3, 4, 5)"
+        ));
+        presetCombo.getSelectionModel().selectFirst();
+        presetCombo.setMaxWidth(Double.MAX_VALUE);
+        presetCombo.setStyle(Components.STYLE_TEXT_FIELD);
+
+        // Pocet hracu v mistnosti (2 = klasicka hra dvou hracu)
+        playersSpinner = new Spinner<>(MIN_PLAYERS, MAX_PLAYERS, MIN_PLAYERS);
+        playersSpinner.setEditable(false);
+        playersSpinner.setMaxWidth(Double.MAX_VALUE);
+        playersSpinner.setStyle(Components.STYLE_TEXT_FIELD);
+        Label playersLabel = Components.createTextLight("Počet hráčů");
+        HBox playersBox = new HBox(10, playersLabel, playersSpinner);
+        playersBox.setAlignment(Pos.CENTER_LEFT);
+        HBox.setHgrow(playersSpinner, Priority.ALWAYS);
+
+        // Hodiny tahu - poradi odpovida CLOCK_SECONDS
+        clockCombo = new ComboBox<>(FXCollections.observableArrayList(
+                "Bez časového limitu", "15 s na tah", "30 s na tah", "60 s na tah"
+        ));
+        clockCombo.getSelectionModel().selectFirst();
+        clockCombo.setMaxWidth(Double.MAX_VALUE);
+        clockCombo.setStyle(Components.STYLE_TEXT_FIELD);
+
         createButton = Components.createPrimaryButton("Vytvořit");
         createButton.setMaxWidth(Double.MAX_VALUE);
         createButton.setOnAction(e -> handleCreateRoom());
 
+        // Rychla hra - soupere s podobnym hodnocenim najde server
+        quickMatchButton = Components.createSecondaryButton("Rychlá hra");
+        quickMatchButton.setMaxWidth(Double.MAX_VALUE);
+        quickMatchButton.setOnAction(e -> {
+            hideError();
+            client.send(Protocol.createQuickMatch());
+        });
+
+        // Turnaj - nazev a pravidla se berou z formulare mistnosti
+        tournamentCreateButton = Components.createSecondaryButton("Založit turnaj");
+        tournamentCreateButton.setOnAction(e -> handleTournamentCreate());
+        tournamentJoinButton = Components.createSecondaryButton("Přihlásit se");
+        tournamentJoinButton.setOnAction(e -> handleTournamentJoin());
+        tournamentStartButton = Components.createPrimaryButton("Spustit");
+        tournamentStartButton.setOnAction(e -> client.send(Protocol.createTournamentStart()));
+        tournamentStartButton.setDisable(true);
+        HBox tournamentBox = new HBox(10, tournamentCreateButton, tournamentJoinButton,
+                                      tournamentStartButton);
+        tournamentBox.setAlignment(Pos.CENTER);
+        tournamentLabel = Components.createTextLight("");
+        tournamentLabel.setWrapText(true);
+
         // Pravidla hry
         VBox rulesBox = new VBox(5);
         rulesBox.setPadding(new Insets(20, 0, 0, 0));
@@ -154,16 +237,21 @@ public class LobbyView {
         rulesTitle.setStyle("-fx-font-weight: bold;");
         
         Label rules = Components.createTextLight(
-                "• Začíná se s 21 kamínky\n" +
-                "• Střídáte se v odebírání 1-3 kamínků\n" +
+                "• Začíná se s 21 kamínky (podle varianty)\n" +
+                "• Střídáte se v odebírání 1-3 kamínků (podle varianty)\n" +
                 "• Kdo vezme poslední, prohrává\n" +
-                "• Každý hráč může 1× přeskočit tah"
+                "• Přeskočení tahu: klasická 1×, rychlá 0×, dlouhá 2×\n" +
+                "• Více hromádek: libovolný počet z jedné hromádky, bez přeskočení\n" +
+                "• Více hráčů: hraje se po řadě, vyhrává hráč za tím, kdo vzal poslední\n" +
+                "• Časový limit: kdo nestihne táhnout, prohrává"
         );
         rules.setWrapText(true);
         
         rulesBox.getChildren().addAll(rulesTitle, rules);
 
-        createPanel.getChildren().addAll(createTitle, roomNameField, createButton, rulesBox);
+        createPanel.getChildren().addAll(createTitle, roomNameField, presetCombo, playersBox,
+                                         clockCombo, createButton, quickMatchButton, tournamentBox,
+                                         tournamentLabel, rulesBox);
 
         // Cekaci panel (skryty)
         waitingPane = Components.createCard();
@@ -176,10 +264,19 @@ public class LobbyView {
         ProgressIndicator waitingProgress = new ProgressIndicator();
         waitingProgress.setMaxSize(40, 40);
         
+        botButton = Components.createSecondaryButton("Hrát proti botovi");
+        botButton.setOnAction(e -> handleAddBot());
+
         Button cancelButton = Components.createDangerButton("Zrušit");
-        cancelButton.setOnAction(e -> handleLeaveRoom());
+        cancelButton.setOnAction(e -> {
+            if (quickMatchQueued) {
+                client.send(Protocol.createQuickMatchCancel());
+            } else {
+                handleLeaveRoom();
+            }
+        });
 
-        waitingPane.getChildren().addAll(waitingLabel, waitingProgress, cancelButton);
+        waitingPane.getChildren().addAll(waitingLabel, waitingProgress, botButton, cancelButton);
 
         mainContent.getChildren().addAll(roomsPanel, createPanel, waitingPane);
 
@@ -198,7 +295,16 @@ public class LobbyView {
 
         // Selection listener pro tabulku
         roomsTable.getSelectionModel().selectedItemProperty().addListener(
-                (obs, oldVal, newVal) -> joinButton.setDisable(newVal == null));
+                (obs, oldVal, newVal) -> {
+                    joinButton.setDisable(newVal == null);
+                    watchButton.setDisable(newVal == null);
+                });
+
+        // Do lobby se hrac vraci i mezi zapasy turnaje
+        updateTournamentControls();
+        if (gameState.getTournament() != null) {
+            tournamentLabel.setText("Přihlášen do turnaje " + gameState.getTournament());
+        }
 
         // Nacti seznam mistnosti
         handleRefresh();
@@ -270,7 +376,61 @@ public class LobbyView {
         }
         
         hideError();
-        client.send(Protocol.createCreateRoom(name));
+        int preset = Math.max(0, presetCombo.getSelectionModel().getSelectedIndex());
+        int players = playersSpinner.getValue();
+        String rules = ROOM_RULES[preset];
+        if (players != MIN_PLAYERS) {
+            rules += ";players=" + players;
+        }
+        int clock = CLOCK_SECONDS[Math.max(0, clockCombo.getSelectionModel().getSelectedIndex())];
+        if (clock > 0) {
+            rules += ";clock=" + clock;
+        }
+        client.send(Protocol.createCreateRoom(name, rules));
+    }
+
+    /**
+     * Zalozi turnaj s nazvem a pravidly z formulare (hraje se vzdy ve dvou).
+     */
+    private void handleTournamentCreate() {
+        String name = roomNameField.getText().trim();
+        
+        if (!name.matches("^[a-zA-Z0-9_ ]{1,64}$")) {
+            showError("Zadejte název turnaje (písmena, čísla, mezery a podtržítka)");
+            roomNameField.requestFocus();
+            return;
+        }
+        
+        hideError();
+        int preset = Math.max(0, presetCombo.getSelectionModel().getSelectedIndex());
+        String rules = ROOM_RULES[preset];
+        int clock = CLOCK_SECONDS[Math.max(0, clockCombo.getSelectionModel().getSelectedIndex())];
+        if (clock > 0) {
+            rules += ";clock=" + clock;
+        }
+        client.send(Protocol.createTournamentCreate(name, rules));
+    }
+
+    /**
+     * Prihlasi hrace do turnaje, prihlaseneho z nej odhlasi.
+     */
+    private void handleTournamentJoin() {
+        hideError();
+        client.send(gameState.getTournament() != null ?
+                Protocol.createTournamentLeave() : Protocol.createTournamentJoin());
+    }
+
+    /**
+     * Prepne ovladani turnaje podle toho, zda je hrac prihlaseny.
+     */
+    private void updateTournamentControls() {
+        boolean entered = gameState.getTournament() != null;
+        tournamentCreateButton.setDisable(entered);
+        tournamentJoinButton.setText(entered ? "Odhlásit se" : "Přihlásit se");
+        tournamentStartButton.setDisable(!entered);
+        createButton.setDisable(entered);
+        quickMatchButton.setDisable(entered);
+        joinButton.setDisable(entered || roomsTable.getSelectionModel().isEmpty());
     }
 
     /**
@@ -293,10 +453,32 @@ public class LobbyView {
     }
 
     /**
-     * Zpracuje opusteni mistnosti.
+     * Zacne sledovat hru ve vybrane mistnosti.
+     */
+    private void handleWatchRoom() {
+        RoomRow selected = roomsTable.getSelectionModel().getSelectedItem();
+        if (selected == null) {
+            showError("Vyberte místnost");
+            return;
+        }
+        
+        hideError();
+        client.send(Protocol.createWatch(selected.getId()));
+    }
+
+    /**
+     * Obsadi volne misto v mistnosti botem serveru.
+     */
+    private void handleAddBot() {
+        client.send(Protocol.createAddBot());
+    }
+
+    /**
+     * Zpracuje opusteni mistnosti - seznam mistnosti se vyzada hned s odchodem,
+     * bez cekani na LEAVE_OK.
      */
     private void handleLeaveRoom() {
-        client.send(Protocol.createLeaveRoom());
+        client.sendPipelined(Protocol.createLeaveRoom(), Protocol.createListRooms());
     }
 
     /**
@@ -315,9 +497,15 @@ public class LobbyView {
     private void showWaitingPane(String roomName) {
         waitingLabel.setText("Čekání na protihráče v místnosti:\n" + roomName);
         waitingPane.setVisible(true);
+        botButton.setVisible(true);
         createButton.setDisable(true);
+        quickMatchButton.setDisable(true);
         roomNameField.setDisable(true);
+        presetCombo.setDisable(true);
+        playersSpinner.setDisable(true);
+        clockCombo.setDisable(true);
         joinButton.setDisable(true);
+        watchButton.setDisable(true);
         refreshButton.setDisable(true);
     }
 
@@ -327,7 +515,11 @@ public class LobbyView {
     private void hideWaitingPane() {
         waitingPane.setVisible(false);
         createButton.setDisable(false);
+        quickMatchButton.setDisable(false);
         roomNameField.setDisable(false);
+        presetCombo.setDisable(false);
+        playersSpinner.setDisable(false);
+        clockCombo.setDisable(false);
         refreshButton.setDisable(false);
     }
 
@@ -366,7 +558,11 @@ public class LobbyView {
                 refreshButton.setDisable(!controlsEnabled);
                 createButton.setDisable(!controlsEnabled);
                 joinButton.setDisable(!controlsEnabled);
+                watchButton.setDisable(!controlsEnabled);
                 roomNameField.setDisable(!controlsEnabled);
+                presetCombo.setDisable(!controlsEnabled);
+                playersSpinner.setDisable(!controlsEnabled);
+                clockCombo.setDisable(!controlsEnabled);
                 
                 switch (state) {
                     case DISCONNECTED:
@@ -427,13 +623,16 @@ public class LobbyView {
                 break;
                 
             case LEAVE_OK:
+                // ROOMS prijde hned za touto zpravou (viz handleLeaveRoom)
                 gameState.leaveRoom();
                 hideWaitingPane();
-                handleRefresh();
                 break;
                 
             case WAIT_OPPONENT:
-                // Uz jsme ve waiting pane
+                // Po vytvoreni uz jsme ve waiting pane, po pripojeni do
+                // mistnosti pro vic hracu se ceka na dalsi
+                gameState.setPhase(GameState.Phase.IN_ROOM_WAITING);
+                showWaitingPane(gameState.getCurrentRoomName());
                 break;
                 
             case GAME_START:
@@ -444,6 +643,82 @@ public class LobbyView {
                 handleGameResumed(message);
                 break;
                 
+            case WATCH_OK:
+                handleWatchOk(message);
+                break;
+                
+            case WATCH_ERR:
+                showError(Protocol.getErrorMessage(
+                        Protocol.ErrorCode.fromCode(message.getParamAsInt(0))));
+                break;
+                
+            case TOURNAMENT_OPEN:
+                tournamentLabel.setText("Turnaj " + message.getParam(0) + " (založil " +
+                                        message.getParam(1) + ") přijímá přihlášky");
+                break;
+                
+            case TOURNAMENT_OK:
+                gameState.enterTournament(message.getParam(0));
+                tournamentLabel.setText("Přihlášen do turnaje " + message.getParam(0) + " (" +
+                                        message.getParamAsInt(1) + " účastníků)");
+                updateTournamentControls();
+                break;
+                
+            case TOURNAMENT_LEFT:
+                gameState.leaveTournament();
+                tournamentLabel.setText("");
+                updateTournamentControls();
+                break;
+                
+            case TOURNAMENT_ERR:
+                showError(Protocol.getErrorMessage(
+                        Protocol.ErrorCode.fromCode(message.getParamAsInt(0))));
+                break;
+                
+            case TOURNAMENT_MATCH:
+                // GAME_START prijde hned za touto zpravou
+                tournamentLabel.setText(message.getParamAsInt(0) + ". kolo - soupeř " +
+                                        message.getParam(2));
+                break;
+                
+            case TOURNAMENT_ADVANCE:
+                tournamentLabel.setText("Postupujete do " + message.getParamAsInt(0) + ". kola");
+                break;
+                
+            case TOURNAMENT_OVER:
+                handleTournamentOver(message);
+                break;
+                
+            case LEADERBOARD_OK:
+                handleLeaderboard(message);
+                break;
+                
+            case QUICK_MATCH_WAIT:
+                quickMatchQueued = true;
+                showWaitingPane("Rychlá hra");
+                waitingLabel.setText("Hledání soupeře s podobným hodnocením (" +
+                                     message.getParamAsInt(0) + ")...");
+                botButton.setVisible(false);
+                break;
+                
+            case QUICK_MATCH_FOUND:
+                // GAME_START prijde hned za touto zpravou
+                quickMatchQueued = false;
+                gameState.enterRoom(message.getParamAsInt(0), "Rychlá hra", message.getParam(1));
+                Logger.info("Quick match against %s (%d)", message.getParam(1),
+                            message.getParamAsInt(2));
+                break;
+                
+            case QUICK_MATCH_CANCELLED:
+                quickMatchQueued = false;
+                hideWaitingPane();
+                break;
+                
+            case QUICK_MATCH_ERR:
+                showError(Protocol.getErrorMessage(
+                        Protocol.ErrorCode.fromCode(message.getParamAsInt(0))));
+                break;
+                
             case ERROR:
                 showError("Chyba serveru: " + message.getParam(1));
                 break;
@@ -454,6 +729,37 @@ public class LobbyView {
         }
     }
 
+    /**
+     * Zpracuje konec turnaje (prazdny vitez = turnaj byl zrusen).
+     */
+    private void handleTournamentOver(Protocol.ParsedMessage message) {
+        String winner = message.getParam(1);
+        tournamentLabel.setText(winner.isEmpty() ?
+                "Turnaj " + message.getParam(0) + " byl zrušen" :
+                "Turnaj " + message.getParam(0) + " vyhrál " + winner);
+        gameState.leaveTournament();
+        updateTournamentControls();
+    }
+
+    /**
+     * Zobrazi zebricek hracu.
+     * Format: LEADERBOARD_OK;count;nick,rating,wins,losses;...
+     */
+    private void handleLeaderboard(Protocol.ParsedMessage message) {
+        StringBuilder text = new StringBuilder();
+        
+        for (int i = 1; i < message.getParamCount(); i++) {
+            String[] parts = message.getParam(i).split(",");
+            if (parts.length >= 4) {
+                text.append(String.format("%d. %s – %s (výhry %s, prohry %s)%n",
+                                          i, parts[0], parts[1], parts[2], parts[3]));
+            }
+        }
+        
+        Components.showInfo("Žebříček", text.length() > 0 ? text.toString() :
+                "Zatím nikdo nedohrál žádnou hru");
+    }
+
     /**
      * Zpracuje seznam mistnosti.
      */
@@ -523,14 +829,47 @@ public class LobbyView {
         int stones = message.getParamAsInt(0);
         boolean myTurn = message.getParamAsBoolean(1);
         String opponent = message.getParam(2);
+        int minTake = message.getParamAsInt(3, GameState.MIN_TAKE);
+        int maxTake = message.getParamAsInt(4, GameState.MAX_TAKE);
+        int skips = message.getParamAsInt(5, GameState.SKIPS_PER_PLAYER);
+        int[] piles = message.getParamAsIntList(6);
+        List<String> players = message.getParamAsList(7);
+        int moveSeconds = message.getParamAsInt(8, 0);
         
-        gameState.startGame(stones, myTurn, opponent);
+        gameState.startGame(stones, myTurn, opponent, minTake, maxTake, skips, piles, players,
+                            moveSeconds);
         
         // Prejdi na herni obrazovku
         GameView gameView = new GameView(stage, client, gameState);
         gameView.show();
     }
 
+    /**
+     * Zpracuje zacatek sledovani hry.
+     * Format: WATCH_OK;room_id;state;stones;current;min;max;piles;players
+     */
+    private void handleWatchOk(Protocol.ParsedMessage message) {
+        int roomId = message.getParamAsInt(0);
+        
+        String roomName = "";
+        for (RoomRow row : roomsList) {
+            if (row.getId() == roomId) {
+                roomName = row.getName();
+                break;
+            }
+        }
+        
+        gameState.setTurnClock(message.getParamAsInt(8, 0));
+        gameState.watchGame(roomId, roomName, message.getParamAsInt(2), message.getParam(3),
+                            message.getParamAsInt(4, GameState.MIN_TAKE),
+                            message.getParamAsInt(5, GameState.MAX_TAKE),
+                            message.getParamAsIntList(6), message.getParamAsList(7));
+        
+        // Divak pouziva herni obrazovku bez ovladacich prvku
+        GameView gameView = new GameView(stage, client, gameState);
+        gameView.show();
+    }
+
     /**
      * Zpracuje obnoveni hry (po reconnectu).
      */
@@ -539,8 +878,13 @@ public class LobbyView {
         boolean myTurn = message.getParamAsBoolean(1);
         int mySkips = message.getParamAsInt(2);
         int oppSkips = message.getParamAsInt(3);
+        int minTake = message.getParamAsInt(4, GameState.MIN_TAKE);
+        int maxTake = message.getParamAsInt(5, GameState.MAX_TAKE);
+        int[] piles = message.getParamAsIntList(6);
+        List<String> players = message.getParamAsList(7);
         
-        gameState.resumeGame(stones, myTurn, mySkips, oppSkips);
+        gameState.setTurnClock(message.getParamAsInt(8, 0));
+        gameState.resumeGame(stones, myTurn, mySkips, oppSkips, minTake, maxTake, piles, players);
         
         // Prejdi na herni obrazovku
         GameView gameView = new GameView(stage, client, gameState);
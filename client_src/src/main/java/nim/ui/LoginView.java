@@ -12,6 +12,8 @@ import nim.network.Client;
 import nim.network.Protocol;
 import nim.util.Logger;
 
+import java.util.List;
+
 /**
  * Prihlasovaci obrazovka.
  * Umoznuje zadani IP adresy, portu a prezdivky.
@@ -183,10 +185,8 @@ public class LoginView {
         gameState.setNickname(nickname);
         gameState.setPhase(GameState.Phase.CONNECTING);
         
-        // Spust ve vlastnim vlakne
-        new Thread(() -> {
-            boolean success = client.connect(host, port, nickname);
-            
+        // Pripojeni bezi na vlakne transportu, UI neceka
+        client.connectAsync(host, port, nickname).thenAccept(success -> {
             Platform.runLater(() -> {
                 if (!success) {
                     setConnecting(false);
@@ -195,7 +195,7 @@ public class LoginView {
                 }
                 // Uspech se zpracuje v message handleru
             });
-        }).start();
+        });
     }
 
     /**
@@ -316,15 +316,20 @@ public class LoginView {
     
     /**
      * Zpracuje obnoveni hry (po reconnectu).
-     * Server posle GAME_RESUMED ihned po LOGIN_OK pri reconnectu.
+     * Server posle GAME_RESUMED ihned po RESUME_OK pri reconnectu.
      */
     private void handleGameResumed(Protocol.ParsedMessage message) {
         int stones = message.getParamAsInt(0);
         boolean myTurn = message.getParamAsBoolean(1);
         int mySkips = message.getParamAsInt(2);
         int oppSkips = message.getParamAsInt(3);
+        int minTake = message.getParamAsInt(4, GameState.MIN_TAKE);
+        int maxTake = message.getParamAsInt(5, GameState.MAX_TAKE);
+        int[] piles = message.getParamAsIntList(6);
+        List<String> players = message.getParamAsList(7);
         
-        gameState.resumeGame(stones, myTurn, mySkips, oppSkips);
+        gameState.setTurnClock(message.getParamAsInt(8, 0));
+        gameState.resumeGame(stones, myTurn, mySkips, oppSkips, minTake, maxTake, piles, players);
         
         // Prejdi primo na herni obrazovku
         GameView gameView = new GameView(stage, client, gameState);
@@ -25,11 +25,20 @@
 /** Maximalni delka jedne zpravy */
 #define MAX_MESSAGE_LENGTH 512
 
-/** Timeout pro select() v sekundach */
-#define SELECT_TIMEOUT_SEC 1
+/** Timeout pro poll() v milisekundach */
+#define POLL_TIMEOUT_MS 1000
 
-/** Timeout pro select() v mikrosekundach */
-#define SELECT_TIMEOUT_USEC 0
+/** Pocet mist v poll() poli navic pro naslouchajici a ridici sockety */
+#define POLL_EXTRA_FDS 8
+
+/** Vychozi delka fronty nevyrizenych spojeni pro listen() */
+#define DEFAULT_LISTEN_BACKLOG 128
+
+/** Maximalni pocet spojeni prijatych v jedne iteraci smycky */
+#define ACCEPT_BATCH_LIMIT 64
+
+/** Vychozi TCP_DEFER_ACCEPT v sekundach (0 = vypnuto) */
+#define DEFAULT_DEFER_ACCEPT 0
 
 /* ============================================
  * LIMITY SERVERU
@@ -41,9 +50,12 @@
 /** Vychozi maximalni pocet klientu */
 #define DEFAULT_MAX_CLIENTS 50
 
-/** Pocet hracu na mistnost */
+/** Vychozi pocet hracu na mistnost */
 #define PLAYERS_PER_ROOM 2
 
+/** Nejvetsi pocet hracu v mistnosti (CREATE_ROOM players=N) */
+#define ROOM_MAX_PLAYERS 16
+
 /** Maximalni delka prezdivky */
 #define MAX_NICKNAME_LENGTH 32
 
@@ -66,6 +78,55 @@
 /** Pocet preskoceni tahu na hrace */
 #define SKIPS_PER_PLAYER 1
 
+/* ============================================
+ * VARIANTY HRY (PRAVIDLA MISTNOSTI)
+ * ============================================ */
+
+/**
+ * Predvolene varianty: X(ID, nazev, kaminky, min_take, max_take, preskoceni)
+ * Kazda varianta dostane specializovanou validaci tahu s konstantnimi mezemi,
+ * ostatni pravidla z CREATE_ROOM jdou obecnou cestou.
+ */
+#define GAME_PRESETS(X) \
+    X(CLASSIC, "classic", INITIAL_STONES, MIN_TAKE, MAX_TAKE, SKIPS_PER_PLAYER) \
+    X(QUICK,   "quick",   11, 1, 2, 0) \
+    X(LONG,    "long",    41, 1, 5, 2)
+
+/** Nejvetsi pocatecni pocet kaminku vlastni varianty */
+#define RULES_MAX_STONES 1000
+
+/** Nejvetsi max_take vlastni varianty */
+#define RULES_MAX_TAKE 16
+
+/** Nejvetsi pocet preskoceni vlastni varianty */
+#define RULES_MAX_SKIPS 8
+
+/** Nejvetsi pocet hromadek (Nim s vice hromadkami, piles=a,b,c) */
+#define GAME_MAX_PILES 8
+
+/** Nejvetsi velikost jedne hromadky pri vice hromadkach */
+#define RULES_MAX_PILE 255
+
+/** Nejdelsi cas na tah (CREATE_ROOM clock=N, sekundy) */
+#define RULES_MAX_MOVE_SECONDS 3600
+
+/* ============================================
+ * SOLVER A BOTI
+ * ============================================ */
+
+/** Nejvetsi pocet kaminku pokryty predpocitanou tabulkou */
+#define SOLVER_MAX_STONES 1024
+
+/** Nejvetsi pocet preskoceni na hrace pokryty tabulkou */
+#define SOLVER_MAX_SKIPS 8
+
+/** Pocet tabulek solveru (jedna na rozsah min_take..max_take; dalsi
+ *  rozsah prepocita nejdele nepouzitou) */
+#define SOLVER_MAX_TABLES 8
+
+/** Prefix prezdivky bota (znak '#' hrac v LOGIN pouzit nemuze) */
+#define BOT_NICKNAME_PREFIX "Bot#"
+
 /* ============================================
  * RECONNECTION A TIMEOUTY
  * ============================================ */
@@ -111,6 +172,129 @@
 /** Maximalni delka log zpravy */
 #define MAX_LOG_MESSAGE_LENGTH 256
 
+/* ============================================
+ * UPGRADE ZA BEHU (SIGUSR2)
+ * ============================================ */
+
+/** Pocet socketu predanych v jedne SCM_RIGHTS zprave */
+#define UPGRADE_FD_BATCH 128
+
+/** Jak dlouho cekat na potvrzeni od noveho procesu (ms) */
+#define UPGRADE_ACK_TIMEOUT_MS 5000
+
+/** Interval vypisu statistik serveru do logu (sekundy) */
+#define STATS_LOG_INTERVAL 60
+
+/* ============================================
+ * SHARDY (--shards)
+ * ============================================ */
+
+/** Nejvetsi pocet shardu */
+#define SHARD_MAX 16
+
+/** Jak dlouho smi viset zapis do kanalu mezi routerem a shardem (ms) */
+#define SHARD_SEND_TIMEOUT_MS 1000
+
+/* ============================================
+ * REGISTR LOBBY (--registry)
+ * ============================================ */
+
+/** Nejvetsi pocet uzlu v registru */
+#define REGISTRY_MAX_NODES 16
+
+/** Sloty mistnosti jednoho uzlu (= sirka rozsahu ID, nejvyssi -r) */
+#define REGISTRY_NODE_ROOMS 256
+
+/** Nejkratsi odstup dvou zverejneni zmen (ms) - zmeny se mezitim hromadi */
+#define REGISTRY_PUBLISH_INTERVAL_MS 250
+
+/** Interval obnovy heartbeatu uzlu bez zmen (sekundy) */
+#define REGISTRY_HEARTBEAT_INTERVAL 1
+
+/** Uzel bez heartbeatu dele nez tento pocet sekund se povazuje za mrtvy */
+#define REGISTRY_STALE_TIMEOUT 5
+
+/* ============================================
+ * SESSION TOKENY
+ * ============================================ */
+
+/** Delka session tokenu v bajtech (v protokolu jako hex retezec) */
+#define SESSION_TOKEN_BYTES 16
+
+/** Zdroj nahodnych dat pro tokeny */
+#define SESSION_RANDOM_SOURCE "/dev/urandom"
+
+/* ============================================
+ * SNAPSHOT ROZEHRANYCH HER
+ * ============================================ */
+
+/** Interval ukladani snapshotu (sekundy) */
+#define SNAPSHOT_INTERVAL 1
+
+/* ============================================
+ * ZURNAL HERNICH UDALOSTI
+ * ============================================ */
+
+/** Velikost jednoho segmentu zurnalu (bajty) */
+#define JOURNAL_SEGMENT_SIZE (4 * 1024 * 1024)
+
+/** Interval davkoveho zapisu zurnalu na disk (sekundy) */
+#define JOURNAL_SYNC_INTERVAL 1
+
+/* ============================================
+ * HODNOCENI HRACU
+ * ============================================ */
+
+/** Vychozi soubor s hodnocenim hracu */
+#define RATINGS_FILE "nim_ratings.dat"
+
+/** Jak dlouho po upgradu cekat, nez predchozi proces pusti zamek hodnoceni (ms) */
+#define RATINGS_LOCK_WAIT_MS 3000
+
+/** Pocet zaznamu noveho souboru hodnoceni (mocnina 2) */
+#define RATINGS_CAPACITY 65536
+
+/** ELO noveho hrace */
+#define RATING_INITIAL 1500
+
+/** Nejvetsi zmena ELO po jedne hre */
+#define RATING_K_FACTOR 32
+
+/** Delka udrzovaneho zebricku (nejvyssi n v LEADERBOARD) */
+#define LEADERBOARD_SIZE 10
+
+/* ============================================
+ * RYCHLA HRA (QUICK_MATCH)
+ * ============================================ */
+
+/** Sirka kosu fronty podle ELO */
+#define MATCH_BUCKET_WIDTH 50
+
+/** Pocet kosu (ELO mimo rozsah patri do krajniho kosu) */
+#define MATCH_BUCKETS 80
+
+/** Povoleny rozdil ELO hned po zarazeni do fronty */
+#define MATCH_WINDOW_BASE 50
+
+/** Rozsireni okna za kazdou sekundu cekani */
+#define MATCH_WINDOW_GROWTH 25
+
+/** Nejsirsi okno */
+#define MATCH_WINDOW_MAX 400
+
+/* ============================================
+ * DIVACI
+ * ============================================ */
+
+/** Kapacita odchozi fronty spojeni (pocet sdilenych zprav) */
+#define OUT_QUEUE_LENGTH 64
+
+/** Buffer odpovedi spojeni, ktere odejdou na konci iterace (bajty) */
+#define OUT_PENDING_SIZE 2048
+
+/** Jak dlouho smi divak nestihat, nez je odpojen (sekundy) */
+#define SPECTATOR_LAG_TIMEOUT 10
+
 /* ============================================
  * PROTOKOL - ODDELOVACE
  * ============================================ */
@@ -124,5 +308,17 @@
 /** Oddelovac polozek v seznamu */
 #define LIST_DELIMITER ','
 
+/** Uvod volitelneho ID pozadavku (#id;ZPRAVA) */
+#define REQUEST_ID_PREFIX '#'
+
+/** Nejdelsi ID pozadavku */
+#define REQUEST_ID_MAX_LENGTH 16
+
+/** Priznak binarniho rezimu v LOGIN/RESUME (LOGIN;nick;bin) */
+#define BINARY_CAPABILITY "bin"
+
+/** Delka hlavicky binarniho ramce (delka tela, u16 big-endian) */
+#define BINARY_FRAME_HEADER 2
+
 #endif /* CONFIG_H */
 
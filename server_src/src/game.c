@@ -2,11 +2,13 @@
  * @file game.c
  * @brief Implementace herni logiky Nim
  * 
- * Pravidla hry:
+ * Pravidla hry (vychozi hodnoty, mistnost je muze zmenit):
  * - Zacina se s INITIAL_STONES kaminky
- * - Hraci se stridaji, kazdy odebira MIN_TAKE az MAX_TAKE kaminku
- * - Kazdy hrac muze jednou preskocit tah
+ * - Hraci (PLAYERS_PER_ROOM, mistnost jich muze mit vic) se stridaji
+ *   v kruhovem poradi, kazdy odebira MIN_TAKE az MAX_TAKE kaminku
+ * - Kazdy hrac muze SKIPS_PER_PLAYER krat preskocit tah
  * - Kdo odebere posledni kaminek, prohrává (misere)
+ * - Pri vice hromadkach se bere z jedne hromadky libovolny pocet
  */
 
 #include "game.h"
@@ -14,41 +16,41 @@
 #include <string.h>
 
 /* ============================================
- * IMPLEMENTACE
+ * PREDVOLENE VARIANTY
  * ============================================ */
 
-void game_init(Game *game) {
-    if (game == NULL) return;
-    
-    memset(game, 0, sizeof(Game));
-    game->state = GAME_STATE_WAITING;
-    game->stones = INITIAL_STONES;
-    game->current_player = 0;
-    game->player_skips[0] = SKIPS_PER_PLAYER;
-    game->player_skips[1] = SKIPS_PER_PLAYER;
-    game->winner = -1;
-}
+static const GameRules g_presets[] = {
+#define X(id, name, stones, min_take, max_take, skips) { stones, min_take, max_take, skips, PLAYERS_PER_ROOM, 1, { stones }, 0 },
+    GAME_PRESETS(X)
+#undef X
+};
 
-void game_start(Game *game) {
-    if (game == NULL) return;
-    
-    game->state = GAME_STATE_PLAYING;
-    game->stones = INITIAL_STONES;
-    game->current_player = 0; /* Prvni hrac zacina */
-    game->player_skips[0] = SKIPS_PER_PLAYER;
-    game->player_skips[1] = SKIPS_PER_PLAYER;
-    game->winner = -1;
-    
-    LOG_INFO("Game started with %d stones", game->stones);
-}
+static const char *const g_preset_names[] = {
+#define X(id, name, stones, min_take, max_take, skips) name,
+    GAME_PRESETS(X)
+#undef X
+};
 
-void game_reset(Game *game) {
-    game_init(game);
-}
+/* ============================================
+ * TAH - SPOLECNE JADRO
+ * ============================================ */
 
-bool game_take_stones(Game *game, int player_index, int count) {
-    if (game == NULL) return false;
+/**
+ * Validace poctu kaminku; specializovane varianty ji volaji s konstantnimi
+ * mezemi, ktere prekladac dosadi primo do porovnani. Zbyva-li mene nez
+ * min_take kaminku, smi (a bez preskoceni musi) hrac vzit zbytek.
+ */
+static inline bool validate_take(const Game *game, int pile, int count,
+                                 int min_take, int max_take, int pile_count) {
+    if (pile < 0 || pile >= pile_count) return false;
     
+    int available = game->piles[pile];
+    return count <= max_take && count <= available &&
+           (count >= min_take || (count == available && count > 0));
+}
+
+static inline bool take_stones(Game *game, int player_index, int pile, int count,
+                               int min_take, int max_take, int pile_count) {
     /* Kontrola stavu hry */
     if (game->state != GAME_STATE_PLAYING) {
         LOG_WARNING("Cannot take stones - game not in PLAYING state");
@@ -63,32 +65,192 @@ bool game_take_stones(Game *game, int player_index, int count) {
     }
     
     /* Validace poctu */
-    if (!game_validate_take_count(game, count)) {
-        LOG_WARNING("Invalid take count: %d (stones: %d, min: %d, max: %d)",
-                    count, game->stones, MIN_TAKE, MAX_TAKE);
+    if (!validate_take(game, pile, count, min_take, max_take, pile_count)) {
+        LOG_WARNING("Invalid take count: %d from pile %d (stones: %d, min: %d, max: %d)",
+                    count, pile, game->stones, min_take, max_take);
         return false;
     }
     
     /* Odebrani kaminku */
+    game->piles[pile] -= count;
     game->stones -= count;
-    LOG_DEBUG("Player %d took %d stones, %d remaining", 
-              player_index, count, game->stones);
+    LOG_DEBUG("Player %d took %d stones from pile %d, %d remaining", 
+              player_index, count, pile, game->stones);
     
     /* Kontrola konce hry - kdo vzal posledni, prohrává */
     if (game->stones == 0) {
         game->state = GAME_STATE_FINISHED;
-        game->winner = 1 - player_index; /* Druhy hrac vyhrává */
+        game->loser = player_index;
+        game->winner = game_next_player(game, player_index); /* Nasledujici hrac vyhrává */
         LOG_INFO("Game over! Player %d wins (player %d took last stone)",
                  game->winner, player_index);
         return true;
     }
     
     /* Predani tahu */
-    game->current_player = 1 - game->current_player;
+    game->current_player = game_next_player(game, game->current_player);
     
     return true;
 }
 
+/* Specializovane varianty pro predvolena pravidla (vzdy jedna hromadka) */
+#define X(id, name, stones, min_take, max_take, skips)                                  \
+    static bool take_stones_##id(Game *game, int player_index, int pile, int count) {   \
+        return take_stones(game, player_index, pile, count, min_take, max_take, 1);     \
+    }                                                                                   \
+    static bool validate_take_##id(const Game *game, int pile, int count) {             \
+        return validate_take(game, pile, count, min_take, max_take, 1);                 \
+    }
+GAME_PRESETS(X)
+#undef X
+
+/**
+ * Rozdeli kaminky do hromadek podle pravidel
+ */
+static void deal_piles(Game *game) {
+    memset(game->piles, 0, sizeof(game->piles));
+    for (int i = 0; i < game->rules.pile_count; i++) {
+        game->piles[i] = game->rules.piles[i];
+    }
+    game->stones = game->rules.initial_stones;
+}
+
+/**
+ * Nastavi vsem hracum preskoceni podle pravidel
+ */
+static void reset_skips(Game *game) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        game->player_skips[i] = i < game->rules.player_count ? game->rules.skips_per_player : 0;
+    }
+}
+
+/* ============================================
+ * IMPLEMENTACE
+ * ============================================ */
+
+void game_init(Game *game) {
+    if (game == NULL) return;
+    
+    memset(game, 0, sizeof(Game));
+    game->state = GAME_STATE_WAITING;
+    game->rules = g_presets[GAME_PRESET_CLASSIC];
+    game->preset = GAME_PRESET_CLASSIC;
+    deal_piles(game);
+    game->current_player = 0;
+    reset_skips(game);
+    game->winner = -1;
+    game->loser = -1;
+}
+
+const GameRules* game_preset_rules(GamePreset preset) {
+    if (preset < 0 || preset >= GAME_PRESET_CUSTOM) return NULL;
+    return &g_presets[preset];
+}
+
+GamePreset game_find_preset(const char *name) {
+    for (int i = 0; name != NULL && i < GAME_PRESET_CUSTOM; i++) {
+        if (strcmp(g_preset_names[i], name) == 0) {
+            return (GamePreset)i;
+        }
+    }
+    return GAME_PRESET_CUSTOM;
+}
+
+bool game_validate_rules(const GameRules *rules) {
+    if (rules == NULL) return false;
+    
+    if (rules->initial_stones < 1 || rules->initial_stones > RULES_MAX_STONES ||
+        rules->player_count < 2 || rules->player_count > ROOM_MAX_PLAYERS ||
+        rules->pile_count < 1 || rules->pile_count > GAME_MAX_PILES ||
+        rules->move_seconds < 0 || rules->move_seconds > RULES_MAX_MOVE_SECONDS) {
+        return false;
+    }
+    
+    /* Nepouzite hromadky musi byt prazdne (pravidla se porovnavaji memcmp) */
+    for (int i = rules->pile_count; i < GAME_MAX_PILES; i++) {
+        if (rules->piles[i] != 0) return false;
+    }
+    
+    if (rules->pile_count == 1) {
+        return rules->piles[0] == rules->initial_stones &&
+               rules->min_take >= 1 && rules->min_take <= rules->max_take &&
+               rules->max_take <= RULES_MAX_TAKE &&
+               rules->skips_per_player >= 0 && rules->skips_per_player <= RULES_MAX_SKIPS;
+    }
+    
+    /* Vice hromadek - klasicky Nim, pravidla tahu jsou dana hromadkami */
+    int total = 0, largest = 0;
+    for (int i = 0; i < rules->pile_count; i++) {
+        if (rules->piles[i] < 1 || rules->piles[i] > RULES_MAX_PILE) return false;
+        total += rules->piles[i];
+        if (rules->piles[i] > largest) largest = rules->piles[i];
+    }
+    
+    return total == rules->initial_stones && rules->min_take == 1 &&
+           rules->max_take == largest && rules->skips_per_player == 0;
+}
+
+bool game_set_rules(Game *game, const GameRules *rules) {
+    if (game == NULL || !game_validate_rules(rules)) return false;
+    
+    game->rules = *rules;
+    game_update_preset(game);
+    
+    deal_piles(game);
+    reset_skips(game);
+    return true;
+}
+
+void game_update_preset(Game *game) {
+    if (game == NULL) return;
+    
+    /* Specializace zavisi jen na pravidlech tahu, ne na poctu hracu ani hodinach */
+    GameRules rules = game->rules;
+    rules.player_count = PLAYERS_PER_ROOM;
+    rules.move_seconds = 0;
+    
+    game->preset = GAME_PRESET_CUSTOM;
+    for (int i = 0; i < GAME_PRESET_CUSTOM; i++) {
+        if (memcmp(&g_presets[i], &rules, sizeof(GameRules)) == 0) {
+            game->preset = (GamePreset)i;
+            break;
+        }
+    }
+}
+
+void game_start(Game *game) {
+    if (game == NULL) return;
+    
+    game->state = GAME_STATE_PLAYING;
+    deal_piles(game);
+    game->current_player = 0; /* Prvni hrac zacina */
+    reset_skips(game);
+    game->winner = -1;
+    game->loser = -1;
+    
+    LOG_DEBUG("Game started with %d stones in %d piles, %d players (take %d-%d, %d skips)",
+              game->stones, game->rules.pile_count, game->rules.player_count,
+              game->rules.min_take, game->rules.max_take, game->rules.skips_per_player);
+}
+
+void game_reset(Game *game) {
+    game_init(game);
+}
+
+bool game_take_stones(Game *game, int player_index, int pile, int count) {
+    if (game == NULL) return false;
+    
+    switch (game->preset) {
+#define X(id, name, stones, min_take, max_take, skips) \
+        case GAME_PRESET_##id: return take_stones_##id(game, player_index, pile, count);
+        GAME_PRESETS(X)
+#undef X
+        default:
+            return take_stones(game, player_index, pile, count, game->rules.min_take,
+                               game->rules.max_take, game->rules.pile_count);
+    }
+}
+
 bool game_skip_turn(Game *game, int player_index) {
     if (game == NULL) return false;
     
@@ -113,7 +275,7 @@ bool game_skip_turn(Game *game, int player_index) {
     
     /* Preskoceni tahu */
     game->player_skips[player_index]--;
-    game->current_player = 1 - game->current_player;
+    game->current_player = game_next_player(game, game->current_player);
     
     LOG_DEBUG("Player %d skipped turn, %d skips remaining",
               player_index, game->player_skips[player_index]);
@@ -132,24 +294,22 @@ bool game_is_player_turn(Game *game, int player_index) {
 }
 
 bool game_can_skip(Game *game, int player_index) {
-    if (game == NULL) return false;
+    if (game == NULL || player_index < 0 || player_index >= ROOM_MAX_PLAYERS) return false;
     return game->player_skips[player_index] > 0;
 }
 
-bool game_validate_take_count(Game *game, int count) {
+bool game_validate_take_count(const Game *game, int pile, int count) {
     if (game == NULL) return false;
     
-    /* Kontrola rozsahu */
-    if (count < MIN_TAKE || count > MAX_TAKE) {
-        return false;
+    switch (game->preset) {
+#define X(id, name, stones, min_take, max_take, skips) \
+        case GAME_PRESET_##id: return validate_take_##id(game, pile, count);
+        GAME_PRESETS(X)
+#undef X
+        default:
+            return validate_take(game, pile, count, game->rules.min_take,
+                                 game->rules.max_take, game->rules.pile_count);
     }
-    
-    /* Kontrola, zda je dost kaminku */
-    if (count > game->stones) {
-        return false;
-    }
-    
-    return true;
 }
 
 void game_pause(Game *game) {
@@ -174,13 +334,16 @@ int game_get_current_player(Game *game) {
     return game ? game->current_player : -1;
 }
 
+int game_next_player(const Game *game, int player_index) {
+    return (player_index + 1) % game->rules.player_count;
+}
+
 int game_get_winner(Game *game) {
     return game ? game->winner : -1;
 }
 
 int game_get_loser(Game *game) {
-    if (game == NULL || game->winner < 0) return -1;
-    return 1 - game->winner;
+    return game ? game->loser : -1;
 }
 
 const char* game_state_to_string(GameState state) {
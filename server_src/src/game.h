@@ -14,22 +14,50 @@
  * ============================================ */
 
 typedef enum {
-    GAME_STATE_WAITING,     /* Ceka se na druheho hrace */
+    GAME_STATE_WAITING,     /* Ceka se na zaplneni mistnosti */
     GAME_STATE_PLAYING,     /* Hra probiha */
     GAME_STATE_PAUSED,      /* Hra pozastavena (hrac odpojen) */
     GAME_STATE_FINISHED     /* Hra skoncila */
 } GameState;
 
+/* ============================================
+ * PRAVIDLA
+ * ============================================ */
+
+typedef struct {
+    int initial_stones;             /* Pocatecni pocet kaminku */
+    int min_take;                   /* Minimum k odebrani */
+    int max_take;                   /* Maximum k odebrani */
+    int skips_per_player;           /* Preskoceni na hrace */
+    int player_count;               /* Pocet hracu (2 az ROOM_MAX_PLAYERS) */
+    int pile_count;                 /* Pocet hromadek (1 = klasicka hra) */
+    int piles[GAME_MAX_PILES];      /* Pocatecni hromadky, soucet = initial_stones */
+    int move_seconds;               /* Cas na jeden tah v sekundach (0 = bez hodin) */
+} GameRules;
+
+/** Predvolene varianty (GAME_PRESETS v config.h) */
+typedef enum {
+#define X(id, name, stones, min_take, max_take, skips) GAME_PRESET_##id,
+    GAME_PRESETS(X)
+#undef X
+    GAME_PRESET_CUSTOM              /* Vlastni pravidla - obecna cesta */
+} GamePreset;
+
 /* ============================================
  * STRUKTURA HRY
  * ============================================ */
 
 typedef struct {
     GameState state;                /* Stav hry */
-    int stones;                     /* Pocet zbyvajicich kaminku */
-    int current_player;             /* Index aktualniho hrace (0 nebo 1) */
-    int player_skips[2];            /* Zbyvajici preskoceni pro kazdeho hrace */
+    GameRules rules;                /* Pravidla mistnosti */
+    GamePreset preset;              /* Varianta pro specializovane funkce */
+    int stones;                     /* Pocet zbyvajicich kaminku (vsech hromadek) */
+    int piles[GAME_MAX_PILES];      /* Aktualni hromadky (nepouzite jsou 0) */
+    int current_player;             /* Index aktualniho hrace (poradi tahu) */
+    int player_skips[ROOM_MAX_PLAYERS]; /* Zbyvajici preskoceni pro kazdeho hrace */
     int winner;                     /* Index viteze (-1 = jeste neni) */
+    int loser;                      /* Index porazeneho (-1 = jeste neni) */
+    unsigned int id;                /* ID hry v zurnalu (0 = bez zurnalu) */
 } Game;
 
 /* ============================================
@@ -37,13 +65,54 @@ typedef struct {
  * ============================================ */
 
 /**
- * Inicializuje novou hru
+ * Inicializuje novou hru (klasicka pravidla)
  * @param game Ukazatel na strukturu hry
  */
 void game_init(Game *game);
 
 /**
- * Zacne hru (kdyz jsou 2 hraci)
+ * Vrati pravidla predvolene varianty
+ * @param preset Varianta
+ * @return Pravidla (NULL pro GAME_PRESET_CUSTOM)
+ */
+const GameRules* game_preset_rules(GamePreset preset);
+
+/**
+ * Najde predvolenou variantu podle nazvu
+ * @param name Nazev (napr. "classic")
+ * @return Varianta nebo GAME_PRESET_CUSTOM, pokud neexistuje
+ */
+GamePreset game_find_preset(const char *name);
+
+/**
+ * Zkontroluje, zda jsou pravidla v povolenych mezich
+ * Pocet hracu (2 az ROOM_MAX_PLAYERS) na variante nezavisi.
+ * Pri vice hromadkach jde o klasicky Nim: z jedne hromadky libovolny
+ * pocet kaminku (min_take 1, max_take = nejvetsi hromadka), bez preskoceni.
+ * @param rules Pravidla
+ * @return true pokud jsou platna
+ */
+bool game_validate_rules(const GameRules *rules);
+
+/**
+ * Nastavi pravidla hry (pred jejim zacatkem)
+ * Pokud pravidla odpovidaji predvolene variante, hra pouzije jeji
+ * specializovane funkce.
+ * @param game Ukazatel na hru
+ * @param rules Pravidla
+ * @return false pokud jsou pravidla neplatna
+ */
+bool game_set_rules(Game *game, const GameRules *rules);
+
+/**
+ * Znovu urci variantu podle pravidel (po prevzeti hry z jineho procesu,
+ * jehoz tabulka variant se mohla lisit); pocet hracu se neporovnava
+ * @param game Ukazatel na hru
+ */
+void game_update_preset(Game *game);
+
+/**
+ * Zacne hru (kdyz je mistnost plna)
  * @param game Ukazatel na hru
  */
 void game_start(Game *game);
@@ -56,17 +125,20 @@ void game_reset(Game *game);
 
 /**
  * Provede tah - odebrani kaminku
+ * Kdo vezme posledni kaminek, prohrava; vitezem je hrac, ktery by byl
+ * na tahu po nem.
  * @param game Ukazatel na hru
- * @param player_index Index hrace (0 nebo 1)
+ * @param player_index Index hrace
+ * @param pile Index hromadky (0 pri jedne hromadce)
  * @param count Pocet kaminku k odebrani
  * @return true pri uspechu, false pri neplatnem tahu
  */
-bool game_take_stones(Game *game, int player_index, int count);
+bool game_take_stones(Game *game, int player_index, int pile, int count);
 
 /**
  * Provede preskoceni tahu
  * @param game Ukazatel na hru
- * @param player_index Index hrace (0 nebo 1)
+ * @param player_index Index hrace
  * @return true pri uspechu, false pokud nelze
  */
 bool game_skip_turn(Game *game, int player_index);
@@ -97,10 +169,11 @@ bool game_can_skip(Game *game, int player_index);
 /**
  * Validuje pocet kaminku k odebrani
  * @param game Ukazatel na hru
+ * @param pile Index hromadky
  * @param count Pocet kaminku
  * @return true pokud je pocet validni
  */
-bool game_validate_take_count(Game *game, int count);
+bool game_validate_take_count(const Game *game, int pile, int count);
 
 /**
  * Pozastavi hru (pri odpojeni hrace)
@@ -124,10 +197,18 @@ int game_get_stones(Game *game);
 /**
  * Vrati index aktualniho hrace
  * @param game Ukazatel na hru
- * @return Index hrace (0 nebo 1)
+ * @return Index hrace
  */
 int game_get_current_player(Game *game);
 
+/**
+ * Vrati index hrace, ktery je na tahu po zadanem (kruhove poradi)
+ * @param game Ukazatel na hru
+ * @param player_index Index hrace
+ * @return Index dalsiho hrace
+ */
+int game_next_player(const Game *game, int player_index);
+
 /**
  * Vrati index viteze
  * @param game Ukazatel na hru
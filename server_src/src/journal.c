@@ -0,0 +1,346 @@
+/**
+ * @file journal.c
+ * @brief Implementace zurnalu hernich udalosti
+ *
+ * Zaznam se zapisuje tak, ze se nejdriv zkopiruje jeho obsah a teprve
+ * pak se ulozi pole size. Ctenar (nim_replay) konci na prvnim zaznamu
+ * s nulovou delkou, takze po padu procesu nikdy nevidi rozepsany zaznam.
+ */
+
+#include "journal.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static void segment_path(const Journal *journal, unsigned int index, char *buffer, size_t size) {
+    char name[64];
+    snprintf(name, sizeof(name), JOURNAL_SEGMENT_FORMAT, index);
+    snprintf(buffer, size, "%s/%s", journal->dir, name);
+}
+
+/**
+ * Zalozi a namapuje novy segment
+ * @return Mapovani nebo NULL
+ */
+static unsigned char* create_segment(Journal *journal, unsigned int index, int *fd_out) {
+    char path[512];
+    segment_path(journal, index, path, sizeof(path));
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Journal: cannot create '%s': %s", path, strerror(errno));
+        return NULL;
+    }
+
+    if (ftruncate(fd, JOURNAL_SEGMENT_SIZE) < 0) {
+        LOG_ERROR("Journal: ftruncate '%s' failed: %s", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, JOURNAL_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Journal: mmap '%s' failed: %s", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    JournalSegmentHeader *header = (JournalSegmentHeader *)map;
+    header->magic = JOURNAL_MAGIC;
+    header->version = JOURNAL_VERSION;
+    header->segment_index = index;
+    header->created_at = (int64_t)time(NULL);
+
+    *fd_out = fd;
+    return (unsigned char *)map;
+}
+
+/**
+ * Zapise segment na disk a odmapuje ho
+ * @param used Pocet pouzitych bajtu (soubor se na ne zkrati), 0 = nezkracovat
+ */
+static void release_segment(unsigned char *map, int fd, size_t used) {
+    msync(map, JOURNAL_SEGMENT_SIZE, MS_SYNC);
+    munmap(map, JOURNAL_SEGMENT_SIZE);
+    if (used > 0 && ftruncate(fd, (off_t)used) < 0) {
+        LOG_WARNING("Journal: ftruncate failed: %s", strerror(errno));
+    }
+    close(fd);
+}
+
+/**
+ * Najde nejvyssi cislo segmentu v adresari (0 = zadny)
+ */
+static unsigned int find_last_segment(const char *dir) {
+    DIR *d = opendir(dir);
+    if (d == NULL) return 0;
+
+    unsigned int last = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        unsigned int index;
+        char tail;
+        if (sscanf(entry->d_name, "journal-%u.n%c", &index, &tail) == 2 && index > last) {
+            last = index;
+        }
+    }
+    closedir(d);
+    return last;
+}
+
+/**
+ * Vrati nejvyssi ID hry zalozene v segmentu (0 = zadna)
+ */
+static uint32_t scan_max_game_id(const Journal *journal, unsigned int index) {
+    char path[512];
+    segment_path(journal, index, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(JournalSegmentHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const unsigned char *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return 0;
+
+    uint32_t max_id = 0;
+    size_t offset = sizeof(JournalSegmentHeader);
+    while (offset + sizeof(JournalRecord) <= size) {
+        const JournalRecord *record = (const JournalRecord *)(map + offset);
+        if (record->size < sizeof(JournalRecord) || offset + record->size > size) break;
+        if (record->type == JOURNAL_EV_GAME_START && record->game_id > max_id) {
+            max_id = record->game_id;
+        }
+        offset += record->size;
+    }
+
+    munmap((void *)map, size);
+    return max_id;
+}
+
+/**
+ * Prepne na dalsi segment (pripraveny predem, jinak ho zalozi hned)
+ */
+static bool switch_segment(Journal *journal) {
+    /* Dve vymeny mezi ticky - predchozi plny segment uvolnime hned */
+    if (journal->retired_map != NULL) {
+        release_segment(journal->retired_map, journal->retired_fd, 0);
+    }
+    journal->retired_map = journal->map;
+    journal->retired_fd = journal->fd;
+
+    if (journal->next_map == NULL) {
+        journal->next_map = create_segment(journal, journal->segment_index + 1, &journal->next_fd);
+    }
+
+    journal->map = journal->next_map;
+    journal->fd = journal->next_fd;
+    journal->next_map = NULL;
+    journal->next_fd = -1;
+    journal->segment_index++;
+    journal->offset = sizeof(JournalSegmentHeader);
+    journal->synced = 0;
+
+    if (journal->map == NULL) {
+        LOG_ERROR("Journal: no segment available, journaling disabled");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Prida zaznam na konec zurnalu (bez systemoveho volani, krome vymeny
+ * segmentu, pro kterou tick nepripravil dalsi segment)
+ */
+static void append(Journal *journal, const void *record, size_t size) {
+    if (journal->offset + size > JOURNAL_SEGMENT_SIZE && !switch_segment(journal)) {
+        return;
+    }
+
+    unsigned char *dest = journal->map + journal->offset;
+    const unsigned char *src = (const unsigned char *)record;
+
+    /* Nejdriv obsah, pak delka - zaznam je platny az po zapisu size */
+    memcpy(dest + sizeof(uint16_t), src + sizeof(uint16_t), size - sizeof(uint16_t));
+    __atomic_store_n((uint16_t *)dest, (uint16_t)size, __ATOMIC_RELEASE);
+
+    journal->offset += size;
+    journal->records++;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool journal_open(Journal *journal, const char *dir) {
+    memset(journal, 0, sizeof(Journal));
+    journal->fd = -1;
+    journal->next_fd = -1;
+    journal->retired_fd = -1;
+    strncpy(journal->dir, dir, sizeof(journal->dir) - 1);
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("Journal: cannot create directory '%s': %s", dir, strerror(errno));
+        return false;
+    }
+
+    /* Pokracuj v cislovani segmentu i her */
+    unsigned int last = find_last_segment(dir);
+    journal->next_game_id = 1;
+    for (unsigned int i = last; i > 0; i--) {
+        uint32_t max_id = scan_max_game_id(journal, i);
+        if (max_id > 0) {
+            journal->next_game_id = max_id + 1;
+            break;
+        }
+    }
+
+    journal->segment_index = last + 1;
+    journal->map = create_segment(journal, journal->segment_index, &journal->fd);
+    if (journal->map == NULL) {
+        return false;
+    }
+
+    journal->offset = sizeof(JournalSegmentHeader);
+    journal->now = (uint32_t)time(NULL);
+    journal->last_sync = time(NULL);
+
+    LOG_INFO("Journal '%s': segment %u, next game id %u",
+             dir, journal->segment_index, journal->next_game_id);
+    return true;
+}
+
+void journal_close(Journal *journal) {
+    if (journal == NULL) return;
+
+    if (journal->retired_map != NULL) {
+        release_segment(journal->retired_map, journal->retired_fd, 0);
+        journal->retired_map = NULL;
+    }
+
+    if (journal->next_map != NULL) {
+        char path[512];
+        segment_path(journal, journal->segment_index + 1, path, sizeof(path));
+        munmap(journal->next_map, JOURNAL_SEGMENT_SIZE);
+        close(journal->next_fd);
+        unlink(path);
+        journal->next_map = NULL;
+    }
+
+    if (journal->map != NULL) {
+        release_segment(journal->map, journal->fd, journal->offset);
+        journal->map = NULL;
+        LOG_INFO("Journal closed (%lu records written)", journal->records);
+    }
+}
+
+void journal_game_start(Journal *journal, Room *room) {
+    if (journal == NULL || journal->map == NULL || room == NULL) return;
+
+    room->game.id = journal->next_game_id++;
+
+    /* Prezdivky od tretiho hrace nasleduji za strukturou */
+    struct {
+        JournalStartRecord start;
+        char extra[ROOM_MAX_PLAYERS - JOURNAL_START_NICKNAMES][MAX_NICKNAME_LENGTH + 1];
+        char padding[8];
+    } buffer;
+    JournalStartRecord *record = &buffer.start;
+    int player_count = room->game.rules.player_count;
+    size_t size = sizeof(JournalStartRecord);
+    if (player_count > JOURNAL_START_NICKNAMES) {
+        size += (size_t)(player_count - JOURNAL_START_NICKNAMES) * (MAX_NICKNAME_LENGTH + 1);
+        size = (size + 7) & ~(size_t)7;
+    }
+
+    memset(&buffer, 0, sizeof(buffer));
+    record->header.size = (uint16_t)size;
+    record->header.type = JOURNAL_EV_GAME_START;
+    record->header.actor = JOURNAL_NO_ACTOR;
+    record->header.game_id = room->game.id;
+    record->header.timestamp = journal->now;
+    record->header.value = (uint16_t)room->game.stones;
+    record->header.stones = (uint16_t)room->game.stones;
+    record->room_id = room->id;
+    record->skips_per_player = (uint16_t)room->game.rules.skips_per_player;
+    record->min_take = (uint8_t)room->game.rules.min_take;
+    record->max_take = (uint8_t)room->game.rules.max_take;
+    record->pile_count = (uint8_t)room->game.rules.pile_count;
+    record->player_count = (uint8_t)player_count;
+    for (int i = 0; i < room->game.rules.pile_count && room->game.rules.pile_count > 1; i++) {
+        record->piles[i] = (uint8_t)room->game.rules.piles[i];
+    }
+
+    for (int i = 0; i < player_count; i++) {
+        if (room->players[i] != NULL) {
+            char *dest = (char *)journal_start_nickname(record, i);
+            memcpy(dest, room->players[i]->nickname, MAX_NICKNAME_LENGTH + 1);
+        }
+    }
+
+    append(journal, &buffer, size);
+}
+
+void journal_record(Journal *journal, JournalEventType type, const Room *room,
+                    int actor, int value) {
+    if (journal == NULL || journal->map == NULL || room == NULL || room->game.id == 0) {
+        return;
+    }
+
+    JournalRecord record;
+    record.size = sizeof(JournalRecord);
+    record.type = (uint8_t)type;
+    record.actor = actor < 0 ? JOURNAL_NO_ACTOR : (uint8_t)actor;
+    record.game_id = room->game.id;
+    record.timestamp = journal->now;
+    record.value = (uint16_t)value;
+    record.stones = (uint16_t)room->game.stones;
+
+    append(journal, &record, sizeof(record));
+}
+
+void journal_tick(Journal *journal, time_t now) {
+    if (journal == NULL || journal->map == NULL) return;
+
+    journal->now = (uint32_t)now;
+
+    /* Plny segment po vymene - dopsat a uvolnit */
+    if (journal->retired_map != NULL) {
+        release_segment(journal->retired_map, journal->retired_fd, 0);
+        journal->retired_map = NULL;
+        journal->retired_fd = -1;
+    }
+
+    /* Davkovy zapis na disk */
+    if ((now - journal->last_sync) >= JOURNAL_SYNC_INTERVAL && journal->offset > journal->synced) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = journal->synced & ~(page - 1);
+        if (msync(journal->map + start, journal->offset - start, MS_SYNC) < 0) {
+            LOG_WARNING("Journal: msync failed: %s", strerror(errno));
+        }
+        journal->synced = journal->offset;
+        journal->last_sync = now;
+    }
+
+    /* Dalsi segment pripravime predem, aby vymena nebyla na ceste tahu */
+    if (journal->next_map == NULL && journal->offset > JOURNAL_SEGMENT_SIZE / 4 * 3) {
+        journal->next_map = create_segment(journal, journal->segment_index + 1, &journal->next_fd);
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ * @file journal.h
+ * @brief Append-only zurnal hernich udalosti
+ *
+ * Kazdy zacatek hry, tah, preskoceni, pozastaveni/obnoveni a konec hry
+ * se zapise jako binarni zaznam do segmentu pametove mapovaneho souboru.
+ * Zapis je jen memcpy do mapovani - fsync (msync) se dela davkove
+ * v periodickem ticku a dalsi segment se pripravuje predem.
+ *
+ * Format souboru sdili server i nastroj nim_replay (tools/).
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "room.h"
+#include "../include/config.h"
+
+/* ============================================
+ * FORMAT ZURNALU
+ * ============================================ */
+
+#define JOURNAL_MAGIC   0x4A4D494Eu    /* "NIMJ" */
+#define JOURNAL_VERSION 1
+
+/** Jmeno segmentu: journal-000001.nj */
+#define JOURNAL_SEGMENT_FORMAT "journal-%06u.nj"
+
+/** Zaznam bez hrace (actor) */
+#define JOURNAL_NO_ACTOR 0xFF
+
+typedef enum {
+    JOURNAL_EV_GAME_START = 1,      /* JournalStartRecord */
+    JOURNAL_EV_TAKE = 2,            /* value = JOURNAL_TAKE_VALUE(hromadka, pocet) */
+    JOURNAL_EV_SKIP = 3,
+    JOURNAL_EV_PAUSE = 4,           /* actor = odpojeny hrac */
+    JOURNAL_EV_RESUME = 5,          /* actor = vraceny hrac */
+    JOURNAL_EV_GAME_OVER = 6        /* actor = vitez, value = JournalEndReason */
+} JournalEventType;
+
+typedef enum {
+    JOURNAL_END_NORMAL = 0,         /* Porazeny vzal posledni kaminek */
+    JOURNAL_END_LEAVE = 1,          /* Hrac opustil mistnost */
+    JOURNAL_END_DISCONNECT = 2,     /* Hrac se odhlasil / odpojil */
+    JOURNAL_END_TIMEOUT = 3,        /* Vyprsel reconnect timeout */
+    JOURNAL_END_ABANDONED = 4,      /* Oba hraci odpojeni, bez viteze */
+    JOURNAL_END_CLOCK = 5           /* Hraci na tahu vyprsel cas na tah */
+} JournalEndReason;
+
+/** Hodnota zaznamu TAKE: pocet kaminku, v hornim bajtu index hromadky */
+#define JOURNAL_TAKE_VALUE(pile, count) ((uint16_t)(((pile) << 8) | (count)))
+#define JOURNAL_TAKE_PILE(value)        ((value) >> 8)
+#define JOURNAL_TAKE_COUNT(value)       ((value) & 0xFF)
+
+/** Hlavicka segmentu (zacatek kazdeho souboru) */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t segment_index;
+    uint32_t reserved;
+    int64_t created_at;
+    uint64_t reserved2;
+} JournalSegmentHeader;
+
+/** Spolecna hlavicka zaznamu; size == 0 oznacuje konec dat v segmentu */
+typedef struct {
+    uint16_t size;                  /* Delka celeho zaznamu (nasobek 8) */
+    uint8_t type;                   /* JournalEventType */
+    uint8_t actor;                  /* Index hrace v mistnosti */
+    uint32_t game_id;
+    uint32_t timestamp;             /* Unix cas v sekundach */
+    uint16_t value;
+    uint16_t stones;                /* Kaminky po udalosti */
+} JournalRecord;
+
+/** Prezdivky primo ve strukture zaznamu zacatku hry */
+#define JOURNAL_START_NICKNAMES 2
+
+/**
+ * Zaznam zacatku hry
+ * Prezdivky dalsich hracu (od tretiho) nasleduji za strukturou,
+ * delka zaznamu je zaokrouhlena na nasobek 8.
+ */
+typedef struct {
+    JournalRecord header;
+    int32_t room_id;
+    uint16_t skips_per_player;
+    uint8_t min_take;               /* Pravidla mistnosti */
+    uint8_t max_take;
+    char nicknames[JOURNAL_START_NICKNAMES][MAX_NICKNAME_LENGTH + 1];
+    uint8_t pile_count;             /* Hromadky (starsi kratsi zaznamy je nemaji) */
+    uint8_t piles[GAME_MAX_PILES];
+    uint8_t player_count;           /* Pocet hracu (0 = starsi zaznam, 2 hraci) */
+    char padding[8 - (JOURNAL_START_NICKNAMES * (MAX_NICKNAME_LENGTH + 1) + 2 + GAME_MAX_PILES) % 8];
+} JournalStartRecord;
+
+/**
+ * Vrati pocet hracu hry ze zaznamu zacatku (starsi a poskozene zaznamy = 2)
+ */
+static inline int journal_start_players(const JournalStartRecord *record) {
+    int count = record->player_count;
+    if (record->header.size < sizeof(JournalStartRecord) || count <= JOURNAL_START_NICKNAMES) {
+        return JOURNAL_START_NICKNAMES;
+    }
+    size_t needed = sizeof(JournalStartRecord) +
+                    (size_t)(count - JOURNAL_START_NICKNAMES) * (MAX_NICKNAME_LENGTH + 1);
+    return record->header.size >= needed ? count : JOURNAL_START_NICKNAMES;
+}
+
+/**
+ * Vrati prezdivku hrace ze zaznamu zacatku hry
+ * @param index Index hrace, mensi nez journal_start_players()
+ */
+static inline const char* journal_start_nickname(const JournalStartRecord *record, int index) {
+    if (index < JOURNAL_START_NICKNAMES) return record->nicknames[index];
+    return (const char *)(record + 1) +
+           (size_t)(index - JOURNAL_START_NICKNAMES) * (MAX_NICKNAME_LENGTH + 1);
+}
+
+/* ============================================
+ * STRUKTURA ZURNALU
+ * ============================================ */
+
+typedef struct {
+    char dir[256];                  /* Adresar se segmenty */
+    unsigned char *map;             /* Aktualni segment (NULL = vypnuto) */
+    int fd;
+    unsigned int segment_index;
+    size_t offset;                  /* Konec zapsanych dat */
+    size_t synced;                  /* Kam az probehl msync */
+
+    unsigned char *next_map;        /* Predem pripraveny dalsi segment */
+    int next_fd;
+    unsigned char *retired_map;     /* Plny segment cekajici na msync a munmap */
+    int retired_fd;
+
+    uint32_t next_game_id;
+    uint32_t now;                   /* Cas z posledniho ticku */
+    time_t last_sync;
+    unsigned long records;          /* Pocet zapsanych zaznamu */
+} Journal;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Otevre zurnal v adresari a zalozi novy segment
+ * @param journal Zurnal
+ * @param dir Adresar (vytvori se, pokud neexistuje)
+ * @return true pri uspechu
+ */
+bool journal_open(Journal *journal, const char *dir);
+
+/**
+ * Zapise zbyla data na disk a zavre zurnal
+ * @param journal Zurnal
+ */
+void journal_close(Journal *journal);
+
+/**
+ * Zaznamena zacatek hry a prideli ji ID (room->game.id)
+ * @param journal Zurnal
+ * @param room Mistnost s prave zacatou hrou
+ */
+void journal_game_start(Journal *journal, Room *room);
+
+/**
+ * Zaznamena herni udalost
+ * @param journal Zurnal
+ * @param type Typ udalosti
+ * @param room Mistnost
+ * @param actor Index hrace (nebo -1)
+ * @param value Hodnota podle typu udalosti
+ */
+void journal_record(Journal *journal, JournalEventType type, const Room *room,
+                    int actor, int value);
+
+/**
+ * Periodicka udrzba - aktualizuje cas, davkove msync, pripravi dalsi segment
+ * @param journal Zurnal
+ * @param now Aktualni cas
+ */
+void journal_tick(Journal *journal, time_t now);
+
+#endif /* JOURNAL_H */
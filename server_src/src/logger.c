@@ -10,6 +10,7 @@
 #include <time.h>
 #include <string.h>
 #include <pthread.h>
+#include <fcntl.h>
 
 /* ============================================
  * PRIVATNI PROMENNE
@@ -18,6 +19,7 @@
 static FILE *log_file = NULL;
 static LogLevel min_log_level = LOG_INFO;
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char log_tag[16] = "";        /* Oznaceni procesu (shard), prazdne = zadne */
 
 /* ============================================
  * POMOCNE FUNKCE
@@ -68,6 +70,8 @@ bool logger_init(const char *filename, LogLevel min_level) {
             fprintf(stderr, "Warning: Cannot open log file '%s', using stdout\n", filename);
             return false;
         }
+        /* Novy proces po upgradu si soubor otevre sam */
+        fcntl(fileno(log_file), F_SETFD, FD_CLOEXEC);
     } else {
         log_file = stdout;
     }
@@ -97,6 +101,12 @@ void logger_set_level(LogLevel level) {
     pthread_mutex_unlock(&log_mutex);
 }
 
+void logger_set_tag(const char *tag) {
+    pthread_mutex_lock(&log_mutex);
+    snprintf(log_tag, sizeof(log_tag), "%s", tag != NULL ? tag : "");
+    pthread_mutex_unlock(&log_mutex);
+}
+
 void logger_log(LogLevel level, const char *format, ...) {
     if (level < min_log_level) {
         return;
@@ -110,6 +120,9 @@ void logger_log(LogLevel level, const char *format, ...) {
     char timestamp[32];
     get_timestamp(timestamp, sizeof(timestamp));
     fprintf(output, "[%s] [%s] ", timestamp, level_to_string(level));
+    if (log_tag[0] != '\0') {
+        fprintf(output, "[%s] ", log_tag);
+    }
     
     /* Samotna zprava */
     va_list args;
@@ -41,6 +41,12 @@ void logger_close(void);
  */
 void logger_set_level(LogLevel level);
 
+/**
+ * Nastavi oznaceni procesu vypisovane u kazde zpravy (shardy sdili log)
+ * @param tag Oznaceni (NULL nebo "" = zadne)
+ */
+void logger_set_tag(const char *tag);
+
 /**
  * Zapise log zpravu
  * @param level Uroven zpravy
@@ -12,6 +12,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "server.h"
+#include "upgrade.h"
+#include "router.h"
 #include "logger.h"
 #include "../include/config.h"
 
@@ -28,6 +30,9 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
     
+    /* Argumenty pro pripadny upgrade za behu (SIGUSR2) */
+    upgrade_save_args(argc, argv);
+    
     /* Inicializace loggeru */
     /* Verbose mode (-v) loguje na stdout, jinak do souboru */
     const char *log_file = config.verbose ? NULL : LOG_FILE;
@@ -41,14 +46,34 @@ int main(int argc, char *argv[]) {
     LOG_INFO("Configuration:");
     LOG_INFO("  Bind address: %s", config.bind_address);
     LOG_INFO("  Port: %d", config.port);
+    LOG_INFO("  Unix socket: %s", config.unix_socket_path[0] ? config.unix_socket_path : "off");
+    if (config.websocket_port > 0) {
+        LOG_INFO("  WebSocket port: %d", config.websocket_port);
+    } else {
+        LOG_INFO("  WebSocket port: off");
+    }
     LOG_INFO("  Max clients: %d", config.max_clients);
     LOG_INFO("  Max rooms: %d", config.max_rooms);
+    LOG_INFO("  Listen backlog: %d", config.backlog);
+    LOG_INFO("  TCP_DEFER_ACCEPT: %d s", config.defer_accept);
+    LOG_INFO("  Snapshot: %s", config.snapshot_path[0] ? config.snapshot_path : "off");
+    LOG_INFO("  Journal: %s", config.journal_dir[0] ? config.journal_dir : "off");
+    LOG_INFO("  Ratings: %s", config.ratings_path[0] ? config.ratings_path : "off");
+    LOG_INFO("  Shards: %d", config.shards);
+    LOG_INFO("  Registry: %s", config.registry[0] ? config.registry : "off");
     LOG_INFO("Game settings:");
     LOG_INFO("  Initial stones: %d", INITIAL_STONES);
     LOG_INFO("  Min take: %d", MIN_TAKE);
     LOG_INFO("  Max take: %d", MAX_TAKE);
     LOG_INFO("  Skips per player: %d", SKIPS_PER_PLAYER);
     
+    /* Shardy - hlavni proces je jen router pred nimi */
+    if (config.shards > 1) {
+        int status = router_run(&config);
+        logger_close();
+        return status;
+    }
+    
     /* Inicializace serveru */
     if (!server_init(&server, &config)) {
         LOG_ERROR("Failed to initialize server");
@@ -0,0 +1,172 @@
+/**
+ * @file matchmaking.c
+ * @brief Implementace fronty rychle hry
+ *
+ * Nejdele cekajici hrac kosu ma nejsirsi okno, proto se u ciziho kosu
+ * zkousi jen jeho zacatek - kdyz neprijme on, mladsi z kosu taky ne.
+ */
+
+#include "matchmaking.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static int bucket_for(int rating) {
+    int bucket = rating / MATCH_BUCKET_WIDTH;
+    if (bucket < 0) return 0;
+    if (bucket >= MATCH_BUCKETS) return MATCH_BUCKETS - 1;
+    return bucket;
+}
+
+static bool bucket_nonempty(const MatchQueue *queue, int bucket) {
+    return (queue->nonempty[bucket / 64] >> (bucket % 64)) & 1;
+}
+
+/**
+ * Okno hrace - o kolik se smi lisit ELO soupere
+ */
+static int window_of(const MatchQueue *queue, int slot, int64_t now) {
+    int64_t waited = now - queue->since[slot];
+    if (waited < 0) waited = 0;
+    int64_t window = MATCH_WINDOW_BASE + waited * MATCH_WINDOW_GROWTH / 1000;
+    return window > MATCH_WINDOW_MAX ? MATCH_WINDOW_MAX : (int)window;
+}
+
+/**
+ * Prijmou se hraci navzajem? Staci sirsi z obou oken - dele cekajici
+ * hrac uz je ochoten hrat i s vzdalenejsim souperem.
+ */
+static bool acceptable(const MatchQueue *queue, int a, int b, int64_t now) {
+    int diff = abs(queue->rating[a] - queue->rating[b]);
+    int wa = window_of(queue, a, now);
+    int wb = window_of(queue, b, now);
+    return diff <= (wa > wb ? wa : wb);
+}
+
+/**
+ * Vyzkousi nejdele cekajiciho z kosu (mimo samotneho hrace)
+ * @return Slot soupere nebo -1
+ */
+static int try_bucket(const MatchQueue *queue, int bucket, int slot, int64_t now) {
+    if (bucket < 0 || bucket >= MATCH_BUCKETS || !bucket_nonempty(queue, bucket)) return -1;
+
+    int candidate = queue->head[bucket];
+    if (candidate == slot) candidate = queue->next[candidate];
+    if (candidate >= 0 && acceptable(queue, slot, candidate, now)) return candidate;
+    return -1;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool matchqueue_init(MatchQueue *queue, int capacity) {
+    memset(queue, 0, sizeof(MatchQueue));
+    queue->capacity = capacity;
+    queue->next = malloc((size_t)capacity * sizeof(int));
+    queue->prev = malloc((size_t)capacity * sizeof(int));
+    queue->bucket = malloc((size_t)capacity * sizeof(int));
+    queue->rating = malloc((size_t)capacity * sizeof(int32_t));
+    queue->since = malloc((size_t)capacity * sizeof(int64_t));
+    if (queue->next == NULL || queue->prev == NULL || queue->bucket == NULL ||
+        queue->rating == NULL || queue->since == NULL) {
+        matchqueue_destroy(queue);
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        queue->next[i] = queue->prev[i] = queue->bucket[i] = -1;
+    }
+    for (int i = 0; i < MATCH_BUCKETS; i++) {
+        queue->head[i] = queue->tail[i] = -1;
+    }
+    return true;
+}
+
+void matchqueue_destroy(MatchQueue *queue) {
+    free(queue->next);
+    free(queue->prev);
+    free(queue->bucket);
+    free(queue->rating);
+    free(queue->since);
+    queue->next = queue->prev = queue->bucket = NULL;
+    queue->rating = NULL;
+    queue->since = NULL;
+    queue->waiting = 0;
+}
+
+void matchqueue_add(MatchQueue *queue, int slot, int rating, int64_t since) {
+    if (slot < 0 || slot >= queue->capacity || queue->bucket[slot] >= 0) return;
+
+    int bucket = bucket_for(rating);
+    queue->rating[slot] = rating;
+    queue->since[slot] = since;
+    queue->bucket[slot] = bucket;
+    queue->next[slot] = -1;
+    queue->prev[slot] = queue->tail[bucket];
+
+    if (queue->tail[bucket] >= 0) {
+        queue->next[queue->tail[bucket]] = slot;
+    } else {
+        queue->head[bucket] = slot;
+        queue->nonempty[bucket / 64] |= 1ULL << (bucket % 64);
+    }
+    queue->tail[bucket] = slot;
+    queue->waiting++;
+}
+
+bool matchqueue_remove(MatchQueue *queue, int slot) {
+    if (slot < 0 || slot >= queue->capacity || queue->bucket[slot] < 0) return false;
+
+    int bucket = queue->bucket[slot];
+    int prev = queue->prev[slot];
+    int next = queue->next[slot];
+
+    if (prev >= 0) queue->next[prev] = next; else queue->head[bucket] = next;
+    if (next >= 0) queue->prev[next] = prev; else queue->tail[bucket] = prev;
+    if (queue->head[bucket] < 0) {
+        queue->nonempty[bucket / 64] &= ~(1ULL << (bucket % 64));
+    }
+
+    queue->bucket[slot] = queue->next[slot] = queue->prev[slot] = -1;
+    queue->waiting--;
+    return true;
+}
+
+int matchqueue_find(const MatchQueue *queue, int slot, int64_t now) {
+    if (slot < 0 || slot >= queue->capacity || queue->bucket[slot] < 0) return -1;
+
+    /* Nejsirsi mozne okno urcuje, kolik kosu na kazdou stranu ma smysl projit */
+    int bucket = queue->bucket[slot];
+    int reach = MATCH_WINDOW_MAX / MATCH_BUCKET_WIDTH + 1;
+
+    for (int d = 0; d <= reach; d++) {
+        int found = try_bucket(queue, bucket - d, slot, now);
+        if (found < 0 && d > 0) found = try_bucket(queue, bucket + d, slot, now);
+        if (found >= 0) return found;
+    }
+    return -1;
+}
+
+bool matchqueue_find_pair(const MatchQueue *queue, int64_t now, int *first, int *second) {
+    for (int word = 0; word < (MATCH_BUCKETS + 63) / 64; word++) {
+        uint64_t bits = queue->nonempty[word];
+        while (bits != 0) {
+            int bucket = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            int head = queue->head[bucket];
+            int partner = matchqueue_find(queue, head, now);
+            if (partner >= 0) {
+                *first = head;
+                *second = partner;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file matchmaking.h
+ * @brief Fronta rychle hry - parovani podle hodnoceni
+ *
+ * Cekajici hraci jsou v kosech podle ELO (sirka MATCH_BUCKET_WIDTH), kazdy
+ * kos je fronta v poradi prichodu provazana pres sloty hracu. Hrac prijme
+ * soupere, jehoz ELO se lisi nejvys o okno, ktere se s dobou cekani
+ * rozsiruje. Hledani soupere projde jen kosy v dosahu nejsirsiho okna
+ * (bitmapa neprazdnych kosu), takze cena nezavisi na poctu cekajicich.
+ */
+
+#ifndef MATCHMAKING_H
+#define MATCHMAKING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../include/config.h"
+
+/* ============================================
+ * STRUKTURA FRONTY
+ * ============================================ */
+
+typedef struct {
+    int capacity;                   /* Pocet slotu hracu */
+    int *next;                      /* Dalsi hrac v kosu (-1 = konec) */
+    int *prev;                      /* Predchozi hrac v kosu (-1 = zacatek) */
+    int *bucket;                    /* Kos hrace (-1 = neceka) */
+    int32_t *rating;                /* ELO pri zarazeni */
+    int64_t *since;                 /* Cas zarazeni (ms monotonnich hodin) */
+    int head[MATCH_BUCKETS];        /* Nejdele cekajici v kosu */
+    int tail[MATCH_BUCKETS];
+    uint64_t nonempty[(MATCH_BUCKETS + 63) / 64]; /* Bitmapa neprazdnych kosu */
+    int waiting;                    /* Pocet cekajicich */
+} MatchQueue;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Inicializuje prazdnou frontu
+ * @param queue Fronta
+ * @param capacity Pocet slotu hracu
+ * @return true pri uspechu
+ */
+bool matchqueue_init(MatchQueue *queue, int capacity);
+
+/**
+ * Uvolni pole fronty
+ * @param queue Fronta
+ */
+void matchqueue_destroy(MatchQueue *queue);
+
+/**
+ * Zaradi hrace na konec jeho kosu
+ * @param queue Fronta
+ * @param slot Slot hrace
+ * @param rating ELO hrace
+ * @param since Cas zarazeni (ms)
+ */
+void matchqueue_add(MatchQueue *queue, int slot, int rating, int64_t since);
+
+/**
+ * Vyradi hrace z fronty (pokud ceka)
+ * @param queue Fronta
+ * @param slot Slot hrace
+ * @return true pokud hrac cekal
+ */
+bool matchqueue_remove(MatchQueue *queue, int slot);
+
+/**
+ * Najde cekajiciho soupere pro hrace - nejblizsi kos, v nem nejdele cekajiciho
+ * @param queue Fronta
+ * @param slot Slot cekajiciho hrace
+ * @param now Aktualni cas (ms)
+ * @return Slot soupere nebo -1
+ */
+int matchqueue_find(const MatchQueue *queue, int slot, int64_t now);
+
+/**
+ * Najde libovolnou dvojici, kterou uz rozsirena okna dovoluji sparovat
+ * (zkousi se jen nejdele cekajici z kazdeho kosu)
+ * @param queue Fronta
+ * @param now Aktualni cas (ms)
+ * @param first Vystup - slot prvniho hrace
+ * @param second Vystup - slot druheho hrace
+ * @return true pokud dvojice existuje
+ */
+bool matchqueue_find_pair(const MatchQueue *queue, int64_t now, int *first, int *second);
+
+#endif /* MATCHMAKING_H */
@@ -0,0 +1,102 @@
+/**
+ * @file nimsum.c
+ * @brief Implementace vyhodnoceni Nimu s vice hromadkami
+ */
+
+#include "nimsum.h"
+
+/* ============================================
+ * SOUHRN POZICE
+ * ============================================ */
+
+typedef struct {
+    unsigned int sum;               /* Nim-sum */
+    int big;                        /* Hromadky s vice nez jednim kaminkem */
+    int ones;                       /* Hromadky s jednim kaminkem */
+} PileSummary;
+
+static PileSummary summarize(const int piles[GAME_MAX_PILES]) {
+    unsigned int sum = 0;
+    int big = 0, ones = 0;
+
+    /* Pevna delka, bez vetveni - jeden pruchod vektorovymi instrukcemi */
+    for (int i = 0; i < GAME_MAX_PILES; i++) {
+        sum ^= (unsigned int)piles[i];
+        big += piles[i] > 1;
+        ones += piles[i] == 1;
+    }
+
+    PileSummary summary = { sum, big, ones };
+    return summary;
+}
+
+static bool summary_is_winning(const PileSummary *summary) {
+    /* Jen jednicky: hraci se stridaji po jednom, prohraje ten, kdo vezme posledni */
+    if (summary->big == 0) {
+        return summary->ones % 2 == 0;
+    }
+    return summary->sum != 0;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+unsigned int nimsum(const int piles[GAME_MAX_PILES]) {
+    return summarize(piles).sum;
+}
+
+bool nimsum_is_winning(const int piles[GAME_MAX_PILES]) {
+    PileSummary summary = summarize(piles);
+    return summary_is_winning(&summary);
+}
+
+bool nimsum_best_move(const int piles[GAME_MAX_PILES], int *pile, int *count) {
+    PileSummary summary = summarize(piles);
+    *pile = 0;
+    *count = 0;
+
+    /* Jen jednicky - vsechny tahy jsou stejne */
+    if (summary.big == 0) {
+        for (int i = 0; i < GAME_MAX_PILES; i++) {
+            if (piles[i] > 0) {
+                *pile = i;
+                *count = 1;
+                break;
+            }
+        }
+        return summary_is_winning(&summary);
+    }
+
+    /* Jedina velka hromadka - zmensit ji na 0 nebo 1 tak, aby souperi
+     * zustal lichy pocet jednicek */
+    if (summary.big == 1) {
+        for (int i = 0; i < GAME_MAX_PILES; i++) {
+            if (piles[i] > 1) {
+                *pile = i;
+                *count = piles[i] - (summary.ones % 2 == 1 ? 0 : 1);
+                break;
+            }
+        }
+        return true;
+    }
+
+    /* Jako normalni Nim: tah na nulovy nim-sum */
+    if (summary.sum != 0) {
+        for (int i = 0; i < GAME_MAX_PILES; i++) {
+            int target = (int)((unsigned int)piles[i] ^ summary.sum);
+            if (target < piles[i]) {
+                *pile = i;
+                *count = piles[i] - target;
+                return true;
+            }
+        }
+    }
+
+    /* Prohrana pozice - co nejmensi tah */
+    for (int i = 0; i < GAME_MAX_PILES; i++) {
+        if (piles[i] > piles[*pile]) *pile = i;
+    }
+    *count = 1;
+    return false;
+}
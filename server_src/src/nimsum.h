@@ -0,0 +1,46 @@
+/**
+ * @file nimsum.h
+ * @brief Vyhodnoceni Nimu s vice hromadkami pres nim-sum (XOR)
+ *
+ * Misere Nim: dokud je nektera hromadka vetsi nez 1, vyhrava hrac na tahu
+ * prave pri nenulovem nim-sumu; zbyvaji-li jen hromadky s jednim kaminkem,
+ * vyhrava pri jejich sudem poctu. Hromadky jsou pole pevne delky
+ * GAME_MAX_PILES doplnene nulami - smycky nemaji vetveni ani promennou
+ * delku a prekladac je vektorizuje.
+ */
+
+#ifndef NIMSUM_H
+#define NIMSUM_H
+
+#include <stdbool.h>
+#include "../include/config.h"
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Spocita nim-sum hromadek
+ * @param piles Hromadky (nepouzite jsou 0)
+ * @return XOR velikosti vsech hromadek
+ */
+unsigned int nimsum(const int piles[GAME_MAX_PILES]);
+
+/**
+ * Zjisti, zda ma hrac na tahu vyhrani jistou (misere)
+ * @param piles Hromadky
+ * @return true pokud existuje vyherni strategie
+ */
+bool nimsum_is_winning(const int piles[GAME_MAX_PILES]);
+
+/**
+ * Najde nejlepsi tah (misere)
+ * V prohrane pozici vezme jeden kaminek z nejvetsi hromadky.
+ * @param piles Hromadky
+ * @param pile Vystup - index hromadky
+ * @param count Vystup - pocet kaminku
+ * @return true pokud je pozice vyherni
+ */
+bool nimsum_best_move(const int piles[GAME_MAX_PILES], int *pile, int *count);
+
+#endif /* NIMSUM_H */
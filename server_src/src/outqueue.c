@@ -0,0 +1,166 @@
+/**
+ * @file outqueue.c
+ * @brief Implementace sdilenych zprav a odchozich front
+ */
+
+#include "outqueue.h"
+#include "sysio.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+/* ============================================
+ * SDILENE ZPRAVY
+ * ============================================ */
+
+SharedMessage* shared_message_create(const char *data, size_t len) {
+    SharedMessage *msg = malloc(sizeof(SharedMessage) + len);
+    if (msg == NULL) return NULL;
+
+    msg->refs = 1;
+    msg->len = len;
+    memcpy(msg->data, data, len);
+    return msg;
+}
+
+void shared_message_release(SharedMessage *msg) {
+    if (msg != NULL && --msg->refs == 0) {
+        free(msg);
+    }
+}
+
+/* ============================================
+ * FRONTA
+ * ============================================ */
+
+void outqueue_init(OutQueue *queue) {
+    memset(queue, 0, sizeof(OutQueue));
+}
+
+/**
+ * Zaradi obsah bufferu jako sdilenou zpravu, aby za nej sla dalsi zprava
+ * @return false pokud je fronta plna nebo chybi pamet
+ */
+static bool spill_pending(OutQueue *queue) {
+    if (queue->pending_len == 0) return true;
+    if (queue->count == OUT_QUEUE_LENGTH) return false;
+
+    SharedMessage *msg = shared_message_create(queue->pending, queue->pending_len);
+    if (msg == NULL) return false;
+
+    queue->items[(queue->head + queue->count) % OUT_QUEUE_LENGTH] = msg;
+    queue->count++;
+    queue->pending_len = 0;
+    return true;
+}
+
+bool outqueue_push(OutQueue *queue, SharedMessage *msg) {
+    /* Poradi: drive zapsane odpovedi musi odejit pred touto zpravou */
+    if (!spill_pending(queue) || queue->count == OUT_QUEUE_LENGTH) return false;
+
+    queue->items[(queue->head + queue->count) % OUT_QUEUE_LENGTH] = msg;
+    queue->count++;
+    msg->refs++;
+    return true;
+}
+
+/**
+ * Odebere prvni zpravu z fronty
+ */
+static void pop_front(OutQueue *queue) {
+    shared_message_release(queue->items[queue->head]);
+    queue->items[queue->head] = NULL;
+    queue->head = (queue->head + 1) % OUT_QUEUE_LENGTH;
+    queue->count--;
+    queue->offset = 0;
+}
+
+bool outqueue_append(OutQueue *queue, const char *data, size_t len) {
+    if (len > OUT_PENDING_SIZE - queue->pending_len) {
+        if (!spill_pending(queue)) return false;
+    }
+
+    /* Zprava delsi nez cely buffer jde rovnou do fronty */
+    if (len > OUT_PENDING_SIZE) {
+        SharedMessage *msg = shared_message_create(data, len);
+        if (msg == NULL) return false;
+        bool ok = outqueue_push(queue, msg);
+        shared_message_release(msg);
+        return ok;
+    }
+
+    memcpy(queue->pending + queue->pending_len, data, len);
+    queue->pending_len += len;
+    return true;
+}
+
+void outqueue_drop_pending(OutQueue *queue) {
+    int keep = queue->offset > 0 ? 1 : 0;
+
+    while (queue->count > keep) {
+        int last = (queue->head + queue->count - 1) % OUT_QUEUE_LENGTH;
+        shared_message_release(queue->items[last]);
+        queue->items[last] = NULL;
+        queue->count--;
+    }
+}
+
+void outqueue_clear(OutQueue *queue) {
+    while (queue->count > 0) {
+        pop_front(queue);
+    }
+    outqueue_init(queue);
+}
+
+bool outqueue_is_empty(const OutQueue *queue) {
+    return queue->count == 0 && queue->pending_len == 0;
+}
+
+bool outqueue_flush(OutQueue *queue, int fd) {
+    while (!outqueue_is_empty(queue)) {
+        struct iovec iov[OUT_QUEUE_LENGTH + 1];
+        int n = 0;
+
+        for (int i = 0; i < queue->count; i++) {
+            SharedMessage *msg = queue->items[(queue->head + i) % OUT_QUEUE_LENGTH];
+            size_t skip = (i == 0) ? queue->offset : 0;
+            iov[n].iov_base = msg->data + skip;
+            iov[n].iov_len = msg->len - skip;
+            n++;
+        }
+        if (queue->pending_len > 0) {
+            iov[n].iov_base = queue->pending;
+            iov[n].iov_len = queue->pending_len;
+            n++;
+        }
+
+        ssize_t sent = sysio_writev(fd, iov, n);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        /* Odeber cele odeslane zpravy, u posledni si zapamatuj posun */
+        size_t left = (size_t)sent;
+        while (queue->count > 0) {
+            SharedMessage *msg = queue->items[queue->head];
+            size_t remaining = msg->len - queue->offset;
+            if (left < remaining) {
+                queue->offset += left;
+                break;
+            }
+            left -= remaining;
+            pop_front(queue);
+        }
+        if (queue->count == 0 && left > 0) {
+            queue->pending_len -= left;
+            memmove(queue->pending, queue->pending + left, queue->pending_len);
+        }
+
+        if (!outqueue_is_empty(queue)) break; /* Socket je plny */
+    }
+
+    return true;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file outqueue.h
+ * @brief Sdilene zpravy s pocitanim referenci a odchozi fronty spojeni
+ *
+ * Udalost pro mnoho prijemcu (divaky mistnosti) se naformatuje jednou do
+ * SharedMessage a do fronty kazdeho prijemce se zaradi jen ukazatel.
+ * Fronty se vyprazdnuji neblokujicim writev() z hlavni smycky, takze
+ * pomaly prijemce nezdrzuje ostatni.
+ *
+ * Zpravy pro jednoho prijemce (odpovedi) se kopiruji do bufferu fronty
+ * bez alokace. Buffer logicky nasleduje za sdilenymi zpravami a odejde
+ * stejnym writev() - kazde spojeni dostane za iteraci jediny zapis.
+ */
+
+#ifndef OUTQUEUE_H
+#define OUTQUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../include/config.h"
+
+/* ============================================
+ * STRUKTURY
+ * ============================================ */
+
+/** Zprava sdilena vice frontami; uvolni se s posledni referenci */
+typedef struct {
+    int refs;                       /* Pocet drzitelu (fronty + tvurce) */
+    size_t len;                     /* Delka dat vcetne '\n' */
+    char data[];
+} SharedMessage;
+
+/** Kruhova fronta ukazatelu na sdilene zpravy */
+typedef struct {
+    SharedMessage *items[OUT_QUEUE_LENGTH];
+    int head;                       /* Index prvni zpravy */
+    int count;                      /* Pocet zprav ve fronte */
+    size_t offset;                  /* Uz odeslana cast prvni zpravy */
+    size_t pending_len;             /* Obsazena cast bufferu */
+    char pending[OUT_PENDING_SIZE]; /* Odpovedi za sdilenymi zpravami */
+} OutQueue;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Vytvori sdilenou zpravu (jedina kopie dat, tvurce drzi jednu referenci)
+ * @param data Data zpravy
+ * @param len Delka dat
+ * @return Zprava nebo NULL pri nedostatku pameti
+ */
+SharedMessage* shared_message_create(const char *data, size_t len);
+
+/**
+ * Uvolni jednu referenci na zpravu
+ * @param msg Zprava
+ */
+void shared_message_release(SharedMessage *msg);
+
+/**
+ * Inicializuje prazdnou frontu (bez uvolnovani - napr. po prevzeti pri upgradu)
+ * @param queue Fronta
+ */
+void outqueue_init(OutQueue *queue);
+
+/**
+ * Zaradi zpravu do fronty (pridava referenci)
+ * @param queue Fronta
+ * @param msg Zprava
+ * @return false pokud je fronta plna
+ */
+bool outqueue_push(OutQueue *queue, SharedMessage *msg);
+
+/**
+ * Zkopiruje zpravu pro jedineho prijemce na konec fronty (do bufferu;
+ * kdyz se nevejde, buffer se zaradi jako sdilena zprava)
+ * @param queue Fronta
+ * @param data Data zpravy
+ * @param len Delka dat
+ * @return false pokud je fronta plna nebo chybi pamet
+ */
+bool outqueue_append(OutQueue *queue, const char *data, size_t len);
+
+/**
+ * Zahodi cekajici sdilene zpravy krome rozeslane casti prvni zpravy
+ * (buffer odpovedi zustava)
+ * (ta se musi doposlat, jinak by se rozbilo ramcovani protokolu)
+ * @param queue Fronta
+ */
+void outqueue_drop_pending(OutQueue *queue);
+
+/**
+ * Uvolni vsechny zpravy ve fronte
+ * @param queue Fronta
+ */
+void outqueue_clear(OutQueue *queue);
+
+/**
+ * Je fronta prazdna?
+ * @param queue Fronta
+ * @return true pokud neceka zadna zprava
+ */
+bool outqueue_is_empty(const OutQueue *queue);
+
+/**
+ * Odesle co nejvic zprav jednim neblokujicim writev()
+ * @param queue Fronta
+ * @param fd Socket
+ * @return false pri chybe spojeni (EAGAIN chybou neni)
+ */
+bool outqueue_flush(OutQueue *queue, int fd);
+
+#endif /* OUTQUEUE_H */
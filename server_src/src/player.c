@@ -5,8 +5,8 @@
 
 #include "player.h"
 #include "logger.h"
+#include "sysio.h"
 #include <string.h>
-#include <unistd.h>
 
 /* ============================================
  * IMPLEMENTACE
@@ -17,6 +17,8 @@ void player_init_all(Player *players, int count) {
         memset(&players[i], 0, sizeof(Player));
         players[i].socket_fd = -1;
         players[i].room_id = -1;
+        players[i].watch_room_id = -1;
+        players[i].next_spectator = -1;
         players[i].is_active = false;
         players[i].state = PLAYER_STATE_CONNECTING;
     }
@@ -27,9 +29,11 @@ void player_create(Player *player, int socket_fd) {
     player->socket_fd = socket_fd;
     player->state = PLAYER_STATE_CONNECTING;
     player->room_id = -1;
+    player->watch_room_id = -1;
+    player->next_spectator = -1;
     player->skips_remaining = SKIPS_PER_PLAYER;
     player->recv_buffer_len = 0;
-    player->last_activity = time(NULL);
+    player->last_activity = sysio_time();
     player->disconnect_time = 0;
     player->last_ping = 0;
     player->waiting_pong = false;
@@ -38,25 +42,41 @@ void player_create(Player *player, int socket_fd) {
     player->nickname[0] = '\0';
 }
 
+void player_create_bot(Player *player, const char *nickname) {
+    player_create(player, -1);
+    player->is_bot = true;
+    player_set_nickname(player, nickname);
+    player->state = PLAYER_STATE_LOBBY;
+}
+
 void player_reset(Player *player, bool keep_for_reconnect) {
     if (player->socket_fd >= 0) {
-        close(player->socket_fd);
+        /* Posledni odpovedi (napr. ERROR pred odpojenim) jeste zkusime odeslat */
+        outqueue_flush(&player->out_queue, player->socket_fd);
+        sysio_close(player->socket_fd);
     }
     
+    /* Neodeslane zpravy uz nema kdo prevzit */
+    outqueue_clear(&player->out_queue);
+    
     if (keep_for_reconnect) {
         /* Zachovame identitu a hernni stav pro reconnect */
         player->socket_fd = -1;
         player->state = PLAYER_STATE_DISCONNECTED;
-        player->disconnect_time = time(NULL);
+        player->disconnect_time = sysio_time();
         player->recv_buffer_len = 0;
+        memset(&player->ws, 0, sizeof(player->ws));
         player->waiting_pong = false;
         player->invalid_message_count = 0;
+        player->out_overflow = false;
     } else {
         /* Uplny reset */
         int room_id = player->room_id; /* Pro pozdejsi uklid */
         memset(player, 0, sizeof(Player));
         player->socket_fd = -1;
         player->room_id = -1;
+        player->watch_room_id = -1;
+        player->next_spectator = -1;
         player->is_active = false;
         player->state = PLAYER_STATE_CONNECTING;
         (void)room_id; /* Pouzit v lobby/room modulu */
@@ -94,19 +114,6 @@ Player* player_find_by_nickname(Player *players, int count, const char *nickname
     return NULL;
 }
 
-Player* player_find_disconnected(Player *players, int count, const char *nickname) {
-    if (nickname == NULL) return NULL;
-    
-    for (int i = 0; i < count; i++) {
-        if (players[i].is_active && 
-            players[i].state == PLAYER_STATE_DISCONNECTED &&
-            strcmp(players[i].nickname, nickname) == 0) {
-            return &players[i];
-        }
-    }
-    return NULL;
-}
-
 void player_set_nickname(Player *player, const char *nickname) {
     if (player && nickname) {
         strncpy(player->nickname, nickname, MAX_NICKNAME_LENGTH);
@@ -126,7 +133,7 @@ void player_set_state(Player *player, PlayerState state) {
 
 void player_update_activity(Player *player) {
     if (player) {
-        player->last_activity = time(NULL);
+        player->last_activity = sysio_time();
     }
 }
 
@@ -135,7 +142,7 @@ bool player_reconnect_timeout_expired(Player *player) {
         return false;
     }
     
-    time_t now = time(NULL);
+    time_t now = sysio_time();
     return (now - player->disconnect_time) > SHORT_DISCONNECT_TIMEOUT;
 }
 
@@ -144,7 +151,7 @@ bool player_needs_ping(Player *player) {
         return false;
     }
     
-    time_t now = time(NULL);
+    time_t now = sysio_time();
     return !player->waiting_pong && 
            (now - player->last_activity) > PING_INTERVAL;
 }
@@ -154,10 +161,14 @@ bool player_pong_timeout_expired(Player *player) {
         return false;
     }
     
-    time_t now = time(NULL);
+    time_t now = sysio_time();
     return (now - player->last_ping) > PING_TIMEOUT;
 }
 
+bool player_is_online(const Player *player) {
+    return player != NULL && (player->socket_fd >= 0 || player->is_bot);
+}
+
 int player_count_active(Player *players, int count) {
     int active = 0;
     for (int i = 0; i < count; i++) {
@@ -174,6 +185,9 @@ const char* player_state_to_string(PlayerState state) {
         case PLAYER_STATE_LOBBY:        return "LOBBY";
         case PLAYER_STATE_IN_ROOM:      return "IN_ROOM";
         case PLAYER_STATE_IN_GAME:      return "IN_GAME";
+        case PLAYER_STATE_WATCHING:     return "WATCHING";
+        case PLAYER_STATE_TOURNAMENT:   return "TOURNAMENT";
+        case PLAYER_STATE_QUEUED:       return "QUEUED";
         case PLAYER_STATE_DISCONNECTED: return "DISCONNECTED";
         default:                        return "UNKNOWN";
     }
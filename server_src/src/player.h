@@ -7,7 +7,10 @@
 #define PLAYER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
+#include "outqueue.h"
+#include "websocket.h"
 #include "../include/config.h"
 
 /* ============================================
@@ -19,6 +22,9 @@ typedef enum {
     PLAYER_STATE_LOBBY,         /* V lobby, muze vstoupit do mistnosti */
     PLAYER_STATE_IN_ROOM,       /* V mistnosti, ceka na protihrace */
     PLAYER_STATE_IN_GAME,       /* Ve hre */
+    PLAYER_STATE_WATCHING,      /* Sleduje hru jako divak */
+    PLAYER_STATE_TOURNAMENT,    /* Registrovan v turnaji, ceka na zapas */
+    PLAYER_STATE_QUEUED,        /* Ceka ve fronte rychle hry */
     PLAYER_STATE_DISCONNECTED   /* Docasne odpojen (muze se vratit) */
 } PlayerState;
 
@@ -32,18 +38,26 @@ typedef struct {
     PlayerState state;                      /* Aktualni stav */
     int room_id;                            /* ID mistnosti (-1 = neni v mistnosti) */
     
+    /* Session pro RESUME */
+    unsigned char session_token[SESSION_TOKEN_BYTES]; /* Nahodny token */
+    bool has_session;                       /* Byl vydan token? */
+    
     /* Herni data */
     int skips_remaining;                    /* Pocet zbyvajicich preskoceni */
     
     /* Sitova data */
     char recv_buffer[BUFFER_SIZE];          /* Buffer pro prijimani dat */
     int recv_buffer_len;                    /* Delka dat v bufferu */
+    char request_id[REQUEST_ID_MAX_LENGTH + 1]; /* ID zpracovavaneho pozadavku ("" = bez ID) */
+    bool binary;                            /* Binarni ramce misto radku (vyjednano v LOGIN/RESUME) */
+    WsConnection ws;                        /* WebSocket spojeni (ws.state = NONE u TCP) */
     
     /* Casove udaje */
     time_t last_activity;                   /* Cas posledni aktivity */
     time_t disconnect_time;                 /* Cas odpojeni (pro reconnect) */
     time_t last_ping;                       /* Cas posledniho PING */
     bool waiting_pong;                      /* Cekame na PONG? */
+    int64_t queued_at;                      /* Zarazeni do fronty rychle hry (ms, monotonni) */
     
     /* Validace */
     int invalid_message_count;              /* Pocet nevalidnich zprav */
@@ -52,8 +66,17 @@ typedef struct {
     int messages_this_second;               /* Pocet zprav v aktualni sekunde */
     time_t rate_limit_second;               /* Sekunda pro rate limiting */
     
+    /* Divak */
+    int watch_room_id;                      /* Sledovana mistnost (-1 = zadna) */
+    int next_spectator;                     /* Dalsi divak mistnosti (index slotu, -1 = konec) */
+    bool resync_pending;                    /* Fronta pretekla - po vyprazdneni poslat stav hry */
+    time_t lag_since;                       /* Od kdy divak nestiha */
+    OutQueue out_queue;                     /* Sdilene zpravy cekajici na odeslani */
+    bool out_overflow;                      /* Odpoved se nevesla do fronty - odpojit */
+    
     /* Priznaky */
     bool is_active;                         /* Je slot aktivni? */
+    bool is_bot;                            /* Bot serveru (bez socketu) */
 } Player;
 
 /* ============================================
@@ -74,6 +97,13 @@ void player_init_all(Player *players, int count);
  */
 void player_create(Player *player, int socket_fd);
 
+/**
+ * Vytvori bota serveru - hrace bez socketu, ktery je stale "pripojen"
+ * @param player Ukazatel na slot hrace
+ * @param nickname Prezdivka bota
+ */
+void player_create_bot(Player *player, const char *nickname);
+
 /**
  * Resetuje hrace do vychoziho stavu (pri odpojeni)
  * @param player Ukazatel na hrace
@@ -107,15 +137,6 @@ Player* player_find_by_socket(Player *players, int count, int socket_fd);
  */
 Player* player_find_by_nickname(Player *players, int count, const char *nickname);
 
-/**
- * Najde odpojeneho hrace podle prezdivky (pro reconnect)
- * @param players Pole hracu
- * @param count Pocet slotu
- * @param nickname Prezdivka
- * @return Ukazatel na hrace nebo NULL
- */
-Player* player_find_disconnected(Player *players, int count, const char *nickname);
-
 /**
  * Nastavi prezdivku hraci
  * @param player Ukazatel na hrace
@@ -157,6 +178,13 @@ bool player_needs_ping(Player *player);
  */
 bool player_pong_timeout_expired(Player *player);
 
+/**
+ * Zkontroluje, zda je hrac pripojen (bot je pripojen vzdy)
+ * @param player Ukazatel na hrace
+ * @return true pokud muze hrat
+ */
+bool player_is_online(const Player *player);
+
 /**
  * Pocet aktivnich hracu
  * @param players Pole hracu
@@ -7,6 +7,7 @@
 #include "../include/config.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -27,6 +28,18 @@ static const struct {
     { MSG_SKIP,           "SKIP" },
     { MSG_PING,           "PING" },
     { MSG_LOGOUT,         "LOGOUT" },
+    { MSG_RESUME,         "RESUME" },
+    { MSG_ADD_BOT,        "ADD_BOT" },
+    { MSG_HINT,           "HINT" },
+    { MSG_WATCH,          "WATCH" },
+    { MSG_UNWATCH,        "UNWATCH" },
+    { MSG_TOURNAMENT_CREATE, "TOURNAMENT_CREATE" },
+    { MSG_TOURNAMENT_JOIN,   "TOURNAMENT_JOIN" },
+    { MSG_TOURNAMENT_LEAVE,  "TOURNAMENT_LEAVE" },
+    { MSG_TOURNAMENT_START,  "TOURNAMENT_START" },
+    { MSG_LEADERBOARD,    "LEADERBOARD" },
+    { MSG_QUICK_MATCH,    "QUICK_MATCH" },
+    { MSG_QUICK_MATCH_CANCEL, "QUICK_MATCH_CANCEL" },
     { MSG_LOGIN_OK,       "LOGIN_OK" },
     { MSG_LOGIN_ERR,      "LOGIN_ERR" },
     { MSG_ROOMS,          "ROOMS" },
@@ -47,6 +60,25 @@ static const struct {
     { MSG_SERVER_SHUTDOWN,"SERVER_SHUTDOWN" },
     { MSG_WAIT_OPPONENT,  "WAIT_OPPONENT" },
     { MSG_GAME_RESUMED,   "GAME_RESUMED" },
+    { MSG_RESUME_OK,      "RESUME_OK" },
+    { MSG_RESUME_ERR,     "RESUME_ERR" },
+    { MSG_HINT_OK,        "HINT_OK" },
+    { MSG_HINT_ERR,       "HINT_ERR" },
+    { MSG_WATCH_OK,       "WATCH_OK" },
+    { MSG_WATCH_ERR,      "WATCH_ERR" },
+    { MSG_UNWATCH_OK,     "UNWATCH_OK" },
+    { MSG_TOURNAMENT_OPEN,   "TOURNAMENT_OPEN" },
+    { MSG_TOURNAMENT_OK,     "TOURNAMENT_OK" },
+    { MSG_TOURNAMENT_ERR,    "TOURNAMENT_ERR" },
+    { MSG_TOURNAMENT_LEFT,   "TOURNAMENT_LEFT" },
+    { MSG_TOURNAMENT_MATCH,  "TOURNAMENT_MATCH" },
+    { MSG_TOURNAMENT_ADVANCE,"TOURNAMENT_ADVANCE" },
+    { MSG_TOURNAMENT_OVER,   "TOURNAMENT_OVER" },
+    { MSG_LEADERBOARD_OK, "LEADERBOARD_OK" },
+    { MSG_QUICK_MATCH_WAIT,  "QUICK_MATCH_WAIT" },
+    { MSG_QUICK_MATCH_FOUND, "QUICK_MATCH_FOUND" },
+    { MSG_QUICK_MATCH_CANCELLED, "QUICK_MATCH_CANCELLED" },
+    { MSG_QUICK_MATCH_ERR,   "QUICK_MATCH_ERR" },
     { MSG_UNKNOWN,        NULL }
 };
 
@@ -54,30 +86,25 @@ static const struct {
  * MAPOVANI CHYBOVYCH KODU
  * ============================================ */
 
+/** Pocet zaznamu tabulek indexovanych kodem chyby */
+#define ERROR_TABLE_SIZE (ERR_INTERNAL + 1)
+
+/** Vychozi texty chyb */
+static const char *const error_texts[ERROR_TABLE_SIZE] = {
+    [ERR_NONE] = "OK",
+#define X(name, code, text) [name] = text,
+    PROTOCOL_ERRORS(X)
+#undef X
+};
+
+/** Predpripravene konce chybovych zprav "kod;text" se znamou delkou - \n doplni writer_end */
 static const struct {
-    ErrorCode code;
-    const char *message;
-} error_map[] = {
-    { ERR_NONE,             "OK" },
-    { ERR_INVALID_FORMAT,   "Invalid message format" },
-    { ERR_UNKNOWN_COMMAND,  "Unknown command" },
-    { ERR_INVALID_PARAMS,   "Invalid parameters" },
-    { ERR_NOT_LOGGED_IN,    "Not logged in" },
-    { ERR_ALREADY_LOGGED_IN,"Already logged in" },
-    { ERR_NICKNAME_TAKEN,   "Nickname already taken" },
-    { ERR_NICKNAME_INVALID, "Invalid nickname" },
-    { ERR_ROOM_NOT_FOUND,   "Room not found" },
-    { ERR_ROOM_FULL,        "Room is full" },
-    { ERR_ROOM_NAME_TAKEN,  "Room name already taken" },
-    { ERR_NOT_IN_ROOM,      "Not in a room" },
-    { ERR_NOT_IN_GAME,      "Not in a game" },
-    { ERR_NOT_YOUR_TURN,    "Not your turn" },
-    { ERR_INVALID_MOVE,     "Invalid move" },
-    { ERR_NO_SKIPS_LEFT,    "No skips remaining" },
-    { ERR_SERVER_FULL,      "Server is full" },
-    { ERR_MAX_ROOMS,        "Maximum rooms reached" },
-    { ERR_GAME_IN_PROGRESS, "Game already in progress" },
-    { ERR_INTERNAL,         "Internal server error" }
+    const char *data;
+    int len;
+} error_tails[ERROR_TABLE_SIZE] = {
+#define X(name, code, text) [name] = { #code ";" text, (int)sizeof(#code ";" text) - 1 },
+    PROTOCOL_ERRORS(X)
+#undef X
 };
 
 /* ============================================
@@ -118,6 +145,26 @@ MessageType protocol_string_to_message_type(const char *str) {
     return MSG_UNKNOWN;
 }
 
+const char* protocol_split_request_id(const char *line, char *id, int id_size) {
+    id[0] = '\0';
+    if (line[0] != REQUEST_ID_PREFIX) return line;
+    
+    const char *start = line + 1;
+    const char *end = strchr(start, MSG_DELIMITER);
+    int len = end != NULL ? (int)(end - start) : 0;
+    if (len < 1 || len > REQUEST_ID_MAX_LENGTH || len >= id_size) return NULL;
+    
+    for (int i = 0; i < len; i++) {
+        if (!isalnum((unsigned char)start[i]) && start[i] != '-' && start[i] != '_') {
+            return NULL;
+        }
+    }
+    
+    memcpy(id, start, len);
+    id[len] = '\0';
+    return end + 1;
+}
+
 bool protocol_parse_message(const char *raw_message, ParsedMessage *parsed) {
     if (raw_message == NULL || parsed == NULL) {
         return false;
@@ -169,13 +216,199 @@ bool protocol_parse_message(const char *raw_message, ParsedMessage *parsed) {
     return (parsed->type != MSG_UNKNOWN);
 }
 
-const char* protocol_error_to_string(ErrorCode code) {
-    for (size_t i = 0; i < sizeof(error_map) / sizeof(error_map[0]); i++) {
-        if (error_map[i].code == code) {
-            return error_map[i].message;
+/* ============================================
+ * BINARNI REZIM
+ * ============================================ */
+
+/** Pole binarniho ramce: 0x00-0x7F je primo male cislo */
+#define BIN_FIELD_SMALL_MAX 0x7F
+#define BIN_FIELD_INT       0x80    /* + zigzag varint */
+#define BIN_FIELD_STRING    0x81    /* + varint delka + bajty */
+
+/**
+ * Je pole cele cislo, ktere se prevede zpet na stejny text?
+ * (bez uvodnich nul, "-0" a cisel mimo int)
+ */
+static bool field_to_int(const char *field, size_t len, int32_t *value) {
+    size_t i = (len > 0 && field[0] == '-') ? 1 : 0;
+    size_t digits = len - i;
+    if (digits == 0 || digits > 9) return false;
+    if (field[i] == '0' && (digits > 1 || i == 1)) return false;
+
+    int32_t result = 0;
+    for (; i < len; i++) {
+        if (field[i] < '0' || field[i] > '9') return false;
+        result = result * 10 + (field[i] - '0');
+    }
+    *value = field[0] == '-' ? -result : result;
+    return true;
+}
+
+static int put_varint(unsigned char *out, int size, uint32_t value) {
+    int n = 0;
+    do {
+        if (n >= size) return -1;
+        unsigned char byte = value & 0x7F;
+        value >>= 7;
+        out[n++] = value != 0 ? (byte | 0x80) : byte;
+    } while (value != 0);
+    return n;
+}
+
+/**
+ * Precte varint (nejvys 5 bajtu)
+ * @return Pocet prectenych bajtu, -1 pri chybe
+ */
+static int get_varint(const unsigned char *data, int len, uint32_t *value) {
+    uint32_t result = 0;
+    for (int i = 0; i < len && i < 5; i++) {
+        result |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
         }
     }
-    return "Unknown error";
+    return -1;
+}
+
+/**
+ * Retezcove pole nesmi obsahovat nic, co by v textovem rezimu
+ * ostatnich klientu rozbilo zpravu (oddelovac, ridici znaky)
+ */
+static bool is_valid_string_field(const unsigned char *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] < 32 || data[i] > 126 || data[i] == MSG_DELIMITER) return false;
+    }
+    return true;
+}
+
+int protocol_encode_binary(const char *message, size_t len, char *out, int size) {
+    /* Koncove \n (\r\n) do ramce nepatri */
+    while (len > 0 && (message[len - 1] == '\n' || message[len - 1] == '\r')) len--;
+
+    const char *end = message + len;
+    const char *field = message;
+    const char *delim = memchr(field, MSG_DELIMITER, len);
+    size_t name_len = (delim != NULL ? delim : end) - field;
+
+    char name[32];
+    if (name_len == 0 || name_len >= sizeof(name) || size < BINARY_FRAME_HEADER + 1) return -1;
+    memcpy(name, field, name_len);
+    name[name_len] = '\0';
+    MessageType type = protocol_string_to_message_type(name);
+    if (type == MSG_UNKNOWN) return -1;
+
+    unsigned char *buf = (unsigned char *)out;
+    int pos = BINARY_FRAME_HEADER;
+    buf[pos++] = (unsigned char)type;
+
+    while (delim != NULL) {
+        field = delim + 1;
+        delim = memchr(field, MSG_DELIMITER, end - field);
+        size_t field_len = (delim != NULL ? delim : end) - field;
+
+        int32_t value;
+        int n;
+        if (field_to_int(field, field_len, &value) && value >= 0 && value <= BIN_FIELD_SMALL_MAX) {
+            if (pos >= size) return -1;
+            buf[pos++] = (unsigned char)value;
+            continue;
+        }
+        if (pos >= size) return -1;
+        if (field_to_int(field, field_len, &value)) {
+            buf[pos++] = BIN_FIELD_INT;
+            uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+            n = put_varint(buf + pos, size - pos, zigzag);
+            if (n < 0) return -1;
+            pos += n;
+        } else {
+            buf[pos++] = BIN_FIELD_STRING;
+            n = put_varint(buf + pos, size - pos, (uint32_t)field_len);
+            if (n < 0 || pos + n + (int)field_len > size) return -1;
+            pos += n;
+            memcpy(buf + pos, field, field_len);
+            pos += (int)field_len;
+        }
+    }
+
+    int body = pos - BINARY_FRAME_HEADER;
+    if (body > 0xFFFF) return -1;
+    buf[0] = (unsigned char)(body >> 8);
+    buf[1] = (unsigned char)(body & 0xFF);
+    return pos;
+}
+
+int protocol_decode_binary(const char *data, int len, ParsedMessage *parsed) {
+    if (len < BINARY_FRAME_HEADER) return 0;
+
+    const unsigned char *buf = (const unsigned char *)data;
+    int body = (buf[0] << 8) | buf[1];
+    if (body < 1 || body > MAX_MESSAGE_LENGTH) return -1;
+    if (len < BINARY_FRAME_HEADER + body) return 0;
+
+    const unsigned char *p = buf + BINARY_FRAME_HEADER;
+    const unsigned char *end = p + body;
+
+    int frame = BINARY_FRAME_HEADER + body;
+
+    /* Chybny obsah ramce zname delky je jen nevalidni zprava (MSG_UNKNOWN),
+     * spojeni se za nim zachyti */
+    parsed->type = MSG_UNKNOWN;
+    parsed->param_count = 0;
+    parsed->raw[0] = '\0';
+    if (*p >= MSG_UNKNOWN) return frame;
+    MessageType type = (MessageType)*p++;
+
+    while (p < end) {
+        /* Parametry navic se zahodi stejne jako v textovem rezimu */
+        char *param = parsed->param_count < MAX_PARAMS
+                      ? parsed->params[parsed->param_count] : NULL;
+        char scratch[MAX_PARAM_LENGTH];
+        if (param == NULL) param = scratch;
+
+        if (*p <= BIN_FIELD_SMALL_MAX) {
+            snprintf(param, MAX_PARAM_LENGTH, "%d", *p++);
+        } else if (*p == BIN_FIELD_INT) {
+            uint32_t zigzag;
+            int n = get_varint(p + 1, (int)(end - p - 1), &zigzag);
+            if (n < 0) return frame;
+            int32_t value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            snprintf(param, MAX_PARAM_LENGTH, "%d", value);
+            p += 1 + n;
+        } else if (*p == BIN_FIELD_STRING) {
+            uint32_t field_len;
+            int n = get_varint(p + 1, (int)(end - p - 1), &field_len);
+            if (n < 0) return frame;
+            p += 1 + n;
+            if (field_len >= MAX_PARAM_LENGTH || field_len > (uint32_t)(end - p) ||
+                !is_valid_string_field(p, field_len)) {
+                return frame;
+            }
+            memcpy(param, p, field_len);
+            param[field_len] = '\0';
+            p += field_len;
+        } else {
+            return frame;
+        }
+
+        if (parsed->param_count < MAX_PARAMS) parsed->param_count++;
+    }
+
+    parsed->type = type;
+    return frame;
+}
+
+bool protocol_wants_binary(const ParsedMessage *parsed) {
+    return (parsed->type == MSG_LOGIN || parsed->type == MSG_RESUME) &&
+           parsed->param_count >= 2 &&
+           strcmp(parsed->params[1], BINARY_CAPABILITY) == 0;
+}
+
+const char* protocol_error_to_string(ErrorCode code) {
+    if ((int)code < 0 || code >= ERROR_TABLE_SIZE || error_texts[code] == NULL) {
+        return "Unknown error";
+    }
+    return error_texts[code];
 }
 
 ErrorCode protocol_validate_nickname(const char *nickname) {
@@ -225,108 +458,535 @@ ErrorCode protocol_validate_room_name(const char *name) {
     return ERR_NONE;
 }
 
+/**
+ * Nacte cele nezaporne cislo (bez dalsich znaku)
+ */
+static bool parse_rule_value(const char *text, int *value) {
+    if (text == NULL || !isdigit((unsigned char)text[0])) return false;
+    
+    char *end;
+    long v = strtol(text, &end, 10);
+    if (*end != '\0' || v > 100000) return false;
+    
+    *value = (int)v;
+    return true;
+}
+
+/**
+ * Nacte seznam hromadek "3,4,5" a odvodi z nej pravidla klasickeho Nimu
+ */
+static bool parse_piles(const char *text, GameRules *rules) {
+    char list[MAX_PARAM_LENGTH];
+    safe_strcpy(list, text, sizeof(list));
+    
+    int count = 0, total = 0, largest = 0;
+    int piles[GAME_MAX_PILES] = { 0 };
+    char *saveptr;
+    const char delimiter[2] = { LIST_DELIMITER, '\0' };
+    for (char *item = strtok_r(list, delimiter, &saveptr); item != NULL;
+         item = strtok_r(NULL, delimiter, &saveptr)) {
+        if (count >= GAME_MAX_PILES || !parse_rule_value(item, &piles[count])) {
+            return false;
+        }
+        total += piles[count];
+        if (piles[count] > largest) largest = piles[count];
+        count++;
+    }
+    
+    /* Jedna hromadka je obycejna hra s danym poctem kaminku */
+    if (count == 1) {
+        rules->initial_stones = total;
+        rules->piles[0] = total;
+        return true;
+    }
+    
+    rules->pile_count = count;
+    memcpy(rules->piles, piles, sizeof(piles));
+    rules->initial_stones = total;
+    rules->min_take = 1;
+    rules->max_take = largest;
+    rules->skips_per_player = 0;
+    return count > 1;
+}
+
+ErrorCode protocol_parse_rules(const ParsedMessage *msg, int first, GameRules *rules) {
+    *rules = *game_preset_rules(GAME_PRESET_CLASSIC);
+    
+    /* Nejdriv varianta (at je uvedena kdekoli), pak jednotlive hodnoty */
+    for (int i = first; i < msg->param_count; i++) {
+        const char *param = msg->params[i];
+        if (strncmp(param, "preset=", 7) == 0) {
+            GamePreset preset = game_find_preset(param + 7);
+            if (preset == GAME_PRESET_CUSTOM) return ERR_INVALID_RULES;
+            *rules = *game_preset_rules(preset);
+        }
+    }
+    
+    int values = 0;
+    const char *piles = NULL;
+    for (int i = first; i < msg->param_count; i++) {
+        const char *param = msg->params[i];
+        const char *eq = strchr(param, '=');
+        if (eq == NULL) return ERR_INVALID_RULES;
+        
+        size_t key_len = (size_t)(eq - param);
+        int *target = NULL;
+        if (key_len == 6 && strncmp(param, "preset", 6) == 0) continue;
+        if (key_len == 5 && strncmp(param, "piles", 5) == 0) {
+            piles = eq + 1;
+            continue;
+        }
+        /* Pocet hracu lze kombinovat s cimkoli, vcetne hromadek */
+        if (key_len == 7 && strncmp(param, "players", 7) == 0) {
+            if (!parse_rule_value(eq + 1, &rules->player_count)) return ERR_INVALID_RULES;
+            continue;
+        }
+        /* Cas na tah take plati pro kazdou variantu */
+        if (key_len == 5 && strncmp(param, "clock", 5) == 0) {
+            if (!parse_rule_value(eq + 1, &rules->move_seconds)) return ERR_INVALID_RULES;
+            continue;
+        }
+        if (key_len == 6 && strncmp(param, "stones", 6) == 0) target = &rules->initial_stones;
+        if (key_len == 3 && strncmp(param, "min", 3) == 0)    target = &rules->min_take;
+        if (key_len == 3 && strncmp(param, "max", 3) == 0)    target = &rules->max_take;
+        if (key_len == 5 && strncmp(param, "skips", 5) == 0)  target = &rules->skips_per_player;
+        
+        if (target == NULL || !parse_rule_value(eq + 1, target)) {
+            return ERR_INVALID_RULES;
+        }
+        values++;
+    }
+    
+    /* Hromadky urcuji vsechna pravidla - nelze je kombinovat s hodnotami */
+    if (piles != NULL && (values > 0 || !parse_piles(piles, rules))) {
+        return ERR_INVALID_RULES;
+    }
+    
+    /* Jedna hromadka obsahuje vsechny kaminky */
+    if (rules->pile_count == 1) {
+        rules->piles[0] = rules->initial_stones;
+    }
+    
+    return game_validate_rules(rules) ? ERR_NONE : ERR_INVALID_RULES;
+}
+
+/* ============================================
+ * SKLADANI ZPRAV
+ * ============================================ */
+
+/**
+ * Zprava skladana po castech bez snprintf. Pri nedostatku mista se zkrati
+ * (ukoncovac zustane); len je vzdy skutecne zapsana delka.
+ */
+typedef struct {
+    char *buf;
+    int size;
+    int len;
+} MessageWriter;
+
+static MessageWriter writer_start(char *buffer, int size) {
+    MessageWriter w = { buffer, size, 0 };
+    return w;
+}
+
+static void put_bytes(MessageWriter *w, const char *data, int len) {
+    int room = w->size - 1 - w->len;
+    if (len > room) len = room;
+    if (len > 0) {
+        memcpy(w->buf + w->len, data, (size_t)len);
+        w->len += len;
+    }
+}
+
+/** Retezcovy literal - delka je znama pri prekladu */
+#define put_literal(w, text) put_bytes((w), (text), (int)sizeof(text) - 1)
+
+static void put_str(MessageWriter *w, const char *text) {
+    if (text != NULL) put_bytes(w, text, (int)strlen(text));
+}
+
+static void put_char(MessageWriter *w, char c) {
+    put_bytes(w, &c, 1);
+}
+
+/**
+ * Desitkovy zapis cisla bez formatovaciho retezce
+ */
+static void put_int(MessageWriter *w, int value) {
+    char digits[12];
+    int pos = sizeof(digits);
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    
+    do {
+        digits[--pos] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    if (value < 0) digits[--pos] = '-';
+    
+    put_bytes(w, digits + pos, (int)sizeof(digits) - pos);
+}
+
+/** Dalsi pole zpravy (";hodnota") */
+static void put_field_int(MessageWriter *w, int value) {
+    put_char(w, MSG_DELIMITER);
+    put_int(w, value);
+}
+
+static void put_field_str(MessageWriter *w, const char *text) {
+    put_char(w, MSG_DELIMITER);
+    put_str(w, text);
+}
+
+/**
+ * Velikosti hromadek jako seznam oddeleny LIST_DELIMITER
+ */
+static void put_piles(MessageWriter *w, const int *piles, int count) {
+    for (int i = 0; i < count; i++) {
+        if (i > 0) put_char(w, LIST_DELIMITER);
+        put_int(w, piles[i]);
+    }
+}
+
+/**
+ * Ukonci zpravu - \n a '\0'
+ * @return Delka zpravy vcetne \n
+ */
+static int writer_end(MessageWriter *w) {
+    if (w->size <= 0) return 0;
+    if (w->len < w->size - 1) {
+        w->buf[w->len++] = MSG_TERMINATOR;
+    } else if (w->len > 0) {
+        w->buf[w->len - 1] = MSG_TERMINATOR;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+/**
+ * Zprava bez parametru - predpripraveny literal se jen zkopiruje
+ */
+#define create_constant(buffer, size, name) \
+    do { \
+        MessageWriter w_ = writer_start((buffer), (size)); \
+        put_literal(&w_, name); \
+        return writer_end(&w_); \
+    } while (0)
+
+/**
+ * Chybova odpoved "NAZEV;kod;duvod" - s vychozim duvodem se zkopiruje
+ * predpripraveny konec zpravy z error_tails
+ */
+static int create_error_reply(char *buffer, int size, const char *name, int name_len,
+                              ErrorCode code, const char *reason) {
+    MessageWriter w = writer_start(buffer, size);
+    put_bytes(&w, name, name_len);
+    put_char(&w, MSG_DELIMITER);
+    
+    if (reason == NULL && (int)code >= 0 && code < ERROR_TABLE_SIZE &&
+        error_tails[code].data != NULL) {
+        put_bytes(&w, error_tails[code].data, error_tails[code].len);
+    } else {
+        put_int(&w, code);
+        put_field_str(&w, reason != NULL ? reason : protocol_error_to_string(code));
+    }
+    return writer_end(&w);
+}
+
+#define create_error(buffer, size, name, code, reason) \
+    create_error_reply((buffer), (size), (name), (int)sizeof(name) - 1, (code), (reason))
+
 /* ============================================
  * FUNKCE PRO TVORBU ZPRAV
  * ============================================ */
 
-int protocol_create_login_ok(char *buffer, int size) {
-    return snprintf(buffer, size, "LOGIN_OK\n");
+int protocol_create_login_ok(char *buffer, int size, const char *token) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "LOGIN_OK");
+    if (token != NULL && token[0] != '\0') {
+        put_field_str(&w, token);
+    }
+    return writer_end(&w);
 }
 
 int protocol_create_login_err(char *buffer, int size, ErrorCode code, const char *reason) {
-    return snprintf(buffer, size, "LOGIN_ERR;%d;%s\n", code, 
-                    reason ? reason : protocol_error_to_string(code));
+    return create_error(buffer, size, "LOGIN_ERR", code, reason);
+}
+
+int protocol_create_resume_ok(char *buffer, int size, const char *nickname) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "RESUME_OK");
+    put_field_str(&w, nickname);
+    return writer_end(&w);
+}
+
+int protocol_create_resume_err(char *buffer, int size, ErrorCode code, const char *reason) {
+    return create_error(buffer, size, "RESUME_ERR", code, reason);
 }
 
 int protocol_create_rooms(char *buffer, int size, const char *rooms_data) {
-    if (rooms_data && strlen(rooms_data) > 0) {
-        return snprintf(buffer, size, "ROOMS;%s\n", rooms_data);
-    }
-    return snprintf(buffer, size, "ROOMS;0\n");
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "ROOMS");
+    put_field_str(&w, rooms_data != NULL && rooms_data[0] != '\0' ? rooms_data : "0");
+    return writer_end(&w);
 }
 
 int protocol_create_room_created(char *buffer, int size, int room_id) {
-    return snprintf(buffer, size, "ROOM_CREATED;%d\n", room_id);
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "ROOM_CREATED");
+    put_field_int(&w, room_id);
+    return writer_end(&w);
 }
 
 int protocol_create_room_joined(char *buffer, int size, int room_id, const char *opponent) {
-    if (opponent && strlen(opponent) > 0) {
-        return snprintf(buffer, size, "ROOM_JOINED;%d;%s\n", room_id, opponent);
-    }
-    return snprintf(buffer, size, "ROOM_JOINED;%d;\n", room_id);
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "ROOM_JOINED");
+    put_field_int(&w, room_id);
+    put_field_str(&w, opponent);
+    return writer_end(&w);
 }
 
 int protocol_create_room_err(char *buffer, int size, ErrorCode code, const char *reason) {
-    return snprintf(buffer, size, "ROOM_ERR;%d;%s\n", code,
-                    reason ? reason : protocol_error_to_string(code));
+    return create_error(buffer, size, "ROOM_ERR", code, reason);
 }
 
 int protocol_create_leave_ok(char *buffer, int size) {
-    return snprintf(buffer, size, "LEAVE_OK\n");
+    create_constant(buffer, size, "LEAVE_OK");
 }
 
-int protocol_create_game_start(char *buffer, int size, int stones, bool your_turn, const char *opponent) {
-    return snprintf(buffer, size, "GAME_START;%d;%d;%s\n", 
-                    stones, your_turn ? 1 : 0, opponent ? opponent : "");
+int protocol_create_game_start(char *buffer, int size, int stones, bool your_turn, const char *opponent,
+                               const GameRules *rules, const int *piles, const char *players) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "GAME_START");
+    put_field_int(&w, stones);
+    put_field_int(&w, your_turn ? 1 : 0);
+    put_field_str(&w, opponent);
+    put_field_int(&w, rules->min_take);
+    put_field_int(&w, rules->max_take);
+    put_field_int(&w, rules->skips_per_player);
+    put_char(&w, MSG_DELIMITER);
+    put_piles(&w, piles, rules->pile_count);
+    put_field_str(&w, players);
+    put_field_int(&w, rules->move_seconds);
+    return writer_end(&w);
 }
 
-int protocol_create_take_ok(char *buffer, int size, int remaining, bool your_turn) {
-    return snprintf(buffer, size, "TAKE_OK;%d;%d\n", remaining, your_turn ? 1 : 0);
+int protocol_create_take_ok(char *buffer, int size, int remaining, bool your_turn, int clock_ms) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TAKE_OK");
+    put_field_int(&w, remaining);
+    put_field_int(&w, your_turn ? 1 : 0);
+    put_field_int(&w, clock_ms);
+    return writer_end(&w);
 }
 
 int protocol_create_take_err(char *buffer, int size, ErrorCode code, const char *reason) {
-    return snprintf(buffer, size, "TAKE_ERR;%d;%s\n", code,
-                    reason ? reason : protocol_error_to_string(code));
+    return create_error(buffer, size, "TAKE_ERR", code, reason);
 }
 
-int protocol_create_skip_ok(char *buffer, int size, bool your_turn) {
-    return snprintf(buffer, size, "SKIP_OK;%d\n", your_turn ? 1 : 0);
+int protocol_create_skip_ok(char *buffer, int size, bool your_turn, int clock_ms) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "SKIP_OK");
+    put_field_int(&w, your_turn ? 1 : 0);
+    put_field_int(&w, clock_ms);
+    return writer_end(&w);
 }
 
 int protocol_create_skip_err(char *buffer, int size, ErrorCode code, const char *reason) {
-    return snprintf(buffer, size, "SKIP_ERR;%d;%s\n", code,
-                    reason ? reason : protocol_error_to_string(code));
+    return create_error(buffer, size, "SKIP_ERR", code, reason);
 }
 
-int protocol_create_opponent_action(char *buffer, int size, const char *action, int param, int remaining) {
-    return snprintf(buffer, size, "OPPONENT_ACTION;%s;%d;%d\n", action, param, remaining);
+int protocol_create_opponent_action(char *buffer, int size, const char *action, int param,
+                                    int remaining, int pile, const char *actor, const char *next,
+                                    int clock_ms) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "OPPONENT_ACTION");
+    put_field_str(&w, action);
+    put_field_int(&w, param);
+    put_field_int(&w, remaining);
+    put_field_int(&w, pile);
+    put_field_str(&w, actor);
+    put_field_str(&w, next);
+    put_field_int(&w, clock_ms);
+    return writer_end(&w);
 }
 
 int protocol_create_game_over(char *buffer, int size, const char *winner, const char *loser) {
-    return snprintf(buffer, size, "GAME_OVER;%s;%s\n", winner, loser);
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "GAME_OVER");
+    put_field_str(&w, winner);
+    put_field_str(&w, loser);
+    return writer_end(&w);
+}
+
+int protocol_create_ping(char *buffer, int size) {
+    create_constant(buffer, size, "PING");
 }
 
 int protocol_create_pong(char *buffer, int size) {
-    return snprintf(buffer, size, "PONG\n");
+    create_constant(buffer, size, "PONG");
 }
 
 int protocol_create_player_status(char *buffer, int size, const char *nickname, PlayerStatusType status) {
-    const char *status_str;
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "PLAYER_STATUS");
+    put_field_str(&w, nickname);
     switch (status) {
-        case STATUS_CONNECTED:    status_str = "CONNECTED"; break;
-        case STATUS_DISCONNECTED: status_str = "DISCONNECTED"; break;
-        case STATUS_RECONNECTED:  status_str = "RECONNECTED"; break;
-        default:                  status_str = "UNKNOWN"; break;
+        case STATUS_CONNECTED:    put_literal(&w, ";CONNECTED"); break;
+        case STATUS_DISCONNECTED: put_literal(&w, ";DISCONNECTED"); break;
+        case STATUS_RECONNECTED:  put_literal(&w, ";RECONNECTED"); break;
+        default:                  put_literal(&w, ";UNKNOWN"); break;
     }
-    return snprintf(buffer, size, "PLAYER_STATUS;%s;%s\n", nickname, status_str);
+    return writer_end(&w);
 }
 
 int protocol_create_error(char *buffer, int size, ErrorCode code, const char *message) {
-    return snprintf(buffer, size, "ERROR;%d;%s\n", code,
-                    message ? message : protocol_error_to_string(code));
+    return create_error(buffer, size, "ERROR", code, message);
 }
 
 int protocol_create_server_shutdown(char *buffer, int size) {
-    return snprintf(buffer, size, "SERVER_SHUTDOWN\n");
+    create_constant(buffer, size, "SERVER_SHUTDOWN");
 }
 
 int protocol_create_wait_opponent(char *buffer, int size) {
-    return snprintf(buffer, size, "WAIT_OPPONENT\n");
+    create_constant(buffer, size, "WAIT_OPPONENT");
 }
 
 int protocol_create_game_resumed(char *buffer, int size, int stones, bool your_turn,
-                                  int your_skips, int opponent_skips) {
-    return snprintf(buffer, size, "GAME_RESUMED;%d;%d;%d;%d\n",
-                    stones, your_turn ? 1 : 0, your_skips, opponent_skips);
+                                  int your_skips, int opponent_skips, const GameRules *rules,
+                                  const int *piles, const char *players, int clock_ms) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "GAME_RESUMED");
+    put_field_int(&w, stones);
+    put_field_int(&w, your_turn ? 1 : 0);
+    put_field_int(&w, your_skips);
+    put_field_int(&w, opponent_skips);
+    put_field_int(&w, rules->min_take);
+    put_field_int(&w, rules->max_take);
+    put_char(&w, MSG_DELIMITER);
+    put_piles(&w, piles, rules->pile_count);
+    put_field_str(&w, players);
+    put_field_int(&w, clock_ms);
+    return writer_end(&w);
 }
 
+int protocol_create_hint_ok(char *buffer, int size, int pile, int count, bool winning) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "HINT_OK");
+    put_field_int(&w, pile);
+    put_field_int(&w, count);
+    put_field_int(&w, winning ? 1 : 0);
+    return writer_end(&w);
+}
+
+int protocol_create_hint_err(char *buffer, int size, ErrorCode code, const char *reason) {
+    return create_error(buffer, size, "HINT_ERR", code, reason);
+}
+
+int protocol_create_watch_ok(char *buffer, int size, int room_id, GameState state, int stones,
+                             const char *current, const GameRules *rules, const int *piles,
+                             const char *players, int clock_ms) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "WATCH_OK");
+    put_field_int(&w, room_id);
+    put_field_str(&w, game_state_to_string(state));
+    put_field_int(&w, stones);
+    put_field_str(&w, current);
+    put_field_int(&w, rules->min_take);
+    put_field_int(&w, rules->max_take);
+    put_char(&w, MSG_DELIMITER);
+    put_piles(&w, piles, rules->pile_count);
+    put_field_str(&w, players);
+    put_field_int(&w, clock_ms);
+    return writer_end(&w);
+}
+
+int protocol_create_watch_err(char *buffer, int size, ErrorCode code, const char *reason) {
+    return create_error(buffer, size, "WATCH_ERR", code, reason);
+}
+
+int protocol_create_unwatch_ok(char *buffer, int size) {
+    create_constant(buffer, size, "UNWATCH_OK");
+}
+
+int protocol_create_tournament_open(char *buffer, int size, const char *name,
+                                    const char *organizer) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TOURNAMENT_OPEN");
+    put_field_str(&w, name);
+    put_field_str(&w, organizer);
+    return writer_end(&w);
+}
+
+int protocol_create_tournament_ok(char *buffer, int size, const char *name, int entrants) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TOURNAMENT_OK");
+    put_field_str(&w, name);
+    put_field_int(&w, entrants);
+    return writer_end(&w);
+}
+
+int protocol_create_tournament_err(char *buffer, int size, ErrorCode code, const char *reason) {
+    return create_error(buffer, size, "TOURNAMENT_ERR", code, reason);
+}
+
+int protocol_create_tournament_left(char *buffer, int size) {
+    create_constant(buffer, size, "TOURNAMENT_LEFT");
+}
+
+int protocol_create_tournament_match(char *buffer, int size, int round, int room_id,
+                                     const char *opponent) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TOURNAMENT_MATCH");
+    put_field_int(&w, round);
+    put_field_int(&w, room_id);
+    put_field_str(&w, opponent);
+    return writer_end(&w);
+}
+
+int protocol_create_tournament_advance(char *buffer, int size, int round) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TOURNAMENT_ADVANCE");
+    put_field_int(&w, round);
+    return writer_end(&w);
+}
+
+int protocol_create_tournament_over(char *buffer, int size, const char *name,
+                                    const char *winner) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "TOURNAMENT_OVER");
+    put_field_str(&w, name);
+    put_field_str(&w, winner);
+    return writer_end(&w);
+}
+
+int protocol_create_leaderboard_ok(char *buffer, int size, const char *entries) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "LEADERBOARD_OK");
+    put_field_str(&w, entries);
+    return writer_end(&w);
+}
+
+int protocol_create_quick_match_wait(char *buffer, int size, int rating) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "QUICK_MATCH_WAIT");
+    put_field_int(&w, rating);
+    return writer_end(&w);
+}
+
+int protocol_create_quick_match_found(char *buffer, int size, int room_id,
+                                      const char *opponent, int opponent_rating) {
+    MessageWriter w = writer_start(buffer, size);
+    put_literal(&w, "QUICK_MATCH_FOUND");
+    put_field_int(&w, room_id);
+    put_field_str(&w, opponent);
+    put_field_int(&w, opponent_rating);
+    return writer_end(&w);
+}
+
+int protocol_create_quick_match_cancelled(char *buffer, int size) {
+    create_constant(buffer, size, "QUICK_MATCH_CANCELLED");
+}
+
+int protocol_create_quick_match_err(char *buffer, int size, ErrorCode code, const char *reason) {
+    return create_error(buffer, size, "QUICK_MATCH_ERR", code, reason);
+}
@@ -4,12 +4,17 @@
  * 
  * Textovy protokol nad TCP.
  * Format zpravy: COMMAND;param1;param2;...\n
+ * Klient si v LOGIN/RESUME muze vyjednat kompaktni binarni ramce
+ * (protocol_encode_binary) - hodnoty MessageType jsou pak soucasti
+ * protokolu, nove typy se pridavaji jen pred MSG_UNKNOWN.
  */
 
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "game.h"
 
 /* ============================================
  * TYPY ZPRAV (COMMANDS)
@@ -19,35 +24,66 @@ typedef enum {
     /* Klientske zpravy */
     MSG_LOGIN,          /* LOGIN;nickname */
     MSG_LIST_ROOMS,     /* LIST_ROOMS */
-    MSG_CREATE_ROOM,    /* CREATE_ROOM;name */
+    MSG_CREATE_ROOM,    /* CREATE_ROOM;name[;key=value...] */
     MSG_JOIN_ROOM,      /* JOIN_ROOM;room_id */
     MSG_LEAVE_ROOM,     /* LEAVE_ROOM */
-    MSG_TAKE,           /* TAKE;count */
+    MSG_TAKE,           /* TAKE;count nebo TAKE;pile;count */
     MSG_SKIP,           /* SKIP */
     MSG_PING,           /* PING */
     MSG_LOGOUT,         /* LOGOUT */
+    MSG_RESUME,         /* RESUME;token */
+    MSG_ADD_BOT,        /* ADD_BOT */
+    MSG_HINT,           /* HINT */
+    MSG_WATCH,          /* WATCH;room_id */
+    MSG_UNWATCH,        /* UNWATCH */
+    MSG_TOURNAMENT_CREATE, /* TOURNAMENT_CREATE;name[;key=value...] */
+    MSG_TOURNAMENT_JOIN,   /* TOURNAMENT_JOIN */
+    MSG_TOURNAMENT_LEAVE,  /* TOURNAMENT_LEAVE */
+    MSG_TOURNAMENT_START,  /* TOURNAMENT_START */
+    MSG_LEADERBOARD,    /* LEADERBOARD[;n] */
+    MSG_QUICK_MATCH,    /* QUICK_MATCH */
+    MSG_QUICK_MATCH_CANCEL, /* QUICK_MATCH_CANCEL */
     
     /* Serverove zpravy */
-    MSG_LOGIN_OK,       /* LOGIN_OK */
+    MSG_LOGIN_OK,       /* LOGIN_OK;token */
     MSG_LOGIN_ERR,      /* LOGIN_ERR;reason */
     MSG_ROOMS,          /* ROOMS;count;id,name,players,max;... */
     MSG_ROOM_CREATED,   /* ROOM_CREATED;room_id */
     MSG_ROOM_JOINED,    /* ROOM_JOINED;room_id;opponent_or_empty */
     MSG_ROOM_ERR,       /* ROOM_ERR;reason */
     MSG_LEAVE_OK,       /* LEAVE_OK */
-    MSG_GAME_START,     /* GAME_START;stones;your_turn;opponent_nick */
+    MSG_GAME_START,     /* GAME_START;stones;your_turn;opponent_nick;min;max;skips;piles */
     MSG_TAKE_OK,        /* TAKE_OK;remaining;next_player */
     MSG_TAKE_ERR,       /* TAKE_ERR;reason */
     MSG_SKIP_OK,        /* SKIP_OK;next_player */
     MSG_SKIP_ERR,       /* SKIP_ERR;reason */
-    MSG_OPPONENT_ACTION,/* OPPONENT_ACTION;action;param;remaining */
+    MSG_OPPONENT_ACTION,/* OPPONENT_ACTION;action;param;remaining;pile */
     MSG_GAME_OVER,      /* GAME_OVER;winner;loser */
     MSG_PONG,           /* PONG */
     MSG_PLAYER_STATUS,  /* PLAYER_STATUS;nickname;status */
     MSG_ERROR,          /* ERROR;code;message */
     MSG_SERVER_SHUTDOWN,/* SERVER_SHUTDOWN */
     MSG_WAIT_OPPONENT,  /* WAIT_OPPONENT */
-    MSG_GAME_RESUMED,   /* GAME_RESUMED;stones;your_turn;your_skips;opp_skips */
+    MSG_GAME_RESUMED,   /* GAME_RESUMED;stones;your_turn;your_skips;opp_skips;min;max;piles */
+    MSG_RESUME_OK,      /* RESUME_OK;nickname */
+    MSG_RESUME_ERR,     /* RESUME_ERR;code;reason */
+    MSG_HINT_OK,        /* HINT_OK;pile;count;winning */
+    MSG_HINT_ERR,       /* HINT_ERR;code;reason */
+    MSG_WATCH_OK,       /* WATCH_OK;room_id;state;stones;current;min;max;piles;players */
+    MSG_WATCH_ERR,      /* WATCH_ERR;code;reason */
+    MSG_UNWATCH_OK,     /* UNWATCH_OK */
+    MSG_TOURNAMENT_OPEN,   /* TOURNAMENT_OPEN;name;organizer */
+    MSG_TOURNAMENT_OK,     /* TOURNAMENT_OK;name;entrants */
+    MSG_TOURNAMENT_ERR,    /* TOURNAMENT_ERR;code;reason */
+    MSG_TOURNAMENT_LEFT,   /* TOURNAMENT_LEFT */
+    MSG_TOURNAMENT_MATCH,  /* TOURNAMENT_MATCH;round;room_id;opponent */
+    MSG_TOURNAMENT_ADVANCE,/* TOURNAMENT_ADVANCE;round */
+    MSG_TOURNAMENT_OVER,   /* TOURNAMENT_OVER;name;winner */
+    MSG_LEADERBOARD_OK, /* LEADERBOARD_OK;count;nick,rating,wins,losses;... */
+    MSG_QUICK_MATCH_WAIT,  /* QUICK_MATCH_WAIT;rating */
+    MSG_QUICK_MATCH_FOUND, /* QUICK_MATCH_FOUND;room_id;opponent;opponent_rating */
+    MSG_QUICK_MATCH_CANCELLED, /* QUICK_MATCH_CANCELLED */
+    MSG_QUICK_MATCH_ERR,   /* QUICK_MATCH_ERR;code;reason */
     
     /* Specialni */
     MSG_UNKNOWN         /* Neznama zprava */
@@ -57,27 +93,43 @@ typedef enum {
  * CHYBOVE KODY
  * ============================================ */
 
+/**
+ * Chybove kody: X(nazev, kod, vychozi text)
+ * Z tabulky vznika vycet ErrorCode i predpripravene konce chybovych zprav
+ * ("kod;text\n") - chybova odpoved s vychozim textem se jen zkopiruje.
+ */
+#define PROTOCOL_ERRORS(X) \
+    X(ERR_INVALID_FORMAT,    1,  "Invalid message format") \
+    X(ERR_UNKNOWN_COMMAND,   2,  "Unknown command") \
+    X(ERR_INVALID_PARAMS,    3,  "Invalid parameters") \
+    X(ERR_NOT_LOGGED_IN,     4,  "Not logged in") \
+    X(ERR_ALREADY_LOGGED_IN, 5,  "Already logged in") \
+    X(ERR_NICKNAME_TAKEN,    6,  "Nickname already taken") \
+    X(ERR_NICKNAME_INVALID,  7,  "Invalid nickname") \
+    X(ERR_ROOM_NOT_FOUND,    8,  "Room not found") \
+    X(ERR_ROOM_FULL,         9,  "Room is full") \
+    X(ERR_ROOM_NAME_TAKEN,   10, "Room name already taken") \
+    X(ERR_NOT_IN_ROOM,       11, "Not in a room") \
+    X(ERR_NOT_IN_GAME,       12, "Not in a game") \
+    X(ERR_NOT_YOUR_TURN,     13, "Not your turn") \
+    X(ERR_INVALID_MOVE,      14, "Invalid move") \
+    X(ERR_NO_SKIPS_LEFT,     15, "No skips remaining") \
+    X(ERR_SERVER_FULL,       16, "Server is full") \
+    X(ERR_MAX_ROOMS,         17, "Maximum rooms reached") \
+    X(ERR_GAME_IN_PROGRESS,  18, "Game already in progress") \
+    X(ERR_INVALID_SESSION,   20, "Invalid or expired session") \
+    X(ERR_INVALID_RULES,     21, "Invalid game rules") \
+    X(ERR_NO_TOURNAMENT,     22, "No tournament open for registration") \
+    X(ERR_TOURNAMENT_EXISTS, 23, "Tournament already in progress") \
+    X(ERR_NOT_ORGANIZER,     24, "Only the organizer can start the tournament") \
+    X(ERR_TOO_FEW_ENTRANTS,  25, "Not enough entrants") \
+    X(ERR_INTERNAL,          99, "Internal server error")
+
 typedef enum {
     ERR_NONE = 0,
-    ERR_INVALID_FORMAT = 1,      /* Nespravny format zpravy */
-    ERR_UNKNOWN_COMMAND = 2,     /* Neznamy prikaz */
-    ERR_INVALID_PARAMS = 3,      /* Nespravne parametry */
-    ERR_NOT_LOGGED_IN = 4,       /* Hrac neni prihlasen */
-    ERR_ALREADY_LOGGED_IN = 5,   /* Hrac uz je prihlasen */
-    ERR_NICKNAME_TAKEN = 6,      /* Prezdivka je obsazena */
-    ERR_NICKNAME_INVALID = 7,    /* Neplatna prezdivka */
-    ERR_ROOM_NOT_FOUND = 8,      /* Mistnost neexistuje */
-    ERR_ROOM_FULL = 9,           /* Mistnost je plna */
-    ERR_ROOM_NAME_TAKEN = 10,    /* Nazev mistnosti je obsazen */
-    ERR_NOT_IN_ROOM = 11,        /* Hrac neni v mistnosti */
-    ERR_NOT_IN_GAME = 12,        /* Hrac neni ve hre */
-    ERR_NOT_YOUR_TURN = 13,      /* Neni tvuj tah */
-    ERR_INVALID_MOVE = 14,       /* Neplatny tah */
-    ERR_NO_SKIPS_LEFT = 15,      /* Zadne preskoceni nezbyva */
-    ERR_SERVER_FULL = 16,        /* Server je plny */
-    ERR_MAX_ROOMS = 17,          /* Maximalni pocet mistnosti */
-    ERR_GAME_IN_PROGRESS = 18,   /* Hra uz probiha */
-    ERR_INTERNAL = 99            /* Interni chyba serveru */
+#define X(name, code, text) name = code,
+    PROTOCOL_ERRORS(X)
+#undef X
 } ErrorCode;
 
 /* ============================================
@@ -116,6 +168,46 @@ typedef struct {
  */
 bool protocol_parse_message(const char *raw_message, ParsedMessage *parsed);
 
+/**
+ * Oddeli volitelne ID pozadavku ("#id;ZPRAVA") - 1 az REQUEST_ID_MAX_LENGTH
+ * pismen, cislic, '-' nebo '_'
+ * @param line Prijata zprava (bez \n)
+ * @param id Vystup - ID pozadavku ("" pokud zprava ID nema)
+ * @param id_size Velikost bufferu pro ID
+ * @return Zprava za ID, nebo NULL pri chybnem ID
+ */
+const char* protocol_split_request_id(const char *line, char *id, int id_size);
+
+/**
+ * Prevede textovou zpravu na binarni ramec: delka tela (u16 big-endian),
+ * typ zpravy (hodnota MessageType) a pole - cislo 0-127 jako jeden bajt,
+ * jine cele cislo 0x80 + zigzag varint, retezec 0x81 + varint delka + bajty
+ * @param message Textova zprava (koncove \n se ignoruje)
+ * @param len Delka zpravy
+ * @param out Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Delka ramce, -1 pokud se nevejde nebo typ zpravy neexistuje
+ */
+int protocol_encode_binary(const char *message, size_t len, char *out, int size);
+
+/**
+ * Parsuje binarni ramec ze zacatku prijatych dat
+ * @param data Prijata data
+ * @param len Delka dat
+ * @param parsed Vystupni struktura (cisla jako desitkove retezce, chybny
+ *               obsah ramce = MSG_UNKNOWN)
+ * @return Delka ramce, 0 pokud ramec jeste neni cely, -1 pri chybne delce
+ *         ramce (za ni se spojeni nezachyti)
+ */
+int protocol_decode_binary(const char *data, int len, ParsedMessage *parsed);
+
+/**
+ * Zada zprava prechod do binarniho rezimu? (LOGIN;nick;bin, RESUME;token;bin)
+ * @param parsed Parsovana zprava
+ * @return true pokud ano
+ */
+bool protocol_wants_binary(const ParsedMessage *parsed);
+
 /**
  * Prevede typ zpravy na retezec
  * @param type Typ zpravy
@@ -130,16 +222,33 @@ const char* protocol_message_type_to_string(MessageType type);
  */
 MessageType protocol_string_to_message_type(const char *str);
 
+/*
+ * Funkce protocol_create_* skladaji zpravu bez snprintf (konstantni zpravy
+ * a chybove odpovedi s vychozim textem jsou predpripravene) a vraci jeji
+ * delku vcetne \n - zprava se tak posila bez strlen(). Pri malem bufferu
+ * se zprava zkrati.
+ */
+
 /**
  * Vytvori zpravu LOGIN_OK
  */
-int protocol_create_login_ok(char *buffer, int size);
+int protocol_create_login_ok(char *buffer, int size, const char *token);
 
 /**
  * Vytvori zpravu LOGIN_ERR
  */
 int protocol_create_login_err(char *buffer, int size, ErrorCode code, const char *reason);
 
+/**
+ * Vytvori zpravu RESUME_OK
+ */
+int protocol_create_resume_ok(char *buffer, int size, const char *nickname);
+
+/**
+ * Vytvori zpravu RESUME_ERR
+ */
+int protocol_create_resume_err(char *buffer, int size, ErrorCode code, const char *reason);
+
 /**
  * Vytvori zpravu ROOMS
  */
@@ -167,13 +276,17 @@ int protocol_create_leave_ok(char *buffer, int size);
 
 /**
  * Vytvori zpravu GAME_START
+ * @param players Prezdivky vsech hracu v poradi tahu (seznam oddeleny carkou)
+ * Posledni pole je cas na tah z pravidel (sekundy, 0 = bez hodin).
  */
-int protocol_create_game_start(char *buffer, int size, int stones, bool your_turn, const char *opponent);
+int protocol_create_game_start(char *buffer, int size, int stones, bool your_turn, const char *opponent,
+                               const GameRules *rules, const int *piles, const char *players);
 
 /**
  * Vytvori zpravu TAKE_OK
+ * @param clock_ms Zbyvajici cas hrace na tahu (ms, 0 = bez hodin)
  */
-int protocol_create_take_ok(char *buffer, int size, int remaining, bool your_turn);
+int protocol_create_take_ok(char *buffer, int size, int remaining, bool your_turn, int clock_ms);
 
 /**
  * Vytvori zpravu TAKE_ERR
@@ -182,8 +295,9 @@ int protocol_create_take_err(char *buffer, int size, ErrorCode code, const char
 
 /**
  * Vytvori zpravu SKIP_OK
+ * @param clock_ms Zbyvajici cas hrace na tahu (ms, 0 = bez hodin)
  */
-int protocol_create_skip_ok(char *buffer, int size, bool your_turn);
+int protocol_create_skip_ok(char *buffer, int size, bool your_turn, int clock_ms);
 
 /**
  * Vytvori zpravu SKIP_ERR
@@ -192,14 +306,26 @@ int protocol_create_skip_err(char *buffer, int size, ErrorCode code, const char
 
 /**
  * Vytvori zpravu OPPONENT_ACTION
+ * Zprava je stejna pro vsechny ostatni hrace mistnosti - nese autora tahu
+ * i hrace, ktery je na tahu po nem.
+ * @param actor Prezdivka hrace, ktery tahl
+ * @param next Prezdivka hrace na tahu
+ * @param clock_ms Zbyvajici cas hrace na tahu (ms, 0 = bez hodin)
  */
-int protocol_create_opponent_action(char *buffer, int size, const char *action, int param, int remaining);
+int protocol_create_opponent_action(char *buffer, int size, const char *action, int param,
+                                    int remaining, int pile, const char *actor, const char *next,
+                                    int clock_ms);
 
 /**
  * Vytvori zpravu GAME_OVER
  */
 int protocol_create_game_over(char *buffer, int size, const char *winner, const char *loser);
 
+/**
+ * Vytvori zpravu PING (server overuje, ze klient zije)
+ */
+int protocol_create_ping(char *buffer, int size);
+
 /**
  * Vytvori zpravu PONG
  */
@@ -227,9 +353,121 @@ int protocol_create_wait_opponent(char *buffer, int size);
 
 /**
  * Vytvori zpravu GAME_RESUMED
+ * @param clock_ms Zbyvajici cas hrace na tahu (ms, 0 = bez hodin)
  */
 int protocol_create_game_resumed(char *buffer, int size, int stones, bool your_turn, 
-                                  int your_skips, int opponent_skips);
+                                  int your_skips, int opponent_skips, const GameRules *rules,
+                                  const int *piles, const char *players, int clock_ms);
+
+/**
+ * Vytvori zpravu HINT_OK
+ */
+int protocol_create_hint_ok(char *buffer, int size, int pile, int count, bool winning);
+
+/**
+ * Vytvori zpravu HINT_ERR
+ */
+int protocol_create_hint_err(char *buffer, int size, ErrorCode code, const char *reason);
+
+/**
+ * Vytvori zpravu WATCH_OK - stav sledovane hry (i pri resynchronizaci divaka)
+ * @param current Prezdivka hrace na tahu (prazdna, pokud hra nebezi)
+ * @param players Prezdivky hracu v poradi tahu (seznam oddeleny carkou)
+ * @param clock_ms Zbyvajici cas hrace na tahu (ms, 0 = bez hodin)
+ */
+int protocol_create_watch_ok(char *buffer, int size, int room_id, GameState state, int stones,
+                             const char *current, const GameRules *rules, const int *piles,
+                             const char *players, int clock_ms);
+
+/**
+ * Vytvori zpravu WATCH_ERR
+ */
+int protocol_create_watch_err(char *buffer, int size, ErrorCode code, const char *reason);
+
+/**
+ * Vytvori zpravu UNWATCH_OK
+ */
+int protocol_create_unwatch_ok(char *buffer, int size);
+
+/**
+ * Vytvori zpravu TOURNAMENT_OPEN (oznameni noveho turnaje do lobby)
+ */
+int protocol_create_tournament_open(char *buffer, int size, const char *name,
+                                    const char *organizer);
+
+/**
+ * Vytvori zpravu TOURNAMENT_OK (potvrzeni registrace)
+ * @param entrants Pocet registrovanych ucastniku
+ */
+int protocol_create_tournament_ok(char *buffer, int size, const char *name, int entrants);
+
+/**
+ * Vytvori zpravu TOURNAMENT_ERR
+ */
+int protocol_create_tournament_err(char *buffer, int size, ErrorCode code, const char *reason);
+
+/**
+ * Vytvori zpravu TOURNAMENT_LEFT
+ */
+int protocol_create_tournament_left(char *buffer, int size);
+
+/**
+ * Vytvori zpravu TOURNAMENT_MATCH (zapas kola, hned za ni prijde GAME_START)
+ */
+int protocol_create_tournament_match(char *buffer, int size, int round, int room_id,
+                                     const char *opponent);
+
+/**
+ * Vytvori zpravu TOURNAMENT_ADVANCE (postup z kola vyhrou nebo volnym losem)
+ */
+int protocol_create_tournament_advance(char *buffer, int size, int round);
+
+/**
+ * Vytvori zpravu TOURNAMENT_OVER
+ * @param winner Vitez turnaje (prazdny = turnaj zrusen)
+ */
+int protocol_create_tournament_over(char *buffer, int size, const char *name,
+                                    const char *winner);
+
+/**
+ * Vytvori zpravu LEADERBOARD_OK
+ * @param entries Retezec zebricku z ratings_leaderboard_to_string
+ */
+int protocol_create_leaderboard_ok(char *buffer, int size, const char *entries);
+
+/**
+ * Vytvori zpravu QUICK_MATCH_WAIT (hrac je ve fronte)
+ */
+int protocol_create_quick_match_wait(char *buffer, int size, int rating);
+
+/**
+ * Vytvori zpravu QUICK_MATCH_FOUND (hned za ni prijde GAME_START)
+ */
+int protocol_create_quick_match_found(char *buffer, int size, int room_id,
+                                      const char *opponent, int opponent_rating);
+
+/**
+ * Vytvori zpravu QUICK_MATCH_CANCELLED
+ */
+int protocol_create_quick_match_cancelled(char *buffer, int size);
+
+/**
+ * Vytvori zpravu QUICK_MATCH_ERR
+ */
+int protocol_create_quick_match_err(char *buffer, int size, ErrorCode code, const char *reason);
+
+/**
+ * Nacte pravidla mistnosti z parametru key=value (CREATE_ROOM)
+ * Klice: preset (nazev varianty), stones, min, max, skips, piles (seznam
+ * velikosti hromadek, nelze kombinovat se stones/min/max/skips), players
+ * a clock (cas na tah v sekundach); vychozi je klasicka varianta, dalsi klice
+ * ji prepisuji.
+ * @param msg Zprava
+ * @param first Index prvniho parametru s pravidlem
+ * @param rules Vystup
+ * @return ERR_NONE nebo ERR_INVALID_RULES
+ */
+ErrorCode protocol_parse_rules(const ParsedMessage *msg, int first, GameRules *rules);
 
 /**
  * Prevede chybovy kod na textovy popis
@@ -0,0 +1,349 @@
+/**
+ * @file ratings.c
+ * @brief Implementace trvaleho hodnoceni hracu
+ *
+ * Zaznamy se nikdy nemazou, takze sondovani nepotrebuje nahrobky - hledani
+ * konci na prvnim volnem zaznamu. Plna tabulka nove hrace nehodnoti.
+ */
+
+#include "ratings.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+/**
+ * FNV-1a hash prezdivky
+ */
+static uint32_t hash_nickname(const char *nickname) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)nickname; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t map_size_for(uint32_t capacity) {
+    return sizeof(RatingsHeader) + (size_t)capacity * sizeof(RatingEntry);
+}
+
+/**
+ * Zamkne soubor pro zapis (fcntl) - soubor smi mapovat jen jeden server
+ * @param wait_ms Jak dlouho cekat, nez zamek pusti predchozi proces (0 = necekat)
+ * @return PID drzitele zamku, 0 pri uspechu, -1 pri chybe
+ */
+static pid_t lock_file(int fd, int wait_ms) {
+    struct flock lock;
+    struct timespec pause = { 0, 10 * 1000000L };
+
+    for (int waited = 0;; waited += 10) {
+        memset(&lock, 0, sizeof(lock));
+        lock.l_type = F_WRLCK;
+        lock.l_whence = SEEK_SET;
+        if (fcntl(fd, F_SETLK, &lock) == 0) return 0;
+        if (errno == EINTR) continue;
+        if (errno != EACCES && errno != EAGAIN) return -1;
+        if (waited >= wait_ms) break;
+        nanosleep(&pause, NULL);
+    }
+
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    if (fcntl(fd, F_GETLK, &lock) == 0 && lock.l_type != F_UNLCK) {
+        return lock.l_pid;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * Najde zaznam hrace, pripadne volny zaznam, kam patri
+ * @return Index zaznamu nebo -1 (hrac neni a tabulka je plna)
+ */
+static int find_slot(const RatingStore *store, const char *nickname) {
+    uint32_t index = hash_nickname(nickname) & store->mask;
+
+    for (uint32_t probe = 0; probe <= store->mask; probe++) {
+        const RatingEntry *entry = &store->entries[index];
+        if (entry->nickname[0] == '\0' || strcmp(entry->nickname, nickname) == 0) {
+            return (int)index;
+        }
+        index = (index + 1) & store->mask;
+    }
+    return -1;
+}
+
+/**
+ * Vrati zaznam hrace, novy hrac dostane pocatecni ELO
+ */
+static RatingEntry* get_or_create(RatingStore *store, const char *nickname) {
+    int index = find_slot(store, nickname);
+
+    /* Nechavame volny aspon jeden zaznam, aby hledani vzdy skoncilo */
+    if (index < 0 || (store->entries[index].nickname[0] == '\0' &&
+                      store->header->count >= store->mask)) {
+        if (!store->full_warned) {
+            LOG_WARNING("Ratings: table full (%u players), new players are not rated",
+                        store->header->count);
+            store->full_warned = true;
+        }
+        return NULL;
+    }
+
+    RatingEntry *entry = &store->entries[index];
+    if (entry->nickname[0] == '\0') {
+        entry->rating = RATING_INITIAL;
+        entry->wins = 0;
+        entry->losses = 0;
+        strncpy(entry->nickname, nickname, MAX_NICKNAME_LENGTH);
+        entry->nickname[MAX_NICKNAME_LENGTH] = '\0';
+        store->header->count++;
+    }
+    return entry;
+}
+
+/**
+ * Poradi v zebricku: vyssi ELO, pak vic vyher, pak abecedne
+ */
+static bool ranks_above(const RatingStore *store, int a, int b) {
+    const RatingEntry *ea = &store->entries[a];
+    const RatingEntry *eb = &store->entries[b];
+    if (ea->rating != eb->rating) return ea->rating > eb->rating;
+    if (ea->wins != eb->wins) return ea->wins > eb->wins;
+    return strcmp(ea->nickname, eb->nickname) < 0;
+}
+
+/**
+ * Zaradi zaznam (ktery v zebricku neni) na jeho misto, pokud se tam vejde
+ * @return Pozice v zebricku nebo -1
+ */
+static int top_offer(RatingStore *store, int index) {
+    int pos = store->top_count;
+    if (pos == LEADERBOARD_SIZE) {
+        if (!ranks_above(store, index, store->top[pos - 1])) return -1;
+        pos--;
+    } else {
+        store->top_count++;
+    }
+
+    while (pos > 0 && ranks_above(store, index, store->top[pos - 1])) {
+        store->top[pos] = store->top[pos - 1];
+        pos--;
+    }
+    store->top[pos] = index;
+    return pos;
+}
+
+/**
+ * Sestavi zebricek pruchodem cele tabulky
+ */
+static void top_rebuild(RatingStore *store) {
+    store->top_count = 0;
+    for (uint32_t i = 0; i <= store->mask; i++) {
+        if (store->entries[i].nickname[0] != '\0') {
+            top_offer(store, (int)i);
+        }
+    }
+}
+
+/**
+ * Aktualizuje zebricek po zmene hodnoceni jednoho zaznamu
+ * @param dropped Hodnoceni kleslo
+ */
+static void top_update(RatingStore *store, int index, bool dropped) {
+    bool member = false;
+    for (int i = 0; i < store->top_count; i++) {
+        if (store->top[i] == index) {
+            memmove(&store->top[i], &store->top[i + 1],
+                    (size_t)(store->top_count - i - 1) * sizeof(int));
+            store->top_count--;
+            member = true;
+            break;
+        }
+    }
+
+    int pos = top_offer(store, index);
+
+    /* Clen, ktery klesl na posledni misto, mohl prepustit misto nekomu
+     * mimo zebricek - jen tehdy je potreba projit celou tabulku */
+    if (member && dropped && pos == store->top_count - 1 &&
+        store->header->count > (uint32_t)store->top_count) {
+        top_rebuild(store);
+    }
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool ratings_open(RatingStore *store, const char *path, int wait_ms) {
+    memset(store, 0, sizeof(RatingStore));
+    store->fd = -1;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Ratings: cannot open '%s': %s", path, strerror(errno));
+        return false;
+    }
+
+    /* Dva servery nad jednim souborem by si prepisovaly zaznamy (a novy
+     * soubor by druhemu zkratil pod rukama) - zamek drzi az do zavreni */
+    pid_t holder = lock_file(fd, wait_ms);
+    if (holder != 0) {
+        if (holder > 0) {
+            LOG_ERROR("Ratings: '%s' is used by another server (pid %d)", path, (int)holder);
+        } else {
+            LOG_ERROR("Ratings: cannot lock '%s': %s", path, strerror(errno));
+        }
+        close(fd);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        LOG_ERROR("Ratings: fstat failed: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    /* Existujici soubor si nese vlastni kapacitu */
+    RatingsHeader existing;
+    uint32_t capacity = RATINGS_CAPACITY;
+    bool fresh = true;
+    if ((size_t)st.st_size >= sizeof(RatingsHeader) &&
+        pread(fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing) &&
+        existing.magic == RATINGS_MAGIC && existing.version == RATINGS_VERSION &&
+        existing.capacity > 1 && (existing.capacity & (existing.capacity - 1)) == 0 &&
+        (size_t)st.st_size >= map_size_for(existing.capacity)) {
+        capacity = existing.capacity;
+        fresh = false;
+    }
+
+    size_t size = map_size_for(capacity);
+    if (fresh && ftruncate(fd, 0) < 0) {
+        LOG_ERROR("Ratings: ftruncate '%s' failed: %s", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    if (fresh && ftruncate(fd, (off_t)size) < 0) {
+        LOG_ERROR("Ratings: ftruncate '%s' failed: %s", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Ratings: mmap '%s' failed: %s", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    store->fd = fd;
+    store->map = map;
+    store->map_size = size;
+    store->header = (RatingsHeader *)map;
+    store->entries = (RatingEntry *)((char *)map + sizeof(RatingsHeader));
+    store->mask = capacity - 1;
+
+    if (fresh) {
+        store->header->magic = RATINGS_MAGIC;
+        store->header->version = RATINGS_VERSION;
+        store->header->capacity = capacity;
+        store->header->count = 0;
+    }
+
+    top_rebuild(store);
+    LOG_INFO("Ratings file '%s' (%u players, capacity %u)", path,
+             store->header->count, capacity);
+    return true;
+}
+
+void ratings_close(RatingStore *store) {
+    if (store->map != NULL) {
+        msync(store->map, store->map_size, MS_ASYNC);
+        munmap(store->map, store->map_size);
+    }
+    if (store->fd >= 0) {
+        close(store->fd);
+    }
+    store->map = NULL;
+    store->header = NULL;
+    store->entries = NULL;
+    store->fd = -1;
+    store->top_count = 0;
+}
+
+const RatingEntry* ratings_get(const RatingStore *store, const char *nickname) {
+    if (store->map == NULL || nickname == NULL || nickname[0] == '\0') return NULL;
+
+    int index = find_slot(store, nickname);
+    if (index < 0 || store->entries[index].nickname[0] == '\0') return NULL;
+    return &store->entries[index];
+}
+
+void ratings_record_game(RatingStore *store, const char *winner, const char *loser) {
+    if (store->map == NULL) return;
+
+    RatingEntry *w = get_or_create(store, winner);
+    RatingEntry *l = get_or_create(store, loser);
+    if (w == NULL || l == NULL) return;
+
+    /* ELO: vitez ziska tolik, kolik vysledek prekonal ocekavani */
+    double expected = 1.0 / (1.0 + pow(10.0, (l->rating - w->rating) / 400.0));
+    int delta = (int)lround(RATING_K_FACTOR * (1.0 - expected));
+    if (delta < 1) delta = 1;
+
+    /* Zebricek se aktualizuje po kazde zmene, aby byl pri zarazovani serazeny */
+    w->rating += delta;
+    w->wins++;
+    top_update(store, (int)(w - store->entries), false);
+    l->rating -= delta;
+    l->losses++;
+    top_update(store, (int)(l - store->entries), true);
+
+    LOG_DEBUG("Ratings: '%s' %d (+%d), '%s' %d (-%d)",
+              w->nickname, w->rating, delta, l->nickname, l->rating, delta);
+}
+
+int ratings_top_entries(const RatingStore *store, RatingEntry *entries, int max) {
+    int count = store->top_count < max ? store->top_count : max;
+    for (int i = 0; i < count; i++) {
+        entries[i] = store->entries[store->top[i]];
+    }
+    return count < 0 ? 0 : count;
+}
+
+int ratings_entries_to_string(const RatingEntry *entries, int available, int count,
+                              char *buffer, int size) {
+    if (buffer == NULL || size <= 0) return 0;
+
+    if (count > available) count = available;
+    if (count < 0) count = 0;
+
+    int written = snprintf(buffer, size, "%d", count);
+    for (int i = 0; i < count && written < size - 1; i++) {
+        written += snprintf(buffer + written, size - written, ";%s,%d,%u,%u",
+                            entries[i].nickname, entries[i].rating,
+                            entries[i].wins, entries[i].losses);
+    }
+    return written;
+}
+
+int ratings_leaderboard_to_string(const RatingStore *store, int count, char *buffer, int size) {
+    RatingEntry top[LEADERBOARD_SIZE];
+    int available = ratings_top_entries(store, top, LEADERBOARD_SIZE);
+    return ratings_entries_to_string(top, available, count, buffer, size);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file ratings.h
+ * @brief Trvale hodnoceni hracu (ELO) a zebricek
+ *
+ * Hodnoceni je tabulka s otevrenym adresovanim (linearni sondovani podle
+ * hashe prezdivky) primo v pametove mapovanem souboru - zmena po hre je
+ * jen zapis do mapovani a data preziji pad i upgrade procesu. Zebricek
+ * nejlepsich LEADERBOARD_SIZE hracu se udrzuje serazeny pri kazde zmene,
+ * LEADERBOARD tak nic netridi.
+ */
+
+#ifndef RATINGS_H
+#define RATINGS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/config.h"
+
+/* ============================================
+ * FORMAT SOUBORU
+ * ============================================ */
+
+#define RATINGS_MAGIC   0x524D494Eu    /* "NIMR" */
+#define RATINGS_VERSION 1
+
+/** Hlavicka souboru */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;              /* Pocet zaznamu (mocnina 2) */
+    uint32_t count;                 /* Obsazene zaznamy */
+} RatingsHeader;
+
+/** Zaznam hrace; prazdna prezdivka = volny zaznam */
+typedef struct {
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    char padding[3];
+    int32_t rating;                 /* ELO */
+    uint32_t wins;
+    uint32_t losses;
+} RatingEntry;
+
+/* ============================================
+ * STRUKTURA HODNOCENI
+ * ============================================ */
+
+typedef struct {
+    int fd;                         /* Soubor s hodnocenim (-1 = vypnuto) */
+    void *map;                      /* Namapovany soubor */
+    size_t map_size;
+    RatingsHeader *header;
+    RatingEntry *entries;
+    uint32_t mask;                  /* capacity - 1 */
+    int top[LEADERBOARD_SIZE];      /* Indexy nejlepsich zaznamu, serazene sestupne */
+    int top_count;
+    bool full_warned;               /* Plna tabulka uz byla zalogovana */
+} RatingStore;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Otevre (pripadne vytvori) soubor s hodnocenim a sestavi zebricek
+ * Soubor se zamkne pro tento proces; drzi-li ho jiny server, selze.
+ * @param store Hodnoceni
+ * @param path Cesta k souboru
+ * @param wait_ms Jak dlouho cekat na zamek (upgrade: predchozi proces
+ *                ho pusti az pri ukonceni; 0 = necekat)
+ * @return true pri uspechu
+ */
+bool ratings_open(RatingStore *store, const char *path, int wait_ms);
+
+/**
+ * Zavre soubor s hodnocenim
+ * @param store Hodnoceni
+ */
+void ratings_close(RatingStore *store);
+
+/**
+ * Vrati zaznam hrace
+ * @param store Hodnoceni
+ * @param nickname Prezdivka
+ * @return Zaznam nebo NULL, pokud hrac jeste nehral
+ */
+const RatingEntry* ratings_get(const RatingStore *store, const char *nickname);
+
+/**
+ * Zapocita vysledek hry obema hracum (ELO) a aktualizuje zebricek
+ * @param store Hodnoceni
+ * @param winner Prezdivka viteze
+ * @param loser Prezdivka porazeneho
+ */
+void ratings_record_game(RatingStore *store, const char *winner, const char *loser);
+
+/**
+ * Vytvori retezec zebricku pro LEADERBOARD
+ * Format: "count;nick,rating,wins,losses;..."
+ * @param store Hodnoceni
+ * @param count Pocet mist (nejvys LEADERBOARD_SIZE)
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Pocet zapsanych znaku
+ */
+int ratings_leaderboard_to_string(const RatingStore *store, int count, char *buffer, int size);
+
+/**
+ * Zkopiruje nejlepsi zaznamy zebricku (shard je zverejnuje ostatnim)
+ * @param store Hodnoceni
+ * @param entries Vystupni pole
+ * @param max Kapacita pole
+ * @return Pocet zkopirovanych zaznamu
+ */
+int ratings_top_entries(const RatingStore *store, RatingEntry *entries, int max);
+
+/**
+ * Vytvori retezec zebricku z pole serazenych zaznamu (format jako LEADERBOARD)
+ * @param entries Zaznamy serazene sestupne
+ * @param available Pocet zaznamu v poli
+ * @param count Pocet mist
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Pocet zapsanych znaku
+ */
+int ratings_entries_to_string(const RatingEntry *entries, int available, int count,
+                              char *buffer, int size);
+
+#endif /* RATINGS_H */
@@ -0,0 +1,238 @@
+/**
+ * @file registry.c
+ * @brief Implementace registru lobby federace (spolecna cast nad backendy)
+ *
+ * Zmenene mistnosti hlasi room.c (room_changes). Na konci iterace se
+ * nahromadene zmeny prevedou na zaznamy registru a zverejni jednou davkou.
+ * Mistnosti ostatnich uzlu se drzi v lokalni kopii, kterou LIST_ROOMS
+ * obnovi jen u uzlu se zmenenou verzi.
+ */
+
+#include "registry.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Zname backendy (podle predpony umisteni) */
+static const RegistryBackend *const g_backends[] = {
+    &registry_file_backend
+};
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+/**
+ * Vybere backend podle predpony "scheme:" - bez predpony je umisteni soubor
+ */
+static const RegistryBackend* select_backend(const char *location, const char **rest) {
+    for (size_t i = 0; i < sizeof(g_backends) / sizeof(g_backends[0]); i++) {
+        size_t len = strlen(g_backends[i]->scheme);
+        if (strncmp(location, g_backends[i]->scheme, len) == 0 && location[len] == ':') {
+            *rest = location + len + 1;
+            return g_backends[i];
+        }
+    }
+    *rest = location;
+    return &registry_file_backend;
+}
+
+static void to_registry_room(const Room *room, RegistryRoom *out) {
+    memset(out, 0, sizeof(RegistryRoom));
+    if (!room->is_active) return;
+
+    out->id = room->id;
+    out->player_count = room->player_count;
+    out->capacity = room->game.rules.player_count;
+    memcpy(out->name, room->name, sizeof(out->name));
+}
+
+static RegistryRoom* node_rooms(const Registry *registry, int node) {
+    return registry->rooms + (size_t)node * REGISTRY_NODE_ROOMS;
+}
+
+/**
+ * Obnovi kopii ostatnich uzlu - kopiruji se jen uzly s novou verzi
+ */
+static void refresh(Registry *registry) {
+    for (int n = 0; n < REGISTRY_MAX_NODES; n++) {
+        if (n == registry->node) continue;
+
+        int count = registry->backend->fetch(registry->state, n, &registry->versions[n],
+                                             node_rooms(registry, n), REGISTRY_NODE_ROOMS,
+                                             registry->addresses[n],
+                                             sizeof(registry->addresses[n]));
+        if (count == -2) {
+            registry->counts[n] = -1;
+            registry->versions[n] = 0;
+        } else if (count >= 0) {
+            registry->counts[n] = count;
+        }
+    }
+}
+
+static int format_room(char *buffer, int size, int id, const char *name,
+                       int player_count, int capacity) {
+    return snprintf(buffer, size, ";%d,%s,%d,%d", id, name, player_count, capacity);
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool registry_open(Registry *registry, const char *location, const char *address, int port,
+                   int max_rooms) {
+    memset(registry, 0, sizeof(Registry));
+
+    const char *rest;
+    const RegistryBackend *backend = select_backend(location, &rest);
+
+    registry->change_slots = malloc(sizeof(int) * (size_t)max_rooms);
+    registry->change_rooms = malloc(sizeof(RegistryRoom) * (size_t)max_rooms);
+    registry->rooms = malloc(sizeof(RegistryRoom) * REGISTRY_MAX_NODES * REGISTRY_NODE_ROOMS);
+    if (registry->change_slots == NULL || registry->change_rooms == NULL ||
+        registry->rooms == NULL || !room_track_changes(max_rooms)) {
+        LOG_ERROR("Registry: out of memory");
+        registry_close(registry, false);
+        return false;
+    }
+
+    registry->node = backend->attach(&registry->state, rest, address, port);
+    if (registry->node < 0) {
+        registry_close(registry, false);
+        return false;
+    }
+
+    registry->backend = backend;
+    registry->max_rooms = max_rooms;
+    for (int n = 0; n < REGISTRY_MAX_NODES; n++) {
+        registry->counts[n] = -1;
+    }
+
+    LOG_INFO("Registry %s:%s - node %d (room IDs %d-%d)", backend->scheme, rest,
+             registry->node, registry->node * REGISTRY_NODE_ROOMS,
+             registry->node * REGISTRY_NODE_ROOMS + max_rooms - 1);
+    return true;
+}
+
+void registry_publish_all(Registry *registry, Room *rooms) {
+    if (registry->backend == NULL) return;
+
+    /* Prevzate mistnosti mohou nest priznak zmeny z predchoziho procesu */
+    room_clear_changes();
+    for (int i = 0; i < registry->max_rooms; i++) {
+        rooms[i].change_pending = false;
+        registry->change_slots[i] = i;
+        to_registry_room(&rooms[i], &registry->change_rooms[i]);
+    }
+
+    if (!registry->backend->publish(registry->state, registry->change_slots,
+                                    registry->change_rooms, registry->max_rooms)) {
+        LOG_WARNING("Registry: node %d was taken over by another process", registry->node);
+    }
+    registry->last_heartbeat = time(NULL);
+}
+
+void registry_tick(Registry *registry, const Room *rooms, int64_t now_ms, time_t now) {
+    if (registry->backend == NULL) return;
+
+    int count;
+    Room **changes = room_changes(&count);
+
+    if (count > 0 && now_ms - registry->last_publish_ms >= REGISTRY_PUBLISH_INTERVAL_MS) {
+        for (int i = 0; i < count; i++) {
+            registry->change_slots[i] = (int)(changes[i] - rooms);
+            to_registry_room(changes[i], &registry->change_rooms[i]);
+        }
+        room_clear_changes();
+    } else if (now - registry->last_heartbeat >= REGISTRY_HEARTBEAT_INTERVAL) {
+        count = 0;
+    } else {
+        return;
+    }
+
+    if (!registry->backend->publish(registry->state, registry->change_slots,
+                                    registry->change_rooms, count) && !registry->lost) {
+        LOG_INFO("Registry: node %d was taken over by another process", registry->node);
+        registry->lost = true;
+    }
+    if (count > 0) {
+        registry->last_publish_ms = now_ms;
+    }
+    registry->last_heartbeat = now;
+}
+
+int registry_room_list_to_string(Registry *registry, const Room *rooms, char *buffer, int size) {
+    if (buffer == NULL || size <= 0) return 0;
+
+    refresh(registry);
+
+    /* Zaznamy se skladaji za sebe, celkovy pocet jde az na zacatek */
+    char entries[BUFFER_SIZE];
+    int entries_size = size < (int)sizeof(entries) ? size : (int)sizeof(entries);
+    int written = 0;
+    int total = 0;
+
+    for (int i = 0; i < registry->max_rooms; i++) {
+        if (!rooms[i].is_active) continue;
+        total++;
+        if (written < entries_size - 1) {
+            written += format_room(entries + written, entries_size - written,
+                                   rooms[i].id, rooms[i].name, rooms[i].player_count,
+                                   rooms[i].game.rules.player_count);
+        }
+    }
+
+    for (int n = 0; n < REGISTRY_MAX_NODES; n++) {
+        if (n == registry->node) continue;
+
+        const RegistryRoom *remote = node_rooms(registry, n);
+        for (int i = 0; i < registry->counts[n]; i++) {
+            total++;
+            if (written < entries_size - 1) {
+                written += format_room(entries + written, entries_size - written,
+                                       remote[i].id, remote[i].name,
+                                       remote[i].player_count, remote[i].capacity);
+            }
+        }
+    }
+
+    if (written > entries_size - 1) written = entries_size - 1;
+    entries[written] = '\0';
+    return snprintf(buffer, size, "%d%s", total, entries);
+}
+
+bool registry_find_room(Registry *registry, int room_id, char *address, int size) {
+    if (registry->backend == NULL || room_id < 0) return false;
+
+    int node = room_id / REGISTRY_NODE_ROOMS;
+    if (node >= REGISTRY_MAX_NODES || node == registry->node) return false;
+
+    refresh(registry);
+
+    const RegistryRoom *remote = node_rooms(registry, node);
+    for (int i = 0; i < registry->counts[node]; i++) {
+        if (remote[i].id == room_id) {
+            snprintf(address, size, "%s", registry->addresses[node]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void registry_close(Registry *registry, bool release) {
+    if (registry->backend != NULL) {
+        registry->backend->detach(registry->state, release);
+    }
+    room_stop_tracking();
+    free(registry->change_slots);
+    free(registry->change_rooms);
+    free(registry->rooms);
+    registry->change_slots = NULL;
+    registry->change_rooms = NULL;
+    registry->rooms = NULL;
+    registry->backend = NULL;
+    registry->state = NULL;
+}
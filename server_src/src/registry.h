@@ -0,0 +1,174 @@
+/**
+ * @file registry.h
+ * @brief Registr lobby federace - mistnosti vice samostatnych serveru
+ *
+ * S --registry se server prihlasi do registru jako uzel a zverejnuje v nem
+ * kratky prehled svych mistnosti (ID, nazev, obsazenost). LIST_ROOMS pak
+ * vraci mistnosti vsech uzlu. Uzel i vlastni ID mistnosti
+ * i * REGISTRY_NODE_ROOMS .. a mistnost jineho uzlu se hledani nepripoji -
+ * klient dostane adresu uzlu, ktery ji hostuje.
+ *
+ * Zverejnuji se jen zmenene mistnosti (seznam zmen z room.c) v davkach
+ * nejvys jednou za REGISTRY_PUBLISH_INTERVAL_MS. Kazda davka zvysi verzi
+ * uzlu; ctenar kopiruje jen uzly, jejichz verze se zmenila.
+ *
+ * Ulozeni registru zajistuje backend (RegistryBackend). Prvni je lokalni
+ * soubor mapovany do pameti - stand-in pro sdileny registr, dokud servery
+ * bezi na jednom stroji.
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "room.h"
+#include "../include/config.h"
+
+/* ============================================
+ * ZAZNAMY A BACKEND
+ * ============================================ */
+
+/** Prehled jedne mistnosti v registru */
+typedef struct {
+    int32_t id;
+    int32_t player_count;
+    int32_t capacity;                       /* 0 = volny slot */
+    char name[MAX_ROOM_NAME_LENGTH + 1];
+} RegistryRoom;
+
+/**
+ * Operace backendu registru
+ * Vsechny operace pracuji se stavem backendu (state) vraceny z attach.
+ */
+typedef struct {
+    const char *scheme;                     /* Predpona umisteni ("file") */
+
+    /**
+     * Pripoji se k registru a zabere uzel
+     * @param state Vystup - stav backendu
+     * @param location Umisteni registru (bez predpony)
+     * @param address Adresa, na ktere uzel prijima klienty
+     * @param port Port uzlu
+     * @return Index uzlu nebo -1 pri chybe
+     */
+    int (*attach)(void **state, const char *location, const char *address, int port);
+
+    /**
+     * Zverejni davku zmenenych slotu a obnovi heartbeat uzlu
+     * @param state Stav backendu
+     * @param slots Sloty zmenenych mistnosti
+     * @param rooms Nove hodnoty slotu (capacity 0 = slot uvolnen)
+     * @param count Pocet zmen (0 = jen heartbeat)
+     * @return true pri uspechu
+     */
+    bool (*publish)(void *state, const int *slots, const RegistryRoom *rooms, int count);
+
+    /**
+     * Precte mistnosti uzlu, pokud se od verze *version zmenily
+     * @param state Stav backendu
+     * @param node Index uzlu
+     * @param version Vstup/vystup - naposledy prectena verze
+     * @param rooms Vystup - obsazene sloty uzlu
+     * @param max Kapacita rooms
+     * @param address Vystup - "adresa:port" uzlu
+     * @param size Velikost address
+     * @return Pocet mistnosti, -1 = beze zmeny, -2 = uzel nebezi
+     */
+    int (*fetch)(void *state, int node, uint64_t *version, RegistryRoom *rooms, int max,
+                 char *address, int size);
+
+    /**
+     * Uvolni uzel a odpoji se od registru
+     * @param state Stav backendu
+     * @param release Uvolnit uzel (false = uzel prebira novy proces po upgradu)
+     */
+    void (*detach)(void *state, bool release);
+} RegistryBackend;
+
+/** Backend s registrem v lokalnim souboru (registry_file.c) */
+extern const RegistryBackend registry_file_backend;
+
+/* ============================================
+ * STAV REGISTRU
+ * ============================================ */
+
+typedef struct {
+    const RegistryBackend *backend;         /* NULL = registr vypnut */
+    void *state;                            /* Stav backendu */
+    int node;                               /* Index vlastniho uzlu */
+    int max_rooms;                          /* Sloty mistnosti tohoto serveru */
+    int64_t last_publish_ms;                /* Posledni zverejneni zmen */
+    time_t last_heartbeat;                  /* Posledni obnoveni heartbeatu */
+    bool lost;                              /* Uzel prevzal jiny proces */
+    int *change_slots;                      /* Davka zmen (max_rooms) */
+    RegistryRoom *change_rooms;
+    uint64_t versions[REGISTRY_MAX_NODES];  /* Prectena verze kazdeho uzlu */
+    int counts[REGISTRY_MAX_NODES];         /* Mistnosti uzlu (-1 = nebezi) */
+    char addresses[REGISTRY_MAX_NODES][80]; /* "adresa:port" uzlu */
+    RegistryRoom *rooms;                    /* Kopie mistnosti uzlu (po REGISTRY_NODE_ROOMS) */
+} Registry;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Otevre registr a zabere v nem uzel; zapne sledovani zmen mistnosti
+ * @param registry Registr
+ * @param location Umisteni ("file:CESTA" nebo jen cesta k souboru)
+ * @param address Adresa uzlu pro klienty
+ * @param port Port uzlu
+ * @param max_rooms Sloty mistnosti serveru (nejvys REGISTRY_NODE_ROOMS)
+ * @return true pri uspechu (registry->node je index uzlu)
+ */
+bool registry_open(Registry *registry, const char *location, const char *address, int port,
+                   int max_rooms);
+
+/**
+ * Zverejni vsechny mistnosti (po startu, obnove nebo upgradu)
+ * @param registry Registr
+ * @param rooms Mistnosti serveru
+ */
+void registry_publish_all(Registry *registry, Room *rooms);
+
+/**
+ * Zverejni nahromadene zmeny (nejvys jednou za REGISTRY_PUBLISH_INTERVAL_MS)
+ * a obnovi heartbeat
+ * @param registry Registr
+ * @param rooms Mistnosti serveru (slot zmenene mistnosti = index v poli)
+ * @param now_ms Monotonni cas v ms (timer_now_ms)
+ * @param now Aktualni cas
+ */
+void registry_tick(Registry *registry, const Room *rooms, int64_t now_ms, time_t now);
+
+/**
+ * Vytvori seznam mistnosti vsech uzlu pro LIST_ROOMS (format jako
+ * room_list_to_string); vlastni mistnosti se berou primo z pole
+ * @param registry Registr
+ * @param rooms Mistnosti serveru
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Pocet zapsanych znaku
+ */
+int registry_room_list_to_string(Registry *registry, const Room *rooms, char *buffer, int size);
+
+/**
+ * Najde uzel, ktery hostuje mistnost s danym ID
+ * @param registry Registr
+ * @param room_id ID mistnosti
+ * @param address Vystup - "adresa:port" uzlu
+ * @param size Velikost address
+ * @return true pokud mistnost existuje na jinem uzlu
+ */
+bool registry_find_room(Registry *registry, int room_id, char *address, int size);
+
+/**
+ * Zavre registr
+ * @param registry Registr
+ * @param release Uvolnit uzel (false po predani spojeni novemu procesu)
+ */
+void registry_close(Registry *registry, bool release);
+
+#endif /* REGISTRY_H */
@@ -0,0 +1,301 @@
+/**
+ * @file registry_file.c
+ * @brief Backend registru v lokalnim souboru mapovanem do pameti
+ *
+ * Rozlozeni souboru:
+ *   FileHeader | FileNode[REGISTRY_MAX_NODES]
+ * Uzel ma pevne sloty mistnosti (index = slot mistnosti na serveru), takze
+ * davka zmen prepise jen zmenene sloty. Do uzlu zapisuje jen jeho proces,
+ * zapis je obalen seqlockem jako v shard.c. Zabirani uzlu a zalozeni
+ * souboru chrani zamek souboru (fcntl).
+ *
+ * Uzel je volny, pokud nema proces nebo jeho proces uz nebezi. Ctenar
+ * preskakuje uzly bez heartbeatu dele nez REGISTRY_STALE_TIMEOUT.
+ */
+
+#include "registry.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define REGISTRY_FILE_MAGIC   0x474E494Eu   /* "NING" */
+#define REGISTRY_FILE_VERSION 1
+
+/* ============================================
+ * ROZLOZENI SOUBORU
+ * ============================================ */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t max_nodes;
+    int32_t node_rooms;
+} FileHeader;
+
+typedef struct {
+    uint32_t seq;                           /* Seqlock */
+    int32_t pid;                            /* Proces uzlu (0 = volny) */
+    int64_t heartbeat;                      /* Posledni zivotni znameni (time_t) */
+    uint64_t version;                       /* Zvysi kazda davka zmen */
+    int32_t port;
+    char address[64];
+    RegistryRoom rooms[REGISTRY_NODE_ROOMS];
+} FileNode;
+
+typedef struct {
+    int fd;
+    void *map;
+    size_t map_size;
+    FileNode *nodes;
+    int node;                               /* Vlastni uzel */
+    pid_t previous;                         /* Predchozi proces uzlu pri upgradu (0 = zadny) */
+} FileRegistry;
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static bool lock_file(int fd, short type) {
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lock) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return true;
+}
+
+static void write_begin(FileNode *node) {
+    uint32_t seq = node->seq;
+    __atomic_store_n(&node->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void write_end(FileNode *node) {
+    __atomic_store_n(&node->seq, node->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Bezi proces uzlu? (volny uzel nebo mrtvy proces lze zabrat)
+ */
+static bool node_owned(const FileNode *node) {
+    pid_t pid = __atomic_load_n(&node->pid, __ATOMIC_ACQUIRE);
+    return pid != 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+/**
+ * Vybere uzel - po upgradu uzel predchoziho procesu (rodice), jinak prvni volny
+ * @return Index uzlu nebo -1
+ */
+static int choose_node(const FileRegistry *reg) {
+    pid_t parent = getppid();
+    for (int i = 0; i < REGISTRY_MAX_NODES; i++) {
+        if (reg->nodes[i].pid == parent) return i;
+    }
+    for (int i = 0; i < REGISTRY_MAX_NODES; i++) {
+        if (!node_owned(&reg->nodes[i])) return i;
+    }
+    return -1;
+}
+
+/* ============================================
+ * OPERACE BACKENDU
+ * ============================================ */
+
+static void file_detach(void *state, bool release);
+
+static int file_attach(void **state, const char *location, const char *address, int port) {
+    int fd = open(location, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Registry: cannot open '%s': %s", location, strerror(errno));
+        return -1;
+    }
+
+    /* Soubor zaklada a uzly zabira vzdy jen jeden proces */
+    if (!lock_file(fd, F_WRLCK)) {
+        LOG_ERROR("Registry: cannot lock '%s': %s", location, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    size_t size = sizeof(FileHeader) + sizeof(FileNode) * REGISTRY_MAX_NODES;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        LOG_ERROR("Registry: fstat failed: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    /* Cizi nebo starsi soubor nezkracujeme - mohou ho mit namapovany jine uzly */
+    bool fresh = st.st_size == 0;
+    if (!fresh && (size_t)st.st_size != size) {
+        LOG_ERROR("Registry: '%s' has a different layout", location);
+        close(fd);
+        return -1;
+    }
+    if (fresh && ftruncate(fd, (off_t)size) < 0) {
+        LOG_ERROR("Registry: ftruncate '%s' failed: %s", location, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Registry: mmap '%s' failed: %s", location, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    FileHeader *header = (FileHeader *)map;
+    if (fresh) {
+        header->magic = REGISTRY_FILE_MAGIC;
+        header->version = REGISTRY_FILE_VERSION;
+        header->max_nodes = REGISTRY_MAX_NODES;
+        header->node_rooms = REGISTRY_NODE_ROOMS;
+    } else if (header->magic != REGISTRY_FILE_MAGIC || header->version != REGISTRY_FILE_VERSION ||
+               header->max_nodes != REGISTRY_MAX_NODES ||
+               header->node_rooms != REGISTRY_NODE_ROOMS) {
+        LOG_ERROR("Registry: '%s' is not a registry file", location);
+        munmap(map, size);
+        close(fd);
+        return -1;
+    }
+
+    FileRegistry *reg = malloc(sizeof(FileRegistry));
+    if (reg == NULL) {
+        munmap(map, size);
+        close(fd);
+        return -1;
+    }
+    reg->fd = fd;
+    reg->map = map;
+    reg->map_size = size;
+    reg->nodes = (FileNode *)(header + 1);
+    reg->node = choose_node(reg);
+
+    if (reg->node < 0) {
+        LOG_ERROR("Registry: all %d nodes in '%s' are taken", REGISTRY_MAX_NODES, location);
+        lock_file(fd, F_UNLCK);
+        file_detach(reg, false);
+        return -1;
+    }
+
+    /* Uzel po predchozim procesu si mistnosti necha (upgrade je hned
+     * zverejni znovu), uzel po mrtvem procesu se vyprazdni */
+    FileNode *node = &reg->nodes[reg->node];
+    bool takeover = node->pid == getppid();
+    reg->previous = takeover ? node->pid : 0;
+    if (node->seq & 1u) {
+        node->seq++;            /* Zapis prerusen padem procesu */
+    }
+    write_begin(node);
+    node->pid = getpid();
+    node->heartbeat = time(NULL);
+    node->version++;
+    node->port = port;
+    snprintf(node->address, sizeof(node->address), "%s", address);
+    if (!takeover) {
+        memset(node->rooms, 0, sizeof(node->rooms));
+    }
+    write_end(node);
+
+    lock_file(fd, F_UNLCK);
+    *state = reg;
+    return reg->node;
+}
+
+static bool file_publish(void *state, const int *slots, const RegistryRoom *rooms, int count) {
+    FileRegistry *reg = state;
+    FileNode *node = &reg->nodes[reg->node];
+
+    /* Uzel prevzal novy proces po upgradu */
+    if (__atomic_load_n(&node->pid, __ATOMIC_ACQUIRE) != getpid()) {
+        return false;
+    }
+
+    if (count > 0) {
+        write_begin(node);
+        for (int i = 0; i < count; i++) {
+            node->rooms[slots[i]] = rooms[i];
+        }
+        node->version++;
+        write_end(node);
+    }
+    __atomic_store_n(&node->heartbeat, (int64_t)time(NULL), __ATOMIC_RELAXED);
+    return true;
+}
+
+static int file_fetch(void *state, int index, uint64_t *version, RegistryRoom *rooms, int max,
+                      char *address, int size) {
+    FileRegistry *reg = state;
+    const FileNode *node = &reg->nodes[index];
+
+    if (__atomic_load_n(&node->pid, __ATOMIC_ACQUIRE) == 0 ||
+        time(NULL) - __atomic_load_n(&node->heartbeat, __ATOMIC_RELAXED) > REGISTRY_STALE_TIMEOUT) {
+        return -2;
+    }
+
+    int count;
+    uint64_t seen;
+    uint32_t seq;
+    do {
+        /* Rozepsany uzel (nebo zapis preruseny padem) - zatim plati stara kopie */
+        seq = __atomic_load_n(&node->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1u) return -1;
+
+        seen = node->version;
+        if (seen == *version) return -1;
+
+        count = 0;
+        for (int i = 0; i < REGISTRY_NODE_ROOMS && count < max; i++) {
+            if (node->rooms[i].capacity > 0) {
+                rooms[count++] = node->rooms[i];
+            }
+        }
+        snprintf(address, size, "%.63s:%d", node->address, node->port);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&node->seq, __ATOMIC_RELAXED) != seq);
+
+    *version = seen;
+    return count;
+}
+
+static void file_detach(void *state, bool release) {
+    FileRegistry *reg = state;
+
+    if (release && reg->node >= 0 && lock_file(reg->fd, F_WRLCK)) {
+        FileNode *node = &reg->nodes[reg->node];
+        if (node->pid == getpid() && reg->previous != 0 && kill(reg->previous, 0) == 0) {
+            /* Nepodareny upgrade - uzel i mistnosti dal vede predchozi proces */
+            __atomic_store_n(&node->pid, reg->previous, __ATOMIC_RELEASE);
+        } else if (node->pid == getpid()) {
+            write_begin(node);
+            node->pid = 0;
+            node->version++;
+            memset(node->rooms, 0, sizeof(node->rooms));
+            write_end(node);
+        }
+        lock_file(reg->fd, F_UNLCK);
+    }
+
+    munmap(reg->map, reg->map_size);
+    close(reg->fd);
+    free(reg);
+}
+
+const RegistryBackend registry_file_backend = {
+    .scheme = "file",
+    .attach = file_attach,
+    .publish = file_publish,
+    .fetch = file_fetch,
+    .detach = file_detach
+};
@@ -5,9 +5,24 @@
 
 #include "room.h"
 #include "logger.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/* ============================================
+ * PRIVATNI PROMENNE
+ * ============================================ */
+
+/** ID mistnosti v prvnim slotu (shard vlastni rozsah ID, jinak 0) */
+static int g_first_id = 0;
+
+/** Mistnosti zmenene od posledniho room_clear_changes (NULL = nesleduje se) */
+static Room **g_changes = NULL;
+static int g_change_count = 0;
+
+/** Pocitadlo vsech zmen mistnosti (prehled shardu) */
+static unsigned int g_change_seq = 0;
+
 /* ============================================
  * PRIVATNI FUNKCE
  * ============================================ */
@@ -24,24 +39,86 @@ static int find_free_slot(Room *rooms, int count) {
     return -1;
 }
 
+/**
+ * Zaradi mistnost do seznamu zmen (kazdou nejvys jednou)
+ */
+static void mark_changed(Room *room) {
+    g_change_seq++;
+    if (g_changes == NULL || room->change_pending) return;
+    room->change_pending = true;
+    g_changes[g_change_count++] = room;
+}
+
+/**
+ * Uroven logu udalosti mistnosti - zapasy turnaje se zakladaji a ruseji
+ * hromadne, do logu jde jen souhrn kola
+ */
+static LogLevel log_level(const Room *room) {
+    return room->tournament_round > 0 ? LOG_DEBUG : LOG_INFO;
+}
+
 /* ============================================
  * IMPLEMENTACE VEREJNYCH FUNKCI
  * ============================================ */
 
+void room_set_first_id(int first_id) {
+    g_first_id = first_id;
+}
+
+int room_slot_to_id(int slot) {
+    return g_first_id + slot;
+}
+
+int room_id_to_slot(int id) {
+    return id - g_first_id;
+}
+
+bool room_track_changes(int count) {
+    free(g_changes);
+    g_change_count = 0;
+    g_changes = malloc(sizeof(Room *) * (size_t)count);
+    return g_changes != NULL;
+}
+
+Room** room_changes(int *count) {
+    *count = g_change_count;
+    return g_changes;
+}
+
+unsigned int room_change_seq(void) {
+    return g_change_seq;
+}
+
+void room_clear_changes(void) {
+    for (int i = 0; i < g_change_count; i++) {
+        g_changes[i]->change_pending = false;
+    }
+    g_change_count = 0;
+}
+
+void room_stop_tracking(void) {
+    free(g_changes);
+    g_changes = NULL;
+    g_change_count = 0;
+}
+
 void room_init_all(Room *rooms, int count) {
     for (int i = 0; i < count; i++) {
         memset(&rooms[i], 0, sizeof(Room));
         rooms[i].id = -1;
         rooms[i].is_active = false;
         rooms[i].player_count = 0;
-        for (int j = 0; j < PLAYERS_PER_ROOM; j++) {
+        rooms[i].spectator_head = -1;
+        rooms[i].spectator_count = 0;
+        for (int j = 0; j < ROOM_MAX_PLAYERS; j++) {
             rooms[i].players[j] = NULL;
         }
         game_init(&rooms[i].game);
     }
 }
 
-int room_create(Room *rooms, int count, const char *name, Player *creator) {
+int room_create(Room *rooms, int count, const char *name, Player *creator,
+                const GameRules *rules) {
     if (rooms == NULL || name == NULL || creator == NULL) {
         return -1;
     }
@@ -61,18 +138,10 @@ int room_create(Room *rooms, int count, const char *name, Player *creator) {
     
     /* Inicializace mistnosti */
     Room *room = &rooms[slot];
-    room->id = slot;
-    strncpy(room->name, name, MAX_ROOM_NAME_LENGTH);
-    room->name[MAX_ROOM_NAME_LENGTH] = '\0';
-    room->is_active = true;
-    room->player_count = 0;
-    
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
-        room->players[i] = NULL;
+    if (!room_open(room, slot, name, rules)) {
+        return -1;
     }
     
-    game_init(&room->game);
-    
     /* Pridani tvurce */
     if (!room_add_player(room, creator)) {
         room->is_active = false;
@@ -85,13 +154,43 @@ int room_create(Room *rooms, int count, const char *name, Player *creator) {
     return room->id;
 }
 
+bool room_open(Room *room, int slot, const char *name, const GameRules *rules) {
+    if (room == NULL || name == NULL || room->is_active) {
+        return false;
+    }
+    
+    mark_changed(room);
+    room->id = room_slot_to_id(slot);
+    strncpy(room->name, name, MAX_ROOM_NAME_LENGTH);
+    room->name[MAX_ROOM_NAME_LENGTH] = '\0';
+    room->is_active = true;
+    room->player_count = 0;
+    room->spectator_head = -1;
+    room->spectator_count = 0;
+    room->turn_deadline = 0;
+    room->tournament_round = 0;
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        room->players[i] = NULL;
+    }
+    
+    game_init(&room->game);
+    if (rules != NULL && !game_set_rules(&room->game, rules)) {
+        room->is_active = false;
+        return false;
+    }
+    
+    return true;
+}
+
 Room* room_find_by_id(Room *rooms, int count, int id) {
-    if (rooms == NULL || id < 0 || id >= count) {
+    int slot = room_id_to_slot(id);
+    if (rooms == NULL || slot < 0 || slot >= count) {
         return NULL;
     }
     
-    if (rooms[id].is_active) {
-        return &rooms[id];
+    if (rooms[slot].is_active) {
+        return &rooms[slot];
     }
     
     return NULL;
@@ -121,16 +220,17 @@ bool room_add_player(Room *room, Player *player) {
         return false;
     }
     
-    /* Najdi volny slot */
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    /* Najdi volny slot - poradi tahu je poradi slotu */
+    for (int i = 0; i < room->game.rules.player_count; i++) {
         if (room->players[i] == NULL) {
             room->players[i] = player;
             room->player_count++;
+            mark_changed(room);
             player->room_id = room->id;
-            player->skips_remaining = SKIPS_PER_PLAYER;
+            player->skips_remaining = room->game.rules.skips_per_player;
             
-            LOG_INFO("Player '%s' joined room '%s' (ID: %d)", 
-                     player->nickname, room->name, room->id);
+            logger_log(log_level(room), "Player '%s' joined room '%s' (ID: %d)",
+                       player->nickname, room->name, room->id);
             
             return true;
         }
@@ -144,14 +244,15 @@ bool room_remove_player(Room *room, Player *player) {
         return false;
     }
     
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         if (room->players[i] == player) {
             room->players[i] = NULL;
             room->player_count--;
+            mark_changed(room);
             player->room_id = -1;
             
-            LOG_INFO("Player '%s' left room '%s' (ID: %d)", 
-                     player->nickname, room->name, room->id);
+            logger_log(log_level(room), "Player '%s' left room '%s' (ID: %d)",
+                       player->nickname, room->name, room->id);
             
             /* Pokud je mistnost prazdna, zrus ji */
             if (room_is_empty(room)) {
@@ -170,7 +271,7 @@ int room_get_player_index(Room *room, Player *player) {
         return -1;
     }
     
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         if (room->players[i] == player) {
             return i;
         }
@@ -184,7 +285,7 @@ Player* room_get_opponent(Room *room, Player *player) {
         return NULL;
     }
     
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         if (room->players[i] != NULL && room->players[i] != player) {
             return room->players[i];
         }
@@ -193,8 +294,36 @@ Player* room_get_opponent(Room *room, Player *player) {
     return NULL;
 }
 
+Player* room_get_next_online(Room *room, Player *player) {
+    int index = room_get_player_index(room, player);
+    if (index < 0) return NULL;
+    
+    int count = room->game.rules.player_count;
+    for (int i = 1; i < count; i++) {
+        Player *next = room->players[(index + i) % count];
+        if (player_is_online(next)) {
+            return next;
+        }
+    }
+    
+    return NULL;
+}
+
+bool room_others_online(Room *room, Player *player) {
+    if (room == NULL) return false;
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        Player *other = room->players[i];
+        if (other != NULL && other != player && !player_is_online(other)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 bool room_is_full(Room *room) {
-    return room != NULL && room->player_count >= PLAYERS_PER_ROOM;
+    return room != NULL && room->player_count >= room->game.rules.player_count;
 }
 
 bool room_is_empty(Room *room) {
@@ -204,18 +333,21 @@ bool room_is_empty(Room *room) {
 void room_destroy(Room *room) {
     if (room == NULL) return;
     
-    LOG_INFO("Room '%s' (ID: %d) destroyed", room->name, room->id);
+    logger_log(log_level(room), "Room '%s' (ID: %d) destroyed", room->name, room->id);
     
     /* Vrat hrace do lobby */
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         if (room->players[i] != NULL) {
             room->players[i]->room_id = -1;
             room->players[i] = NULL;
         }
     }
     
+    mark_changed(room);
     room->is_active = false;
     room->player_count = 0;
+    room->turn_deadline = 0;
+    room->tournament_round = 0;
     room->id = -1;
     room->name[0] = '\0';
     game_reset(&room->game);
@@ -250,13 +382,59 @@ int room_list_to_string(Room *rooms, int count, char *buffer, int size) {
                                rooms[i].id,
                                rooms[i].name,
                                rooms[i].player_count,
-                               PLAYERS_PER_ROOM);
+                               rooms[i].game.rules.player_count);
         }
     }
     
     return written;
 }
 
+int room_players_to_string(const Room *room, char *buffer, int size) {
+    if (room == NULL || buffer == NULL || size <= 0) {
+        return 0;
+    }
+    
+    int written = 0;
+    buffer[0] = '\0';
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS && written < size - 1; i++) {
+        if (room->players[i] != NULL) {
+            written += snprintf(buffer + written, size - written, "%s%s",
+                                written > 0 ? "," : "", room->players[i]->nickname);
+        }
+    }
+    
+    return written;
+}
+
+void room_add_spectator(Room *room, Player *players, Player *spectator) {
+    if (room == NULL || players == NULL || spectator == NULL) return;
+    
+    spectator->next_spectator = room->spectator_head;
+    spectator->watch_room_id = room->id;
+    room->spectator_head = (int)(spectator - players);
+    room->spectator_count++;
+}
+
+void room_remove_spectator(Room *room, Player *players, Player *spectator) {
+    if (room == NULL || players == NULL || spectator == NULL) return;
+    
+    int index = (int)(spectator - players);
+    int *link = &room->spectator_head;
+    
+    while (*link >= 0) {
+        if (*link == index) {
+            *link = spectator->next_spectator;
+            room->spectator_count--;
+            break;
+        }
+        link = &players[*link].next_spectator;
+    }
+    
+    spectator->next_spectator = -1;
+    spectator->watch_room_id = -1;
+}
+
 bool room_start_game(Room *room) {
     if (room == NULL) return false;
     
@@ -273,14 +451,19 @@ bool room_start_game(Room *room) {
     game_start(&room->game);
     
     /* Nastav hrace do stavu IN_GAME */
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         if (room->players[i] != NULL) {
             player_set_state(room->players[i], PLAYER_STATE_IN_GAME);
-            room->players[i]->skips_remaining = SKIPS_PER_PLAYER;
+            room->players[i]->skips_remaining = room->game.rules.skips_per_player;
         }
     }
     
-    LOG_INFO("Game started in room '%s' (ID: %d)", room->name, room->id);
+    const GameRules *rules = &room->game.rules;
+    logger_log(log_level(room),
+               "Game started in room '%s' (ID: %d): %d stones in %d piles, %d players "
+               "(take %d-%d, %d skips)", room->name, room->id, room->game.stones,
+               rules->pile_count, rules->player_count, rules->min_take, rules->max_take,
+               rules->skips_per_player);
     
     return true;
 }
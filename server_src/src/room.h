@@ -7,10 +7,14 @@
 #define ROOM_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "game.h"
 #include "player.h"
 #include "../include/config.h"
 
+/** Velikost bufferu pro seznam hracu (room_players_to_string) */
+#define ROOM_PLAYER_LIST_SIZE (ROOM_MAX_PLAYERS * (MAX_NICKNAME_LENGTH + 1))
+
 /* ============================================
  * STRUKTURA MISTNOSTI
  * ============================================ */
@@ -18,16 +22,76 @@
 typedef struct {
     int id;                                     /* ID mistnosti */
     char name[MAX_ROOM_NAME_LENGTH + 1];        /* Nazev mistnosti */
-    Player *players[PLAYERS_PER_ROOM];          /* Ukazatele na hrace */
+    Player *players[ROOM_MAX_PLAYERS];          /* Hraci v poradi tahu (kapacita
+                                                   game.rules.player_count) */
     int player_count;                           /* Pocet hracu */
     Game game;                                  /* Stav hry */
+    int spectator_head;                         /* Prvni divak (index slotu hrace, -1 = zadny) */
+    int spectator_count;                        /* Pocet divaku */
+    int64_t turn_deadline;                      /* Termin tahu (ms monotonnich hodin,
+                                                   0 = hodiny nebezi) */
+    int tournament_round;                       /* Kolo turnaje (0 = bezna mistnost) */
     bool is_active;                             /* Je mistnost aktivni? */
+    bool change_pending;                        /* Ceka v seznamu zmen (registr) */
 } Room;
 
 /* ============================================
  * VEREJNE FUNKCE
  * ============================================ */
 
+/**
+ * Nastavi ID mistnosti v prvnim slotu - shard vlastni souvisly rozsah ID
+ * (ID = first_id + slot), bez shardu je ID rovno slotu
+ * @param first_id ID prvni mistnosti
+ */
+void room_set_first_id(int first_id);
+
+/**
+ * Prevede slot mistnosti na jeji ID
+ * @param slot Index v poli mistnosti
+ * @return ID mistnosti
+ */
+int room_slot_to_id(int slot);
+
+/**
+ * Prevede ID mistnosti na slot (mimo rozsah vrati index mimo pole)
+ * @param id ID mistnosti
+ * @return Index v poli mistnosti
+ */
+int room_id_to_slot(int id);
+
+/**
+ * Zapne sledovani zmen mistnosti (otevreni, hraci, zruseni) pro registr
+ * lobby federace - kazda zmenena mistnost se zaradi do seznamu jednou
+ * @param count Pocet mistnosti
+ * @return true pri uspechu
+ */
+bool room_track_changes(int count);
+
+/**
+ * Vrati seznam mistnosti zmenenych od posledniho room_clear_changes
+ * @param count Vystup - pocet mistnosti v seznamu
+ * @return Seznam (NULL pokud se zmeny nesleduji)
+ */
+Room** room_changes(int *count);
+
+/**
+ * Vrati pocitadlo zmen mistnosti - roste pri kazde zmene, i kdyz se
+ * seznam zmen nesleduje
+ * @return Aktualni hodnota (porovnava se jen na rovnost)
+ */
+unsigned int room_change_seq(void);
+
+/**
+ * Vyprazdni seznam zmen (po zverejneni v registru)
+ */
+void room_clear_changes(void);
+
+/**
+ * Vypne sledovani zmen a uvolni seznam
+ */
+void room_stop_tracking(void);
+
 /**
  * Inicializuje pole mistnosti
  * @param rooms Pole mistnosti
@@ -41,9 +105,22 @@ void room_init_all(Room *rooms, int count);
  * @param count Pocet mistnosti
  * @param name Nazev mistnosti
  * @param creator Hrac, ktery vytvari mistnost
+ * @param rules Pravidla hry (NULL = klasicka varianta)
  * @return ID nove mistnosti nebo -1 pri chybe
  */
-int room_create(Room *rooms, int count, const char *name, Player *creator);
+int room_create(Room *rooms, int count, const char *name, Player *creator,
+                const GameRules *rules);
+
+/**
+ * Zalozi mistnost v zadanem volnem slotu bez tvurce a bez kontroly nazvu
+ * (hromadne zakladani zapasu turnaje, ktere maji nazev jedinecny z konstrukce)
+ * @param room Volny slot mistnosti
+ * @param slot Index slotu (ID mistnosti viz room_slot_to_id)
+ * @param name Nazev mistnosti
+ * @param rules Pravidla hry (NULL = klasicka varianta)
+ * @return true pri uspechu
+ */
+bool room_open(Room *room, int slot, const char *name, const GameRules *rules);
 
 /**
  * Najde mistnost podle ID
@@ -83,18 +160,35 @@ bool room_remove_player(Room *room, Player *player);
  * Vrati index hrace v mistnosti
  * @param room Ukazatel na mistnost
  * @param player Hrac
- * @return Index (0 nebo 1) nebo -1 pokud neni v mistnosti
+ * @return Index (poradi tahu) nebo -1 pokud neni v mistnosti
  */
 int room_get_player_index(Room *room, Player *player);
 
 /**
- * Vrati protihrace
+ * Vrati protihrace (ve hre vice hracu prvniho jineho hrace v mistnosti)
  * @param room Ukazatel na mistnost
  * @param player Hrac
  * @return Ukazatel na protihrace nebo NULL
  */
 Player* room_get_opponent(Room *room, Player *player);
 
+/**
+ * Najde prvniho pripojeneho hrace v poradi tahu za zadanym hracem
+ * (vitez pri predcasnem konci hry)
+ * @param room Ukazatel na mistnost
+ * @param player Hrac
+ * @return Ukazatel na hrace nebo NULL, pokud zadny jiny neni pripojen
+ */
+Player* room_get_next_online(Room *room, Player *player);
+
+/**
+ * Zkontroluje, zda jsou pripojeni vsichni ostatni hraci mistnosti
+ * @param room Ukazatel na mistnost
+ * @param player Hrac, ktery se nepocita
+ * @return true pokud jsou vsichni ostatni online
+ */
+bool room_others_online(Room *room, Player *player);
+
 /**
  * Zkontroluje, zda je mistnost plna
  * @param room Ukazatel na mistnost
@@ -135,7 +229,33 @@ int room_count_active(Room *rooms, int count);
 int room_list_to_string(Room *rooms, int count, char *buffer, int size);
 
 /**
- * Zacne hru v mistnosti (pokud jsou 2 hraci)
+ * Vytvori seznam prezdivek hracu v poradi tahu (oddelenych carkou)
+ * @param room Ukazatel na mistnost
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Delka retezce
+ */
+int room_players_to_string(const Room *room, char *buffer, int size);
+
+/**
+ * Prida divaka do seznamu mistnosti (seznam je provazany indexy slotu,
+ * takze prezije predani tabulek pri upgradu)
+ * @param room Ukazatel na mistnost
+ * @param players Pole hracu serveru
+ * @param spectator Divak
+ */
+void room_add_spectator(Room *room, Player *players, Player *spectator);
+
+/**
+ * Odebere divaka ze seznamu mistnosti
+ * @param room Ukazatel na mistnost
+ * @param players Pole hracu serveru
+ * @param spectator Divak
+ */
+void room_remove_spectator(Room *room, Player *players, Player *spectator);
+
+/**
+ * Zacne hru v mistnosti (pokud je plna)
  * @param room Ukazatel na mistnost
  * @return true pokud hra zacala
  */
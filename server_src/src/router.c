@@ -0,0 +1,426 @@
+/**
+ * @file router.c
+ * @brief Implementace routeru pred shardy
+ *
+ * Kazdy shard ma s routerem jeden kanal (socketpair SOCK_SEQPACKET).
+ * Router je jen prepinac zprav mezi kanaly - stav her, hracu a mistnosti
+ * vedou shardy, router cte ze sdileneho prehledu jen pocty spojeni.
+ * Shard, jehoz kanal se zavre, je mrtvy - nedostava spojeni a ostatni
+ * shardy jeho mistnosti nevidi.
+ */
+
+#include "router.h"
+#include "shard.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+/* ============================================
+ * GLOBALNI PROMENNE
+ * ============================================ */
+
+static volatile sig_atomic_t g_router_stop = 0;
+
+/* ============================================
+ * STRUKTURY
+ * ============================================ */
+
+typedef struct {
+    pid_t pid;                  /* Proces shardu */
+    int channel;                /* Kanal k shardu (-1 = shard nebezi) */
+} ShardProcess;
+
+typedef struct {
+    int fd;                     /* Naslouchajici socket */
+    ShardOrigin origin;         /* Druh spojeni pro shard */
+} RouterListener;
+
+typedef struct {
+    ServerConfig config;
+    ShardSummary summary;
+    ShardProcess shards[SHARD_MAX];
+    RouterListener listeners[3];
+    int listener_count;
+} Router;
+
+/* ============================================
+ * SIGNAL HANDLER
+ * ============================================ */
+
+static void router_signal_handler(int sig) {
+    (void)sig;
+    g_router_stop = 1;
+}
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+/**
+ * Omezi blokujici zapis do kanalu - zaseknuty shard nesmi zastavit router
+ */
+static void set_send_timeout(int fd) {
+    struct timeval tv;
+    tv.tv_sec = SHARD_SEND_TIMEOUT_MS / 1000;
+    tv.tv_usec = (SHARD_SEND_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/**
+ * Zavre listenery; soubor AF_UNIX socketu smaze jen vlastnik (router)
+ */
+static void close_listeners(Router *router, bool unlink_unix) {
+    for (int i = 0; i < router->listener_count; i++) {
+        close(router->listeners[i].fd);
+        if (unlink_unix && router->listeners[i].origin == SHARD_ORIGIN_UNIX) {
+            unlink(router->config.unix_socket_path);
+        }
+    }
+    router->listener_count = 0;
+}
+
+static bool add_listener(Router *router, int fd, ShardOrigin origin) {
+    if (fd < 0) return false;
+    router->listeners[router->listener_count].fd = fd;
+    router->listeners[router->listener_count].origin = origin;
+    router->listener_count++;
+    return true;
+}
+
+/**
+ * Odvodi cestu souboru shardu z cesty v konfiguraci
+ * @return false pokud se vysledek nevejde
+ */
+static bool shard_path(char *path, size_t size, const char *format, int index) {
+    char base[256];
+    snprintf(base, sizeof(base), "%s", path);
+    int written = snprintf(path, size, format, base, index);
+    return written > 0 && (size_t)written < size;
+}
+
+/**
+ * Telo procesu shardu - bezny server bez listeneru s kanalem k routeru
+ */
+static void run_shard(Router *router, int index, int channel) {
+    ServerConfig config = router->config;
+    Server server;
+    char tag[32];
+
+    snprintf(tag, sizeof(tag), "shard %d", index);
+    logger_set_tag(tag);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    config.shard_index = index;
+    config.shard_fd = channel;
+    config.shard_summary = &router->summary;
+    config.unix_socket_path[0] = '\0';
+
+    /* Kazdy shard ma vlastni snapshot a zurnal, hodnoceni vede SHARD_HOME */
+    if ((config.snapshot_path[0] != '\0' &&
+         !shard_path(config.snapshot_path, sizeof(config.snapshot_path), "%s.%d", index)) ||
+        (config.journal_dir[0] != '\0' &&
+         !shard_path(config.journal_dir, sizeof(config.journal_dir), "%s/shard%d", index))) {
+        LOG_ERROR("Snapshot or journal path too long for shard %d", index);
+        exit(EXIT_FAILURE);
+    }
+    if (index != SHARD_HOME) {
+        config.ratings_path[0] = '\0';
+    }
+
+    if (!server_init(&server, &config)) {
+        LOG_ERROR("Failed to initialize shard %d", index);
+        logger_close();
+        exit(EXIT_FAILURE);
+    }
+
+    server_run(&server);
+    logger_close();
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * Spusti proces shardu
+ * @return true pri uspechu
+ */
+static bool start_shard(Router *router, int index) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) < 0) {
+        LOG_ERROR("Failed to create channel for shard %d: %s", index, strerror(errno));
+        return false;
+    }
+    set_send_timeout(pair[0]);
+    set_send_timeout(pair[1]);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("Failed to fork shard %d: %s", index, strerror(errno));
+        close(pair[0]);
+        close(pair[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        /* Shard nepotrebuje listenery ani kanaly ostatnich shardu */
+        close_listeners(router, false);
+        for (int i = 0; i < index; i++) {
+            if (router->shards[i].channel >= 0) close(router->shards[i].channel);
+        }
+        close(pair[0]);
+        run_shard(router, index, pair[1]);
+    }
+
+    close(pair[1]);
+    router->shards[index].pid = pid;
+    router->shards[index].channel = pair[0];
+    shard_set_alive(&router->summary, index, true);
+    LOG_INFO("Shard %d started (pid %d, room IDs %d-%d)", index, (int)pid,
+             index * router->config.max_rooms, (index + 1) * router->config.max_rooms - 1);
+    return true;
+}
+
+/**
+ * Oznaci shard jako mrtvy po zavreni jeho kanalu
+ */
+static void shard_exited(Router *router, int index) {
+    ShardProcess *shard = &router->shards[index];
+    int status = 0;
+
+    shard_set_alive(&router->summary, index, false);
+    close(shard->channel);
+    shard->channel = -1;
+
+    if (waitpid(shard->pid, &status, 0) == shard->pid && WIFSIGNALED(status)) {
+        LOG_ERROR("Shard %d (pid %d) killed by signal %d", index, (int)shard->pid,
+                  WTERMSIG(status));
+    } else {
+        LOG_ERROR("Shard %d (pid %d) exited", index, (int)shard->pid);
+    }
+}
+
+static bool any_shard_alive(const Router *router) {
+    for (int i = 0; i < router->config.shards; i++) {
+        if (router->shards[i].channel >= 0) return true;
+    }
+    return false;
+}
+
+/**
+ * Preda nova spojeni z accept fronty listeneru shardum (nejvyse
+ * ACCEPT_BATCH_LIMIT, zbytek v pristi iteraci)
+ */
+static void accept_pending(Router *router, const RouterListener *listener) {
+    ShardMessage msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = SHARD_MSG_CLIENT;
+    msg.source = -1;
+    msg.origin = listener->origin;
+
+    for (unsigned int accepted = 0; accepted < ACCEPT_BATCH_LIMIT; accepted++) {
+        int fd = accept(listener->fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR &&
+                errno != ECONNABORTED) {
+                LOG_ERROR("Accept failed: %s", strerror(errno));
+            }
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+
+        int target = shard_least_loaded(&router->summary);
+        msg.target = target;
+        if (target < 0 || !shard_send(router->shards[target].channel, &msg, fd)) {
+            LOG_WARNING("No shard accepted a new connection, closing it");
+        }
+        close(fd);
+    }
+}
+
+/**
+ * Preposle zpravu shardu (socket, ktery ji doprovazi, po predani zavre)
+ */
+static void forward(Router *router, int target, const ShardMessage *msg, int fd) {
+    if (target < 0 || target >= router->config.shards || router->shards[target].channel < 0) {
+        if (fd >= 0) {
+            LOG_WARNING("Shard %d is not running, dropping moved connection", target);
+        }
+    } else if (!shard_send(router->shards[target].channel, msg, fd)) {
+        LOG_WARNING("Failed to forward message to shard %d", target);
+    }
+
+    if (fd >= 0) close(fd);
+}
+
+/**
+ * Zpracuje zpravy z kanalu jednoho shardu
+ */
+static void receive_from_shard(Router *router, int index) {
+    ShardMessage msg;
+    int fd;
+    int result;
+    unsigned int received = 0;
+
+    while (received < ACCEPT_BATCH_LIMIT &&
+           (result = shard_recv(router->shards[index].channel, &msg, &fd)) == 1) {
+        received++;
+        msg.source = index;
+
+        switch (msg.type) {
+            case SHARD_MSG_PLAYER:
+                forward(router, msg.target, &msg, fd);
+                break;
+            case SHARD_MSG_RATING:
+                forward(router, SHARD_HOME, &msg, fd);
+                break;
+            case SHARD_MSG_LOBBY:
+                for (int i = 0; i < router->config.shards; i++) {
+                    if (i != index && router->shards[i].channel >= 0) {
+                        forward(router, i, &msg, -1);
+                    }
+                }
+                if (fd >= 0) close(fd);
+                break;
+            default:
+                LOG_WARNING("Unexpected message type %d from shard %d", msg.type, index);
+                if (fd >= 0) close(fd);
+                break;
+        }
+    }
+
+    if (result == 0) {
+        shard_exited(router, index);
+    }
+}
+
+/**
+ * Ukonci vsechny bezici shardy a pocka na ne
+ */
+static void stop_shards(Router *router) {
+    for (int i = 0; i < router->config.shards; i++) {
+        if (router->shards[i].channel >= 0) {
+            kill(router->shards[i].pid, SIGTERM);
+        }
+    }
+    for (int i = 0; i < router->config.shards; i++) {
+        if (router->shards[i].channel >= 0) {
+            waitpid(router->shards[i].pid, NULL, 0);
+            close(router->shards[i].channel);
+            router->shards[i].channel = -1;
+        }
+    }
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+int router_run(const ServerConfig *config) {
+    static Router router;
+    bool ok = true;
+
+    memset(&router, 0, sizeof(router));
+    router.config = *config;
+    for (int i = 0; i < SHARD_MAX; i++) {
+        router.shards[i].channel = -1;
+    }
+
+    logger_set_tag("router");
+
+    signal(SIGINT, router_signal_handler);
+    signal(SIGTERM, router_signal_handler);
+    signal(SIGUSR2, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Verejne listenery drzi jen router */
+    ok = add_listener(&router, server_create_tcp_listener(config, config->port), SHARD_ORIGIN_TCP);
+    if (ok && config->unix_socket_path[0] != '\0') {
+        ok = add_listener(&router, server_create_unix_listener(config), SHARD_ORIGIN_UNIX);
+    }
+    if (ok && config->websocket_port > 0) {
+        ok = add_listener(&router, server_create_tcp_listener(config, config->websocket_port),
+                          SHARD_ORIGIN_WEBSOCKET);
+    }
+    if (ok) {
+        ok = shard_summary_create(&router.summary, config->shards, config->max_clients,
+                                  config->max_rooms);
+    }
+
+    /* Zurnaly shardu jsou podadresare spolecneho adresare */
+    if (ok && config->journal_dir[0] != '\0' && mkdir(config->journal_dir, 0755) < 0 &&
+        errno != EEXIST) {
+        LOG_ERROR("Cannot create journal directory '%s': %s", config->journal_dir,
+                  strerror(errno));
+        ok = false;
+    }
+
+    for (int i = 0; ok && i < config->shards; i++) {
+        ok = start_shard(&router, i);
+    }
+
+    if (ok) {
+        LOG_INFO("Router listening on %s:%d with %d shards", config->bind_address,
+                 config->port, config->shards);
+        LOG_INFO("Upgrade (SIGUSR2) is not supported with --shards");
+    }
+
+    while (ok && !g_router_stop) {
+        struct pollfd fds[3 + SHARD_MAX];
+        int nfds = 0;
+
+        for (int i = 0; i < router.listener_count; i++) {
+            fds[nfds].fd = router.listeners[i].fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            nfds++;
+        }
+        for (int i = 0; i < config->shards; i++) {
+            /* Mrtvy shard ma fd -1 - poll() ho preskoci */
+            fds[nfds].fd = router.shards[i].channel;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            nfds++;
+        }
+
+        if (poll(fds, nfds, POLL_TIMEOUT_MS) < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Poll error: %s", strerror(errno));
+            break;
+        }
+
+        /* Nejdriv presuny mezi shardy, pak nova spojeni */
+        for (int i = 0; i < config->shards; i++) {
+            if (fds[router.listener_count + i].revents != 0) {
+                receive_from_shard(&router, i);
+            }
+        }
+        for (int i = 0; i < router.listener_count; i++) {
+            if (fds[i].revents & POLLIN) {
+                accept_pending(&router, &router.listeners[i]);
+            }
+        }
+
+        if (!any_shard_alive(&router)) {
+            LOG_ERROR("All shards exited, router shutting down");
+            ok = false;
+        }
+    }
+
+    LOG_INFO("Router shutting down...");
+    stop_shards(&router);
+    close_listeners(&router, true);
+    shard_summary_destroy(&router.summary);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
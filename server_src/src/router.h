@@ -0,0 +1,27 @@
+/**
+ * @file router.h
+ * @brief Router pred shardy serveru (--shards)
+ *
+ * Router drzi verejne naslouchajici sockety a spusti K shardu (fork).
+ * Nova spojeni predava shardu s nejmene spojenimi, mezi shardy preposila
+ * presouvane hrace (socket pres SCM_RIGHTS), zpravy do lobby a vysledky
+ * her. Data klientu nikdy necte - po predani socketu zavre svou kopii.
+ */
+
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "server.h"
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Spusti shardy a obsluhuje listenery a kanaly, dokud neprijde SIGINT/SIGTERM
+ * @param config Konfigurace (config->shards > 1)
+ * @return Navratovy kod procesu (EXIT_SUCCESS / EXIT_FAILURE)
+ */
+int router_run(const ServerConfig *config);
+
+#endif /* ROUTER_H */
@@ -7,6 +7,12 @@
 #include "protocol.h"
 #include "logger.h"
 #include "game.h"
+#include "upgrade.h"
+#include "session.h"
+#include "journal.h"
+#include "solver.h"
+#include "outqueue.h"
+#include "websocket.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,19 +20,30 @@
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
+#include <time.h>
 #include <fcntl.h>
 #include <sys/socket.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 #include <getopt.h>
 
+/** Kody dlouhych voleb bez kratke varianty */
+#define OPT_UPGRADE_FD 256
+#define OPT_UNIX_SOCKET 257
+#define OPT_WEBSOCKET 258
+#define OPT_SHARDS 259
+#define OPT_REGISTRY 260
+
 /* ============================================
  * GLOBALNI PROMENNE
  * ============================================ */
 
 static volatile sig_atomic_t g_shutdown_requested = 0;
+static volatile sig_atomic_t g_upgrade_requested = 0;
 
 /* ============================================
  * SIGNAL HANDLER
@@ -37,6 +54,11 @@ static void signal_handler(int sig) {
     g_shutdown_requested = 1;
 }
 
+static void upgrade_signal_handler(int sig) {
+    (void)sig;
+    server_request_upgrade();
+}
+
 /* ============================================
  * POMOCNE FUNKCE
  * ============================================ */
@@ -51,84 +73,146 @@ static bool set_nonblocking(int fd) {
 }
 
 /**
- * Aktualizuje max_fd pro select
+ * Nastavi FD_CLOEXEC, aby se socket nedostal do procesu po exec()
+ * (pri upgradu se predava explicitne pres SCM_RIGHTS)
  */
-static void update_max_fd(Server *server) {
-    server->max_fd = server->listen_fd;
-    
-    for (int i = 0; i < server->config.max_clients; i++) {
-        if (server->players[i].is_active && server->players[i].socket_fd > server->max_fd) {
-            server->max_fd = server->players[i].socket_fd;
-        }
-    }
+static bool set_cloexec(int fd) {
+    int flags = fcntl(fd, F_GETFD, 0);
+    if (flags == -1) return false;
+    return fcntl(fd, F_SETFD, flags | FD_CLOEXEC) != -1;
 }
 
 /**
- * Prijme noveho klienta
+ * Nastavi TCP keepalive pro detekci odpojeneho klienta
  */
-static void accept_new_client(Server *server) {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    
-    int client_fd = accept(server->listen_fd, 
-                           (struct sockaddr*)&client_addr, 
-                           &client_len);
-    
-    if (client_fd < 0) {
-        if (errno != EWOULDBLOCK && errno != EAGAIN) {
-            LOG_ERROR("Accept failed: %s", strerror(errno));
-        }
-        return;
-    }
-    
-    /* Nastav non-blocking */
-    if (!set_nonblocking(client_fd)) {
-        LOG_ERROR("Failed to set non-blocking for client socket");
-        close(client_fd);
-        return;
-    }
-    
-    /* Nastav TCP keepalive pro detekci odpojeneho klienta */
+static void set_tcp_keepalive(int fd) {
     int keepalive = 1;
-    setsockopt(client_fd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive));
     
 #ifdef TCP_KEEPIDLE
     int keepidle = 10;  /* Zacni keepalive po 10s neaktivity */
-    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
 #endif
 
 #ifdef TCP_KEEPINTVL
     int keepintvl = 5;  /* Interval mezi keepalive proby */
-    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
 #endif
 
 #ifdef TCP_KEEPCNT
     int keepcnt = 3;    /* Pocet pokusu pred odpojenim */
-    setsockopt(client_fd, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
 #endif
+}
+
+/**
+ * Popis protistrany pro log ("adresa:port", u AF_UNIX "unix socket")
+ */
+static const char* describe_peer(const struct sockaddr_storage *addr, char *buffer, size_t size) {
+    if (addr->ss_family == AF_INET) {
+        const struct sockaddr_in *in = (const struct sockaddr_in *)addr;
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+        snprintf(buffer, size, "%s:%d", ip, ntohs(in->sin_port));
+    } else {
+        snprintf(buffer, size, "unix socket");
+    }
+    return buffer;
+}
+
+/**
+ * Zaradi nove spojeni do volneho slotu hrace
+ * @param client_fd Socket klienta (prevezme ho hrac, jinak se zavre)
+ * @param client_addr Adresa protistrany
+ * @param websocket Spojeni z WebSocket portu (ceka se handshake)
+ */
+static void add_client(Server *server, int client_fd, const struct sockaddr_storage *client_addr,
+                       bool websocket) {
+    /* Keepalive ma smysl jen pres sit - lokalni spojeni hlida jadro */
+    if (client_addr->ss_family == AF_INET) {
+        set_tcp_keepalive(client_fd);
+    }
+    
+    char peer[64];
     
     /* Najdi volny slot */
     int slot = player_find_free_slot(server->players, server->config.max_clients);
     if (slot < 0) {
         LOG_WARNING("Server full, rejecting connection from %s", 
-                    inet_ntoa(client_addr.sin_addr));
-        /* Posli chybu a zavri */
+                    describe_peer(client_addr, peer, sizeof(peer)));
+        server->stats.rejected_full++;
+        /* Posli chybu a zavri - prohlizeci jeste pred handshakem HTTP odpovedi */
         char buffer[128];
-        protocol_create_login_err(buffer, sizeof(buffer), ERR_SERVER_FULL, NULL);
-        send(client_fd, buffer, strlen(buffer), 0);
-        close(client_fd);
+        int len = websocket
+                  ? ws_create_http_error(buffer, sizeof(buffer), "503 Service Unavailable")
+                  : protocol_create_login_err(buffer, sizeof(buffer), ERR_SERVER_FULL, NULL);
+        sysio_send(client_fd, buffer, (size_t)len);
+        sysio_close(client_fd);
         return;
     }
     
     /* Vytvor hrace */
     player_create(&server->players[slot], client_fd);
+    server->shard_dirty = true;
+    server->stats.accepted_total++;
+    if (client_addr->ss_family == AF_UNIX) {
+        server->stats.accepted_unix++;
+    }
+    if (websocket) {
+        /* Prvni data jsou HTTP pozadavek na upgrade */
+        server->players[slot].ws.state = WS_STATE_HANDSHAKE;
+        server->stats.accepted_websocket++;
+    }
     
-    LOG_INFO("New client connected from %s:%d (slot %d, fd %d)",
-             inet_ntoa(client_addr.sin_addr),
-             ntohs(client_addr.sin_port),
-             slot, client_fd);
+    LOG_INFO("New %sclient connected from %s (slot %d, fd %d)", websocket ? "WebSocket " : "",
+             describe_peer(client_addr, peer, sizeof(peer)), slot, client_fd);
+}
+
+/**
+ * Prijme jednoho noveho klienta z accept fronty
+ * @param listen_fd Naslouchajici socket (TCP, AF_UNIX nebo WebSocket)
+ * @return true pokud ma smysl zkusit dalsi accept(), false pokud je fronta
+ *         prazdna nebo nastala chyba, kterou dalsi pokus nevyresi
+ */
+static bool accept_new_client(Server *server, int listen_fd) {
+    struct sockaddr_storage client_addr;
+    int client_fd = sysio_accept(listen_fd, &client_addr);
+    
+    if (client_fd < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN) {
+            return false; /* Fronta je prazdna */
+        }
+        server->stats.accept_errors++;
+        if (errno == EINTR || errno == ECONNABORTED) {
+            return true; /* Prechodna chyba - zkus dalsi spojeni */
+        }
+        LOG_ERROR("Accept failed: %s", strerror(errno));
+        return false;
+    }
+    
+    add_client(server, client_fd, &client_addr, listen_fd == server->ws_listen_fd);
+    return true;
+}
+
+/**
+ * Vyprazdni accept frontu - prijima spojeni, dokud accept() nevrati EAGAIN
+ * nebo dokud neni vycerpan ACCEPT_BATCH_LIMIT (aby vlna pripojeni
+ * nezablokovala obsluhu jiz pripojenych klientu)
+ * @param listen_fd Naslouchajici socket
+ */
+static void accept_pending_clients(Server *server, int listen_fd) {
+    unsigned int accepted = 0;
     
-    update_max_fd(server);
+    while (accepted < ACCEPT_BATCH_LIMIT) {
+        if (!accept_new_client(server, listen_fd)) {
+            stats_record_accept_batch(&server->stats, accepted, false);
+            return;
+        }
+        accepted++;
+    }
+    
+    /* Budget vycerpan - zbytek fronty prijmeme v pristi iteraci */
+    stats_record_accept_batch(&server->stats, accepted, true);
 }
 
 /**
@@ -148,12 +232,71 @@ static bool is_valid_protocol_data(const char *data, size_t len) {
     return true;
 }
 
+/**
+ * Pripoji k odpovedi ID pozadavku, ktery hrac prave posila
+ * @param len Delka zpravy, na vystupu delka zpravy s ID
+ * @return Zprava k odeslani (buffer, nebo puvodni zprava bez ID)
+ */
+static const char* with_request_id(const Player *player, const char *message, size_t *len,
+                                   char *buffer, size_t size) {
+    if (player->request_id[0] == '\0') return message;
+    
+    size_t id_len = strlen(player->request_id);
+    if (id_len + 2 + *len > size) return message;
+    
+    buffer[0] = REQUEST_ID_PREFIX;
+    memcpy(buffer + 1, player->request_id, id_len);
+    buffer[id_len + 1] = MSG_DELIMITER;
+    memcpy(buffer + id_len + 2, message, *len);
+    *len += id_len + 2;
+    return buffer;
+}
+
+/** Format dat na spojeni - kazdy dostane vlastni sdilenou kopii udalosti */
+typedef enum {
+    WIRE_TEXT,
+    WIRE_BINARY,
+    WIRE_WEBSOCKET,
+    WIRE_FORMATS
+} WireFormat;
+
+static WireFormat wire_format(const Player *player) {
+    if (player->ws.state == WS_STATE_OPEN) return WIRE_WEBSOCKET;
+    return player->binary ? WIRE_BINARY : WIRE_TEXT;
+}
+
+/**
+ * Prevede hotovou zpravu do formatu spojeni prijemce (radek, binarni ramec
+ * nebo WebSocket ramec)
+ * @param len Delka zpravy, na vystupu delka dat k odeslani
+ * @return Data k odeslani (message nebo out), NULL pokud se zprava nevejde
+ */
+static const char* encode_for_player(const Player *player, const char *message, size_t *len,
+                                     char *out, int size) {
+    int encoded;
+    
+    switch (wire_format(player)) {
+        case WIRE_BINARY:
+            encoded = protocol_encode_binary(message, *len, out, size);
+            break;
+        case WIRE_WEBSOCKET:
+            encoded = ws_encode_text(message, *len, out, size);
+            break;
+        default:
+            return message;
+    }
+    
+    if (encoded < 0) return NULL;
+    *len = (size_t)encoded;
+    return out;
+}
+
 /**
  * Zkontroluje rate limit pro hrace
  * @return true pokud je v limitu
  */
 static bool check_rate_limit(Player *player) {
-    time_t now = time(NULL);
+    time_t now = sysio_time();
     
     if (player->rate_limit_second != now) {
         player->rate_limit_second = now;
@@ -169,14 +312,184 @@ static bool check_rate_limit(Player *player) {
     return true;
 }
 
+/**
+ * Zapocita nevalidni zpravu - po MAX_INVALID_MESSAGES hrace odpoji
+ */
+static void reject_invalid_message(Server *server, Player *player) {
+    player->invalid_message_count++;
+    
+    if (player->invalid_message_count >= MAX_INVALID_MESSAGES) {
+        LOG_WARNING("Too many invalid messages from '%s', disconnecting",
+                    player->nickname[0] ? player->nickname : "(unknown)");
+        char response[BUFFER_SIZE];
+        int len;
+        len = protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
+                              "Too many invalid messages");
+        server_send_to_player(player, response, len);
+        server_handle_disconnect(server, player, false);
+    }
+}
+
 /**
  * Precte data od klienta
  */
+static void process_messages(Server *server, Player *player);
+static void dispatch_message(Server *server, Player *player, ParsedMessage *parsed);
+static bool queue_bytes(Player *player, const char *data, size_t len);
+
+/**
+ * Ukonci WebSocket spojeni ramcem CLOSE (odejde pri odpojeni se zbytkem fronty)
+ */
+static void websocket_close(Server *server, Player *player, int status) {
+    char frame[WS_SERVER_HEADER_MAX + 2];
+    int len = ws_create_close(frame, sizeof(frame), status);
+    queue_bytes(player, frame, (size_t)len);
+    server_handle_disconnect(server, player, false);
+}
+
+/**
+ * Rozbali prijate WebSocket ramce primo do prijimaciho bufferu hrace
+ * a obslouzi ridici ramce
+ * @return false pokud spojeni skoncilo
+ */
+static bool read_websocket_frames(Server *server, Player *player, const char *data, size_t len) {
+    size_t offset = 0;
+    
+    while (offset < len) {
+        size_t consumed;
+        WsDecodeResult result = ws_decode(&player->ws, data + offset, len - offset, &consumed,
+                                          player->recv_buffer, &player->recv_buffer_len,
+                                          BUFFER_SIZE - 1);
+        offset += consumed;
+        
+        if (result == WS_DECODE_PING) {
+            char frame[WS_SERVER_HEADER_MAX + WS_MAX_CONTROL_PAYLOAD];
+            int frame_len = ws_encode_control(WS_OPCODE_PONG, player->ws.control,
+                                              player->ws.control_len, frame, sizeof(frame));
+            queue_bytes(player, frame, (size_t)frame_len);
+        } else if (result == WS_DECODE_CLOSE) {
+            LOG_INFO("WebSocket client '%s' closed the connection",
+                     player->nickname[0] ? player->nickname : "(unknown)");
+            websocket_close(server, player, WS_CLOSE_NORMAL);
+            return false;
+        } else if (result != WS_DECODE_DATA) {
+            bool too_big = result == WS_DECODE_TOO_BIG;
+            LOG_WARNING("%s from WebSocket client '%s', disconnecting",
+                        too_big ? "Message too long" : "Invalid frame",
+                        player->nickname[0] ? player->nickname : "(unknown)");
+            websocket_close(server, player, too_big ? WS_CLOSE_TOO_BIG : WS_CLOSE_PROTOCOL);
+            return false;
+        }
+    }
+    
+    player->recv_buffer[player->recv_buffer_len] = '\0';
+    return true;
+}
+
+/**
+ * Zpracuje radky HTTP pozadavku na upgrade. Po prazdnem radku odpovi 101
+ * a data za pozadavkem (prvni ramce) rozbali jako u otevreneho spojeni.
+ * @return true pokud je spojeni otevrene a buffer obsahuje zpravy
+ */
+static bool process_websocket_handshake(Server *server, Player *player) {
+    char *newline;
+    
+    while ((newline = memchr(player->recv_buffer, '\n', player->recv_buffer_len)) != NULL) {
+        size_t line_len = (size_t)(newline - player->recv_buffer);
+        int remaining = player->recv_buffer_len - (int)line_len - 1;
+        if (line_len > 0 && player->recv_buffer[line_len - 1] == '\r') line_len--;
+        
+        WsHandshakeResult result = ws_handshake_line(&player->ws, player->recv_buffer, line_len);
+        memmove(player->recv_buffer, newline + 1, remaining);
+        player->recv_buffer_len = remaining;
+        
+        char response[BUFFER_SIZE];
+        int len;
+        
+        if (result == WS_HANDSHAKE_BAD) {
+            LOG_WARNING("Invalid WebSocket handshake, disconnecting");
+            len = ws_create_http_error(response, sizeof(response), "400 Bad Request");
+            queue_bytes(player, response, (size_t)len);
+            server_handle_disconnect(server, player, false);
+            return false;
+        }
+        
+        if (result == WS_HANDSHAKE_DONE) {
+            len = ws_create_handshake_response(&player->ws, response, sizeof(response));
+            queue_bytes(player, response, (size_t)len);
+            player->ws.state = WS_STATE_OPEN;
+            LOG_DEBUG("WebSocket handshake completed (fd %d)", player->socket_fd);
+            
+            /* Zbytek bufferu uz jsou ramce */
+            char frames[BUFFER_SIZE];
+            memcpy(frames, player->recv_buffer, remaining);
+            player->recv_buffer_len = 0;
+            return read_websocket_frames(server, player, frames, (size_t)remaining);
+        }
+    }
+    
+    player->recv_buffer[player->recv_buffer_len] = '\0';
+    return false;
+}
+
+/**
+ * Prida prijata data k HTTP pozadavku na upgrade. Radek hlavicky delsi nez
+ * prijimaci buffer (napr. Cookie z prohlizece) se zahodi - handshake z nej
+ * nic nepotrebuje. Data za pozadavkem se rozbali jako ramce.
+ * @return true pokud je spojeni otevrene a buffer obsahuje zpravy
+ */
+static bool read_websocket_handshake(Server *server, Player *player, const char *data, size_t len) {
+    int fd = player->socket_fd;
+    
+    while (len > 0) {
+        if (player->ws.skip_line) {
+            const char *newline = memchr(data, '\n', len);
+            if (newline == NULL) return false;
+            len -= (size_t)(newline - data) + 1;
+            data = newline + 1;
+            player->ws.skip_line = false;
+            continue;
+        }
+        
+        size_t space = (size_t)(BUFFER_SIZE - 1 - player->recv_buffer_len);
+        size_t chunk = len < space ? len : space;
+        memcpy(player->recv_buffer + player->recv_buffer_len, data, chunk);
+        player->recv_buffer_len += (int)chunk;
+        data += chunk;
+        len -= chunk;
+        
+        bool ready = process_websocket_handshake(server, player);
+        if (player->socket_fd != fd) return false;
+        if (player->ws.state == WS_STATE_OPEN) {
+            if (len == 0) return ready;
+            return read_websocket_frames(server, player, data, len);
+        }
+        
+        /* Cely buffer je jeden nedokonceny radek */
+        if (player->recv_buffer_len == BUFFER_SIZE - 1) {
+            player->recv_buffer_len = 0;
+            player->recv_buffer[0] = '\0';
+            if (!ws_handshake_skip_line(&player->ws)) {
+                char response[BUFFER_SIZE];
+                int response_len;
+                LOG_WARNING("WebSocket request line too long, disconnecting");
+                response_len = ws_create_http_error(response, sizeof(response),
+                                                    "414 URI Too Long");
+                queue_bytes(player, response, (size_t)response_len);
+                server_handle_disconnect(server, player, false);
+                return false;
+            }
+            LOG_DEBUG("Skipping long WebSocket header line (fd %d)", fd);
+        }
+    }
+    return false;
+}
+
 static void read_from_client(Server *server, Player *player) {
     char buffer[BUFFER_SIZE];
     ssize_t bytes_read;
     
-    bytes_read = recv(player->socket_fd, buffer, sizeof(buffer) - 1, 0);
+    bytes_read = sysio_recv(player->socket_fd, buffer, sizeof(buffer) - 1);
     
     if (bytes_read <= 0) {
         if (bytes_read == 0) {
@@ -194,583 +507,1893 @@ static void read_from_client(Server *server, Player *player) {
     buffer[bytes_read] = '\0';
     player_update_activity(player);
     
-    /* OCHRANA: Zkontroluj, zda data obsahuji pouze validni znaky */
-    if (!is_valid_protocol_data(buffer, bytes_read)) {
-        LOG_WARNING("Binary/invalid data from '%s', counting as invalid message",
-                    player->nickname[0] ? player->nickname : "(unknown)");
-        player->invalid_message_count++;
-        
-        if (player->invalid_message_count >= MAX_INVALID_MESSAGES) {
-            LOG_WARNING("Too many invalid messages from '%s', disconnecting",
+    if (player->ws.state == WS_STATE_OPEN) {
+        /* Ramce se rozbali rovnou do bufferu hrace (kapacitu hlida dekoder) */
+        if (!read_websocket_frames(server, player, buffer, (size_t)bytes_read)) return;
+    } else if (player->ws.state == WS_STATE_HANDSHAKE) {
+        /* Hlavicky HTTP nejsou zpravy protokolu - ochrana proti flood se jich netyka */
+        if (!read_websocket_handshake(server, player, buffer, (size_t)bytes_read)) return;
+    } else {
+        /* Pridej do bufferu hrace */
+        int space_left = BUFFER_SIZE - player->recv_buffer_len - 1;
+        if ((int)bytes_read > space_left) {
+            LOG_WARNING("Buffer overflow for player '%s', disconnecting",
                         player->nickname[0] ? player->nickname : "(unknown)");
-            char response[BUFFER_SIZE];
-            protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
-                                  "Binary data not allowed");
-            server_send_to_player(player, response);
             server_handle_disconnect(server, player, false);
+            return;
         }
-        /* Zahodit binarni data - nevkladat do bufferu */
-        return;
-    }
-    
-    /* Pridej do bufferu hrace */
-    int space_left = BUFFER_SIZE - player->recv_buffer_len - 1;
-    if ((int)bytes_read > space_left) {
-        LOG_WARNING("Buffer overflow for player '%s', disconnecting",
-                    player->nickname[0] ? player->nickname : "(unknown)");
-        server_handle_disconnect(server, player, false);
-        return;
+        
+        memcpy(player->recv_buffer + player->recv_buffer_len, buffer, bytes_read);
+        player->recv_buffer_len += bytes_read;
+        player->recv_buffer[player->recv_buffer_len] = '\0';
     }
     
-    memcpy(player->recv_buffer + player->recv_buffer_len, buffer, bytes_read);
-    player->recv_buffer_len += bytes_read;
-    player->recv_buffer[player->recv_buffer_len] = '\0';
-    
-    /* OCHRANA: Kontrola proti flood bez newline */
-    if (player->recv_buffer_len > MAX_MESSAGE_WITHOUT_NEWLINE && 
-        strchr(player->recv_buffer, '\n') == NULL) {
+    /* OCHRANA: Kontrola proti flood bez newline (binarni ramec ma delku
+     * omezenou v hlavicce) */
+    if (!player->binary && player->recv_buffer_len > MAX_MESSAGE_WITHOUT_NEWLINE && 
+        memchr(player->recv_buffer, '\n', player->recv_buffer_len) == NULL) {
         LOG_WARNING("Message too long without newline from '%s', disconnecting",
                     player->nickname[0] ? player->nickname : "(unknown)");
         char response[BUFFER_SIZE];
-        protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
+        int len;
+        len = protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
                               "Message too long");
-        server_send_to_player(player, response);
+        server_send_to_player(player, response, len);
         server_handle_disconnect(server, player, false);
         return;
     }
     
     /* Zpracuj vsechny kompletni zpravy (oddelene \n) */
-    char *line_start = player->recv_buffer;
-    char *newline;
-    
-    while ((newline = strchr(line_start, '\n')) != NULL) {
-        *newline = '\0';
-        
-        /* Odstran pripadny \r */
-        if (newline > line_start && *(newline - 1) == '\r') {
-            *(newline - 1) = '\0';
-        }
-        
-        size_t msg_len = strlen(line_start);
-        if (msg_len > 0) {
-            /* OCHRANA: Rate limiting */
-            if (!check_rate_limit(player)) {
-                LOG_WARNING("Rate limit exceeded for '%s'",
-                            player->nickname[0] ? player->nickname : "(unknown)");
-                player->invalid_message_count++;
-                /* Preskoc tuto zpravu, ale pokracuj */
-            } else {
-                LOG_DEBUG("Received from '%s': %s",
-                          player->nickname[0] ? player->nickname : "(unknown)",
-                          line_start);
-                server_handle_message(server, player, line_start);
-            }
-        }
-        
-        line_start = newline + 1;
-    }
-    
-    /* Presun zbytek bufferu na zacatek */
-    int remaining = player->recv_buffer_len - (line_start - player->recv_buffer);
-    if (remaining > 0) {
-        memmove(player->recv_buffer, line_start, remaining);
-    }
-    player->recv_buffer_len = remaining;
-    player->recv_buffer[remaining] = '\0';
+    process_messages(server, player);
 }
 
-/* ============================================
- * ZPRACOVANI ZPRAV
- * ============================================ */
-
 /**
- * Zpracuje LOGIN
+ * Zpracuje jeden binarni ramec ze zacatku prijimaciho bufferu
+ * @return false pokud v bufferu neni cely ramec nebo spojeni skoncilo
  */
-static void handle_login(Server *server, Player *player, ParsedMessage *msg) {
-    char response[BUFFER_SIZE];
+static bool process_binary_frame(Server *server, Player *player) {
+    ParsedMessage parsed;
+    int consumed = protocol_decode_binary(player->recv_buffer, player->recv_buffer_len, &parsed);
+    if (consumed == 0) return false;
     
-    /* Kontrola stavu */
-    if (player->state != PLAYER_STATE_CONNECTING) {
-        protocol_create_login_err(response, sizeof(response), 
-                                  ERR_ALREADY_LOGGED_IN, NULL);
-        server_send_to_player(player, response);
-        return;
+    if (consumed < 0) {
+        /* Za ramcem chybne delky se nelze zachytit */
+        LOG_WARNING("Invalid binary frame from '%s', disconnecting",
+                    player->nickname[0] ? player->nickname : "(unknown)");
+        char response[BUFFER_SIZE];
+        int len;
+        len = protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
+                              "Invalid frame");
+        server_send_to_player(player, response, len);
+        server_handle_disconnect(server, player, false);
+        return false;
     }
     
-    /* Kontrola parametru */
-    if (msg->param_count < 1) {
-        protocol_create_login_err(response, sizeof(response), 
-                                  ERR_INVALID_PARAMS, "Missing nickname");
-        server_send_to_player(player, response);
+    int remaining = player->recv_buffer_len - consumed;
+    memmove(player->recv_buffer, player->recv_buffer + consumed, remaining);
+    player->recv_buffer_len = remaining;
+    player->recv_buffer[remaining] = '\0';
+    
+    if (!check_rate_limit(player)) {
+        LOG_WARNING("Rate limit exceeded for '%s'",
+                    player->nickname[0] ? player->nickname : "(unknown)");
         player->invalid_message_count++;
-        return;
+        return true;
     }
     
-    const char *nickname = msg->params[0];
-    
-    /* Validace prezdivky */
-    ErrorCode err = protocol_validate_nickname(nickname);
-    if (err != ERR_NONE) {
-        protocol_create_login_err(response, sizeof(response), err, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
-        return;
+    if (parsed.type == MSG_UNKNOWN) {
+        LOG_WARNING("Invalid binary message from '%s'",
+                    player->nickname[0] ? player->nickname : "(unknown)");
+        reject_invalid_message(server, player);
+        return true;
     }
     
-    /* Kontrola, zda existuje odpojeny hrac se stejnou prezdivkou (reconnect) */
-    Player *disconnected = player_find_disconnected(server->players, 
-                                                    server->config.max_clients, 
-                                                    nickname);
-    if (disconnected != NULL) {
-        /* Reconnect - prevezmi session */
-        LOG_INFO("Player '%s' reconnecting", nickname);
+    LOG_DEBUG("Received from '%s': %s (binary)",
+              player->nickname[0] ? player->nickname : "(unknown)",
+              protocol_message_type_to_string(parsed.type));
+    dispatch_message(server, player, &parsed);
+    return true;
+}
+
+/**
+ * Zpracuje kompletni zpravy v prijimacim bufferu hrace
+ * Kazda zprava se z bufferu odebere pred zpracovanim, takze pokud ji
+ * obsluha spojeni uzavre nebo presune do jineho slotu (RESUME),
+ * zbytek bufferu uz patri novemu vlastnikovi.
+ * Odpovedi na celou davku odejdou az s ostatnimi zpravami iterace
+ * (flush_out_queues) - klient, ktery posle vic pozadavku najednou,
+ * dostane odpovedi v jednom segmentu.
+ * Po LOGIN/RESUME s priznakem binarniho rezimu nasleduji v bufferu ramce.
+ */
+static void process_messages(Server *server, Player *player) {
+    int fd = player->socket_fd;
+    char line[BUFFER_SIZE];
+    char *newline;
+    
+    while (player->is_active && player->socket_fd == fd) {
+        if (player->binary) {
+            if (!process_binary_frame(server, player)) break;
+            continue;
+        }
         
-        /* Zkopiruj stav z odpojeneho hrace */
-        int old_room_id = disconnected->room_id;
-        int old_skips = disconnected->skips_remaining;
-        PlayerState old_state = disconnected->state == PLAYER_STATE_DISCONNECTED ? 
-                                PLAYER_STATE_IN_GAME : disconnected->state;
+        newline = memchr(player->recv_buffer, '\n', player->recv_buffer_len);
+        if (newline == NULL) break;
         
-        /* Resetuj stareho hrace */
-        player_reset(disconnected, false);
+        size_t line_len = newline - player->recv_buffer;
+        memcpy(line, player->recv_buffer, line_len);
+        line[line_len] = '\0';
         
-        /* Nastav noveho hrace */
-        player_set_nickname(player, nickname);
-        player->room_id = old_room_id;
-        player->skips_remaining = old_skips;
+        /* Odeber zpravu z bufferu */
+        int remaining = player->recv_buffer_len - (int)line_len - 1;
+        memmove(player->recv_buffer, newline + 1, remaining);
+        player->recv_buffer_len = remaining;
+        player->recv_buffer[remaining] = '\0';
         
-        /* Posli potvrzeni */
-        protocol_create_login_ok(response, sizeof(response));
-        server_send_to_player(player, response);
+        /* Odstran pripadny \r */
+        if (line_len > 0 && line[line_len - 1] == '\r') {
+            line[--line_len] = '\0';
+        }
         
-        /* Obnov do mistnosti, pokud byl ve hre */
-        if (old_room_id >= 0) {
-            Room *room = room_find_by_id(server->rooms, server->config.max_rooms, old_room_id);
-            if (room != NULL) {
-                /* Aktualizuj ukazatel v mistnosti */
-                for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
-                    if (room->players[i] == disconnected) {
-                        room->players[i] = player;
-                        break;
-                    }
-                }
-                
-                player_set_state(player, old_state);
-                
-                /* Obnov hru, pokud byla pozastavena */
-                if (room->game.state == GAME_STATE_PAUSED) {
-                    game_resume(&room->game);
-                    
-                    /* Posli stav hry */
-                    int player_idx = room_get_player_index(room, player);
-                    bool my_turn = game_is_player_turn(&room->game, player_idx);
-                    int opp_idx = 1 - player_idx;
-                    
-                    protocol_create_game_resumed(response, sizeof(response),
-                                                  game_get_stones(&room->game),
-                                                  my_turn,
-                                                  player->skips_remaining,
-                                                  room->game.player_skips[opp_idx]);
-                    server_send_to_player(player, response);
-                    
-                    /* Informuj protihrace */
-                    Player *opponent = room_get_opponent(room, player);
-                    if (opponent != NULL && opponent->socket_fd >= 0) {
-                        protocol_create_player_status(response, sizeof(response),
-                                                      nickname, STATUS_RECONNECTED);
-                        server_send_to_player(opponent, response);
-                    }
-                }
-            }
-        } else {
-            player_set_state(player, PLAYER_STATE_LOBBY);
+        if (line_len == 0) continue;
+        
+        /* OCHRANA: Zkontroluj, zda zprava obsahuje pouze validni znaky */
+        if (!is_valid_protocol_data(line, line_len)) {
+            LOG_WARNING("Binary/invalid data from '%s', counting as invalid message",
+                        player->nickname[0] ? player->nickname : "(unknown)");
+            reject_invalid_message(server, player);
+            continue;
         }
         
-        return;
+        /* OCHRANA: Rate limiting */
+        if (!check_rate_limit(player)) {
+            LOG_WARNING("Rate limit exceeded for '%s'",
+                        player->nickname[0] ? player->nickname : "(unknown)");
+            player->invalid_message_count++;
+            /* Preskoc tuto zpravu, ale pokracuj */
+            continue;
+        }
+        
+        LOG_DEBUG("Received from '%s': %s",
+                  player->nickname[0] ? player->nickname : "(unknown)", line);
+        
+        /* Volitelne ID pozadavku se vraci v odpovedich (pipelining) */
+        const char *message = protocol_split_request_id(line, player->request_id,
+                                                        sizeof(player->request_id));
+        if (message == NULL) {
+            /* Chybne ID - zprava se zapocita jako nevalidni */
+            server_handle_message(server, player, line);
+            continue;
+        }
+        server_handle_message(server, player, message);
+        player->request_id[0] = '\0';
     }
+}
+
+/* ============================================
+ * HODINY TAHU
+ * ============================================ */
+
+/**
+ * Spusti hodiny hrace, ktery je prave na tahu - kazdy tah ma plny cas
+ * z pravidel. V mistnosti bez hodin nebo mimo bezici hru hodiny zastavi.
+ * Terminy drzi halda serveru, vyprseni se neprochazi v kazde iteraci.
+ */
+static void start_turn_clock(Server *server, Room *room) {
+    int slot = (int)(room - server->rooms);
     
-    /* Kontrola, zda prezdivka neni obsazena */
-    Player *existing = player_find_by_nickname(server->players, 
-                                               server->config.max_clients, 
-                                               nickname);
-    if (existing != NULL) {
-        protocol_create_login_err(response, sizeof(response), 
-                                  ERR_NICKNAME_TAKEN, NULL);
-        server_send_to_player(player, response);
+    if (room->game.rules.move_seconds <= 0 || room->game.state != GAME_STATE_PLAYING) {
+        room->turn_deadline = 0;
+        timer_cancel(&server->turn_clocks, slot);
         return;
     }
     
-    /* Uspesny login */
-    player_set_nickname(player, nickname);
-    player_set_state(player, PLAYER_STATE_LOBBY);
-    
-    protocol_create_login_ok(response, sizeof(response));
-    server_send_to_player(player, response);
+    room->turn_deadline = timer_now_ms() + (int64_t)room->game.rules.move_seconds * 1000;
+    timer_schedule(&server->turn_clocks, slot, room->turn_deadline);
+}
+
+/**
+ * Zastavi hodiny mistnosti (konec nebo pozastaveni hry)
+ */
+static void stop_turn_clock(Server *server, Room *room) {
+    room->turn_deadline = 0;
+    timer_cancel(&server->turn_clocks, (int)(room - server->rooms));
+}
+
+/**
+ * Vrati zbyvajici cas hrace na tahu v ms
+ * @return 0 pokud hodiny nebezi, jinak alespon 1
+ */
+static int turn_clock_left(const Room *room) {
+    if (room->turn_deadline == 0) return 0;
     
-    LOG_INFO("Player '%s' logged in", nickname);
+    int64_t left = room->turn_deadline - timer_now_ms();
+    return left > 0 ? (int)left : 1;
 }
 
+/* ============================================
+ * DIVACI
+ * ============================================ */
+
 /**
- * Zpracuje LIST_ROOMS
+ * Zaradi sdilenou zpravu do odchozi fronty divaka
+ * Pretece-li fronta, cekajici udalosti se zahodi a po jejim vyprazdneni
+ * dostane divak aktualni stav hry (WATCH_OK). Dokud resync ceka, dalsi
+ * udalosti se zahazuji.
  */
-static void handle_list_rooms(Server *server, Player *player, ParsedMessage *msg) {
-    (void)msg;
-    char response[BUFFER_SIZE];
-    char rooms_data[BUFFER_SIZE - 64];
+static void queue_to_spectator(Player *spectator, SharedMessage *msg) {
+    if (spectator->socket_fd < 0 || spectator->resync_pending) return;
     
-    if (player->state == PLAYER_STATE_CONNECTING) {
-        protocol_create_error(response, sizeof(response), ERR_NOT_LOGGED_IN, NULL);
-        server_send_to_player(player, response);
-        return;
+    if (!outqueue_push(&spectator->out_queue, msg)) {
+        outqueue_drop_pending(&spectator->out_queue);
+        spectator->resync_pending = true;
+        spectator->lag_since = sysio_time();
+        LOG_WARNING("Spectator '%s' is lagging, events dropped until resync",
+                    spectator->nickname);
     }
-    
-    room_list_to_string(server->rooms, server->config.max_rooms, 
-                        rooms_data, sizeof(rooms_data));
-    protocol_create_rooms(response, sizeof(response), rooms_data);
-    server_send_to_player(player, response);
 }
 
 /**
- * Zpracuje CREATE_ROOM
+ * Vytvori sdilenou zpravu ve formatu spojeni prijemce
  */
-static void handle_create_room(Server *server, Player *player, ParsedMessage *msg) {
-    char response[BUFFER_SIZE];
-    
+static SharedMessage* shared_message_for(const Player *player, const char *message,
+                                         size_t len) {
+    char frame[2 * BUFFER_SIZE];
+    const char *data = encode_for_player(player, message, &len, frame, sizeof(frame));
+    return data == NULL ? NULL : shared_message_create(data, len);
+}
+
+/**
+ * Rozesle udalost divakum mistnosti - zprava se zkopiruje jednou do sdileneho
+ * bufferu (pro kazdy format spojeni), fronty divaku drzi jen ukazatel
+ */
+static void broadcast_to_spectators(Server *server, Room *room, const char *message,
+                                    size_t len) {
+    if (room->spectator_count == 0) return;
+    
+    SharedMessage *formats[WIRE_FORMATS] = { NULL };
+    
+    for (int i = room->spectator_head; i >= 0; i = server->players[i].next_spectator) {
+        Player *spectator = &server->players[i];
+        SharedMessage **shared = &formats[wire_format(spectator)];
+        if (*shared == NULL) {
+            *shared = shared_message_for(spectator, message, len);
+            if (*shared == NULL) {
+                LOG_ERROR("Out of memory for spectator broadcast in room %d", room->id);
+                continue;
+            }
+        }
+        queue_to_spectator(spectator, *shared);
+    }
+    
+    for (int i = 0; i < WIRE_FORMATS; i++) {
+        if (formats[i] != NULL) shared_message_release(formats[i]);
+    }
+}
+
+/**
+ * Vytvori zpravu WATCH_OK s aktualnim stavem hry v mistnosti
+ * @return Delka zpravy
+ */
+static int create_watch_state(Room *room, char *buffer, int size) {
+    char players[ROOM_PLAYER_LIST_SIZE];
+    const char *current = "";
+    
+    if (room->game.state == GAME_STATE_PLAYING || room->game.state == GAME_STATE_PAUSED) {
+        Player *on_turn = room->players[room->game.current_player];
+        if (on_turn != NULL) current = on_turn->nickname;
+    }
+    
+    room_players_to_string(room, players, sizeof(players));
+    return protocol_create_watch_ok(buffer, size, room->id, room->game.state,
+                             game_get_stones(&room->game), current,
+                             &room->game.rules, room->game.piles, players,
+                             turn_clock_left(room));
+}
+
+/**
+ * Ukonci sledovani mistnosti a vrati divaka do lobby
+ */
+static void stop_watching(Server *server, Player *spectator) {
+    /* Primo slot - zaniklou mistnost room_find_by_id nevrati */
+    int slot = room_id_to_slot(spectator->watch_room_id);
+    if (spectator->watch_room_id >= 0 && slot >= 0 && slot < server->config.max_rooms) {
+        room_remove_spectator(&server->rooms[slot], server->players, spectator);
+    }
+    spectator->watch_room_id = -1;
+    spectator->next_spectator = -1;
+    spectator->resync_pending = false;
+    
+    if (spectator->state == PLAYER_STATE_WATCHING) {
+        player_set_state(spectator, PLAYER_STATE_LOBBY);
+    }
+}
+
+/**
+ * Uvolni vsechny divaky mistnosti (konec hry nebo zanik mistnosti)
+ * @param notify Poslat UNWATCH_OK (po GAME_OVER neni potreba)
+ */
+static void release_spectators(Server *server, Room *room, bool notify) {
+    char response[BUFFER_SIZE];
+    int len;
+    len = protocol_create_unwatch_ok(response, sizeof(response));
+    
+    while (room->spectator_head >= 0) {
+        Player *spectator = &server->players[room->spectator_head];
+        stop_watching(server, spectator);
+        if (notify) {
+            server_send_to_player(spectator, response, len);
+        }
+    }
+}
+
+/**
+ * Vyprazdni odchozi fronty - kazde spojeni s cekajicimi zpravami (odpovedi
+ * i udalosti cele iterace) dostane jediny neblokujici writev(); divakovi,
+ * ktery nestihal, posle po vyprazdneni aktualni stav hry
+ */
+static void flush_out_queues(Server *server) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    for (int i = 0; i < server->config.max_clients; i++) {
+        Player *player = &server->players[i];
+        if (!player->is_active || player->socket_fd < 0) continue;
+        if (player->out_overflow) {
+            server_handle_disconnect(server, player, false);
+            continue;
+        }
+        if (outqueue_is_empty(&player->out_queue) && !player->resync_pending) continue;
+        
+        bool ok = outqueue_flush(&player->out_queue, player->socket_fd);
+        
+        if (ok && player->resync_pending && outqueue_is_empty(&player->out_queue)) {
+            player->resync_pending = false;
+            Room *room = room_find_by_id(server->rooms, server->config.max_rooms,
+                                         player->watch_room_id);
+            SharedMessage *state = NULL;
+            if (room != NULL) {
+                len = create_watch_state(room, response, sizeof(response));
+                state = shared_message_for(player, response, len);
+            }
+            if (state != NULL) {
+                outqueue_push(&player->out_queue, state);
+                shared_message_release(state);
+                ok = outqueue_flush(&player->out_queue, player->socket_fd);
+                LOG_INFO("Spectator '%s' resynced to room %d", player->nickname, room->id);
+            }
+        }
+        
+        if (!ok) {
+            LOG_WARNING("Failed to flush queue of '%s': %s", player->nickname, strerror(errno));
+            server_handle_disconnect(server, player, false);
+        }
+    }
+}
+
+/* ============================================
+ * ZPRACOVANI ZPRAV
+ * ============================================ */
+
+/**
+ * Zaznamena konec hry do zurnalu
+ * @param winner Vitez (NULL = hra skoncila bez viteze)
+ */
+static void journal_game_over(Server *server, Room *room, Player *winner, JournalEndReason reason) {
+    int winner_idx = winner != NULL ? room_get_player_index(room, winner) : -1;
+    journal_record(&server->journal, JOURNAL_EV_GAME_OVER, room, winner_idx, reason);
+}
+
+/**
+ * Vrati hrace z mistnosti do lobby; bota rovnou uvolni
+ */
+static void leave_to_lobby(Room *room, Player *player) {
+    room_remove_player(room, player);
+    if (player->is_bot) {
+        player_reset(player, false);
+    } else {
+        player_set_state(player, PLAYER_STATE_LOBBY);
+    }
+}
+
+/**
+ * Zrusi mistnost, ve ktere zustali jen boti (posledni clovek odesel)
+ */
+static void dismiss_idle_bots(Room *room) {
+    if (!room->is_active) return;
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        if (room->players[i] != NULL && !room->players[i]->is_bot) return;
+    }
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS && room->is_active; i++) {
+        if (room->players[i] != NULL) {
+            leave_to_lobby(room, room->players[i]);
+        }
+    }
+}
+
+/**
+ * Uklid po odchodu hrace z mistnosti - zrusi mistnost, ve ktere zustali
+ * jen boti, a uvolni divaky zanikle mistnosti
+ */
+static void room_vacated(Server *server, Room *room) {
+    dismiss_idle_bots(room);
+    if (!room->is_active) {
+        stop_turn_clock(server, room);
+        release_spectators(server, room, true);
+    }
+}
+
+static void tournament_match_over(Server *server, int round, Player *winner);
+
+/**
+ * Zapise vysledek hry do hodnoceni; hodnoceni vede jen SHARD_HOME,
+ * ostatni shardy mu vysledek poslou pres router
+ */
+static void record_rating(Server *server, const char *winner, const char *loser) {
+    if (server->config.shard_fd < 0 || server->config.shard_index == SHARD_HOME) {
+        ratings_record_game(&server->ratings, winner, loser);
+        server->shard_dirty = true;
+        return;
+    }
+    
+    ShardMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = SHARD_MSG_RATING;
+    msg.source = server->config.shard_index;
+    msg.target = SHARD_HOME;
+    snprintf(msg.names[0], sizeof(msg.names[0]), "%s", winner);
+    snprintf(msg.names[1], sizeof(msg.names[1]), "%s", loser);
+    if (!shard_send(server->config.shard_fd, &msg, -1)) {
+        LOG_WARNING("Result '%s' over '%s' not rated", winner, loser);
+    }
+}
+
+/**
+ * Ukonci hru - zaznamena konec, posle GAME_OVER pripojenym hracum
+ * (krome except) a vrati je do lobby
+ * Odpojeni hraci zustavaji v mistnosti do vyprseni reconnect timeoutu.
+ * @param winner Vitez (NULL = hra skoncila bez viteze, GAME_OVER se neposila)
+ * @param except Hrac, kteremu se GAME_OVER neposila (odchazejici) nebo NULL
+ */
+static void end_game(Server *server, Room *room, Player *winner, Player *loser,
+                     JournalEndReason reason, Player *except) {
+    char response[BUFFER_SIZE];
+    int len;
+    int tournament_round = room->tournament_round;
+    
+    room->game.state = GAME_STATE_FINISHED;
+    stop_turn_clock(server, room);
+    journal_game_over(server, room, winner, reason);
+    if (winner == NULL || loser == NULL) {
+        release_spectators(server, room, true);
+        tournament_match_over(server, tournament_round, NULL);
+        return;
+    }
+    
+    len = protocol_create_game_over(response, sizeof(response),
+                               winner->nickname, loser->nickname);
+    server_broadcast_to_room(room, response, len, except);
+    
+    /* Hry s botem se do hodnoceni nepocitaji */
+    if (!winner->is_bot && !loser->is_bot) {
+        record_rating(server, winner->nickname, loser->nickname);
+    }
+    
+    /* Divaci dostanou GAME_OVER a tim sledovani konci */
+    broadcast_to_spectators(server, room, response, len);
+    release_spectators(server, room, false);
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS && room->is_active; i++) {
+        Player *p = room->players[i];
+        if (p != NULL && p != except && player_is_online(p)) {
+            leave_to_lobby(room, p);
+        }
+    }
+    
+    tournament_match_over(server, tournament_round, winner);
+}
+
+/**
+ * Ukonci hry, ve kterych hraci na tahu vyprsel cas - prohrava, vitezem je
+ * dalsi pripojeny hrac v poradi. Vybira jen vyprsele terminy z vrcholu haldy.
+ */
+static void expire_turn_clocks(Server *server) {
+    int64_t now = timer_now_ms();
+    int slot;
+    
+    while ((slot = timer_pop_expired(&server->turn_clocks, now)) >= 0) {
+        Room *room = &server->rooms[slot];
+        if (!room->is_active || room->game.state != GAME_STATE_PLAYING ||
+            room->turn_deadline == 0) {
+            continue;
+        }
+        room->turn_deadline = 0;
+        
+        Player *player = room->players[room->game.current_player];
+        if (player == NULL) continue;
+        
+        LOG_INFO("Player '%s' ran out of time in room '%s'", player->nickname, room->name);
+        end_game(server, room, room_get_next_online(room, player), player,
+                 JOURNAL_END_CLOCK, NULL);
+    }
+}
+
+/**
+ * Zacne hru v plne mistnosti a posle GAME_START pripojenym hracum
+ */
+static void start_game(Server *server, Room *room) {
+    char response[BUFFER_SIZE];
+    int len;
+    char players[ROOM_PLAYER_LIST_SIZE];
+    
+    room_start_game(room);
+    start_turn_clock(server, room);
+    journal_game_start(&server->journal, room);
+    room_players_to_string(room, players, sizeof(players));
+    
+    /* Divaci dostanou jednu spolecnou verzi (nejsou na tahu, souperem je prvni hrac) */
+    len = protocol_create_game_start(response, sizeof(response),
+                               game_get_stones(&room->game), false,
+                               room->players[0] ? room->players[0]->nickname : "",
+                               &room->game.rules, room->game.piles, players);
+    broadcast_to_spectators(server, room, response, len);
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        Player *p = room->players[i];
+        if (p != NULL && p->socket_fd >= 0) {
+            Player *opp = room_get_opponent(room, p);
+            bool my_turn = game_is_player_turn(&room->game, i);
+            len = protocol_create_game_start(response, sizeof(response),
+                                        game_get_stones(&room->game),
+                                        my_turn,
+                                        opp ? opp->nickname : "",
+                                        &room->game.rules,
+                                        room->game.piles,
+                                        players);
+            server_send_to_player(p, response, len);
+        }
+    }
+}
+
+/* ============================================
+ * TURNAJ
+ * ============================================ */
+
+/**
+ * Muze hrac ze slotu nastoupit k zapasu? (ceka v turnaji a je pripojeny)
+ */
+static bool tournament_ready(Server *server, int slot) {
+    Player *player = &server->players[slot];
+    return player->is_active && player->socket_fd >= 0 &&
+           player->state == PLAYER_STATE_TOURNAMENT;
+}
+
+/**
+ * Posle hraci oznameni o postupu z kola
+ */
+static void notify_advance(Server *server, int slot, int round) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (!tournament_ready(server, slot)) return;
+    len = protocol_create_tournament_advance(response, sizeof(response), round);
+    server_send_to_player(&server->players[slot], response, len);
+}
+
+/**
+ * Ukonci turnaj - vitez (nebo vsichni cekajici pri zruseni) se vraci do lobby
+ * a lobby dostane TOURNAMENT_OVER
+ * @param champion Vitez turnaje (NULL = turnaj zrusen nebo bez viteze)
+ */
+static void finish_tournament(Server *server, Player *champion) {
+    Tournament *t = &server->tournament;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    for (int i = 0; i < server->config.max_clients; i++) {
+        if (server->players[i].is_active &&
+            server->players[i].state == PLAYER_STATE_TOURNAMENT) {
+            player_set_state(&server->players[i], PLAYER_STATE_LOBBY);
+        }
+    }
+    
+    LOG_INFO("Tournament '%s' finished after %d rounds, winner: %s", t->name, t->round,
+             champion ? champion->nickname : "(none)");
+    
+    len = protocol_create_tournament_over(response, sizeof(response), t->name,
+                                    champion ? champion->nickname : "");
+    server_broadcast_to_lobby(server, response, len);
+    tournament_close(t);
+}
+
+/**
+ * Zalozi mistnost zapasu ve volnem slotu, posadi do ni oba hrace,
+ * oznami jim parovani a hru rovnou zahaji
+ */
+static void open_match(Server *server, int slot, Player *first, Player *second) {
+    Tournament *t = &server->tournament;
+    Room *room = &server->rooms[slot];
+    char name[MAX_ROOM_NAME_LENGTH + 1];
+    char response[BUFFER_SIZE];
+    int len;
+    
+    snprintf(name, sizeof(name), "%.40s#%d.%d", t->name, t->round, t->next_pair / 2);
+    room_open(room, slot, name, &t->rules);
+    room->tournament_round = t->round;
+    room_add_player(room, first);
+    room_add_player(room, second);
+    t->matches_running++;
+    
+    len = protocol_create_tournament_match(response, sizeof(response), t->round, room->id,
+                                     second->nickname);
+    server_send_to_player(first, response, len);
+    len = protocol_create_tournament_match(response, sizeof(response), t->round, room->id,
+                                     first->nickname);
+    server_send_to_player(second, response, len);
+    
+    start_game(server, room);
+}
+
+/**
+ * Rozehraje cekajici zapasy kola ve volnych mistnostech a po dohrani kola
+ * zacne dalsi. Volne mistnosti se hledaji jednim pruchodem pole, zapasy bez
+ * volne mistnosti pockaji na dalsi volani (po dohrani jineho zapasu).
+ * Hrac, ktery k zapasu nenastoupi (odpojil se nebo odstoupil), prohrava
+ * kontumacne.
+ */
+static void tournament_schedule(Server *server) {
+    Tournament *t = &server->tournament;
+    int free_slot = 0;
+    int first, second;
+    
+    while (t->state == TOURNAMENT_RUNNING) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int opened = 0;
+        
+        for (;;) {
+            while (free_slot < server->config.max_rooms && server->rooms[free_slot].is_active) {
+                free_slot++;
+            }
+            if (free_slot >= server->config.max_rooms ||
+                !tournament_next_match(t, &first, &second)) {
+                break;
+            }
+            
+            bool first_ready = tournament_ready(server, first);
+            bool second_ready = tournament_ready(server, second);
+            if (first_ready && second_ready) {
+                open_match(server, free_slot, &server->players[first], &server->players[second]);
+                opened++;
+            } else if (first_ready || second_ready) {
+                int slot = first_ready ? first : second;
+                tournament_advance(t, slot);
+                notify_advance(server, slot, t->round);
+            }
+        }
+        
+        if (opened > 0) {
+            struct timespec end;
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            LOG_INFO("Tournament '%s' round %d: %d matches seated in %.2f ms",
+                     t->name, t->round, opened,
+                     (end.tv_sec - start.tv_sec) * 1000.0 +
+                     (end.tv_nsec - start.tv_nsec) / 1000000.0);
+        }
+        
+        if (!tournament_round_done(t)) return;
+        
+        /* Kolo dohrano - posledni postupujici vyhral turnaj */
+        if (t->advanced_count <= 1) {
+            int slot = t->advanced_count == 1 ? t->advanced[0] : -1;
+            finish_tournament(server, slot >= 0 && tournament_ready(server, slot)
+                                      ? &server->players[slot] : NULL);
+            return;
+        }
+        
+        int bye = tournament_begin_round(t);
+        LOG_INFO("Tournament '%s' round %d: %d entrants", t->name, t->round, t->entrant_count);
+        if (bye >= 0) {
+            notify_advance(server, bye, t->round);
+        }
+        free_slot = 0;
+    }
+}
+
+/**
+ * Zaznamena vysledek zapasu turnaje - vitez ceka na dalsi kolo, porazeny
+ * zustava v lobby. Dalsi zapasy se rozehraji na konci iterace smycky,
+ * az volajici dokonci uklid mistnosti.
+ * @param round Kolo turnaje mistnosti (0 = bezna mistnost)
+ * @param winner Vitez zapasu (NULL = nikdo nepostupuje)
+ */
+static void tournament_match_over(Server *server, int round, Player *winner) {
+    Tournament *t = &server->tournament;
+    
+    if (round == 0 || t->state != TOURNAMENT_RUNNING || round != t->round) return;
+    
+    t->matches_running--;
+    server->tournament_pending = true;
+    
+    if (winner != NULL && player_is_online(winner) && winner->state == PLAYER_STATE_LOBBY) {
+        int slot = (int)(winner - server->players);
+        player_set_state(winner, PLAYER_STATE_TOURNAMENT);
+        tournament_advance(t, slot);
+        notify_advance(server, slot, round);
+    }
+}
+
+/**
+ * Odhlasi hrace z turnaje. Pri registraci zakladatel turnaj rusi, behem
+ * turnaje zustava hrac v pavouku a souper postoupi kontumacne.
+ */
+static void tournament_withdraw(Server *server, Player *player) {
+    Tournament *t = &server->tournament;
+    int slot = (int)(player - server->players);
+    
+    player_set_state(player, PLAYER_STATE_LOBBY);
+    if (t->state != TOURNAMENT_REGISTERING) return;
+    
+    if (slot == t->organizer) {
+        finish_tournament(server, NULL);
+    } else {
+        tournament_unregister(t, slot);
+    }
+}
+
+/* ============================================
+ * RYCHLA HRA
+ * ============================================ */
+
+/**
+ * Vrati ELO hrace (hrac bez odehrane hry ma pocatecni)
+ */
+static int player_rating(Server *server, const Player *player) {
+    const RatingEntry *entry = ratings_get(&server->ratings, player->nickname);
+    return entry != NULL ? entry->rating : RATING_INITIAL;
+}
+
+static int find_free_room(Server *server, int from) {
+    while (from < server->config.max_rooms && server->rooms[from].is_active) from++;
+    return from < server->config.max_rooms ? from : -1;
+}
+
+/**
+ * Vyradi sparovanou dvojici z fronty, posadi ji do nove mistnosti
+ * s klasickymi pravidly a hru zahaji; zacina dele cekajici hrac
+ */
+static void open_quick_match(Server *server, int room_slot, int first, int second,
+                             int64_t now) {
+    MatchQueue *queue = &server->match_queue;
+    Player *a = &server->players[first];
+    Player *b = &server->players[second];
+    Room *room = &server->rooms[room_slot];
+    char name[MAX_ROOM_NAME_LENGTH + 1];
+    char response[BUFFER_SIZE];
+    int len;
+    
+    int rating_a = queue->rating[first];
+    int rating_b = queue->rating[second];
+    int64_t since = queue->since[first] < queue->since[second] ?
+                    queue->since[first] : queue->since[second];
+    if (queue->since[second] < queue->since[first]) {
+        Player *tmp = a; a = b; b = tmp;
+        int r = rating_a; rating_a = rating_b; rating_b = r;
+    }
+    
+    stats_record_match(&server->stats, (long)(now - since), abs(rating_a - rating_b));
+    matchqueue_remove(queue, first);
+    matchqueue_remove(queue, second);
+    
+    snprintf(name, sizeof(name), "Quick#%u", ++server->quick_match_seq);
+    room_open(room, room_slot, name, game_preset_rules(GAME_PRESET_CLASSIC));
+    room_add_player(room, a);
+    room_add_player(room, b);
+    
+    LOG_INFO("Quick match '%s' (%d) vs '%s' (%d) after %ld ms in room '%s'",
+             a->nickname, rating_a, b->nickname, rating_b, (long)(now - since), name);
+    
+    len = protocol_create_quick_match_found(response, sizeof(response), room->id,
+                                      b->nickname, rating_b);
+    server_send_to_player(a, response, len);
+    len = protocol_create_quick_match_found(response, sizeof(response), room->id,
+                                      a->nickname, rating_a);
+    server_send_to_player(b, response, len);
+    
+    start_game(server, room);
+}
+
+/**
+ * Zkusi najit soupere pro hrace, ktery se prave zaradil do fronty
+ */
+static void quick_match_try(Server *server, int slot) {
+    int64_t now = timer_now_ms();
+    int partner = matchqueue_find(&server->match_queue, slot, now);
+    if (partner < 0) return;
+    
+    int room_slot = find_free_room(server, 0);
+    if (room_slot < 0) {
+        LOG_WARNING("Quick match: no free room, players keep waiting");
+        return;
+    }
+    open_quick_match(server, room_slot, partner, slot, now);
+}
+
+/**
+ * Sparuje dvojice, ktere uz dovoluji rozsirena okna cekajicich hracu.
+ * Vola se jednou za sekundu - okno roste s casem, ne s prichody.
+ */
+static void quick_match_schedule(Server *server) {
+    MatchQueue *queue = &server->match_queue;
+    int64_t now = timer_now_ms();
+    int room_slot = 0;
+    int first, second;
+    
+    while (queue->waiting >= 2) {
+        room_slot = find_free_room(server, room_slot);
+        if (room_slot < 0 || !matchqueue_find_pair(queue, now, &first, &second)) return;
+        open_quick_match(server, room_slot, first, second, now);
+    }
+}
+
+/**
+ * Vyradi hrace z fronty rychle hry a vrati ho do lobby
+ */
+static void quick_match_leave(Server *server, Player *player) {
+    matchqueue_remove(&server->match_queue, (int)(player - server->players));
+    player_set_state(player, PLAYER_STATE_LOBBY);
+}
+
+static void bot_play(Server *server, Room *room);
+
+/**
+ * Zpracuje LOGIN
+ */
+static void handle_login(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    /* Kontrola stavu */
+    if (player->state != PLAYER_STATE_CONNECTING) {
+        len = protocol_create_login_err(response, sizeof(response), 
+                                  ERR_ALREADY_LOGGED_IN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Kontrola parametru */
+    if (msg->param_count < 1) {
+        len = protocol_create_login_err(response, sizeof(response), 
+                                  ERR_INVALID_PARAMS, "Missing nickname");
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    const char *nickname = msg->params[0];
+    
+    /* Validace prezdivky */
+    ErrorCode err = protocol_validate_nickname(nickname);
+    if (err != ERR_NONE) {
+        len = protocol_create_login_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    /* Kontrola, zda prezdivka neni obsazena - i odpojenym hracem, ktery
+     * se muze vratit jen pres RESUME se svym tokenem */
+    Player *existing = player_find_by_nickname(server->players, 
+                                               server->config.max_clients, 
+                                               nickname);
+    if (existing != NULL ||
+        (server->config.shard_fd >= 0 &&
+         shard_find_nickname(server->config.shard_summary, server->config.shard_index,
+                             nickname) >= 0)) {
+        len = protocol_create_login_err(response, sizeof(response), 
+                                  ERR_NICKNAME_TAKEN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Uspesny login */
+    player_set_nickname(player, nickname);
+    player_set_state(player, PLAYER_STATE_LOBBY);
+    
+    char token[SESSION_TOKEN_HEX_LENGTH + 1] = "";
+    if (session_issue(&server->sessions, server->players, player)) {
+        session_token_to_hex(player, token, sizeof(token));
+    }
+    server->shard_dirty = true;
+    
+    len = protocol_create_login_ok(response, sizeof(response), token);
+    server_send_to_player(player, response, len);
+    
+    LOG_INFO("Player '%s' logged in", nickname);
+}
+
+/**
+ * Posle hraci vracejicimu se do hry jeji stav a obnovi ji,
+ * pokud jsou pripojeni i vsichni ostatni hraci
+ */
+static void resume_game(Server *server, Player *player) {
+    char response[BUFFER_SIZE];
+    int len;
+    char players[ROOM_PLAYER_LIST_SIZE];
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        player->room_id = -1;
+        player_set_state(player, PLAYER_STATE_LOBBY);
+        return;
+    }
+    
+    player_set_state(player, PLAYER_STATE_IN_GAME);
+    
+    /* Obnov hru, pokud byla pozastavena. Odpojenych muze byt vic
+     * (po obnove ze snapshotu vsichni) - hra pak zustava
+     * pozastavena, dokud se nevrati vsichni. */
+    if (room->game.state == GAME_STATE_PAUSED && room_others_online(room, player)) {
+        game_resume(&room->game);
+        start_turn_clock(server, room);
+        journal_record(&server->journal, JOURNAL_EV_RESUME, room,
+                       room_get_player_index(room, player), 0);
+    }
+    
+    /* Posli stav hry */
+    int player_idx = room_get_player_index(room, player);
+    bool my_turn = room->game.current_player == player_idx;
+    int next_idx = game_next_player(&room->game, player_idx);
+    room_players_to_string(room, players, sizeof(players));
+    
+    len = protocol_create_game_resumed(response, sizeof(response),
+                                  game_get_stones(&room->game),
+                                  my_turn,
+                                  player->skips_remaining,
+                                  room->game.player_skips[next_idx],
+                                  &room->game.rules,
+                                  room->game.piles,
+                                  players,
+                                  turn_clock_left(room));
+    server_send_to_player(player, response, len);
+    
+    /* Informuj ostatni hrace, a vraceneho hrace o dosud odpojenych */
+    len = protocol_create_player_status(response, sizeof(response),
+                                  player->nickname, STATUS_RECONNECTED);
+    server_broadcast_to_room(room, response, len, player);
+    broadcast_to_spectators(server, room, response, len);
+    
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        Player *other = room->players[i];
+        if (other != NULL && other != player && !player_is_online(other)) {
+            len = protocol_create_player_status(response, sizeof(response),
+                                          other->nickname, STATUS_DISCONNECTED);
+            server_send_to_player(player, response, len);
+        }
+    }
+    
+    /* Hra proti botovi pokracuje hned */
+    bot_play(server, room);
+}
+
+/**
+ * Zpracuje RESUME - navrat do puvodni session podle tokenu
+ * Nove spojeni se presune primo do slotu puvodniho hrace, ukazatele
+ * v mistnosti tak zustavaji platne a nic se nekopiruje.
+ */
+static void handle_resume(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_CONNECTING) {
+        len = protocol_create_resume_err(response, sizeof(response),
+                                   ERR_ALREADY_LOGGED_IN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    if (msg->param_count < 1) {
+        len = protocol_create_resume_err(response, sizeof(response),
+                                   ERR_INVALID_PARAMS, "Missing token");
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    Player *session = session_find(&server->sessions, server->players, msg->params[0]);
+    if (session == NULL || session == player) {
+        len = protocol_create_resume_err(response, sizeof(response),
+                                   ERR_INVALID_SESSION, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    LOG_INFO("Player '%s' resuming session", session->nickname);
+    
+    /* Stare spojeni mohlo zustat polootevrene - nove ho nahrazuje */
+    if (session->socket_fd >= 0) {
+        LOG_INFO("Closing stale connection of '%s'", session->nickname);
+        sysio_close(session->socket_fd);
+    }
+    
+    /* Neodeslany zbytek (i rozepsany radek) patril staremu spojeni */
+    outqueue_clear(&session->out_queue);
+    
+    /* Odpovedi na zpravy pred RESUME ze stejne davky jeste cekaji ve fronte
+     * noveho spojeni - fronta se presune i s nimi, player_reset by je zahodil */
+    session->out_queue = player->out_queue;
+    session->out_overflow = player->out_overflow;
+    outqueue_init(&player->out_queue);
+    
+    /* Presun spojeni vcetne zbytku prijimaciho bufferu */
+    session->socket_fd = player->socket_fd;
+    memcpy(session->request_id, player->request_id, sizeof(session->request_id));
+    memcpy(session->recv_buffer, player->recv_buffer, player->recv_buffer_len + 1);
+    session->recv_buffer_len = player->recv_buffer_len;
+    session->ws = player->ws;
+    session->last_activity = player->last_activity;
+    session->messages_this_second = player->messages_this_second;
+    session->rate_limit_second = player->rate_limit_second;
+    session->disconnect_time = 0;
+    session->last_ping = 0;
+    session->waiting_pong = false;
+    session->invalid_message_count = 0;
+    
+    player->socket_fd = -1;
+    player_reset(player, false);
+    server->shard_dirty = true;
+    
+    /* RESUME_OK jde jeste textove, dalsi zpravy v rezimu noveho spojeni */
+    session->binary = false;
+    len = protocol_create_resume_ok(response, sizeof(response), session->nickname);
+    server_send_to_player(session, response, len);
+    session->binary = protocol_wants_binary(msg) && session->ws.state == WS_STATE_NONE;
+    
+    if (session->room_id >= 0) {
+        resume_game(server, session);
+    } else {
+        player_set_state(session, PLAYER_STATE_LOBBY);
+    }
+    
+    /* ID z RESUME patri jen odpovedi - dalsi udalosti jdou bez ID */
+    session->request_id[0] = '\0';
+    
+    /* Zpravy poslane hned za RESUME uz patri puvodnimu slotu */
+    process_messages(server, session);
+}
+
+/**
+ * Popis mistnosti hostovane jinym uzlem registru pro ROOM_NOT_FOUND
+ * @return Text zpravy nebo NULL (mistnost neexistuje nikde)
+ */
+static const char* remote_room_hint(Server *server, int room_id, char *buffer, int size) {
+    char address[80];
+    if (!registry_find_room(&server->registry, room_id, address, sizeof(address))) {
+        return NULL;
+    }
+    snprintf(buffer, size, "Room is hosted by %s", address);
+    return buffer;
+}
+
+/**
+ * Zpracuje LIST_ROOMS
+ */
+static void handle_list_rooms(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    char rooms_data[BUFFER_SIZE - 64];
+    
+    if (player->state == PLAYER_STATE_CONNECTING) {
+        len = protocol_create_error(response, sizeof(response), ERR_NOT_LOGGED_IN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Shard sklada seznam ze sdileneho prehledu vsech shardu */
+    if (server->config.shard_fd >= 0) {
+        shard_room_list_to_string(server->config.shard_summary, server->config.shard_index,
+                                  server->rooms, rooms_data, sizeof(rooms_data));
+    } else if (server->registry.backend != NULL) {
+        /* Uzel registru pridava mistnosti ostatnich serveru */
+        registry_room_list_to_string(&server->registry, server->rooms,
+                                     rooms_data, sizeof(rooms_data));
+    } else {
+        room_list_to_string(server->rooms, server->config.max_rooms, 
+                            rooms_data, sizeof(rooms_data));
+    }
+    len = protocol_create_rooms(response, sizeof(response), rooms_data);
+    server_send_to_player(player, response, len);
+}
+
+/**
+ * Zpracuje CREATE_ROOM
+ */
+static void handle_create_room(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_LOBBY) {
+        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ? 
+                        ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
+        len = protocol_create_room_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    if (msg->param_count < 1) {
+        len = protocol_create_room_err(response, sizeof(response), 
+                                 ERR_INVALID_PARAMS, "Missing room name");
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    const char *room_name = msg->params[0];
+    
+    /* Validace nazvu */
+    ErrorCode err = protocol_validate_room_name(room_name);
+    if (err != ERR_NONE) {
+        len = protocol_create_room_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    /* Pravidla mistnosti (volitelne parametry key=value) */
+    GameRules rules;
+    err = protocol_parse_rules(msg, 1, &rules);
+    if (err != ERR_NONE) {
+        len = protocol_create_room_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    /* Kontrola limitu mistnosti */
+    if (room_count_active(server->rooms, server->config.max_rooms) >= server->config.max_rooms) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_MAX_ROOMS, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Nazev musi byt volny i na ostatnich shardech */
+    if (server->config.shard_fd >= 0 &&
+        shard_find_room_name(server->config.shard_summary, server->config.shard_index,
+                             room_name) >= 0) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_ROOM_NAME_TAKEN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Vytvor mistnost */
+    int room_id = room_create(server->rooms, server->config.max_rooms, room_name, player, &rules);
+    if (room_id < 0) {
+        /* Nazev obsazen nebo jina chyba */
+        len = protocol_create_room_err(response, sizeof(response), ERR_ROOM_NAME_TAKEN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    player_set_state(player, PLAYER_STATE_IN_ROOM);
+    
+    len = protocol_create_room_created(response, sizeof(response), room_id);
+    server_send_to_player(player, response, len);
+    
+    /* Posli WAIT_OPPONENT */
+    len = protocol_create_wait_opponent(response, sizeof(response));
+    server_send_to_player(player, response, len);
+}
+
+/**
+ * Zpracuje JOIN_ROOM
+ */
+static void handle_join_room(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
     if (player->state != PLAYER_STATE_LOBBY) {
         ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ? 
                         ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
-        protocol_create_room_err(response, sizeof(response), err, NULL);
-        server_send_to_player(player, response);
+        len = protocol_create_room_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
     if (msg->param_count < 1) {
-        protocol_create_room_err(response, sizeof(response), 
-                                 ERR_INVALID_PARAMS, "Missing room name");
-        server_send_to_player(player, response);
+        len = protocol_create_room_err(response, sizeof(response), 
+                                 ERR_INVALID_PARAMS, "Missing room ID");
+        server_send_to_player(player, response, len);
         player->invalid_message_count++;
         return;
     }
     
-    const char *room_name = msg->params[0];
+    int room_id = atoi(msg->params[0]);
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, room_id);
     
-    /* Validace nazvu */
-    ErrorCode err = protocol_validate_room_name(room_name);
-    if (err != ERR_NONE) {
-        protocol_create_room_err(response, sizeof(response), err, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
+    if (room == NULL) {
+        char hint[128];
+        len = protocol_create_room_err(response, sizeof(response), ERR_ROOM_NOT_FOUND,
+                                       remote_room_hint(server, room_id, hint, sizeof(hint)));
+        server_send_to_player(player, response, len);
         return;
     }
     
-    /* Kontrola limitu mistnosti */
-    if (room_count_active(server->rooms, server->config.max_rooms) >= server->config.max_rooms) {
-        protocol_create_room_err(response, sizeof(response), ERR_MAX_ROOMS, NULL);
-        server_send_to_player(player, response);
+    if (room_is_full(room)) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_ROOM_FULL, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    /* Vytvor mistnost */
-    int room_id = room_create(server->rooms, server->config.max_rooms, room_name, player);
-    if (room_id < 0) {
-        /* Nazev obsazen nebo jina chyba */
-        protocol_create_room_err(response, sizeof(response), ERR_ROOM_NAME_TAKEN, NULL);
-        server_send_to_player(player, response);
+    /* Pridej hrace */
+    Player *opponent = room_get_opponent(room, player); /* Prvni hrac v mistnosti */
+    
+    if (!room_add_player(room, player)) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
     player_set_state(player, PLAYER_STATE_IN_ROOM);
     
-    protocol_create_room_created(response, sizeof(response), room_id);
-    server_send_to_player(player, response);
+    /* Posli potvrzeni s prezdivkou protihrace */
+    len = protocol_create_room_joined(response, sizeof(response), room_id, 
+                                 opponent ? opponent->nickname : "");
+    server_send_to_player(player, response, len);
     
-    /* Posli WAIT_OPPONENT */
-    protocol_create_wait_opponent(response, sizeof(response));
-    server_send_to_player(player, response);
+    /* Pokud je mistnost plna, zacni hru, jinak se ceka na dalsi hrace */
+    if (room_is_full(room)) {
+        start_game(server, room);
+        bot_play(server, room);
+    } else {
+        len = protocol_create_wait_opponent(response, sizeof(response));
+        server_send_to_player(player, response, len);
+    }
 }
 
 /**
- * Zpracuje JOIN_ROOM
+ * Zpracuje ADD_BOT - obsadi volne misto v mistnosti botem serveru
+ * Bot nema socket, zabira jen slot za sloty klientu (podle ID mistnosti).
  */
-static void handle_join_room(Server *server, Player *player, ParsedMessage *msg) {
+static void handle_add_bot(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_IN_ROOM) {
+        ErrorCode err = ERR_NOT_IN_ROOM;
+        if (player->state == PLAYER_STATE_CONNECTING) err = ERR_NOT_LOGGED_IN;
+        if (player->state == PLAYER_STATE_IN_GAME) err = ERR_GAME_IN_PROGRESS;
+        len = protocol_create_room_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    if (room_is_full(room)) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_ROOM_FULL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Player *bot = &server->players[server->config.max_clients + (int)(room - server->rooms)];
+    if (bot->is_active) {
+        len = protocol_create_room_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    snprintf(nickname, sizeof(nickname), "%s%d", BOT_NICKNAME_PREFIX, room->id);
+    player_create_bot(bot, nickname);
+    
+    if (!room_add_player(room, bot)) {
+        player_reset(bot, false);
+        len = protocol_create_room_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    player_set_state(bot, PLAYER_STATE_IN_ROOM);
+    
+    LOG_INFO("Bot '%s' joined room '%s' (ID: %d)", bot->nickname, room->name, room->id);
+    
+    /* Ve vetsi mistnosti se dal ceka na hrace */
+    if (!room_is_full(room)) {
+        len = protocol_create_wait_opponent(response, sizeof(response));
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    start_game(server, room);
+    bot_play(server, room);
+}
+
+/**
+ * Zpracuje LEAVE_ROOM
+ */
+static void handle_leave_room(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_IN_ROOM && player->state != PLAYER_STATE_IN_GAME) {
+        len = protocol_create_error(response, sizeof(response), ERR_NOT_IN_ROOM, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        len = protocol_create_error(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Pokud hra probihala, konci pro vsechny - vyhrava dalsi hrac v poradi */
+    if (room->game.state == GAME_STATE_PLAYING || room->game.state == GAME_STATE_PAUSED) {
+        end_game(server, room, room_get_next_online(room, player), player,
+                 JOURNAL_END_LEAVE, player);
+    }
+    
+    /* Odeber hrace z mistnosti (ostatni v cekajici mistnosti zustavaji) */
+    room_remove_player(room, player);
+    room_vacated(server, room);
+    player_set_state(player, PLAYER_STATE_LOBBY);
+    
+    len = protocol_create_leave_ok(response, sizeof(response));
+    server_send_to_player(player, response, len);
+}
+
+/**
+ * Provede overeny tah TAKE hrace nebo bota a rozesle vysledek
+ * @return false pokud tah nelze provest
+ */
+static bool apply_take(Server *server, Room *room, Player *player, int player_idx,
+                       int pile, int count) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    /* Proved tah */
+    if (!game_take_stones(&room->game, player_idx, pile, count)) {
+        len = protocol_create_take_err(response, sizeof(response), ERR_INVALID_MOVE, NULL);
+        server_send_to_player(player, response, len);
+        return false;
+    }
+    
+    journal_record(&server->journal, JOURNAL_EV_TAKE, room, player_idx,
+                   JOURNAL_TAKE_VALUE(pile, count));
+    
+    int remaining = game_get_stones(&room->game);
+    
+    /* Kontrola konce hry - GAME_OVER dostanou vsichni a vraci se do lobby */
+    if (game_is_over(&room->game)) {
+        Player *winner = room->players[game_get_winner(&room->game)];
+        Player *loser = room->players[game_get_loser(&room->game)];
+        end_game(server, room, winner, loser, JOURNAL_END_NORMAL, NULL);
+        return true;
+    }
+    
+    /* Posli potvrzeni hraci */
+    bool still_my_turn = game_is_player_turn(&room->game, player_idx);
+    start_turn_clock(server, room);
+    int clock_ms = turn_clock_left(room);
+    len = protocol_create_take_ok(response, sizeof(response), remaining, still_my_turn, clock_ms);
+    server_send_to_player(player, response, len);
+    
+    /* Akce se naformatuje jednou a rozesle vsem ostatnim hracum */
+    Player *next = room->players[room->game.current_player];
+    len = protocol_create_opponent_action(response, sizeof(response), "TAKE", count, remaining,
+                                    pile, player->nickname, next ? next->nickname : "",
+                                    clock_ms);
+    server_broadcast_to_room(room, response, len, player);
+    broadcast_to_spectators(server, room, response, len);
+    
+    return true;
+}
+
+/**
+ * Provede overene preskoceni hrace nebo bota a rozesle vysledek
+ * @return false pokud preskoceni nelze provest
+ */
+static bool apply_skip(Server *server, Room *room, Player *player, int player_idx) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    /* Proved preskoceni */
+    if (!game_skip_turn(&room->game, player_idx)) {
+        len = protocol_create_skip_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return false;
+    }
+    
+    player->skips_remaining = room->game.player_skips[player_idx];
+    journal_record(&server->journal, JOURNAL_EV_SKIP, room, player_idx, 0);
+    
+    /* Posli potvrzeni */
+    bool still_my_turn = game_is_player_turn(&room->game, player_idx);
+    start_turn_clock(server, room);
+    int clock_ms = turn_clock_left(room);
+    len = protocol_create_skip_ok(response, sizeof(response), still_my_turn, clock_ms);
+    server_send_to_player(player, response, len);
+    
+    /* Informuj ostatni hrace */
+    Player *next = room->players[room->game.current_player];
+    len = protocol_create_opponent_action(response, sizeof(response), "SKIP", 0,
+                                    game_get_stones(&room->game), 0,
+                                    player->nickname, next ? next->nickname : "", clock_ms);
+    server_broadcast_to_room(room, response, len, player);
+    broadcast_to_spectators(server, room, response, len);
+    
+    return true;
+}
+
+/**
+ * Odehraje tahy botu, dokud je bot na tahu
+ * Tah se vybira z predpocitane tabulky solveru, tedy v O(1), pri vice
+ * hromadkach z nim-sumu.
+ */
+static void bot_play(Server *server, Room *room) {
+    while (room->is_active && room->game.state == GAME_STATE_PLAYING) {
+        int idx = room->game.current_player;
+        Player *bot = room->players[idx];
+        if (bot == NULL || !bot->is_bot) break;
+        
+        SolverMove move = solver_best_move(&room->game);
+        bool ok;
+        if (move.count == SOLVER_MOVE_SKIP && game_can_skip(&room->game, idx)) {
+            ok = apply_skip(server, room, bot, idx);
+        } else {
+            if (!game_validate_take_count(&room->game, move.pile, move.count)) {
+                move.pile = 0;
+                move.count = room->game.piles[0] < room->game.rules.min_take
+                             ? room->game.piles[0] : room->game.rules.min_take;
+            }
+            ok = apply_take(server, room, bot, idx, move.pile, move.count);
+        }
+        
+        if (!ok) {
+            LOG_ERROR("Bot '%s' has no valid move in room %d", bot->nickname, room->id);
+            break;
+        }
+    }
+}
+
+/**
+ * Zpracuje TAKE
+ */
+static void handle_take(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_IN_GAME) {
+        len = protocol_create_take_err(response, sizeof(response), ERR_NOT_IN_GAME, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        len = protocol_create_take_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* TAKE;count pri jedne hromadce, jinak TAKE;pile;count */
+    int needed = room->game.rules.pile_count > 1 ? 2 : 1;
+    if (msg->param_count < needed) {
+        len = protocol_create_take_err(response, sizeof(response), 
+                                 ERR_INVALID_PARAMS, needed > 1 ? "Missing pile" : "Missing count");
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    int pile = msg->param_count >= 2 ? atoi(msg->params[0]) : 0;
+    int count = atoi(msg->params[msg->param_count >= 2 ? 1 : 0]);
+    
+    int player_idx = room_get_player_index(room, player);
+    
+    /* Kontrola, zda je hrac na tahu */
+    if (!game_is_player_turn(&room->game, player_idx)) {
+        len = protocol_create_take_err(response, sizeof(response), ERR_NOT_YOUR_TURN, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    /* Validace tahu */
+    if (!game_validate_take_count(&room->game, pile, count)) {
+        len = protocol_create_take_err(response, sizeof(response), ERR_INVALID_MOVE, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    apply_take(server, room, player, player_idx, pile, count);
+    bot_play(server, room);
+}
+
+/**
+ * Zpracuje SKIP
+ */
+static void handle_skip(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_IN_GAME) {
+        len = protocol_create_skip_err(response, sizeof(response), ERR_NOT_IN_GAME, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        len = protocol_create_skip_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    int player_idx = room_get_player_index(room, player);
+    
+    /* Kontrola, zda je hrac na tahu */
+    if (!game_is_player_turn(&room->game, player_idx)) {
+        len = protocol_create_skip_err(response, sizeof(response), ERR_NOT_YOUR_TURN, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    /* Kontrola, zda ma preskoceni */
+    if (!game_can_skip(&room->game, player_idx)) {
+        len = protocol_create_skip_err(response, sizeof(response), ERR_NO_SKIPS_LEFT, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    apply_skip(server, room, player, player_idx);
+    bot_play(server, room);
+}
+
+/**
+ * Zpracuje HINT - nejlepsi tah podle solveru pro hrace na tahu
+ */
+static void handle_hint(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_IN_GAME) {
+        len = protocol_create_hint_err(response, sizeof(response), ERR_NOT_IN_GAME, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
+    if (room == NULL) {
+        len = protocol_create_hint_err(response, sizeof(response), ERR_INTERNAL, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    int player_idx = room_get_player_index(room, player);
+    if (!game_is_player_turn(&room->game, player_idx)) {
+        len = protocol_create_hint_err(response, sizeof(response), ERR_NOT_YOUR_TURN, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    /* Bez tabulky by verdikt byl vymysleny - radeji chyba */
+    if (!solver_knows(&room->game)) {
+        len = protocol_create_hint_err(response, sizeof(response), ERR_INTERNAL,
+                                 "Position not solvable");
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    SolverMove move = solver_best_move(&room->game);
+    len = protocol_create_hint_ok(response, sizeof(response), move.pile, move.count,
+                            solver_is_winning(&room->game));
+    server_send_to_player(player, response, len);
+}
+
+/**
+ * Zpracuje WATCH - hrac z lobby zacne sledovat hru v mistnosti
+ */
+static void handle_watch(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_LOBBY) {
+        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ?
+                        ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
+        len = protocol_create_watch_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    if (msg->param_count < 1) {
+        len = protocol_create_watch_err(response, sizeof(response),
+                                  ERR_INVALID_PARAMS, "Missing room ID");
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
+        return;
+    }
+    
+    int room_id = atoi(msg->params[0]);
+    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, room_id);
+    if (room == NULL) {
+        char hint[128];
+        len = protocol_create_watch_err(response, sizeof(response), ERR_ROOM_NOT_FOUND,
+                                        remote_room_hint(server, room_id, hint, sizeof(hint)));
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    room_add_spectator(room, server->players, player);
+    player_set_state(player, PLAYER_STATE_WATCHING);
+    
+    len = create_watch_state(room, response, sizeof(response));
+    server_send_to_player(player, response, len);
+    
+    LOG_INFO("Player '%s' is watching room '%s' (%d spectators)",
+             player->nickname, room->name, room->spectator_count);
+}
+
+/**
+ * Zpracuje UNWATCH
+ */
+static void handle_unwatch(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->state != PLAYER_STATE_WATCHING) {
+        len = protocol_create_watch_err(response, sizeof(response), ERR_NOT_IN_ROOM, NULL);
+        server_send_to_player(player, response, len);
+        return;
+    }
+    
+    stop_watching(server, player);
+    len = protocol_create_unwatch_ok(response, sizeof(response));
+    server_send_to_player(player, response, len);
+}
+
+/**
+ * Zpracuje TOURNAMENT_CREATE - zalozi turnaj a zaregistruje zakladatele
+ */
+static void handle_tournament_create(Server *server, Player *player, ParsedMessage *msg) {
     char response[BUFFER_SIZE];
+    int len;
     
     if (player->state != PLAYER_STATE_LOBBY) {
-        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ? 
+        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ?
                         ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
-        protocol_create_room_err(response, sizeof(response), err, NULL);
-        server_send_to_player(player, response);
+        len = protocol_create_tournament_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
     if (msg->param_count < 1) {
-        protocol_create_room_err(response, sizeof(response), 
-                                 ERR_INVALID_PARAMS, "Missing room ID");
-        server_send_to_player(player, response);
+        len = protocol_create_tournament_err(response, sizeof(response),
+                                       ERR_INVALID_PARAMS, "Missing tournament name");
+        server_send_to_player(player, response, len);
         player->invalid_message_count++;
         return;
     }
     
-    int room_id = atoi(msg->params[0]);
-    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, room_id);
-    
-    if (room == NULL) {
-        protocol_create_room_err(response, sizeof(response), ERR_ROOM_NOT_FOUND, NULL);
-        server_send_to_player(player, response);
+    const char *name = msg->params[0];
+    ErrorCode err = protocol_validate_room_name(name);
+    if (err != ERR_NONE) {
+        len = protocol_create_tournament_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
         return;
     }
     
-    if (room_is_full(room)) {
-        protocol_create_room_err(response, sizeof(response), ERR_ROOM_FULL, NULL);
-        server_send_to_player(player, response);
+    /* Zapasy turnaje se hraji ve dvou */
+    GameRules rules;
+    err = protocol_parse_rules(msg, 1, &rules);
+    if (err == ERR_NONE && rules.player_count != PLAYERS_PER_ROOM) {
+        err = ERR_INVALID_RULES;
+    }
+    if (err != ERR_NONE) {
+        len = protocol_create_tournament_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
+        player->invalid_message_count++;
         return;
     }
     
-    /* Pridej hrace */
-    Player *opponent = room_get_opponent(room, NULL); /* Prvni hrac v mistnosti */
-    
-    if (!room_add_player(room, player)) {
-        protocol_create_room_err(response, sizeof(response), ERR_INTERNAL, NULL);
-        server_send_to_player(player, response);
+    if (!tournament_open(&server->tournament, name, &rules, (int)(player - server->players))) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_TOURNAMENT_EXISTS, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    player_set_state(player, PLAYER_STATE_IN_ROOM);
+    player_set_state(player, PLAYER_STATE_TOURNAMENT);
+    LOG_INFO("Tournament '%s' opened by '%s'", name, player->nickname);
     
-    /* Posli potvrzeni s prezdivkou protihrace */
-    protocol_create_room_joined(response, sizeof(response), room_id, 
-                                 opponent ? opponent->nickname : "");
-    server_send_to_player(player, response);
+    len = protocol_create_tournament_ok(response, sizeof(response), name, 1);
+    server_send_to_player(player, response, len);
     
-    /* Pokud je mistnost plna, zacni hru */
-    if (room_is_full(room)) {
-        room_start_game(room);
-        
-        /* Posli GAME_START obema hracum */
-        for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
-            Player *p = room->players[i];
-            if (p != NULL && p->socket_fd >= 0) {
-                Player *opp = room_get_opponent(room, p);
-                bool my_turn = game_is_player_turn(&room->game, i);
-                protocol_create_game_start(response, sizeof(response),
-                                            game_get_stones(&room->game),
-                                            my_turn,
-                                            opp ? opp->nickname : "");
-                server_send_to_player(p, response);
-            }
-        }
-    }
+    len = protocol_create_tournament_open(response, sizeof(response), name, player->nickname);
+    server_broadcast_to_lobby(server, response, len);
 }
 
 /**
- * Zpracuje LEAVE_ROOM
+ * Zpracuje TOURNAMENT_JOIN - registrace do otevreneho turnaje
  */
-static void handle_leave_room(Server *server, Player *player, ParsedMessage *msg) {
+static void handle_tournament_join(Server *server, Player *player, ParsedMessage *msg) {
     (void)msg;
     char response[BUFFER_SIZE];
+    int len;
+    Tournament *t = &server->tournament;
     
-    if (player->state != PLAYER_STATE_IN_ROOM && player->state != PLAYER_STATE_IN_GAME) {
-        protocol_create_error(response, sizeof(response), ERR_NOT_IN_ROOM, NULL);
-        server_send_to_player(player, response);
+    if (player->state != PLAYER_STATE_LOBBY) {
+        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ?
+                        ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
+        len = protocol_create_tournament_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
-    if (room == NULL) {
-        protocol_create_error(response, sizeof(response), ERR_INTERNAL, NULL);
-        server_send_to_player(player, response);
+    if (!tournament_register(t, (int)(player - server->players))) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_NO_TOURNAMENT, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    Player *opponent = room_get_opponent(room, player);
-    
-    /* Pokud hra probihala, protihrac vyhrává */
-    if (room->game.state == GAME_STATE_PLAYING || room->game.state == GAME_STATE_PAUSED) {
-        room->game.state = GAME_STATE_FINISHED;
-        
-        if (opponent != NULL && opponent->socket_fd >= 0) {
-            protocol_create_game_over(response, sizeof(response),
-                                       opponent->nickname, player->nickname);
-            server_send_to_player(opponent, response);
-            
-            /* Presun protihrace do lobby */
-            room_remove_player(room, opponent);
-            player_set_state(opponent, PLAYER_STATE_LOBBY);
-        }
-    } else if (opponent != NULL && opponent->socket_fd >= 0) {
-        /* Informuj protihrace */
-        protocol_create_player_status(response, sizeof(response),
-                                       player->nickname, STATUS_DISCONNECTED);
-        server_send_to_player(opponent, response);
-        
-        /* Presun protihrace do lobby */
-        room_remove_player(room, opponent);
-        player_set_state(opponent, PLAYER_STATE_LOBBY);
-    }
-    
-    /* Odeber hrace z mistnosti */
-    room_remove_player(room, player);
-    player_set_state(player, PLAYER_STATE_LOBBY);
-    
-    protocol_create_leave_ok(response, sizeof(response));
-    server_send_to_player(player, response);
+    player_set_state(player, PLAYER_STATE_TOURNAMENT);
+    len = protocol_create_tournament_ok(response, sizeof(response), t->name, t->entrant_count);
+    server_send_to_player(player, response, len);
 }
 
 /**
- * Zpracuje TAKE
+ * Zpracuje TOURNAMENT_LEAVE - odstoupeni hrace cekajiciho na zapas
  */
-static void handle_take(Server *server, Player *player, ParsedMessage *msg) {
+static void handle_tournament_leave(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
     char response[BUFFER_SIZE];
+    int len;
     
-    if (player->state != PLAYER_STATE_IN_GAME) {
-        protocol_create_take_err(response, sizeof(response), ERR_NOT_IN_GAME, NULL);
-        server_send_to_player(player, response);
+    if (player->state != PLAYER_STATE_TOURNAMENT) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_NO_TOURNAMENT, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    if (msg->param_count < 1) {
-        protocol_create_take_err(response, sizeof(response), 
-                                 ERR_INVALID_PARAMS, "Missing count");
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
+    len = protocol_create_tournament_left(response, sizeof(response));
+    server_send_to_player(player, response, len);
+    tournament_withdraw(server, player);
+}
+
+/**
+ * Zpracuje TOURNAMENT_START - zakladatel ukonci registraci a rozehraje
+ * prvni kolo (po odchodu zakladatele muze zacit kterykoli ucastnik)
+ */
+static void handle_tournament_start(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
+    Tournament *t = &server->tournament;
+    int slot = (int)(player - server->players);
+    
+    if (player->state != PLAYER_STATE_TOURNAMENT || t->state != TOURNAMENT_REGISTERING) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_NO_TOURNAMENT, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    int count = atoi(msg->params[0]);
-    
-    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
-    if (room == NULL) {
-        protocol_create_take_err(response, sizeof(response), ERR_INTERNAL, NULL);
-        server_send_to_player(player, response);
+    if (slot != t->organizer && tournament_ready(server, t->organizer)) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_NOT_ORGANIZER, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    int player_idx = room_get_player_index(room, player);
-    
-    /* Kontrola, zda je hrac na tahu */
-    if (!game_is_player_turn(&room->game, player_idx)) {
-        protocol_create_take_err(response, sizeof(response), ERR_NOT_YOUR_TURN, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
+    if (t->entrant_count < 2) {
+        len = protocol_create_tournament_err(response, sizeof(response), ERR_TOO_FEW_ENTRANTS, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    /* Validace tahu */
-    if (!game_validate_take_count(&room->game, count)) {
-        protocol_create_take_err(response, sizeof(response), ERR_INVALID_MOVE, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
-        return;
+    int bye = tournament_begin_round(t);
+    LOG_INFO("Tournament '%s' started: %d entrants", t->name, t->entrant_count);
+    if (bye >= 0) {
+        notify_advance(server, bye, t->round);
     }
+    tournament_schedule(server);
+}
+
+/**
+ * Zpracuje LEADERBOARD - zebricek je udrzovany serazeny, jen se zformatuje
+ */
+static void handle_leaderboard(Server *server, Player *player, ParsedMessage *msg) {
+    char response[BUFFER_SIZE];
+    int len;
+    char entries[BUFFER_SIZE - 64];
     
-    /* Proved tah */
-    if (!game_take_stones(&room->game, player_idx, count)) {
-        protocol_create_take_err(response, sizeof(response), ERR_INVALID_MOVE, NULL);
-        server_send_to_player(player, response);
+    if (player->state == PLAYER_STATE_CONNECTING) {
+        len = protocol_create_error(response, sizeof(response), ERR_NOT_LOGGED_IN, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    int remaining = game_get_stones(&room->game);
-    Player *opponent = room_get_opponent(room, player);
-    
-    /* Kontrola konce hry */
-    if (game_is_over(&room->game)) {
-        int winner_idx = game_get_winner(&room->game);
-        Player *winner = room->players[winner_idx];
-        Player *loser = room->players[1 - winner_idx];
-        
-        /* Posli GAME_OVER obema */
-        protocol_create_game_over(response, sizeof(response),
-                                   winner->nickname, loser->nickname);
-        server_send_to_player(player, response);
-        
-        if (opponent != NULL && opponent->socket_fd >= 0) {
-            server_send_to_player(opponent, response);
-        }
-        
-        /* Presun hrace do lobby */
-        player_set_state(player, PLAYER_STATE_LOBBY);
-        if (opponent != NULL) {
-            player_set_state(opponent, PLAYER_STATE_LOBBY);
-            room_remove_player(room, opponent);
+    int count = LEADERBOARD_SIZE;
+    if (msg->param_count >= 1) {
+        count = atoi(msg->params[0]);
+        if (count < 1) {
+            len = protocol_create_error(response, sizeof(response), ERR_INVALID_PARAMS, NULL);
+            server_send_to_player(player, response, len);
+            player->invalid_message_count++;
+            return;
         }
-        room_remove_player(room, player);
-        
-        return;
     }
     
-    /* Posli potvrzeni hraci */
-    bool still_my_turn = game_is_player_turn(&room->game, player_idx);
-    protocol_create_take_ok(response, sizeof(response), remaining, still_my_turn);
-    server_send_to_player(player, response);
-    
-    /* Posli akci protihracovi */
-    if (opponent != NULL && opponent->socket_fd >= 0) {
-        protocol_create_opponent_action(response, sizeof(response), 
-                                        "TAKE", count, remaining);
-        server_send_to_player(opponent, response);
+    /* Hodnoceni vede SHARD_HOME, ostatni shardy ctou jeho zverejneny zebricek */
+    if (server->config.shard_fd >= 0 && server->config.shard_index != SHARD_HOME) {
+        shard_leaderboard_to_string(server->config.shard_summary, count,
+                                    entries, sizeof(entries));
+    } else {
+        ratings_leaderboard_to_string(&server->ratings, count, entries, sizeof(entries));
     }
+    len = protocol_create_leaderboard_ok(response, sizeof(response), entries);
+    server_send_to_player(player, response, len);
 }
 
 /**
- * Zpracuje SKIP
+ * Zpracuje QUICK_MATCH - zaradi hrace do fronty a hned zkusi najit soupere
  */
-static void handle_skip(Server *server, Player *player, ParsedMessage *msg) {
+static void handle_quick_match(Server *server, Player *player, ParsedMessage *msg) {
     (void)msg;
     char response[BUFFER_SIZE];
+    int len;
     
-    if (player->state != PLAYER_STATE_IN_GAME) {
-        protocol_create_skip_err(response, sizeof(response), ERR_NOT_IN_GAME, NULL);
-        server_send_to_player(player, response);
-        return;
-    }
-    
-    Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
-    if (room == NULL) {
-        protocol_create_skip_err(response, sizeof(response), ERR_INTERNAL, NULL);
-        server_send_to_player(player, response);
+    if (player->state != PLAYER_STATE_LOBBY) {
+        ErrorCode err = (player->state == PLAYER_STATE_CONNECTING) ?
+                        ERR_NOT_LOGGED_IN : ERR_GAME_IN_PROGRESS;
+        len = protocol_create_quick_match_err(response, sizeof(response), err, NULL);
+        server_send_to_player(player, response, len);
         return;
     }
     
-    int player_idx = room_get_player_index(room, player);
+    int slot = (int)(player - server->players);
+    int rating = player_rating(server, player);
+    player->queued_at = timer_now_ms();
+    player_set_state(player, PLAYER_STATE_QUEUED);
+    matchqueue_add(&server->match_queue, slot, rating, player->queued_at);
     
-    /* Kontrola, zda je hrac na tahu */
-    if (!game_is_player_turn(&room->game, player_idx)) {
-        protocol_create_skip_err(response, sizeof(response), ERR_NOT_YOUR_TURN, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
-        return;
-    }
+    len = protocol_create_quick_match_wait(response, sizeof(response), rating);
+    server_send_to_player(player, response, len);
     
-    /* Kontrola, zda ma preskoceni */
-    if (!game_can_skip(&room->game, player_idx)) {
-        protocol_create_skip_err(response, sizeof(response), ERR_NO_SKIPS_LEFT, NULL);
-        server_send_to_player(player, response);
-        player->invalid_message_count++;
-        return;
-    }
+    quick_match_try(server, slot);
+}
+
+/**
+ * Zpracuje QUICK_MATCH_CANCEL
+ */
+static void handle_quick_match_cancel(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    char response[BUFFER_SIZE];
+    int len;
     
-    /* Proved preskoceni */
-    if (!game_skip_turn(&room->game, player_idx)) {
-        protocol_create_skip_err(response, sizeof(response), ERR_INTERNAL, NULL);
-        server_send_to_player(player, response);
+    if (player->state != PLAYER_STATE_QUEUED) {
+        len = protocol_create_quick_match_err(response, sizeof(response), ERR_INVALID_PARAMS,
+                                        "Not waiting for a quick match");
+        server_send_to_player(player, response, len);
         return;
     }
     
-    player->skips_remaining = room->game.player_skips[player_idx];
-    
-    /* Posli potvrzeni */
-    bool still_my_turn = game_is_player_turn(&room->game, player_idx);
-    protocol_create_skip_ok(response, sizeof(response), still_my_turn);
-    server_send_to_player(player, response);
-    
-    /* Informuj protihrace */
-    Player *opponent = room_get_opponent(room, player);
-    if (opponent != NULL && opponent->socket_fd >= 0) {
-        protocol_create_opponent_action(response, sizeof(response), 
-                                        "SKIP", 0, game_get_stones(&room->game));
-        server_send_to_player(opponent, response);
-    }
+    quick_match_leave(server, player);
+    len = protocol_create_quick_match_cancelled(response, sizeof(response));
+    server_send_to_player(player, response, len);
 }
 
 /**
@@ -780,8 +2403,9 @@ static void handle_ping(Server *server, Player *player, ParsedMessage *msg) {
     (void)server;
     (void)msg;
     char response[BUFFER_SIZE];
-    protocol_create_pong(response, sizeof(response));
-    server_send_to_player(player, response);
+    int len;
+    len = protocol_create_pong(response, sizeof(response));
+    server_send_to_player(player, response, len);
 }
 
 /**
@@ -795,18 +2419,372 @@ static void handle_pong(Server *server, Player *player, ParsedMessage *msg) {
 }
 
 /**
- * Zpracuje LOGOUT
+ * Zpracuje LOGOUT
+ */
+static void handle_logout(Server *server, Player *player, ParsedMessage *msg) {
+    (void)msg;
+    LOG_INFO("Player '%s' logging out", 
+             player->nickname[0] ? player->nickname : "(unknown)");
+    server_handle_disconnect(server, player, true);
+}
+
+/* ============================================
+ * SHARDY
+ * Hrac v lobby se presouva na shard, kteremu patri mistnost jeho JOIN_ROOM
+ * nebo WATCH (rychla hra a turnaj bezi na SHARD_HOME). Socket jde pres
+ * router spolu s hracem a zpravou, kterou pak zpracuje cilovy shard.
+ * ============================================ */
+
+static void release_player(Server *server, Player *player);
+
+/**
+ * Odesle zpravu hracum v lobby tohoto procesu
+ */
+static void broadcast_to_local_lobby(Server *server, const char *message, size_t len) {
+    for (int i = 0; i < server->config.max_clients; i++) {
+        Player *player = &server->players[i];
+        if (player->is_active && player->state == PLAYER_STATE_LOBBY &&
+            player->socket_fd >= 0) {
+            server_send_to_player(player, message, len);
+        }
+    }
+}
+
+/**
+ * Vybere shard, ktery ma zpravu zpracovat
+ * @return Index shardu nebo -1 = zpracovat zde
+ */
+static int message_shard(Server *server, const Player *player, const ParsedMessage *msg) {
+    const ServerConfig *config = &server->config;
+    int target = -1;
+    
+    if (config->shard_fd < 0 || server->shard_routed) return -1;
+    
+    switch (msg->type) {
+        case MSG_JOIN_ROOM:
+        case MSG_WATCH:
+            if (player->state == PLAYER_STATE_LOBBY && msg->param_count >= 1) {
+                target = shard_room_owner(config->shard_summary, atoi(msg->params[0]));
+            }
+            break;
+        case MSG_QUICK_MATCH:
+        case MSG_TOURNAMENT_CREATE:
+        case MSG_TOURNAMENT_JOIN:
+            if (player->state == PLAYER_STATE_LOBBY) {
+                target = SHARD_HOME;
+            }
+            break;
+        case MSG_RESUME:
+            /* Session drzi shard, na kterem hrac naposledy hral */
+            if (player->state == PLAYER_STATE_CONNECTING && msg->param_count >= 1 &&
+                session_find(&server->sessions, server->players, msg->params[0]) == NULL) {
+                target = shard_find_session(config->shard_summary, config->shard_index,
+                                            msg->params[0]);
+            }
+            break;
+        default:
+            break;
+    }
+    
+    /* Mistnosti a hraci mrtveho shardu nejsou - odpovi tento shard */
+    if (target == config->shard_index || !shard_is_alive(config->shard_summary, target)) {
+        return -1;
+    }
+    return target;
+}
+
+/**
+ * Presune hrace i se zpravou na jiny shard
+ * @return false pokud presun nejde - zprava se pak zpracuje zde
+ */
+static bool move_to_shard(Server *server, Player *player, const ParsedMessage *parsed,
+                          int target) {
+    /* Drive zarazene odpovedi musi odejit pred odpovedmi ciloveho shardu */
+    if (!outqueue_is_empty(&player->out_queue)) {
+        outqueue_flush(&player->out_queue, player->socket_fd);
+        if (!outqueue_is_empty(&player->out_queue)) return false;
+    }
+    
+    ShardMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = SHARD_MSG_PLAYER;
+    msg.source = server->config.shard_index;
+    msg.target = target;
+    msg.player = *player;
+    msg.message = *parsed;
+    
+    if (!shard_send(server->config.shard_fd, &msg, player->socket_fd)) {
+        return false;
+    }
+    
+    LOG_INFO("Player '%s' moved to shard %d (%s)",
+             player->nickname[0] ? player->nickname : "(unknown)", target,
+             protocol_message_type_to_string(parsed->type));
+    server->stats.moved_out++;
+    
+    /* Spojeni ted vlastni cilovy shard - uvolneni zavre jen nasi kopii socketu */
+    release_player(server, player);
+    return true;
+}
+
+/**
+ * Prevezme nove spojeni, ktere router prijal na verejnem listeneru
+ */
+static void adopt_client(Server *server, int fd, int origin) {
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    
+    memset(&addr, 0, sizeof(addr));
+    if (getpeername(fd, (struct sockaddr*)&addr, &addr_len) < 0) {
+        /* Klient se mezitim odpojil */
+        close(fd);
+        return;
+    }
+    
+    if (!set_nonblocking(fd) || !set_cloexec(fd)) {
+        LOG_ERROR("Failed to set non-blocking for client socket");
+        close(fd);
+        return;
+    }
+    
+    add_client(server, fd, &addr, origin == SHARD_ORIGIN_WEBSOCKET);
+}
+
+/**
+ * Prevezme hrace z jineho shardu a zpracuje zpravu, kvuli ktere prisel
+ * (a pripadne dalsi zpravy, ktere uz cekaji v jeho bufferu)
+ */
+static void adopt_player(Server *server, ShardMessage *msg, int fd) {
+    int slot = player_find_free_slot(server->players, server->config.max_clients);
+    if (slot < 0) {
+        LOG_WARNING("Server full, dropping '%s' moved from shard %d",
+                    msg->player.nickname, msg->source);
+        server->stats.rejected_full++;
+        close(fd);
+        return;
+    }
+    
+    Player *player = &server->players[slot];
+    *player = msg->player;
+    player->socket_fd = fd;
+    player->room_id = -1;
+    player->watch_room_id = -1;
+    player->next_spectator = -1;
+    player->resync_pending = false;
+    player->last_ping = 0;
+    player->waiting_pong = false;
+    outqueue_init(&player->out_queue);
+    player->out_overflow = false;
+    session_adopt(&server->sessions, server->players, player);
+    server->shard_dirty = true;
+    server->stats.moved_in++;
+    
+    LOG_INFO("Player '%s' moved in from shard %d (slot %d, fd %d)",
+             player->nickname[0] ? player->nickname : "(unknown)", msg->source, slot, fd);
+    
+    server->shard_routed = true;
+    dispatch_message(server, player, &msg->message);
+    server->shard_routed = false;
+    
+    player->request_id[0] = '\0';
+    process_messages(server, player);
+}
+
+/**
+ * Zpracuje zpravy od routeru - nova spojeni, presunute hrace, zpravy
+ * do lobby a vysledky her k hodnoceni
+ */
+static void receive_from_router(Server *server) {
+    ShardMessage msg;
+    unsigned int received = 0;
+    int result = -1;
+    int fd;
+    
+    while (received < ACCEPT_BATCH_LIMIT &&
+           (result = shard_recv(server->config.shard_fd, &msg, &fd)) == 1) {
+        received++;
+        
+        if ((msg.type == SHARD_MSG_CLIENT || msg.type == SHARD_MSG_PLAYER) && fd < 0) {
+            LOG_ERROR("Router message without a socket (type %d)", msg.type);
+            continue;
+        }
+        
+        switch (msg.type) {
+            case SHARD_MSG_CLIENT:
+                adopt_client(server, fd, msg.origin);
+                break;
+            case SHARD_MSG_PLAYER:
+                adopt_player(server, &msg, fd);
+                break;
+            case SHARD_MSG_LOBBY:
+                if (msg.text_len > 0 && msg.text_len <= (int)sizeof(msg.text)) {
+                    broadcast_to_local_lobby(server, msg.text, (size_t)msg.text_len);
+                }
+                break;
+            case SHARD_MSG_RATING:
+                ratings_record_game(&server->ratings, msg.names[0], msg.names[1]);
+                server->shard_dirty = true;
+                break;
+            default:
+                LOG_WARNING("Unknown router message type %d", msg.type);
+                if (fd >= 0) close(fd);
+                break;
+        }
+    }
+    
+    if (result == 0) {
+        LOG_ERROR("Router closed the shard channel, shutting down");
+        server->running = false;
+    }
+}
+
+/**
+ * Zverejni prehled shardu, jen kdyz se od minula neco zmenilo - jinak by
+ * kazda iterace prochazela vsechny sloty pod seqlockem
+ */
+static void publish_shard_summary(Server *server) {
+    unsigned int room_seq = room_change_seq();
+    if (!server->shard_dirty && room_seq == server->shard_room_seq) return;
+    
+    shard_publish(server->config.shard_summary, server->config.shard_index,
+                  server->rooms, server->players, &server->ratings);
+    server->shard_dirty = false;
+    server->shard_room_seq = room_seq;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+int server_create_tcp_listener(const ServerConfig *config, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create socket: %s", strerror(errno));
+        return -1;
+    }
+    
+    /* SO_REUSEADDR */
+    int optval = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    
+    /* Non-blocking */
+    if (!set_nonblocking(fd) || !set_cloexec(fd)) {
+        LOG_ERROR("Failed to set non-blocking: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    /* Bind */
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    
+    if (inet_pton(AF_INET, config->bind_address, &addr.sin_addr) <= 0) {
+        LOG_ERROR("Invalid bind address: %s", config->bind_address);
+        close(fd);
+        return -1;
+    }
+    
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind to %s:%d: %s", 
+                  config->bind_address, port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    /* Listen */
+    if (listen(fd, config->backlog) < 0) {
+        LOG_ERROR("Failed to listen: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+#ifdef TCP_DEFER_ACCEPT
+    /* Probud accept() az ve chvili, kdy klient posle prvni data */
+    if (config->defer_accept > 0) {
+        int defer = config->defer_accept;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+                       &defer, sizeof(defer)) < 0) {
+            LOG_WARNING("Failed to set TCP_DEFER_ACCEPT: %s", strerror(errno));
+        }
+    }
+#endif
+    
+    return fd;
+}
+
+/**
+ * Odstrani zbytek AF_UNIX socketu po predchozim behu
+ * Soubor, ktery neni socket, nebo socket, na kterem nekdo posloucha, zustane.
+ * @return true pokud je cesta volna
  */
-static void handle_logout(Server *server, Player *player, ParsedMessage *msg) {
-    (void)msg;
-    LOG_INFO("Player '%s' logging out", 
-             player->nickname[0] ? player->nickname : "(unknown)");
-    server_handle_disconnect(server, player, true);
+static bool remove_stale_unix_socket(const struct sockaddr_un *addr) {
+    struct stat st;
+    if (lstat(addr->sun_path, &st) < 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        LOG_ERROR("Unix socket path %s exists and is not a socket", addr->sun_path);
+        return false;
+    }
+    
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) return false;
+    bool alive = connect(probe, (const struct sockaddr*)addr, sizeof(*addr)) == 0;
+    close(probe);
+    
+    if (alive) {
+        LOG_ERROR("Unix socket %s is in use by another process", addr->sun_path);
+        return false;
+    }
+    return unlink(addr->sun_path) == 0 || errno == ENOENT;
 }
 
-/* ============================================
- * IMPLEMENTACE VEREJNYCH FUNKCI
- * ============================================ */
+/* AF_UNIX socket (--unix-socket) - lokalni brany a boti tak obchazeji TCP
+ * stack, spojeni jinak obsluhuje stejna smycka jako TCP klienty */
+int server_create_unix_listener(const ServerConfig *config) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    
+    if (strlen(config->unix_socket_path) >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Unix socket path too long: %s", config->unix_socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, config->unix_socket_path);
+    
+    if (!remove_stale_unix_socket(&addr)) {
+        return -1;
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create unix socket: %s", strerror(errno));
+        return -1;
+    }
+    
+    if (!set_nonblocking(fd) || !set_cloexec(fd)) {
+        LOG_ERROR("Failed to set non-blocking: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind to %s: %s", addr.sun_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    if (listen(fd, config->backlog) < 0) {
+        LOG_ERROR("Failed to listen on %s: %s", addr.sun_path, strerror(errno));
+        close(fd);
+        unlink(addr.sun_path);
+        return -1;
+    }
+    
+    return fd;
+}
 
 bool server_init(Server *server, const ServerConfig *config) {
     if (server == NULL || config == NULL) return false;
@@ -815,14 +2793,18 @@ bool server_init(Server *server, const ServerConfig *config) {
     server->config = *config;
     server->running = false;
     server->listen_fd = -1;
+    server->unix_listen_fd = -1;
+    server->ws_listen_fd = -1;
+    server->shard_dirty = true;
     
-    /* Alokace hracu */
-    server->players = malloc(config->max_clients * sizeof(Player));
+    /* Alokace hracu - za sloty klientu je jeden slot bota na mistnost */
+    int player_slots = config->max_clients + config->max_rooms;
+    server->players = malloc(player_slots * sizeof(Player));
     if (server->players == NULL) {
         LOG_ERROR("Failed to allocate players array");
         return false;
     }
-    player_init_all(server->players, config->max_clients);
+    player_init_all(server->players, player_slots);
     
     /* Alokace mistnosti */
     server->rooms = malloc(config->max_rooms * sizeof(Room));
@@ -833,140 +2815,403 @@ bool server_init(Server *server, const ServerConfig *config) {
     }
     room_init_all(server->rooms, config->max_rooms);
     
-    /* Vytvoreni socketu */
-    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server->listen_fd < 0) {
-        LOG_ERROR("Failed to create socket: %s", strerror(errno));
+    /* Shard vlastni rozsah ID mistnosti za rozsahy predchozich shardu */
+    room_set_first_id(config->shard_fd >= 0 ? config->shard_index * config->max_rooms : 0);
+    
+    /* Pole pro poll() - vsichni klienti + naslouchajici sockety */
+    int poll_capacity = config->max_clients + POLL_EXTRA_FDS;
+    server->poll_fds = malloc(poll_capacity * sizeof(struct pollfd));
+    server->poll_slots = malloc(poll_capacity * sizeof(int));
+    if (server->poll_fds == NULL || server->poll_slots == NULL) {
+        LOG_ERROR("Failed to allocate poll arrays");
+        free(server->poll_fds);
+        free(server->poll_slots);
         free(server->players);
         free(server->rooms);
         return false;
     }
     
-    /* SO_REUSEADDR */
-    int optval = 1;
-    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
-    
-    /* Non-blocking */
-    if (!set_nonblocking(server->listen_fd)) {
-        LOG_ERROR("Failed to set non-blocking: %s", strerror(errno));
-        close(server->listen_fd);
+    if (!session_init(&server->sessions, config->max_clients)) {
+        free(server->poll_fds);
+        free(server->poll_slots);
         free(server->players);
         free(server->rooms);
         return false;
     }
     
-    /* Bind */
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(config->port);
+    if (!timer_init(&server->turn_clocks, config->max_rooms)) {
+        LOG_ERROR("Failed to allocate turn clocks");
+        session_destroy(&server->sessions);
+        free(server->poll_fds);
+        free(server->poll_slots);
+        free(server->players);
+        free(server->rooms);
+        return false;
+    }
     
-    if (inet_pton(AF_INET, config->bind_address, &addr.sin_addr) <= 0) {
-        LOG_ERROR("Invalid bind address: %s", config->bind_address);
-        close(server->listen_fd);
+    if (!tournament_init(&server->tournament, config->max_clients)) {
+        LOG_ERROR("Failed to allocate tournament bracket");
+        timer_destroy(&server->turn_clocks);
+        session_destroy(&server->sessions);
+        free(server->poll_fds);
+        free(server->poll_slots);
         free(server->players);
         free(server->rooms);
         return false;
     }
     
-    if (bind(server->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        LOG_ERROR("Failed to bind to %s:%d: %s", 
-                  config->bind_address, config->port, strerror(errno));
-        close(server->listen_fd);
+    if (!matchqueue_init(&server->match_queue, config->max_clients)) {
+        LOG_ERROR("Failed to allocate quick match queue");
+        tournament_destroy(&server->tournament);
+        timer_destroy(&server->turn_clocks);
+        session_destroy(&server->sessions);
+        free(server->poll_fds);
+        free(server->poll_slots);
         free(server->players);
         free(server->rooms);
         return false;
     }
     
-    /* Listen */
-    if (listen(server->listen_fd, 10) < 0) {
-        LOG_ERROR("Failed to listen: %s", strerror(errno));
-        close(server->listen_fd);
+    /* Uzel registru vlastni rozsah ID podle sveho indexu - musi byt znamy
+     * pred obnovou mistnosti ze snapshotu */
+    if (config->registry[0] != '\0') {
+        /* Registr je lokalni - pri bindu na vsechny adresy staci loopback */
+        const char *address = strcmp(config->bind_address, "0.0.0.0") == 0 ?
+                              "127.0.0.1" : config->bind_address;
+        if (registry_open(&server->registry, config->registry, address,
+                          config->port, config->max_rooms)) {
+            room_set_first_id(server->registry.node * REGISTRY_NODE_ROOMS);
+        } else {
+            LOG_WARNING("Continuing without registry");
+        }
+    }
+    
+    /* Naslouchajici socket - novy, nebo prevzaty od predchoziho procesu */
+    bool ok;
+    if (config->upgrade_fd >= 0) {
+        ok = upgrade_receive(server, config->upgrade_fd);
+    } else if (config->shard_fd >= 0) {
+        /* Shard nema vlastni listenery - spojeni mu predava router */
+        ok = true;
+    } else {
+        server->listen_fd = server_create_tcp_listener(config, config->port);
+        ok = server->listen_fd >= 0;
+        if (ok && config->unix_socket_path[0] != '\0') {
+            server->unix_listen_fd = server_create_unix_listener(config);
+            if (server->unix_listen_fd < 0) {
+                close(server->listen_fd);
+                ok = false;
+            }
+        }
+        if (ok && config->websocket_port > 0) {
+            server->ws_listen_fd = server_create_tcp_listener(config, config->websocket_port);
+            if (server->ws_listen_fd < 0) {
+                close(server->listen_fd);
+                if (server->unix_listen_fd >= 0) {
+                    close(server->unix_listen_fd);
+                    unlink(config->unix_socket_path);
+                }
+                ok = false;
+            }
+        }
+    }
+    
+    if (!ok) {
+        registry_close(&server->registry, true);
+        matchqueue_destroy(&server->match_queue);
+        tournament_destroy(&server->tournament);
+        timer_destroy(&server->turn_clocks);
+        session_destroy(&server->sessions);
+        free(server->poll_fds);
+        free(server->poll_slots);
         free(server->players);
         free(server->rooms);
         return false;
     }
     
-    server->max_fd = server->listen_fd;
+    /* Hodiny prevzatych her - monotonni cas plati i v novem procesu */
+    for (int i = 0; i < config->max_rooms; i++) {
+        if (server->rooms[i].is_active && server->rooms[i].turn_deadline != 0) {
+            timer_schedule(&server->turn_clocks, i, server->rooms[i].turn_deadline);
+        }
+    }
+    
+    /* Prevzaty turnaj mohl cekat na volne mistnosti */
+    server->tournament_pending = server->tournament.state == TOURNAMENT_RUNNING;
+    
+    stats_init(&server->stats);
+    solver_init();
+    
+    /* Snapshot rozehranych her - po padu obnovime hry ze souboru,
+     * pri upgradu je prebirame primo od predchoziho procesu */
+    server->snapshot.fd = -1;
+    server->snapshot.map = NULL;
+    if (config->snapshot_path[0] != '\0') {
+        if (snapshot_open(&server->snapshot, config->snapshot_path,
+                          config->max_clients, config->max_rooms)) {
+            if (config->upgrade_fd < 0) {
+                snapshot_restore(&server->snapshot, server->players, server->rooms);
+            }
+        } else {
+            LOG_WARNING("Continuing without snapshot");
+        }
+    }
+    
+    /* Zurnal hernich udalosti */
+    server->journal.map = NULL;
+    if (config->journal_dir[0] != '\0' && !journal_open(&server->journal, config->journal_dir)) {
+        LOG_WARNING("Continuing without journal");
+    }
+    
+    /* Hodnoceni hracu - soubor zamyka jeden proces; po upgradu pocka,
+     * az ho pusti predchozi proces (konci hned po potvrzeni predani) */
+    server->ratings.fd = -1;
+    server->ratings.map = NULL;
+    if (config->ratings_path[0] != '\0' &&
+        !ratings_open(&server->ratings, config->ratings_path,
+                      config->upgrade_fd >= 0 ? RATINGS_LOCK_WAIT_MS : 0)) {
+        LOG_WARNING("Continuing without ratings");
+    }
+    
+    /* Fronta rychle hry prevzatych hracu - poradi a doba cekani zustavaji */
+    for (int i = 0; i < config->max_clients; i++) {
+        Player *player = &server->players[i];
+        if (player->is_active && player->state == PLAYER_STATE_QUEUED) {
+            matchqueue_add(&server->match_queue, i, player_rating(server, player),
+                           player->queued_at);
+        }
+    }
+    
+    /* Tokeny prevzatych nebo obnovenych hracu */
+    session_rebuild(&server->sessions, server->players, config->max_clients);
+    
+    /* Prevzate nebo obnovene mistnosti do registru */
+    registry_publish_all(&server->registry, server->rooms);
     
-    LOG_INFO("Server initialized on %s:%d (max clients: %d, max rooms: %d)",
-             config->bind_address, config->port, 
-             config->max_clients, config->max_rooms);
+    if (config->shard_fd >= 0) {
+        LOG_INFO("Shard %d of %d initialized (max clients: %d, room IDs %d-%d)",
+                 config->shard_index, config->shards, config->max_clients,
+                 room_slot_to_id(0), room_slot_to_id(config->max_rooms - 1));
+    } else {
+        LOG_INFO("Server initialized on %s:%d (max clients: %d, max rooms: %d, backlog: %d)",
+                 config->bind_address, config->port, 
+                 config->max_clients, config->max_rooms, config->backlog);
+    }
+    if (server->unix_listen_fd >= 0) {
+        LOG_INFO("Listening on unix socket %s", config->unix_socket_path);
+    }
+    if (server->ws_listen_fd >= 0) {
+        LOG_INFO("Listening for WebSocket clients on %s:%d",
+                 config->bind_address, config->websocket_port);
+    }
     
     return true;
 }
 
+/**
+ * Naplni pole pro poll() - naslouchajici sockety a vsechny pripojene klienty
+ * Naslouchajici sockety a kanal od routeru jsou na zacatku pole (poll_slots = -1).
+ * @return Pocet zaznamu
+ */
+static int build_poll_set(Server *server) {
+    int count = 0;
+    
+    if (server->listen_fd >= 0) {
+        server->poll_fds[count].fd = server->listen_fd;
+        server->poll_fds[count].events = POLLIN;
+        server->poll_fds[count].revents = 0;
+        server->poll_slots[count] = -1;
+        count++;
+    }
+    
+    /* Shard misto listeneru posloucha na kanalu od routeru */
+    if (server->config.shard_fd >= 0) {
+        server->poll_fds[count].fd = server->config.shard_fd;
+        server->poll_fds[count].events = POLLIN;
+        server->poll_fds[count].revents = 0;
+        server->poll_slots[count] = -1;
+        count++;
+    }
+    
+    if (server->unix_listen_fd >= 0) {
+        server->poll_fds[count].fd = server->unix_listen_fd;
+        server->poll_fds[count].events = POLLIN;
+        server->poll_fds[count].revents = 0;
+        server->poll_slots[count] = -1;
+        count++;
+    }
+    
+    if (server->ws_listen_fd >= 0) {
+        server->poll_fds[count].fd = server->ws_listen_fd;
+        server->poll_fds[count].events = POLLIN;
+        server->poll_fds[count].revents = 0;
+        server->poll_slots[count] = -1;
+        count++;
+    }
+    
+    for (int i = 0; i < server->config.max_clients; i++) {
+        if (server->players[i].is_active && server->players[i].socket_fd >= 0) {
+            server->poll_fds[count].fd = server->players[i].socket_fd;
+            /* Cekajici odchozi fronta - probud se, az bude socket zapisovatelny */
+            server->poll_fds[count].events = outqueue_is_empty(&server->players[i].out_queue)
+                                             ? POLLIN : POLLIN | POLLOUT;
+            server->poll_fds[count].revents = 0;
+            server->poll_slots[count] = i;
+            count++;
+        }
+    }
+    
+    return count;
+}
+
 void server_run(Server *server) {
     if (server == NULL) return;
     
     /* Nastav signal handlery */
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    /* Shardy se za behu neupgraduji - predavani stavu zna jen jeden proces */
+    signal(SIGUSR2, server->config.shard_fd >= 0 ? SIG_IGN : upgrade_signal_handler);
     signal(SIGPIPE, SIG_IGN);
     
     server->running = true;
     LOG_INFO("Server started, waiting for connections...");
     
     while (server->running && !g_shutdown_requested) {
-        /* Priprav fd_set */
-        FD_ZERO(&server->read_fds);
-        FD_SET(server->listen_fd, &server->read_fds);
-        
-        for (int i = 0; i < server->config.max_clients; i++) {
-            if (server->players[i].is_active && server->players[i].socket_fd >= 0) {
-                FD_SET(server->players[i].socket_fd, &server->read_fds);
+        /* Upgrade na novy binarni soubor (SIGUSR2) */
+        if (g_upgrade_requested) {
+            g_upgrade_requested = 0;
+            snapshot_save(&server->snapshot, server->players, server->rooms);
+            if (upgrade_handover(server)) {
+                server->handed_over = true;
+                break;
             }
         }
         
-        /* Select s timeoutem */
-        struct timeval timeout;
-        timeout.tv_sec = SELECT_TIMEOUT_SEC;
-        timeout.tv_usec = SELECT_TIMEOUT_USEC;
+        /* Priprav pole pro poll */
+        int nfds = build_poll_set(server);
         
-        int activity = select(server->max_fd + 1, &server->read_fds, NULL, NULL, &timeout);
+        /* Poll ceka nejdele do nejblizsiho terminu hodin tahu */
+        int timeout = timer_poll_timeout(&server->turn_clocks, timer_now_ms(), POLL_TIMEOUT_MS);
+        int activity = sysio_poll(server->poll_fds, nfds, timeout);
         
         if (activity < 0) {
             if (errno == EINTR) continue; /* Preruseno signalem */
-            LOG_ERROR("Select error: %s", strerror(errno));
+            LOG_ERROR("Poll error: %s", strerror(errno));
             break;
         }
         
-        /* Nova spojeni */
-        if (FD_ISSET(server->listen_fd, &server->read_fds)) {
-            accept_new_client(server);
-        }
-        
-        /* Data od klientu */
-        for (int i = 0; i < server->config.max_clients; i++) {
-            Player *player = &server->players[i];
-            if (player->is_active && player->socket_fd >= 0 &&
-                FD_ISSET(player->socket_fd, &server->read_fds)) {
+        /* Nova spojeni a data od klientu */
+        for (int i = 0; i < nfds; i++) {
+            if (server->poll_fds[i].revents == 0) continue;
+            
+            if (server->poll_slots[i] < 0) {
+                if (server->poll_fds[i].fd == server->config.shard_fd) {
+                    receive_from_router(server);
+                } else if (server->poll_fds[i].revents & POLLIN) {
+                    accept_pending_clients(server, server->poll_fds[i].fd);
+                }
+                continue;
+            }
+            
+            Player *player = &server->players[server->poll_slots[i]];
+            /* Hrac mohl byt mezitim odpojen; samotny POLLOUT obslouzi flush_out_queues */
+            if (player->is_active && player->socket_fd == server->poll_fds[i].fd &&
+                (server->poll_fds[i].revents & ~POLLOUT)) {
                 read_from_client(server, player);
             }
         }
         
-        /* Kontrola timeoutu */
+        /* Vyprsele hodiny tahu, pak ostatni timeouty */
+        expire_turn_clocks(server);
         server_check_timeouts(server);
+        
+        /* Zapasy turnaje do mistnosti uvolnenych v teto iteraci */
+        if (server->tournament_pending) {
+            server->tournament_pending = false;
+            tournament_schedule(server);
+        }
+        
+        /* Rychla hra - okna cekajicich se rozsiruji s casem */
+        if (server->match_queue.waiting >= 2 && sysio_time() != server->last_match_pass) {
+            server->last_match_pass = sysio_time();
+            quick_match_schedule(server);
+        }
+        
+        /* Odchozi data - jeden zapis na spojeni, az po obsluze vsech udalosti iterace */
+        flush_out_queues(server);
+        
+        /* Periodicky vypis statistik */
+        time_t now = sysio_time();
+        stats_log_periodic(&server->stats, server->listen_fd, now);
+        
+        /* Prubezny snapshot rozehranych her */
+        snapshot_save_periodic(&server->snapshot, server->players, server->rooms, now);
+        
+        /* Davkovy zapis zurnalu */
+        journal_tick(&server->journal, now);
+        
+        /* Prehled pro router a ostatni shardy */
+        if (server->config.shard_fd >= 0) {
+            publish_shard_summary(server);
+        }
+        
+        /* Davka zmenenych mistnosti do registru */
+        registry_tick(&server->registry, server->rooms, timer_now_ms(), now);
     }
     
-    LOG_INFO("Server shutting down...");
+    stats_log(&server->stats, server->listen_fd);
+    
+    if (server->handed_over) {
+        LOG_INFO("Connections handed over to the new process, exiting...");
+    } else {
+        LOG_INFO("Server shutting down...");
+    }
     server_shutdown(server);
 }
 
+void server_request_upgrade(void) {
+    g_upgrade_requested = 1;
+}
+
+void server_request_shutdown(void) {
+    g_shutdown_requested = 1;
+}
+
 void server_shutdown(Server *server) {
     if (server == NULL) return;
     
     server->running = false;
     
-    /* Informuj vsechny klienty */
+    /* Informuj vsechny klienty - po upgradu jen zavri nase kopie socketu,
+     * spojeni zustavaji otevrena v novem procesu */
     char buffer[64];
-    protocol_create_server_shutdown(buffer, sizeof(buffer));
+    char frame[64];
+    int len = protocol_create_server_shutdown(buffer, sizeof(buffer));
     
     for (int i = 0; i < server->config.max_clients; i++) {
-        if (server->players[i].is_active && server->players[i].socket_fd >= 0) {
-            send(server->players[i].socket_fd, buffer, strlen(buffer), MSG_NOSIGNAL);
-            close(server->players[i].socket_fd);
+        Player *player = &server->players[i];
+        if (player->is_active && player->socket_fd >= 0) {
+            /* Nejdriv doposli frontu - SERVER_SHUTDOWN nesmi skoncit uprostred
+             * rozepsane zpravy; plnemu spojeni ho neposilej */
+            if (!server->handed_over) {
+                outqueue_flush(&player->out_queue, player->socket_fd);
+            }
+            if (!server->handed_over && outqueue_is_empty(&player->out_queue)) {
+                size_t data_len = (size_t)len;
+                const char *data = encode_for_player(player, buffer, &data_len,
+                                                     frame, sizeof(frame));
+                if (data != NULL) {
+                    sysio_send(player->socket_fd, data, data_len);
+                }
+                if (player->ws.state == WS_STATE_OPEN) {
+                    int close_len = ws_create_close(frame, sizeof(frame), WS_CLOSE_GOING_AWAY);
+                    sysio_send(player->socket_fd, frame, (size_t)close_len);
+                }
+            }
+            sysio_close(player->socket_fd);
         }
+        outqueue_clear(&server->players[i].out_queue);
     }
     
     /* Uvolni zdroje */
@@ -974,24 +3219,88 @@ void server_shutdown(Server *server) {
         close(server->listen_fd);
     }
     
+    if (server->ws_listen_fd >= 0) {
+        close(server->ws_listen_fd);
+    }
+    
+    if (server->config.shard_fd >= 0) {
+        close(server->config.shard_fd);
+    }
+    
+    /* Soubor socketu patri dal novemu procesu, jinak ho uklidime */
+    if (server->unix_listen_fd >= 0) {
+        close(server->unix_listen_fd);
+        if (!server->handed_over) {
+            unlink(server->config.unix_socket_path);
+        }
+    }
+    
+    /* Po radnem ukonceni uz neni co obnovovat; po upgradu snapshot
+     * dal vede novy proces */
+    if (!server->handed_over) {
+        snapshot_clear(&server->snapshot);
+    }
+    snapshot_close(&server->snapshot);
+    registry_close(&server->registry, !server->handed_over);
+    journal_close(&server->journal);
+    ratings_close(&server->ratings);
+    session_destroy(&server->sessions);
+    timer_destroy(&server->turn_clocks);
+    tournament_destroy(&server->tournament);
+    matchqueue_destroy(&server->match_queue);
+    solver_cleanup();
+    
     free(server->players);
     free(server->rooms);
+    free(server->poll_fds);
+    free(server->poll_slots);
     
     LOG_INFO("Server shutdown complete");
 }
 
-bool server_send_to_player(Player *player, const char *message) {
-    if (player == NULL || message == NULL || player->socket_fd < 0) {
+/**
+ * Zaradi data (uz ve formatu spojeni) do odchozich dat hrace - odejdou se
+ * vsemi ostatnimi zpravami iterace jednim writev() (flush_out_queues)
+ */
+static bool queue_bytes(Player *player, const char *data, size_t len) {
+    if (player->out_overflow) return false;
+    if (outqueue_append(&player->out_queue, data, len)) return true;
+    
+    /* Divak dostane po vyprazdneni aktualni stav hry - cekajici zpravy
+     * muze zahodit */
+    if (player->watch_room_id >= 0) {
+        outqueue_drop_pending(&player->out_queue);
+        player->resync_pending = true;
+        player->lag_since = sysio_time();
+        if (outqueue_append(&player->out_queue, data, len)) return true;
+    }
+    
+    /* Hrac by prisel o primou odpoved (GAME_STATE, MOVE_OK) a rozesel se
+     * se serverem - odpoji se (flush_out_queues), ze hry se vrati pres
+     * RESUME s uplnym stavem */
+    LOG_WARNING("Output queue of '%s' overflowed, disconnecting",
+                player->nickname[0] ? player->nickname : "(unknown)");
+    player->out_overflow = true;
+    return false;
+}
+
+/**
+ * Zaradi hotovou zpravu zname delky do odchozich dat hrace, prevedenou
+ * do formatu jeho spojeni (binarni nebo WebSocket ramec)
+ */
+static bool send_buffer(Player *player, const char *message, size_t len) {
+    char frame[2 * BUFFER_SIZE];
+    size_t data_len = len;
+    const char *data = encode_for_player(player, message, &data_len, frame, sizeof(frame));
+    
+    if (data == NULL) {
+        LOG_WARNING("Cannot encode message for '%s': %.*s",
+                    player->nickname[0] ? player->nickname : "(unknown)",
+                    (int)(len - 1), message);
         return false;
     }
     
-    size_t len = strlen(message);
-    ssize_t sent = send(player->socket_fd, message, len, MSG_NOSIGNAL);
-    
-    if (sent < 0) {
-        LOG_WARNING("Failed to send to '%s': %s", 
-                    player->nickname[0] ? player->nickname : "(unknown)",
-                    strerror(errno));
+    if (!queue_bytes(player, data, data_len)) {
         return false;
     }
     
@@ -1002,26 +3311,48 @@ bool server_send_to_player(Player *player, const char *message) {
     return true;
 }
 
-void server_broadcast_to_room(Room *room, const char *message, Player *except) {
+bool server_send_to_player(Player *player, const char *message, size_t len) {
+    if (player == NULL || message == NULL || player->socket_fd < 0) {
+        return false;
+    }
+    
+    char tagged[BUFFER_SIZE + REQUEST_ID_MAX_LENGTH + 2];
+    message = with_request_id(player, message, &len, tagged, sizeof(tagged));
+    
+    return send_buffer(player, message, len);
+}
+
+void server_broadcast_to_room(Room *room, const char *message, size_t len, Player *except) {
     if (room == NULL || message == NULL) return;
     
-    for (int i = 0; i < PLAYERS_PER_ROOM; i++) {
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
         Player *player = room->players[i];
-        if (player != NULL && player != except && player->socket_fd >= 0) {
-            server_send_to_player(player, message);
+        if (player == NULL || player == except || player->socket_fd < 0) continue;
+        
+        /* Hrac, jehoz pozadavek se prave zpracovava, dostane zpravu s ID */
+        if (player->request_id[0] == '\0') {
+            send_buffer(player, message, len);
+        } else {
+            server_send_to_player(player, message, len);
         }
     }
 }
 
-void server_broadcast_to_lobby(Server *server, const char *message) {
+void server_broadcast_to_lobby(Server *server, const char *message, size_t len) {
     if (server == NULL || message == NULL) return;
     
-    for (int i = 0; i < server->config.max_clients; i++) {
-        Player *player = &server->players[i];
-        if (player->is_active && player->state == PLAYER_STATE_LOBBY &&
-            player->socket_fd >= 0) {
-            server_send_to_player(player, message);
-        }
+    broadcast_to_local_lobby(server, message, len);
+    
+    /* Lobby ostatnich shardu - zpravu rozesle router */
+    if (server->config.shard_fd >= 0 && len <= BUFFER_SIZE) {
+        ShardMessage msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.type = SHARD_MSG_LOBBY;
+        msg.source = server->config.shard_index;
+        msg.target = -1;
+        msg.text_len = (int32_t)len;
+        memcpy(msg.text, message, len);
+        shard_send(server->config.shard_fd, &msg, -1);
     }
 }
 
@@ -1032,113 +3363,176 @@ void server_handle_message(Server *server, Player *player, const char *message)
         LOG_WARNING("Invalid message from '%s': %s",
                     player->nickname[0] ? player->nickname : "(unknown)",
                     message);
-        player->invalid_message_count++;
-        
-        /* Kontrola limitu nevalidnich zprav */
-        if (player->invalid_message_count >= MAX_INVALID_MESSAGES) {
-            LOG_WARNING("Too many invalid messages from '%s', disconnecting",
-                        player->nickname[0] ? player->nickname : "(unknown)");
-            char response[BUFFER_SIZE];
-            protocol_create_error(response, sizeof(response), ERR_INVALID_FORMAT,
-                                  "Too many invalid messages");
-            server_send_to_player(player, response);
-            server_handle_disconnect(server, player, false);
-        }
+        reject_invalid_message(server, player);
+        return;
+    }
+    
+    dispatch_message(server, player, &parsed);
+}
+
+/**
+ * Preda parsovanou zpravu (z radku nebo binarniho ramce) obsluze
+ */
+static void dispatch_message(Server *server, Player *player, ParsedMessage *parsed) {
+    /* Mistnost nebo session na jinem shardu - zpravu zpracuje on */
+    int target = message_shard(server, player, parsed);
+    if (target >= 0 && move_to_shard(server, player, parsed, target)) {
         return;
     }
     
     /* Dispatch podle typu zpravy */
-    switch (parsed.type) {
+    switch (parsed->type) {
         case MSG_LOGIN:
-            handle_login(server, player, &parsed);
+            handle_login(server, player, parsed);
             break;
         case MSG_LIST_ROOMS:
-            handle_list_rooms(server, player, &parsed);
+            handle_list_rooms(server, player, parsed);
             break;
         case MSG_CREATE_ROOM:
-            handle_create_room(server, player, &parsed);
+            handle_create_room(server, player, parsed);
             break;
         case MSG_JOIN_ROOM:
-            handle_join_room(server, player, &parsed);
+            handle_join_room(server, player, parsed);
             break;
         case MSG_LEAVE_ROOM:
-            handle_leave_room(server, player, &parsed);
+            handle_leave_room(server, player, parsed);
             break;
         case MSG_TAKE:
-            handle_take(server, player, &parsed);
+            handle_take(server, player, parsed);
             break;
         case MSG_SKIP:
-            handle_skip(server, player, &parsed);
+            handle_skip(server, player, parsed);
             break;
         case MSG_PING:
-            handle_ping(server, player, &parsed);
+            handle_ping(server, player, parsed);
             break;
         case MSG_PONG:
-            handle_pong(server, player, &parsed);
+            handle_pong(server, player, parsed);
             break;
         case MSG_LOGOUT:
-            handle_logout(server, player, &parsed);
+            handle_logout(server, player, parsed);
+            break;
+        case MSG_RESUME:
+            handle_resume(server, player, parsed);
+            break;
+        case MSG_ADD_BOT:
+            handle_add_bot(server, player, parsed);
+            break;
+        case MSG_HINT:
+            handle_hint(server, player, parsed);
+            break;
+        case MSG_WATCH:
+            handle_watch(server, player, parsed);
+            break;
+        case MSG_UNWATCH:
+            handle_unwatch(server, player, parsed);
+            break;
+        case MSG_TOURNAMENT_CREATE:
+            handle_tournament_create(server, player, parsed);
+            break;
+        case MSG_TOURNAMENT_JOIN:
+            handle_tournament_join(server, player, parsed);
+            break;
+        case MSG_TOURNAMENT_LEAVE:
+            handle_tournament_leave(server, player, parsed);
+            break;
+        case MSG_TOURNAMENT_START:
+            handle_tournament_start(server, player, parsed);
+            break;
+        case MSG_LEADERBOARD:
+            handle_leaderboard(server, player, parsed);
+            break;
+        case MSG_QUICK_MATCH:
+            handle_quick_match(server, player, parsed);
+            break;
+        case MSG_QUICK_MATCH_CANCEL:
+            handle_quick_match_cancel(server, player, parsed);
             break;
         default:
             LOG_WARNING("Unknown message type from '%s': %s",
                         player->nickname[0] ? player->nickname : "(unknown)",
-                        message);
+                        protocol_message_type_to_string(parsed->type));
             player->invalid_message_count++;
             break;
     }
+    
+    /* Binarni rezim plati od odpovedi na LOGIN/RESUME; uspesny RESUME
+     * prepina rovnou slot puvodniho hrace (handle_resume) */
+    if (protocol_wants_binary(parsed) && player->socket_fd >= 0 &&
+        player->ws.state == WS_STATE_NONE) {
+        player->binary = true;
+    }
+}
+
+/**
+ * Uplne uvolni slot hrace vcetne jeho session
+ */
+static void release_player(Server *server, Player *player) {
+    session_remove(&server->sessions, server->players, player);
+    player_reset(player, false);
+    server->shard_dirty = true;
 }
 
 void server_handle_disconnect(Server *server, Player *player, bool graceful) {
     if (player == NULL) return;
     
     char response[BUFFER_SIZE];
+    int len;
+    
+    if (player->watch_room_id >= 0) {
+        stop_watching(server, player);
+    }
+    
+    /* Hrac cekajici v turnaji odstupuje */
+    if (player->state == PLAYER_STATE_TOURNAMENT) {
+        tournament_withdraw(server, player);
+    }
+    
+    if (player->state == PLAYER_STATE_QUEUED) {
+        quick_match_leave(server, player);
+    }
     
     /* Pokud je ve hre, informuj protihrace */
     if (player->room_id >= 0) {
         Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
         if (room != NULL) {
-            Player *opponent = room_get_opponent(room, player);
+            bool running = room->game.state == GAME_STATE_PLAYING ||
+                           room->game.state == GAME_STATE_PAUSED;
             
-            if (graceful || opponent == NULL) {
-                /* Graceful disconnect nebo zadny protihrac - ukonci hru */
+            if (graceful || !running) {
+                /* Graceful disconnect nebo hra jeste nebezi - ukonci hru */
                 if (room->game.state == GAME_STATE_PLAYING) {
-                    room->game.state = GAME_STATE_FINISHED;
-                    
-                    if (opponent != NULL && opponent->socket_fd >= 0) {
-                        protocol_create_game_over(response, sizeof(response),
-                                                   opponent->nickname, player->nickname);
-                        server_send_to_player(opponent, response);
-                        
-                        room_remove_player(room, opponent);
-                        player_set_state(opponent, PLAYER_STATE_LOBBY);
-                    }
+                    end_game(server, room, room_get_next_online(room, player), player,
+                             JOURNAL_END_DISCONNECT, player);
                 }
                 
                 room_remove_player(room, player);
+                room_vacated(server, room);
             } else {
                 /* Neocekavany disconnect - zachovej pro reconnect */
-                if (opponent != NULL && opponent->socket_fd >= 0) {
-                    protocol_create_player_status(response, sizeof(response),
-                                                   player->nickname, STATUS_DISCONNECTED);
-                    server_send_to_player(opponent, response);
-                }
+                len = protocol_create_player_status(response, sizeof(response),
+                                               player->nickname, STATUS_DISCONNECTED);
+                server_broadcast_to_room(room, response, len, player);
+                broadcast_to_spectators(server, room, response, len);
                 
                 /* Pozastav hru */
                 if (room->game.state == GAME_STATE_PLAYING) {
                     game_pause(&room->game);
+                    stop_turn_clock(server, room);
+                    journal_record(&server->journal, JOURNAL_EV_PAUSE, room,
+                                   room_get_player_index(room, player), 0);
                 }
                 
                 /* Zachovej hrace pro reconnect */
                 player_reset(player, true);
-                update_max_fd(server);
+                server->shard_dirty = true;
                 return;
             }
         }
     }
     
     /* Uplne odpojeni */
-    player_reset(player, false);
-    update_max_fd(server);
+    release_player(server, player);
 }
 
 void server_handle_timeout(Server *server, Player *player) {
@@ -1147,33 +3541,35 @@ void server_handle_timeout(Server *server, Player *player) {
     LOG_WARNING("Player '%s' reconnect timeout expired",
                 player->nickname[0] ? player->nickname : "(unknown)");
     
-    char response[BUFFER_SIZE];
-    
-    /* Informuj protihrace a ukonci hru */
+    /* Ukonci hru - vyhrava prvni pripojeny hrac v poradi za odpojenym */
     if (player->room_id >= 0) {
         Room *room = room_find_by_id(server->rooms, server->config.max_rooms, player->room_id);
         if (room != NULL) {
-            Player *opponent = room_get_opponent(room, player);
+            if (room->game.state == GAME_STATE_PLAYING || room->game.state == GAME_STATE_PAUSED) {
+                Player *winner = room_get_next_online(room, player);
+                end_game(server, room, winner, player,
+                         winner != NULL ? JOURNAL_END_TIMEOUT : JOURNAL_END_ABANDONED, player);
+            }
             
-            if (opponent != NULL && opponent->socket_fd >= 0) {
-                /* Protihrac vyhrává */
-                protocol_create_game_over(response, sizeof(response),
-                                           opponent->nickname, player->nickname);
-                server_send_to_player(opponent, response);
-                
-                room_remove_player(room, opponent);
-                player_set_state(opponent, PLAYER_STATE_LOBBY);
+            /* Ostatni odpojeni (napr. po obnove ze snapshotu) o hru prisli taky */
+            for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+                Player *other = room->players[i];
+                if (other != NULL && other != player && !player_is_online(other)) {
+                    room_remove_player(room, other);
+                    release_player(server, other);
+                }
             }
             
             room_remove_player(room, player);
+            room_vacated(server, room);
         }
     }
     
-    player_reset(player, false);
+    release_player(server, player);
 }
 
 void server_check_timeouts(Server *server) {
-    time_t now = time(NULL);
+    time_t now = sysio_time();
     char buffer[BUFFER_SIZE];
     
     for (int i = 0; i < server->config.max_clients; i++) {
@@ -1194,18 +3590,30 @@ void server_check_timeouts(Server *server) {
             if ((now - player->last_activity) > LOGIN_TIMEOUT) {
                 LOG_WARNING("Client at fd %d login timeout (no LOGIN received)", 
                             player->socket_fd);
-                protocol_create_error(buffer, sizeof(buffer), ERR_NOT_LOGGED_IN,
-                                      "Login timeout");
-                server_send_to_player(player, buffer);
+                /* Prohlizec, ktery nedokoncil handshake, protokolu nerozumi */
+                if (player->ws.state != WS_STATE_HANDSHAKE) {
+                    int len = protocol_create_error(buffer, sizeof(buffer), ERR_NOT_LOGGED_IN,
+                                                    "Login timeout");
+                    server_send_to_player(player, buffer, len);
+                }
                 server_handle_disconnect(server, player, false);
                 continue;
             }
         }
         
+        /* Divak, ktery nestiha odebirat ani po resynchronizaci */
+        if (player->resync_pending && (now - player->lag_since) > SPECTATOR_LAG_TIMEOUT) {
+            LOG_WARNING("Spectator '%s' lagging for %ds, dropping",
+                        player->nickname, SPECTATOR_LAG_TIMEOUT);
+            server_handle_disconnect(server, player, false);
+            continue;
+        }
+        
         /* Kontrola, zda nepotrebuje PING */
-        if (player->socket_fd >= 0 && player_needs_ping(player)) {
-            snprintf(buffer, sizeof(buffer), "PING\n");
-            if (server_send_to_player(player, buffer)) {
+        if (player->socket_fd >= 0 && player->ws.state != WS_STATE_HANDSHAKE &&
+            player_needs_ping(player)) {
+            int len = protocol_create_ping(buffer, sizeof(buffer));
+            if (server_send_to_player(player, buffer, len)) {
                 player->last_ping = now;
                 player->waiting_pong = true;
             }
@@ -1226,10 +3634,44 @@ bool server_parse_args(int argc, char *argv[], ServerConfig *config) {
     config->port = DEFAULT_PORT;
     config->max_clients = DEFAULT_MAX_CLIENTS;
     config->max_rooms = DEFAULT_MAX_ROOMS;
+    config->backlog = DEFAULT_LISTEN_BACKLOG;
+    config->defer_accept = DEFAULT_DEFER_ACCEPT;
+    config->snapshot_path[0] = '\0';
+    config->journal_dir[0] = '\0';
+    strncpy(config->ratings_path, RATINGS_FILE, sizeof(config->ratings_path) - 1);
+    config->ratings_path[sizeof(config->ratings_path) - 1] = '\0';
+    config->unix_socket_path[0] = '\0';
+    config->websocket_port = 0;
+    config->upgrade_fd = -1;
+    config->shards = 1;
+    config->shard_index = 0;
+    config->shard_fd = -1;
+    config->shard_summary = NULL;
+    config->registry[0] = '\0';
     config->verbose = false;
     
+    static const struct option long_options[] = {
+        { "address",      required_argument, NULL, 'a' },
+        { "port",         required_argument, NULL, 'p' },
+        { "clients",      required_argument, NULL, 'c' },
+        { "rooms",        required_argument, NULL, 'r' },
+        { "backlog",      required_argument, NULL, 'b' },
+        { "defer-accept", required_argument, NULL, 'd' },
+        { "snapshot",     required_argument, NULL, 's' },
+        { "journal",      required_argument, NULL, 'j' },
+        { "ratings",      required_argument, NULL, 'e' },
+        { "unix-socket",  required_argument, NULL, OPT_UNIX_SOCKET },
+        { "websocket",    required_argument, NULL, OPT_WEBSOCKET },
+        { "shards",       required_argument, NULL, OPT_SHARDS },
+        { "registry",     required_argument, NULL, OPT_REGISTRY },
+        { "upgrade-fd",   required_argument, NULL, OPT_UPGRADE_FD },
+        { "verbose",      no_argument,       NULL, 'v' },
+        { "help",         no_argument,       NULL, 'h' },
+        { NULL,           0,                 NULL, 0 }
+    };
+    
     int opt;
-    while ((opt = getopt(argc, argv, "a:p:c:r:vh")) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:p:c:r:b:d:s:j:e:vh", long_options, NULL)) != -1) {
         switch (opt) {
             case 'a':
                 strncpy(config->bind_address, optarg, sizeof(config->bind_address) - 1);
@@ -1255,6 +3697,61 @@ bool server_parse_args(int argc, char *argv[], ServerConfig *config) {
                     return false;
                 }
                 break;
+            case 'b':
+                config->backlog = atoi(optarg);
+                if (config->backlog <= 0) {
+                    fprintf(stderr, "Invalid backlog: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'd':
+                config->defer_accept = atoi(optarg);
+                if (config->defer_accept < 0) {
+                    fprintf(stderr, "Invalid defer-accept timeout: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 's':
+                strncpy(config->snapshot_path, optarg, sizeof(config->snapshot_path) - 1);
+                config->snapshot_path[sizeof(config->snapshot_path) - 1] = '\0';
+                break;
+            case 'j':
+                strncpy(config->journal_dir, optarg, sizeof(config->journal_dir) - 1);
+                config->journal_dir[sizeof(config->journal_dir) - 1] = '\0';
+                break;
+            case 'e':
+                strncpy(config->ratings_path, optarg, sizeof(config->ratings_path) - 1);
+                config->ratings_path[sizeof(config->ratings_path) - 1] = '\0';
+                break;
+            case OPT_UNIX_SOCKET:
+                if (strlen(optarg) >= sizeof(config->unix_socket_path)) {
+                    fprintf(stderr, "Unix socket path too long: %s\n", optarg);
+                    return false;
+                }
+                strcpy(config->unix_socket_path, optarg);
+                break;
+            case OPT_WEBSOCKET:
+                config->websocket_port = atoi(optarg);
+                if (config->websocket_port <= 0 || config->websocket_port > 65535) {
+                    fprintf(stderr, "Invalid WebSocket port: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case OPT_SHARDS:
+                config->shards = atoi(optarg);
+                if (config->shards < 1 || config->shards > SHARD_MAX) {
+                    fprintf(stderr, "Invalid shard count: %s (1-%d)\n", optarg, SHARD_MAX);
+                    return false;
+                }
+                break;
+            case OPT_REGISTRY:
+                strncpy(config->registry, optarg, sizeof(config->registry) - 1);
+                config->registry[sizeof(config->registry) - 1] = '\0';
+                break;
+            case OPT_UPGRADE_FD:
+                /* Interni - predava ho stary proces pri upgradu */
+                config->upgrade_fd = atoi(optarg);
+                break;
             case 'v':
                 config->verbose = true;
                 break;
@@ -1265,6 +3762,23 @@ bool server_parse_args(int argc, char *argv[], ServerConfig *config) {
         }
     }
     
+    /* Stav shardu neumi upgrade predat - novy proces by prevzal jen jeden */
+    if (config->shards > 1 && config->upgrade_fd >= 0) {
+        fprintf(stderr, "--shards cannot be combined with a running upgrade\n");
+        return false;
+    }
+    
+    /* Shardy uz maji sdileny prehled; uzel registru vlastni jen
+     * REGISTRY_NODE_ROOMS ID mistnosti */
+    if (config->registry[0] != '\0' && config->shards > 1) {
+        fprintf(stderr, "--registry cannot be combined with --shards\n");
+        return false;
+    }
+    if (config->registry[0] != '\0' && config->max_rooms > REGISTRY_NODE_ROOMS) {
+        fprintf(stderr, "--registry allows at most %d rooms\n", REGISTRY_NODE_ROOMS);
+        return false;
+    }
+    
     return true;
 }
 
@@ -1276,6 +3790,24 @@ void server_print_usage(const char *program_name) {
     printf("  -p PORT      Port number (default: %d)\n", DEFAULT_PORT);
     printf("  -c COUNT     Maximum clients (default: %d)\n", DEFAULT_MAX_CLIENTS);
     printf("  -r COUNT     Maximum rooms (default: %d)\n", DEFAULT_MAX_ROOMS);
+    printf("  -b, --backlog COUNT\n");
+    printf("               Listen backlog (default: %d)\n", DEFAULT_LISTEN_BACKLOG);
+    printf("  -d, --defer-accept SECONDS\n");
+    printf("               TCP_DEFER_ACCEPT timeout, 0 = off (default: %d)\n", DEFAULT_DEFER_ACCEPT);
+    printf("  -s, --snapshot FILE\n");
+    printf("               Snapshot file for restoring games after a crash (default: off)\n");
+    printf("  -j, --journal DIR\n");
+    printf("               Directory for the game event journal (default: off)\n");
+    printf("  -e, --ratings FILE\n");
+    printf("               Player ratings file, empty = off (default: %s)\n", RATINGS_FILE);
+    printf("  --unix-socket PATH\n");
+    printf("               Additional AF_UNIX listener for local gateways and bots (default: off)\n");
+    printf("  --websocket PORT\n");
+    printf("               WebSocket listener for browser clients (default: off)\n");
+    printf("  --shards COUNT\n");
+    printf("               Run COUNT shard processes behind a routing front door, max %d (default: 1)\n", SHARD_MAX);
+    printf("  --registry PATH\n");
+    printf("               Share the lobby with other servers through a registry file (default: off)\n");
     printf("  -v           Verbose mode (log to stdout instead of file)\n");
     printf("  -h           Show this help\n");
 }
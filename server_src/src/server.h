@@ -1,6 +1,6 @@
 /**
  * @file server.h
- * @brief Hlavni serverovy modul - socket handling, select() loop
+ * @brief Hlavni serverovy modul - socket handling, poll() loop
  */
 
 #ifndef SERVER_H
@@ -8,9 +8,20 @@
 
 #include <stdbool.h>
 #include <netinet/in.h>
-#include <sys/select.h>
+#include <poll.h>
 #include "player.h"
 #include "room.h"
+#include "stats.h"
+#include "snapshot.h"
+#include "session.h"
+#include "journal.h"
+#include "ratings.h"
+#include "matchmaking.h"
+#include "timer.h"
+#include "tournament.h"
+#include "shard.h"
+#include "registry.h"
+#include "sysio.h"
 #include "../include/config.h"
 
 /* ============================================
@@ -22,6 +33,19 @@ typedef struct {
     int port;
     int max_clients;
     int max_rooms;
+    int backlog;            /* Delka fronty pro listen() */
+    int defer_accept;       /* TCP_DEFER_ACCEPT v sekundach (0 = vypnuto) */
+    char snapshot_path[256]; /* Soubor se snapshotem her (prazdny = vypnuto) */
+    char journal_dir[256];  /* Adresar zurnalu udalosti (prazdny = vypnuto) */
+    char ratings_path[256]; /* Soubor s hodnocenim hracu (prazdny = vypnuto) */
+    char unix_socket_path[108]; /* AF_UNIX socket pro lokalni klienty (prazdny = vypnuto) */
+    int websocket_port;     /* Port WebSocket listeneru (0 = vypnuto) */
+    int upgrade_fd;         /* Kanal pro prevzeti stavu pri upgradu (-1 = bezny start) */
+    int shards;             /* Pocet shardu za routerem (--shards, 1 = jeden proces) */
+    int shard_index;        /* Index tohoto shardu (nastavuje router) */
+    int shard_fd;           /* Kanal k routeru (-1 = server neni shard) */
+    ShardSummary *shard_summary; /* Sdileny prehled shardu (nastavuje router) */
+    char registry[256];     /* Registr lobby federace (prazdny = vypnuto) */
     bool verbose;           /* Verbose mode - log to stdout */
 } ServerConfig;
 
@@ -31,12 +55,30 @@ typedef struct {
 
 typedef struct {
     int listen_fd;                  /* Socket pro naslouchani */
+    int unix_listen_fd;             /* Naslouchajici AF_UNIX socket (-1 = vypnuto) */
+    int ws_listen_fd;               /* Naslouchajici WebSocket socket (-1 = vypnuto) */
     ServerConfig config;            /* Konfigurace */
-    Player *players;                /* Pole hracu */
+    Player *players;                /* Pole hracu (max_clients + sloty botu) */
     Room *rooms;                    /* Pole mistnosti */
     bool running;                   /* Server bezi? */
-    fd_set read_fds;               /* File descriptory pro select */
-    int max_fd;                     /* Nejvyssi fd pro select */
+    struct pollfd *poll_fds;        /* File descriptory pro poll() */
+    int *poll_slots;                /* Index hrace ke kazdemu zaznamu v poll_fds (-1 = listener) */
+    bool handed_over;               /* Spojeni prevzal novy proces (upgrade) */
+    ServerStats stats;              /* Provozni statistiky */
+    Snapshot snapshot;              /* Snapshot rozehranych her */
+    SessionTable sessions;          /* Session tokeny pro RESUME */
+    Journal journal;                /* Zurnal hernich udalosti */
+    RatingStore ratings;            /* Hodnoceni hracu a zebricek */
+    MatchQueue match_queue;         /* Fronta rychle hry */
+    unsigned int quick_match_seq;   /* Cislo posledni mistnosti rychle hry */
+    time_t last_match_pass;         /* Posledni pruchod fronty (rozsirena okna) */
+    TimerHeap turn_clocks;          /* Terminy hodin tahu (cislo casovace = slot mistnosti) */
+    Tournament tournament;          /* Turnaj (nejvys jeden soucasne) */
+    bool tournament_pending;        /* Dohrany zapas - rozehrat dalsi na konci iterace */
+    bool shard_routed;              /* Zpravu sem presunul jiny shard - zpracovat zde */
+    bool shard_dirty;               /* Hraci, spojeni nebo zebricek se zmenili od zverejneni */
+    unsigned int shard_room_seq;    /* room_change_seq() pri poslednim zverejneni */
+    Registry registry;              /* Registr lobby federace (--registry) */
 } Server;
 
 /* ============================================
@@ -67,24 +109,27 @@ void server_shutdown(Server *server);
  * Odesle zpravu klientovi
  * @param player Cilovy hrac
  * @param message Zprava k odeslani
+ * @param len Delka zpravy (vraci ji protocol_create_*)
  * @return true pri uspechu
  */
-bool server_send_to_player(Player *player, const char *message);
+bool server_send_to_player(Player *player, const char *message, size_t len);
 
 /**
  * Odesle zpravu vsem hracum v mistnosti
  * @param room Mistnost
  * @param message Zprava
+ * @param len Delka zpravy
  * @param except Hrac, kteremu se zprava neposila (muze byt NULL)
  */
-void server_broadcast_to_room(Room *room, const char *message, Player *except);
+void server_broadcast_to_room(Room *room, const char *message, size_t len, Player *except);
 
 /**
  * Odesle zpravu vsem hracum v lobby
  * @param server Server
  * @param message Zprava
+ * @param len Delka zpravy
  */
-void server_broadcast_to_lobby(Server *server, const char *message);
+void server_broadcast_to_lobby(Server *server, const char *message, size_t len);
 
 /**
  * Zpracuje prijatou zpravu od klienta
@@ -115,6 +160,31 @@ void server_handle_timeout(Server *server, Player *player);
  */
 void server_check_timeouts(Server *server);
 
+/**
+ * Vytvori naslouchajici TCP socket na adrese z konfigurace (i pro router)
+ * @param config Konfigurace
+ * @param port Port (hlavni nebo WebSocket)
+ * @return Socket nebo -1 pri chybe
+ */
+int server_create_tcp_listener(const ServerConfig *config, int port);
+
+/**
+ * Vytvori naslouchajici AF_UNIX socket na config->unix_socket_path (i pro router)
+ * @param config Konfigurace
+ * @return Socket nebo -1 pri chybe
+ */
+int server_create_unix_listener(const ServerConfig *config);
+
+/**
+ * Pozada o upgrade na novy binarni soubor (async-signal-safe, volano z SIGUSR2)
+ */
+void server_request_upgrade(void);
+
+/**
+ * Pozada o ukonceni hlavni smycky (jako SIGTERM; volaji simulace a nastroje)
+ */
+void server_request_shutdown(void);
+
 /**
  * Parsuje argumenty prikazove radky
  * @param argc Pocet argumentu
@@ -0,0 +1,214 @@
+/**
+ * @file session.c
+ * @brief Implementace session tokenu
+ *
+ * Tabulka pouziva linearni sondovani s mazanim posunem (bez nahrobku).
+ * Token je nahodny, takze jako hash staci jeho prvnich 8 bajtu.
+ */
+
+#include "session.h"
+#include "logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static unsigned int token_hash(const unsigned char *token, int capacity) {
+    uint64_t h;
+    memcpy(&h, token, sizeof(h));
+    return (unsigned int)(h & (uint64_t)(capacity - 1));
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * Vlozi slot do tabulky (token uz je u hrace nastaven)
+ */
+static void insert_slot(SessionTable *table, Player *players, int slot) {
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int i = token_hash(players[slot].session_token, table->capacity);
+
+    while (table->slots[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    table->slots[i] = slot;
+    table->count++;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool session_init(SessionTable *table, int max_clients) {
+    memset(table, 0, sizeof(SessionTable));
+    table->random_fd = -1;
+
+    /* Zaplneni nejvyse na polovinu - kratke retezce sondovani */
+    int capacity = 16;
+    while (capacity < 2 * max_clients) {
+        capacity *= 2;
+    }
+
+    table->slots = malloc(capacity * sizeof(int));
+    if (table->slots == NULL) {
+        LOG_ERROR("Failed to allocate session table");
+        return false;
+    }
+    for (int i = 0; i < capacity; i++) {
+        table->slots[i] = -1;
+    }
+    table->capacity = capacity;
+
+    table->random_fd = open(SESSION_RANDOM_SOURCE, O_RDONLY | O_CLOEXEC);
+    if (table->random_fd < 0) {
+        LOG_ERROR("Cannot open %s: %s", SESSION_RANDOM_SOURCE, strerror(errno));
+        free(table->slots);
+        table->slots = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void session_destroy(SessionTable *table) {
+    if (table == NULL) return;
+
+    free(table->slots);
+    table->slots = NULL;
+    if (table->random_fd >= 0) {
+        close(table->random_fd);
+        table->random_fd = -1;
+    }
+}
+
+bool session_issue(SessionTable *table, Player *players, Player *player) {
+    if (table == NULL || table->slots == NULL || player == NULL) return false;
+
+    session_remove(table, players, player);
+
+    ssize_t got = read(table->random_fd, player->session_token, SESSION_TOKEN_BYTES);
+    if (got != SESSION_TOKEN_BYTES) {
+        LOG_ERROR("Failed to generate session token");
+        return false;
+    }
+
+    player->has_session = true;
+    insert_slot(table, players, (int)(player - players));
+    return true;
+}
+
+bool session_adopt(SessionTable *table, Player *players, Player *player) {
+    if (table == NULL || table->slots == NULL || player == NULL || !player->has_session) {
+        return false;
+    }
+
+    insert_slot(table, players, (int)(player - players));
+    return true;
+}
+
+Player* session_find(SessionTable *table, Player *players, const char *token_hex) {
+    if (table == NULL || table->slots == NULL || token_hex == NULL) return NULL;
+
+    unsigned char token[SESSION_TOKEN_BYTES];
+    if (!session_token_from_hex(token_hex, token)) return NULL;
+
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int i = token_hash(token, table->capacity);
+
+    while (table->slots[i] >= 0) {
+        Player *player = &players[table->slots[i]];
+        if (player->is_active && player->has_session &&
+            memcmp(player->session_token, token, SESSION_TOKEN_BYTES) == 0) {
+            return player;
+        }
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+void session_remove(SessionTable *table, Player *players, Player *player) {
+    if (table == NULL || table->slots == NULL || player == NULL || !player->has_session) {
+        return;
+    }
+
+    int slot = (int)(player - players);
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int i = token_hash(player->session_token, table->capacity);
+
+    while (table->slots[i] >= 0 && table->slots[i] != slot) {
+        i = (i + 1) & mask;
+    }
+    player->has_session = false;
+    if (table->slots[i] < 0) return;
+
+    /* Mazani posunem - polozky za dirou, ktere by ji pri hledani
+     * nepreskocily, posuneme zpet */
+    unsigned int j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (table->slots[j] < 0) break;
+
+        unsigned int home = token_hash(players[table->slots[j]].session_token, table->capacity);
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            table->slots[i] = table->slots[j];
+            i = j;
+        }
+    }
+    table->slots[i] = -1;
+    table->count--;
+}
+
+void session_rebuild(SessionTable *table, Player *players, int count) {
+    if (table == NULL || table->slots == NULL) return;
+
+    for (int i = 0; i < table->capacity; i++) {
+        table->slots[i] = -1;
+    }
+    table->count = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (players[i].is_active && players[i].has_session) {
+            insert_slot(table, players, i);
+        }
+    }
+}
+
+bool session_token_from_hex(const char *hex, unsigned char *token) {
+    if (strlen(hex) != SESSION_TOKEN_HEX_LENGTH) return false;
+
+    for (int i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        int hi = hex_value(hex[2 * i]);
+        int lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        token[i] = (unsigned char)((hi << 4) | lo);
+    }
+    return true;
+}
+
+void session_token_to_hex(const Player *player, char *buffer, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+
+    if (size < SESSION_TOKEN_HEX_LENGTH + 1) {
+        if (size > 0) buffer[0] = '\0';
+        return;
+    }
+
+    for (int i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        buffer[2 * i] = digits[player->session_token[i] >> 4];
+        buffer[2 * i + 1] = digits[player->session_token[i] & 0x0F];
+    }
+    buffer[SESSION_TOKEN_HEX_LENGTH] = '\0';
+}
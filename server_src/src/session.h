@@ -0,0 +1,111 @@
+/**
+ * @file session.h
+ * @brief Session tokeny pro obnoveni spojeni (RESUME)
+ *
+ * Pri prihlaseni server vyda hraci nahodny token (LOGIN_OK;token).
+ * Po vypadku se klient vraci zpravou RESUME;token, ktera se pres
+ * hashovaci tabulku mapuje primo na slot hrace - bez hledani podle
+ * prezdivky a bez moznosti prevzit cizi hru jen znalosti prezdivky.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "player.h"
+#include "../include/config.h"
+
+/** Delka tokenu v hex zapisu (bez '\0') */
+#define SESSION_TOKEN_HEX_LENGTH (SESSION_TOKEN_BYTES * 2)
+
+/* ============================================
+ * STRUKTURA TABULKY
+ * ============================================ */
+
+typedef struct {
+    int *slots;                 /* Index hrace nebo -1 (otevrene adresovani) */
+    int capacity;               /* Velikost tabulky (mocnina dvou) */
+    int count;                  /* Pocet platnych session */
+    int random_fd;              /* Zdroj nahodnych dat */
+} SessionTable;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Inicializuje tabulku session
+ * @param table Tabulka
+ * @param max_clients Velikost tabulky hracu
+ * @return true pri uspechu
+ */
+bool session_init(SessionTable *table, int max_clients);
+
+/**
+ * Uvolni tabulku session
+ * @param table Tabulka
+ */
+void session_destroy(SessionTable *table);
+
+/**
+ * Vyda hraci novy token a zaradi ho do tabulky
+ * @param table Tabulka
+ * @param players Pole hracu
+ * @param player Hrac
+ * @return true pri uspechu
+ */
+bool session_issue(SessionTable *table, Player *players, Player *player);
+
+/**
+ * Zaradi do tabulky token, se kterym hrac prisel z jineho shardu
+ * @param table Tabulka
+ * @param players Pole hracu
+ * @param player Hrac (token a has_session uz jsou nastaveny)
+ * @return true pokud hrac session ma
+ */
+bool session_adopt(SessionTable *table, Player *players, Player *player);
+
+/**
+ * Najde hrace podle tokenu v hex zapisu
+ * @param table Tabulka
+ * @param players Pole hracu
+ * @param token_hex Token z RESUME
+ * @return Ukazatel na hrace nebo NULL
+ */
+Player* session_find(SessionTable *table, Player *players, const char *token_hex);
+
+/**
+ * Odebere session hrace z tabulky (volat pred uplnym resetem hrace)
+ * @param table Tabulka
+ * @param players Pole hracu
+ * @param player Hrac
+ */
+void session_remove(SessionTable *table, Player *players, Player *player);
+
+/**
+ * Znovu sestavi tabulku z tokenu ulozenych u hracu
+ * (po prevzeti stavu pri upgradu nebo obnove ze snapshotu)
+ * @param table Tabulka
+ * @param players Pole hracu
+ * @param count Pocet slotu
+ */
+void session_rebuild(SessionTable *table, Player *players, int count);
+
+/**
+ * Prevede token z hex zapisu
+ * @param hex Token z RESUME
+ * @param token Vystup (SESSION_TOKEN_BYTES bajtu)
+ * @return false pokud retezec nema spravnou delku nebo znaky
+ */
+bool session_token_from_hex(const char *hex, unsigned char *token);
+
+/**
+ * Zapise token hrace jako hex retezec
+ * @param player Hrac
+ * @param buffer Vystup (alespon SESSION_TOKEN_HEX_LENGTH + 1 bajtu)
+ * @param size Velikost bufferu
+ */
+void session_token_to_hex(const Player *player, char *buffer, size_t size);
+
+#endif /* SESSION_H */
@@ -0,0 +1,436 @@
+/**
+ * @file shard.c
+ * @brief Implementace sdileneho prehledu shardu a kanalu k routeru
+ *
+ * Oblast jednoho shardu ve sdilene pameti:
+ *   ShardHeader | ShardRoom[max_rooms] | ShardPlayer[max_clients]
+ * Do oblasti zapisuje jen jeji shard, ctou ji vsichni. Zapis je obalen
+ * seqlockem (liche seq = probiha zapis), ctenar si hodnoty zformatuje
+ * a pri zmene seq behem cteni to udela znovu.
+ */
+
+/* MAP_ANONYMOUS je dostupne jen s _DEFAULT_SOURCE */
+#define _DEFAULT_SOURCE
+
+#include "shard.h"
+#include "session.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* ============================================
+ * ROZLOZENI SDILENE PAMETI
+ * ============================================ */
+
+typedef struct {
+    uint32_t seq;                           /* Seqlock */
+    int32_t alive;                          /* Shard bezi (nastavuje router) */
+    int32_t connections;                    /* Pripojena spojeni (rozdelovani routeru) */
+    int32_t room_count;                     /* Platne zaznamy ShardRoom */
+    int32_t player_count;                   /* Platne zaznamy ShardPlayer */
+    int32_t leaderboard_count;              /* Zebricek (jen SHARD_HOME) */
+    RatingEntry leaderboard[LEADERBOARD_SIZE];
+} ShardHeader;
+
+typedef struct {
+    int32_t id;
+    int32_t player_count;
+    int32_t capacity;
+    char name[MAX_ROOM_NAME_LENGTH + 1];
+} ShardRoom;
+
+typedef struct {
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    bool has_session;
+    unsigned char session_token[SESSION_TOKEN_BYTES];
+} ShardPlayer;
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static ShardHeader* header_of(const ShardSummary *summary, int shard) {
+    return (ShardHeader *)((char *)summary->map + summary->stride * (size_t)shard);
+}
+
+static ShardRoom* rooms_of(const ShardSummary *summary, int shard) {
+    return (ShardRoom *)(header_of(summary, shard) + 1);
+}
+
+static ShardPlayer* players_of(const ShardSummary *summary, int shard) {
+    return (ShardPlayer *)(rooms_of(summary, shard) + summary->max_rooms);
+}
+
+static uint32_t read_begin(const ShardHeader *header) {
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE)) & 1u) {
+        /* Zapis prave probiha - trva jen kopii nekolika zaznamu */
+    }
+    return seq;
+}
+
+static bool read_retry(const ShardHeader *header, uint32_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&header->seq, __ATOMIC_RELAXED) != seq;
+}
+
+/**
+ * Zapise jeden zaznam mistnosti ve formatu LIST_ROOMS
+ */
+static int format_room(char *buffer, int size, int id, const char *name,
+                       int player_count, int capacity) {
+    return snprintf(buffer, size, ";%d,%s,%d,%d", id, name, player_count, capacity);
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI - PREHLED
+ * ============================================ */
+
+bool shard_summary_create(ShardSummary *summary, int count, int max_clients, int max_rooms) {
+    memset(summary, 0, sizeof(ShardSummary));
+
+    size_t stride = sizeof(ShardHeader) + sizeof(ShardRoom) * (size_t)max_rooms +
+                    sizeof(ShardPlayer) * (size_t)max_clients;
+    stride = (stride + 63) & ~(size_t)63;
+
+    /* Anonymni sdilene mapovani zdedi shardy pri fork() */
+    void *map = mmap(NULL, stride * (size_t)count, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Shards: mmap of the summary failed: %s", strerror(errno));
+        return false;
+    }
+
+    summary->map = map;
+    summary->map_size = stride * (size_t)count;
+    summary->stride = stride;
+    summary->count = count;
+    summary->max_clients = max_clients;
+    summary->max_rooms = max_rooms;
+    return true;
+}
+
+void shard_summary_destroy(ShardSummary *summary) {
+    if (summary->map != NULL) {
+        munmap(summary->map, summary->map_size);
+    }
+    summary->map = NULL;
+}
+
+void shard_set_alive(ShardSummary *summary, int shard, bool alive) {
+    ShardHeader *header = header_of(summary, shard);
+    __atomic_store_n(&header->connections, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->alive, alive ? 1 : 0, __ATOMIC_RELEASE);
+    if (!alive) {
+        /* Mistnosti a hraci mrtveho shardu uz nejsou dosazitelni */
+        uint32_t seq = header->seq;
+        __atomic_store_n(&header->seq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        header->room_count = 0;
+        header->player_count = 0;
+        header->leaderboard_count = 0;
+        __atomic_store_n(&header->seq, seq + 2, __ATOMIC_RELEASE);
+    }
+}
+
+void shard_publish(ShardSummary *summary, int shard, const Room *rooms,
+                   const Player *players, const RatingStore *ratings) {
+    ShardHeader *header = header_of(summary, shard);
+    ShardRoom *room_out = rooms_of(summary, shard);
+    ShardPlayer *player_out = players_of(summary, shard);
+    int room_count = 0;
+    int player_count = 0;
+    int connections = 0;
+
+    uint32_t seq = header->seq;
+    __atomic_store_n(&header->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (int i = 0; i < summary->max_rooms; i++) {
+        const Room *room = &rooms[i];
+        if (!room->is_active) continue;
+
+        ShardRoom *out = &room_out[room_count++];
+        out->id = room->id;
+        out->player_count = room->player_count;
+        out->capacity = room->game.rules.player_count;
+        memcpy(out->name, room->name, sizeof(out->name));
+    }
+
+    for (int i = 0; i < summary->max_clients; i++) {
+        const Player *player = &players[i];
+        if (!player->is_active) continue;
+        if (player->socket_fd >= 0) connections++;
+        if (player->nickname[0] == '\0') continue;
+
+        ShardPlayer *out = &player_out[player_count++];
+        memcpy(out->nickname, player->nickname, sizeof(out->nickname));
+        out->has_session = player->has_session;
+        memcpy(out->session_token, player->session_token, SESSION_TOKEN_BYTES);
+    }
+
+    header->room_count = room_count;
+    header->player_count = player_count;
+    if (shard == SHARD_HOME) {
+        header->leaderboard_count = ratings_top_entries(ratings, header->leaderboard,
+                                                        LEADERBOARD_SIZE);
+    }
+
+    __atomic_store_n(&header->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->connections, connections, __ATOMIC_RELAXED);
+}
+
+bool shard_is_alive(const ShardSummary *summary, int shard) {
+    if (shard < 0 || shard >= summary->count) return false;
+    return __atomic_load_n(&header_of(summary, shard)->alive, __ATOMIC_ACQUIRE) != 0;
+}
+
+int shard_least_loaded(ShardSummary *summary) {
+    int best = -1;
+    int best_connections = 0;
+
+    for (int i = 0; i < summary->count; i++) {
+        const ShardHeader *header = header_of(summary, i);
+        if (!__atomic_load_n(&header->alive, __ATOMIC_ACQUIRE)) continue;
+
+        int connections = __atomic_load_n(&header->connections, __ATOMIC_RELAXED);
+        if (best < 0 || connections < best_connections) {
+            best = i;
+            best_connections = connections;
+        }
+    }
+
+    if (best >= 0) {
+        __atomic_add_fetch(&header_of(summary, best)->connections, 1, __ATOMIC_RELAXED);
+    }
+    return best;
+}
+
+int shard_room_owner(const ShardSummary *summary, int room_id) {
+    if (room_id < 0) return -1;
+    int shard = room_id / summary->max_rooms;
+    return shard < summary->count ? shard : -1;
+}
+
+int shard_find_nickname(const ShardSummary *summary, int self, const char *nickname) {
+    for (int s = 0; s < summary->count; s++) {
+        if (s == self) continue;
+
+        const ShardHeader *header = header_of(summary, s);
+        const ShardPlayer *players = players_of(summary, s);
+        bool found;
+        uint32_t seq;
+        do {
+            seq = read_begin(header);
+            found = false;
+            for (int i = 0; i < header->player_count && !found; i++) {
+                found = strncmp(players[i].nickname, nickname, MAX_NICKNAME_LENGTH) == 0;
+            }
+        } while (read_retry(header, seq));
+
+        if (found) return s;
+    }
+    return -1;
+}
+
+int shard_find_room_name(const ShardSummary *summary, int self, const char *name) {
+    for (int s = 0; s < summary->count; s++) {
+        if (s == self) continue;
+
+        const ShardHeader *header = header_of(summary, s);
+        const ShardRoom *rooms = rooms_of(summary, s);
+        bool found;
+        uint32_t seq;
+        do {
+            seq = read_begin(header);
+            found = false;
+            for (int i = 0; i < header->room_count && !found; i++) {
+                found = strncmp(rooms[i].name, name, MAX_ROOM_NAME_LENGTH) == 0;
+            }
+        } while (read_retry(header, seq));
+
+        if (found) return s;
+    }
+    return -1;
+}
+
+int shard_find_session(const ShardSummary *summary, int self, const char *token_hex) {
+    unsigned char token[SESSION_TOKEN_BYTES];
+    if (!session_token_from_hex(token_hex, token)) return -1;
+
+    for (int s = 0; s < summary->count; s++) {
+        if (s == self) continue;
+
+        const ShardHeader *header = header_of(summary, s);
+        const ShardPlayer *players = players_of(summary, s);
+        bool found;
+        uint32_t seq;
+        do {
+            seq = read_begin(header);
+            found = false;
+            for (int i = 0; i < header->player_count && !found; i++) {
+                found = players[i].has_session &&
+                        memcmp(players[i].session_token, token, SESSION_TOKEN_BYTES) == 0;
+            }
+        } while (read_retry(header, seq));
+
+        if (found) return s;
+    }
+    return -1;
+}
+
+int shard_room_list_to_string(const ShardSummary *summary, int self, const Room *rooms,
+                              char *buffer, int size) {
+    if (buffer == NULL || size <= 0) return 0;
+
+    /* Zaznamy se skladaji za sebe, celkovy pocet jde az na zacatek */
+    char entries[BUFFER_SIZE];
+    int entries_size = size < (int)sizeof(entries) ? size : (int)sizeof(entries);
+    int written = 0;
+    int total = 0;
+
+    for (int s = 0; s < summary->count; s++) {
+        if (s == self) {
+            for (int i = 0; i < summary->max_rooms; i++) {
+                if (!rooms[i].is_active) continue;
+                total++;
+                if (written < entries_size - 1) {
+                    written += format_room(entries + written, entries_size - written,
+                                           rooms[i].id, rooms[i].name,
+                                           rooms[i].player_count,
+                                           rooms[i].game.rules.player_count);
+                }
+            }
+            continue;
+        }
+
+        const ShardHeader *header = header_of(summary, s);
+        const ShardRoom *shard_rooms = rooms_of(summary, s);
+        int start_written = written;
+        int start_total = total;
+        uint32_t seq;
+        do {
+            seq = read_begin(header);
+            written = start_written;
+            total = start_total;
+            for (int i = 0; i < header->room_count; i++) {
+                total++;
+                if (written < entries_size - 1) {
+                    written += format_room(entries + written, entries_size - written,
+                                           shard_rooms[i].id, shard_rooms[i].name,
+                                           shard_rooms[i].player_count,
+                                           shard_rooms[i].capacity);
+                }
+            }
+        } while (read_retry(header, seq));
+    }
+
+    if (written > entries_size - 1) written = entries_size - 1;
+    entries[written] = '\0';
+    return snprintf(buffer, size, "%d%s", total, entries);
+}
+
+int shard_leaderboard_to_string(const ShardSummary *summary, int count, char *buffer, int size) {
+    const ShardHeader *header = header_of(summary, SHARD_HOME);
+    RatingEntry top[LEADERBOARD_SIZE];
+    int available;
+    uint32_t seq;
+
+    do {
+        seq = read_begin(header);
+        available = header->leaderboard_count;
+        if (available > LEADERBOARD_SIZE) available = LEADERBOARD_SIZE;
+        memcpy(top, header->leaderboard, sizeof(RatingEntry) * (size_t)available);
+    } while (read_retry(header, seq));
+
+    return ratings_entries_to_string(top, available, count, buffer, size);
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI - KANAL
+ * ============================================ */
+
+bool shard_send(int channel, const ShardMessage *msg, int fd) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov;
+    struct msghdr hdr;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memset(control, 0, sizeof(control));
+    iov.iov_base = (void *)msg;
+    iov.iov_len = sizeof(ShardMessage);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    if (fd >= 0) {
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(channel, &hdr, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent != (ssize_t)sizeof(ShardMessage)) {
+        LOG_ERROR("Shards: channel send failed: %s", sent < 0 ? strerror(errno) : "short write");
+        return false;
+    }
+    return true;
+}
+
+int shard_recv(int channel, ShardMessage *msg, int *fd) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov;
+    struct msghdr hdr;
+
+    *fd = -1;
+    memset(&hdr, 0, sizeof(hdr));
+    iov.iov_base = msg;
+    iov.iov_len = sizeof(ShardMessage);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(channel, &hdr, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+
+    if (received == 0) return 0;
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("Shards: channel receive failed: %s", strerror(errno));
+        }
+        return -1;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    /* Seqpacket doruci celou zpravu, nebo ji zkrati - zkracenou zahodime */
+    if (received != (ssize_t)sizeof(ShardMessage) || (hdr.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        LOG_ERROR("Shards: malformed channel message (%zd bytes)", received);
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+        return -1;
+    }
+    return 1;
+}
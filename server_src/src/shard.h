@@ -0,0 +1,215 @@
+/**
+ * @file shard.h
+ * @brief Sdileny prehled shardu a kanal mezi routerem a shardy
+ *
+ * S --shards K bezi server jako K procesu (shardu) za routerem, ktery drzi
+ * verejne naslouchajici sockety. Shard i vlastni mistnosti s ID
+ * i * max_rooms .. (i + 1) * max_rooms - 1 a hrace v nich. Spojeni se mezi
+ * shardy presouvaji predanim socketu (SCM_RIGHTS) pres router - data
+ * klientu router nikdy necte ani nekopiruje.
+ *
+ * Kazdy shard na konci iterace zapise do sdilene pameti prehled svych
+ * mistnosti a prihlasenych hracu (prezdivka, session token) a pocet
+ * spojeni. Ostatni shardy z nej skladaji LIST_ROOMS a hledaji vlastnika
+ * mistnosti nebo session, router podle nej rozdeluje nova spojeni.
+ * Oblast shardu chrani seqlock - ctenar pri soubehu se zapisem cte znovu.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "player.h"
+#include "room.h"
+#include "protocol.h"
+#include "ratings.h"
+#include "../include/config.h"
+
+/** Shard s rychlou hrou, turnaji a hodnocenim hracu */
+#define SHARD_HOME 0
+
+/* ============================================
+ * ZPRAVY KANALU ROUTER <-> SHARD
+ * ============================================ */
+
+typedef enum {
+    SHARD_MSG_CLIENT,           /* router -> shard: nove spojeni (socket) */
+    SHARD_MSG_PLAYER,           /* shard -> router -> shard: presun hrace (socket) */
+    SHARD_MSG_LOBBY,            /* shard -> router -> ostatni shardy: zprava do lobby */
+    SHARD_MSG_RATING            /* shard -> router -> SHARD_HOME: vysledek hry */
+} ShardMessageType;
+
+typedef enum {
+    SHARD_ORIGIN_TCP,           /* Spojeni z hlavniho TCP portu */
+    SHARD_ORIGIN_UNIX,          /* Z AF_UNIX socketu */
+    SHARD_ORIGIN_WEBSOCKET      /* Z WebSocket portu (ceka se handshake) */
+} ShardOrigin;
+
+/**
+ * Zprava kanalu - kanal je SOCK_SEQPACKET, jedna zprava = jeden paket
+ * Hrac se prenasi binarne jako pri upgradu (stejny binarni soubor).
+ */
+typedef struct {
+    int32_t type;                           /* ShardMessageType */
+    int32_t source;                         /* Odesilajici shard (doplni router) */
+    int32_t target;                         /* Cilovy shard (-1 = vsechny ostatni) */
+    int32_t origin;                         /* CLIENT: listener (ShardOrigin) */
+    Player player;                          /* PLAYER: presouvany hrac */
+    ParsedMessage message;                  /* PLAYER: zprava, kterou zpracuje cil */
+    char names[2][MAX_NICKNAME_LENGTH + 1]; /* RATING: vitez a porazeny */
+    int32_t text_len;
+    char text[BUFFER_SIZE];                 /* LOBBY: hotova zprava */
+} ShardMessage;
+
+/* ============================================
+ * SDILENY PREHLED
+ * ============================================ */
+
+typedef struct {
+    void *map;                  /* Sdilena anonymni pamet (dedi ji shardy) */
+    size_t map_size;
+    size_t stride;              /* Velikost oblasti jednoho shardu */
+    int count;                  /* Pocet shardu */
+    int max_clients;            /* Sloty hracu jednoho shardu */
+    int max_rooms;              /* Sloty mistnosti jednoho shardu (= sirka rozsahu ID) */
+} ShardSummary;
+
+/* ============================================
+ * VEREJNE FUNKCE - PREHLED
+ * ============================================ */
+
+/**
+ * Vytvori sdileny prehled (router pred spustenim shardu)
+ * @param summary Prehled
+ * @param count Pocet shardu
+ * @param max_clients Sloty hracu jednoho shardu
+ * @param max_rooms Sloty mistnosti jednoho shardu
+ * @return true pri uspechu
+ */
+bool shard_summary_create(ShardSummary *summary, int count, int max_clients, int max_rooms);
+
+/**
+ * Uvolni sdileny prehled
+ * @param summary Prehled
+ */
+void shard_summary_destroy(ShardSummary *summary);
+
+/**
+ * Oznaci shard jako zivy nebo mrtvy (mrtvy nedostava spojeni a nic nezverejnuje)
+ * @param summary Prehled
+ * @param shard Index shardu
+ * @param alive Bezi shard?
+ */
+void shard_set_alive(ShardSummary *summary, int shard, bool alive);
+
+/**
+ * Zverejni stav shardu - mistnosti, prihlasene hrace, pocet spojeni
+ * a u SHARD_HOME i zebricek
+ * @param summary Prehled
+ * @param shard Index shardu
+ * @param rooms Mistnosti shardu (max_rooms)
+ * @param players Hraci shardu (max_clients)
+ * @param ratings Hodnoceni (zebricek zverejnuje jen SHARD_HOME)
+ */
+void shard_publish(ShardSummary *summary, int shard, const Room *rooms,
+                   const Player *players, const RatingStore *ratings);
+
+/**
+ * Bezi shard?
+ * @param summary Prehled
+ * @param shard Index shardu
+ * @return true pokud shard bezi
+ */
+bool shard_is_alive(const ShardSummary *summary, int shard);
+
+/**
+ * Vybere zivy shard s nejmene spojenimi a zapocita mu predavane spojeni
+ * (presny pocet shard zverejni na konci sve iterace)
+ * @param summary Prehled
+ * @return Index shardu nebo -1, pokud zadny nebezi
+ */
+int shard_least_loaded(ShardSummary *summary);
+
+/**
+ * Vrati shard, kteremu patri ID mistnosti
+ * @param summary Prehled
+ * @param room_id ID mistnosti
+ * @return Index shardu nebo -1 (ID mimo vsechny rozsahy)
+ */
+int shard_room_owner(const ShardSummary *summary, int room_id);
+
+/**
+ * Najde jiny shard s prihlasenym hracem dane prezdivky
+ * @param summary Prehled
+ * @param self Vlastni shard (neprohledava se)
+ * @param nickname Prezdivka
+ * @return Index shardu nebo -1
+ */
+int shard_find_nickname(const ShardSummary *summary, int self, const char *nickname);
+
+/**
+ * Najde jiny shard s mistnosti daneho nazvu
+ * @param summary Prehled
+ * @param self Vlastni shard (neprohledava se)
+ * @param name Nazev mistnosti
+ * @return Index shardu nebo -1
+ */
+int shard_find_room_name(const ShardSummary *summary, int self, const char *name);
+
+/**
+ * Najde jiny shard, ktery drzi session s danym tokenem
+ * @param summary Prehled
+ * @param self Vlastni shard (neprohledava se)
+ * @param token_hex Token z RESUME
+ * @return Index shardu nebo -1
+ */
+int shard_find_session(const ShardSummary *summary, int self, const char *token_hex);
+
+/**
+ * Vytvori seznam mistnosti vsech shardu pro LIST_ROOMS (format jako
+ * room_list_to_string); vlastni mistnosti se berou primo z pole
+ * @param summary Prehled
+ * @param self Vlastni shard
+ * @param rooms Mistnosti vlastniho shardu
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Pocet zapsanych znaku
+ */
+int shard_room_list_to_string(const ShardSummary *summary, int self, const Room *rooms,
+                              char *buffer, int size);
+
+/**
+ * Vytvori zebricek pro LEADERBOARD ze zverejneneho zebricku SHARD_HOME
+ * @param summary Prehled
+ * @param count Pocet mist
+ * @param buffer Vystupni buffer
+ * @param size Velikost bufferu
+ * @return Pocet zapsanych znaku
+ */
+int shard_leaderboard_to_string(const ShardSummary *summary, int count, char *buffer, int size);
+
+/* ============================================
+ * VEREJNE FUNKCE - KANAL
+ * ============================================ */
+
+/**
+ * Odesle zpravu kanalem, pripadne spolu se socketem (SCM_RIGHTS)
+ * @param channel Kanal (SOCK_SEQPACKET)
+ * @param msg Zprava
+ * @param fd Predavany socket nebo -1
+ * @return true pri uspechu (odesilatel pak svou kopii socketu zavre)
+ */
+bool shard_send(int channel, const ShardMessage *msg, int fd);
+
+/**
+ * Prijme zpravu z kanalu bez blokovani
+ * @param channel Kanal
+ * @param msg Vystupni zprava
+ * @param fd Vystup - predany socket nebo -1
+ * @return 1 = zprava prijata, 0 = kanal zavren, -1 = zadna dalsi zprava nebo chyba
+ */
+int shard_recv(int channel, ShardMessage *msg, int *fd);
+
+#endif /* SHARD_H */
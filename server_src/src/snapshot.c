@@ -0,0 +1,416 @@
+/**
+ * @file snapshot.c
+ * @brief Implementace snapshotu rozehranych her
+ *
+ * Rozlozeni souboru:
+ *   SnapshotHeader
+ *   kopie 0: SnapshotRoom[file_rooms] + int32_t live[file_rooms]
+ *   kopie 1: SnapshotRoom[file_rooms] + int32_t live[file_rooms]
+ *
+ * Zaznam mistnosti lezi na indexu jejiho slotu, takze nezmenene mistnosti
+ * se pri ukladani neprepisuji. Pole live obsahuje husty seznam slotu
+ * ulozenych mistnosti - obnova prochazi jen ten.
+ */
+
+#include "snapshot.h"
+#include "logger.h"
+#include "../include/config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ============================================
+ * FORMAT SOUBORU
+ * ============================================ */
+
+#define SNAPSHOT_MAGIC   0x4E494D53u   /* "NIMS" */
+#define SNAPSHOT_VERSION 7
+
+typedef struct {
+    uint64_t sequence;          /* Poradove cislo ulozeni */
+    int64_t saved_at;           /* Cas ulozeni */
+    int32_t room_count;         /* Pocet platnych polozek v live */
+    int32_t reserved;
+} SnapshotCopy;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t room_record_size;  /* sizeof(SnapshotRoom) - kontrola kompatibility */
+    int32_t max_rooms;          /* Pocet slotu mistnosti v souboru */
+    uint32_t active;            /* Index platne kopie (0/1) */
+    uint32_t reserved;
+    SnapshotCopy copies[2];
+} SnapshotHeader;
+
+typedef struct {
+    int32_t slot;                               /* Slot v tabulce hracu (-1 = prazdne) */
+    int32_t skips_remaining;
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    uint8_t has_session;
+    uint8_t is_bot;                             /* Bot serveru - obnovi se pripojeny */
+    uint8_t session_token[SESSION_TOKEN_BYTES]; /* Pro RESUME po restartu */
+} SnapshotPlayer;
+
+typedef struct {
+    int32_t id;
+    int32_t player_count;
+    char name[MAX_ROOM_NAME_LENGTH + 1];
+    SnapshotPlayer players[ROOM_MAX_PLAYERS];   /* Podle pozice v mistnosti */
+    Game game;
+} SnapshotRoom;
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static size_t copy_size(int rooms) {
+    return (size_t)rooms * (sizeof(SnapshotRoom) + sizeof(int32_t));
+}
+
+static size_t file_size(int rooms) {
+    return sizeof(SnapshotHeader) + 2 * copy_size(rooms);
+}
+
+static SnapshotHeader* header(Snapshot *snap) {
+    return (SnapshotHeader *)snap->map;
+}
+
+static SnapshotRoom* copy_rooms(Snapshot *snap, int copy) {
+    char *base = (char *)snap->map + sizeof(SnapshotHeader);
+    return (SnapshotRoom *)(base + (size_t)copy * copy_size(snap->file_rooms));
+}
+
+static int32_t* copy_live(Snapshot *snap, int copy) {
+    return (int32_t *)(copy_rooms(snap, copy) + snap->file_rooms);
+}
+
+/**
+ * Je hlavicka platna a odpovida velikosti souboru?
+ */
+static bool header_valid(const SnapshotHeader *hdr, size_t size) {
+    return hdr->magic == SNAPSHOT_MAGIC &&
+           hdr->version == SNAPSHOT_VERSION &&
+           hdr->room_record_size == sizeof(SnapshotRoom) &&
+           hdr->max_rooms > 0 &&
+           hdr->active <= 1 &&
+           size >= file_size(hdr->max_rooms);
+}
+
+/**
+ * Prenastavi soubor na rozlozeni podle aktualni konfigurace (obsah zahodi)
+ */
+static bool init_layout(Snapshot *snap) {
+    size_t size = file_size(snap->max_rooms);
+
+    if (snap->map != NULL) {
+        munmap(snap->map, snap->map_size);
+        snap->map = NULL;
+    }
+
+    if (ftruncate(snap->fd, 0) < 0 || ftruncate(snap->fd, (off_t)size) < 0) {
+        LOG_ERROR("Snapshot: ftruncate failed: %s", strerror(errno));
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, snap->fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Snapshot: mmap failed: %s", strerror(errno));
+        return false;
+    }
+
+    snap->map = map;
+    snap->map_size = size;
+    snap->file_rooms = snap->max_rooms;
+
+    /* Soubor je po ftruncate vynulovany, staci hlavicka */
+    SnapshotHeader *hdr = header(snap);
+    hdr->version = SNAPSHOT_VERSION;
+    hdr->room_record_size = sizeof(SnapshotRoom);
+    hdr->max_rooms = snap->max_rooms;
+    hdr->active = 0;
+    __atomic_store_n(&hdr->magic, SNAPSHOT_MAGIC, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < 2; i++) {
+        int32_t *live = copy_live(snap, i);
+        for (int j = 0; j < snap->file_rooms; j++) {
+            live[j] = -1;
+        }
+    }
+
+    snap->layout_valid = true;
+    return true;
+}
+
+/**
+ * Lze mistnost po restartu obnovit? (rozehrana hra s plnou mistnosti)
+ */
+static bool room_is_resumable(const Room *room) {
+    return room->is_active &&
+           room->player_count == room->game.rules.player_count &&
+           (room->game.state == GAME_STATE_PLAYING ||
+            room->game.state == GAME_STATE_PAUSED);
+}
+
+/**
+ * Sestavi zaznam mistnosti (vcetne vyplne vynulovane kvuli memcmp)
+ */
+static void build_record(SnapshotRoom *rec, const Room *room, const Player *players) {
+    memset(rec, 0, sizeof(SnapshotRoom));
+    rec->id = room->id;
+    rec->player_count = room->player_count;
+    memcpy(rec->name, room->name, sizeof(rec->name));
+    rec->game = room->game;
+
+    for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+        const Player *player = room->players[i];
+        if (player == NULL) {
+            rec->players[i].slot = -1;
+            continue;
+        }
+        rec->players[i].slot = (int32_t)(player - players);
+        rec->players[i].skips_remaining = player->skips_remaining;
+        memcpy(rec->players[i].nickname, player->nickname, sizeof(rec->players[i].nickname));
+        rec->players[i].has_session = player->has_session ? 1 : 0;
+        rec->players[i].is_bot = player->is_bot ? 1 : 0;
+        memcpy(rec->players[i].session_token, player->session_token, SESSION_TOKEN_BYTES);
+    }
+}
+
+/**
+ * Obnovi jednoho hrace; vrati NULL pokud neni volny slot
+ */
+static Player* restore_player(Snapshot *snap, Player *players, const SnapshotPlayer *rec,
+                              int room_slot, time_t now) {
+    Player *player = NULL;
+    int room_id = room_slot_to_id(room_slot);
+
+    /* Bot ma pevny slot za sloty klientu podle mistnosti */
+    if (rec->is_bot) {
+        player = &players[snap->max_clients + room_slot];
+        player_create_bot(player, rec->nickname);
+        player->room_id = room_id;
+        player->skips_remaining = rec->skips_remaining;
+        player->state = PLAYER_STATE_IN_GAME;
+        return player;
+    }
+
+    if (rec->slot >= 0 && rec->slot < snap->max_clients && !players[rec->slot].is_active) {
+        player = &players[rec->slot];
+    } else {
+        int slot = player_find_free_slot(players, snap->max_clients);
+        if (slot < 0) return NULL;
+        player = &players[slot];
+    }
+
+    player_create(player, -1);
+    player_set_nickname(player, rec->nickname);
+    player->room_id = room_id;
+    player->skips_remaining = rec->skips_remaining;
+    player->has_session = rec->has_session != 0;
+    memcpy(player->session_token, rec->session_token, SESSION_TOKEN_BYTES);
+    player->state = PLAYER_STATE_DISCONNECTED;
+    player->disconnect_time = now;
+    return player;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool snapshot_open(Snapshot *snap, const char *path, int max_clients, int max_rooms) {
+    memset(snap, 0, sizeof(Snapshot));
+    snap->fd = -1;
+    snap->max_clients = max_clients;
+    snap->max_rooms = max_rooms;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Snapshot: cannot open '%s': %s", path, strerror(errno));
+        return false;
+    }
+    snap->fd = fd;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        LOG_ERROR("Snapshot: fstat failed: %s", strerror(errno));
+        snapshot_close(snap);
+        return false;
+    }
+
+    /* Existujici snapshot namapujeme v jeho puvodnim rozlozeni */
+    if ((size_t)st.st_size >= sizeof(SnapshotHeader)) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            snap->map = map;
+            snap->map_size = (size_t)st.st_size;
+
+            SnapshotHeader *hdr = header(snap);
+            if (header_valid(hdr, snap->map_size)) {
+                snap->file_rooms = hdr->max_rooms;
+                snap->layout_valid = (hdr->max_rooms == max_rooms);
+            }
+        }
+    }
+
+    if (snap->file_rooms == 0 && !init_layout(snap)) {
+        snapshot_close(snap);
+        return false;
+    }
+
+    snap->last_save = time(NULL);
+    LOG_INFO("Snapshot file '%s' (%zu bytes)", path, snap->map_size);
+    return true;
+}
+
+int snapshot_restore(Snapshot *snap, Player *players, Room *rooms) {
+    if (snap == NULL || snap->map == NULL) return 0;
+
+    SnapshotHeader *hdr = header(snap);
+    int active = (int)__atomic_load_n(&hdr->active, __ATOMIC_ACQUIRE);
+    const SnapshotCopy *copy = &hdr->copies[active];
+    const SnapshotRoom *recs = copy_rooms(snap, active);
+    const int32_t *live = copy_live(snap, active);
+
+    int count = copy->room_count;
+    if (count < 0 || count > snap->file_rooms) count = 0;
+
+    time_t now = time(NULL);
+    int restored_rooms = 0;
+    int restored_players = 0;
+
+    /* Prochazime jen husty seznam ulozenych mistnosti */
+    for (int k = 0; k < count; k++) {
+        int slot = live[k];
+        if (slot < 0 || slot >= snap->file_rooms || slot >= snap->max_rooms) {
+            continue;
+        }
+
+        const SnapshotRoom *rec = &recs[slot];
+        Room *room = &rooms[slot];
+        int room_players = rec->game.rules.player_count;
+        if (room->is_active || room_players < 2 || room_players > ROOM_MAX_PLAYERS ||
+            rec->player_count != room_players) {
+            continue;
+        }
+
+        Player *restored[ROOM_MAX_PLAYERS] = { NULL };
+        bool ok = true;
+        for (int i = 0; i < room_players && ok; i++) {
+            restored[i] = restore_player(snap, players, &rec->players[i], slot, now);
+            ok = (restored[i] != NULL);
+        }
+        if (!ok) {
+            for (int i = 0; i < room_players; i++) {
+                if (restored[i] != NULL) player_reset(restored[i], false);
+            }
+            LOG_WARNING("Snapshot: no player slots for room '%s'", rec->name);
+            continue;
+        }
+
+        room->id = room_slot_to_id(slot);
+        memcpy(room->name, rec->name, sizeof(room->name));
+        room->name[MAX_ROOM_NAME_LENGTH] = '\0';
+        room->player_count = room_players;
+        room->game = rec->game;
+        game_update_preset(&room->game);
+        room->is_active = true;
+        for (int i = 0; i < ROOM_MAX_PLAYERS; i++) {
+            room->players[i] = restored[i];
+        }
+
+        /* Vsichni hraci jsou odpojeni - hra ceka na reconnect */
+        if (room->game.state == GAME_STATE_PLAYING) {
+            room->game.state = GAME_STATE_PAUSED;
+        }
+
+        restored_rooms++;
+        restored_players += room_players;
+        LOG_INFO("Snapshot: restored room '%s' (%d players, stones: %d)",
+                 room->name, room_players, room->game.stones);
+    }
+
+    if (count > 0) {
+        LOG_INFO("Snapshot: restored %d rooms, %d players (saved %lds ago)",
+                 restored_rooms, restored_players, (long)(now - copy->saved_at));
+    }
+
+    /* Snapshot z jine konfigurace - dal uz pracujeme s novym rozlozenim */
+    if (!snap->layout_valid) {
+        init_layout(snap);
+    }
+
+    return restored_players;
+}
+
+void snapshot_save(Snapshot *snap, Player *players, Room *rooms) {
+    if (snap == NULL || snap->fd < 0) return;
+    if (!snap->layout_valid && !init_layout(snap)) return;
+
+    SnapshotHeader *hdr = header(snap);
+    int active = (int)hdr->active;
+    int target = 1 - active;
+    SnapshotRoom *recs = copy_rooms(snap, target);
+    int32_t *live = copy_live(snap, target);
+
+    int count = 0;
+    for (int i = 0; i < snap->max_rooms; i++) {
+        const Room *room = &rooms[i];
+        if (!room_is_resumable(room)) continue;
+
+        /* Zapisujeme jen zmenene zaznamy - nezmenene stranky zustanou ciste */
+        SnapshotRoom rec;
+        build_record(&rec, room, players);
+        if (memcmp(&recs[i], &rec, sizeof(SnapshotRoom)) != 0) {
+            recs[i] = rec;
+        }
+        if (live[count] != i) {
+            live[count] = i;
+        }
+        count++;
+    }
+
+    SnapshotCopy *copy = &hdr->copies[target];
+    copy->room_count = count;
+    copy->saved_at = (int64_t)time(NULL);
+    copy->sequence = hdr->copies[active].sequence + 1;
+
+    /* Prepnuti az po zapisu cele kopie - pad uprostred necha platnou starou */
+    __atomic_store_n(&hdr->active, (uint32_t)target, __ATOMIC_RELEASE);
+}
+
+void snapshot_save_periodic(Snapshot *snap, Player *players, Room *rooms, time_t now) {
+    if (snap == NULL || snap->fd < 0) return;
+
+    if ((now - snap->last_save) >= SNAPSHOT_INTERVAL) {
+        snapshot_save(snap, players, rooms);
+        snap->last_save = now;
+    }
+}
+
+void snapshot_clear(Snapshot *snap) {
+    if (snap == NULL || snap->map == NULL || !snap->layout_valid) return;
+
+    SnapshotHeader *hdr = header(snap);
+    hdr->copies[0].room_count = 0;
+    hdr->copies[1].room_count = 0;
+}
+
+void snapshot_close(Snapshot *snap) {
+    if (snap == NULL) return;
+
+    if (snap->map != NULL) {
+        msync(snap->map, snap->map_size, MS_SYNC);
+        munmap(snap->map, snap->map_size);
+        snap->map = NULL;
+    }
+    if (snap->fd >= 0) {
+        close(snap->fd);
+        snap->fd = -1;
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file snapshot.h
+ * @brief Prubezny snapshot rozehranych her do pametove mapovaneho souboru
+ *
+ * Server pravidelne uklada mistnosti s rozehranou hrou a jejich hrace,
+ * aby po padu procesu mohl hry obnovit a klienti se do nich vratili
+ * beznym reconnectem (GAME_RESUMED).
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "player.h"
+#include "room.h"
+
+/* ============================================
+ * STRUKTURA SNAPSHOTU
+ * ============================================ */
+
+typedef struct {
+    int fd;                     /* Soubor se snapshotem (-1 = vypnuto) */
+    void *map;                  /* Namapovany obsah souboru */
+    size_t map_size;            /* Velikost mapovani */
+    int max_clients;            /* Velikost tabulky hracu serveru */
+    int max_rooms;              /* Velikost tabulky mistnosti serveru */
+    int file_rooms;             /* Pocet slotu mistnosti v souboru */
+    bool layout_valid;          /* Odpovida rozlozeni souboru konfiguraci? */
+    time_t last_save;           /* Cas posledniho ulozeni */
+} Snapshot;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Otevre (pripadne vytvori) soubor se snapshotem a namapuje ho
+ * @param snap Snapshot
+ * @param path Cesta k souboru
+ * @param max_clients Velikost tabulky hracu
+ * @param max_rooms Velikost tabulky mistnosti
+ * @return true pri uspechu
+ */
+bool snapshot_open(Snapshot *snap, const char *path, int max_clients, int max_rooms);
+
+/**
+ * Obnovi rozehrane hry z posledniho platneho snapshotu
+ * Hraci se obnovi jako odpojeni (PLAYER_STATE_DISCONNECTED) a hry jako
+ * pozastavene; doba behu zavisi jen na poctu ulozenych her.
+ * @param snap Snapshot
+ * @param players Tabulka hracu (max_clients slotu klientu + max_rooms slotu botu)
+ * @param rooms Tabulka mistnosti (max_rooms slotu)
+ * @return Pocet obnovenych hracu
+ */
+int snapshot_restore(Snapshot *snap, Player *players, Room *rooms);
+
+/**
+ * Ulozi aktualni stav rozehranych her
+ * Zapisuje do neaktivni kopie jen zmenene zaznamy a nakonec atomicky
+ * prepne aktivni kopii, takze pad uprostred ukladani nic nepokazi.
+ * @param snap Snapshot
+ * @param players Tabulka hracu
+ * @param rooms Tabulka mistnosti
+ */
+void snapshot_save(Snapshot *snap, Player *players, Room *rooms);
+
+/**
+ * Ulozi stav, pokud od posledniho ulozeni uplynul SNAPSHOT_INTERVAL
+ */
+void snapshot_save_periodic(Snapshot *snap, Player *players, Room *rooms, time_t now);
+
+/**
+ * Oznaci snapshot jako prazdny (pri radnem ukonceni serveru)
+ * @param snap Snapshot
+ */
+void snapshot_clear(Snapshot *snap);
+
+/**
+ * Odmapuje a zavre soubor
+ * @param snap Snapshot
+ */
+void snapshot_close(Snapshot *snap);
+
+#endif /* SNAPSHOT_H */
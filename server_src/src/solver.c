@@ -0,0 +1,206 @@
+/**
+ * @file solver.c
+ * @brief Implementace solveru hry Nim
+ *
+ * Pozice z pohledu hrace na tahu: (s, a, b) - s kaminku, a vlastnich
+ * a b souperovych preskoceni. Kdo vezme posledni kaminek, prohrava,
+ * takze s == 0 je vyhra hrace na tahu. Tah vede na (s - k, b, a),
+ * preskoceni na (s, b, a - 1); tabulka se plni podle s a pak podle
+ * celkoveho poctu preskoceni, oba nasledniky jsou tak uz spocitane.
+ *
+ * Tabulka zavisi jen na rozsahu tahu (min_take..max_take), pro kazdy
+ * rozsah se pocita jednou. Kdyz je vsech SOLVER_MAX_TABLES obsazeno,
+ * prepocita se nejdele nepouzita tabulka pro novy rozsah.
+ */
+
+#include "solver.h"
+#include "nimsum.h"
+#include "logger.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+/* ============================================
+ * TABULKY
+ * ============================================ */
+
+/** Priznak vyherni pozice; nizsi bity nesou nejlepsi tah */
+#define SOLVER_WIN 0x80
+#define SOLVER_MOVE_MASK 0x7F
+
+typedef unsigned char SolverEntries[SOLVER_MAX_STONES + 1][SOLVER_MAX_SKIPS + 1][SOLVER_MAX_SKIPS + 1];
+
+/** Tabulka pro jeden rozsah tahu (na poctu kaminku ani preskoceni nezavisi) */
+typedef struct {
+    int min_take;
+    int max_take;
+    unsigned long last_used;        /* Hodnota g_use_clock pri poslednim dotazu */
+    SolverEntries *entries;
+} SolverTable;
+
+static SolverTable g_tables[SOLVER_MAX_TABLES];
+static int g_table_count = 0;
+static unsigned long g_use_clock = 0;
+
+static bool is_win(SolverEntries *t, int s, int a, int b) {
+    return ((*t)[s][a][b] & SOLVER_WIN) != 0;
+}
+
+/**
+ * Spocita jednu pozici (nasledniky uz tabulka obsahuje)
+ */
+static unsigned char solve_position(SolverEntries *t, int min_take, int max_take,
+                                    int s, int a, int b) {
+    if (s == 0) {
+        return SOLVER_WIN;
+    }
+
+    for (int k = min_take; k <= max_take && k <= s; k++) {
+        if (!is_win(t, s - k, b, a)) {
+            return (unsigned char)(SOLVER_WIN | k);
+        }
+    }
+
+    /* Preskoceni az po tazich - setri ho pro pozdejsi pozice */
+    if (a > 0 && !is_win(t, s, b, a - 1)) {
+        return SOLVER_WIN | SOLVER_MOVE_SKIP;
+    }
+
+    /* Prohrana pozice; pri mene nez min_take kaminku zbyva jen vzit zbytek */
+    return (unsigned char)(s >= min_take ? min_take : s);
+}
+
+/**
+ * Najde (nebo spocita) tabulku pro rozsah tahu; pri plnem poli prepocita
+ * nejdele nepouzitou
+ * @return Tabulka nebo NULL (tah mimo rozsah tabulky, nedostatek pameti)
+ */
+static SolverTable* get_table(int min_take, int max_take) {
+    g_use_clock++;
+    for (int i = 0; i < g_table_count; i++) {
+        if (g_tables[i].min_take == min_take && g_tables[i].max_take == max_take) {
+            g_tables[i].last_used = g_use_clock;
+            return &g_tables[i];
+        }
+    }
+
+    if (max_take > SOLVER_MOVE_MASK) {
+        return NULL;
+    }
+
+    SolverTable *table;
+    SolverEntries *t;
+    if (g_table_count < SOLVER_MAX_TABLES) {
+        t = malloc(sizeof(SolverEntries));
+        if (t == NULL) return NULL;
+        table = &g_tables[g_table_count++];
+    } else {
+        table = &g_tables[0];
+        for (int i = 1; i < g_table_count; i++) {
+            if (g_tables[i].last_used < table->last_used) table = &g_tables[i];
+        }
+        LOG_DEBUG("Solver: evicting take %d-%d", table->min_take, table->max_take);
+        t = table->entries;
+    }
+
+    clock_t start = clock();
+    int winning = 0;
+
+    for (int s = 0; s <= SOLVER_MAX_STONES; s++) {
+        for (int total = 0; total <= 2 * SOLVER_MAX_SKIPS; total++) {
+            int a_min = total > SOLVER_MAX_SKIPS ? total - SOLVER_MAX_SKIPS : 0;
+            int a_max = total < SOLVER_MAX_SKIPS ? total : SOLVER_MAX_SKIPS;
+            for (int a = a_min; a <= a_max; a++) {
+                (*t)[s][a][total - a] = solve_position(t, min_take, max_take, s, a, total - a);
+                if ((*t)[s][a][total - a] & SOLVER_WIN) winning++;
+            }
+        }
+    }
+
+    table->min_take = min_take;
+    table->max_take = max_take;
+    table->last_used = g_use_clock;
+    table->entries = t;
+
+    LOG_INFO("Solver: take %d-%d, %d positions (%d winning) in %.2f ms",
+             min_take, max_take,
+             (SOLVER_MAX_STONES + 1) * (SOLVER_MAX_SKIPS + 1) * (SOLVER_MAX_SKIPS + 1),
+             winning, (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+    return table;
+}
+
+/**
+ * Najde polozku tabulky pro hru; false pokud pozice v tabulkach neni
+ */
+static bool lookup(const Game *game, unsigned char *entry) {
+    int mover = game->current_player;
+    int s = game->stones;
+    int a = game->player_skips[mover];
+    int b = game->player_skips[game_next_player(game, mover)];
+
+    if (s < 0 || s > SOLVER_MAX_STONES ||
+        a < 0 || a > SOLVER_MAX_SKIPS || b < 0 || b > SOLVER_MAX_SKIPS) {
+        return false;
+    }
+
+    SolverTable *table = get_table(game->rules.min_take, game->rules.max_take);
+    if (table == NULL) return false;
+
+    *entry = (*table->entries)[s][a][b];
+    return true;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+void solver_init(void) {
+    /* Tabulky predvolenych variant hned, ostatni az pri prvnim dotazu */
+    for (int i = 0; i < GAME_PRESET_CUSTOM; i++) {
+        const GameRules *rules = game_preset_rules((GamePreset)i);
+        get_table(rules->min_take, rules->max_take);
+    }
+}
+
+void solver_cleanup(void) {
+    for (int i = 0; i < g_table_count; i++) {
+        free(g_tables[i].entries);
+        g_tables[i].entries = NULL;
+    }
+    g_table_count = 0;
+}
+
+bool solver_knows(const Game *game) {
+    unsigned char entry;
+    if (game == NULL) return false;
+    if (game->rules.pile_count > 1) return true;
+    return lookup(game, &entry);
+}
+
+bool solver_is_winning(const Game *game) {
+    unsigned char entry;
+    if (game == NULL) return false;
+    if (game->rules.pile_count > 1) return nimsum_is_winning(game->piles);
+    if (!lookup(game, &entry)) return false;
+    return (entry & SOLVER_WIN) != 0;
+}
+
+SolverMove solver_best_move(const Game *game) {
+    SolverMove move = { 0, SOLVER_MOVE_SKIP };
+    unsigned char entry;
+    if (game == NULL) return move;
+
+    if (game->rules.pile_count > 1) {
+        nimsum_best_move(game->piles, &move.pile, &move.count);
+        return move;
+    }
+
+    if (!lookup(game, &entry)) {
+        /* Mimo tabulky - vzdy legalni tah */
+        move.count = game->stones >= game->rules.min_take ? game->rules.min_take : game->stones;
+        return move;
+    }
+
+    move.count = entry & SOLVER_MOVE_MASK;
+    return move;
+}
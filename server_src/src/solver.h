@@ -0,0 +1,68 @@
+/**
+ * @file solver.h
+ * @brief Predpocitany solver hry Nim (misere s preskocenim)
+ *
+ * Pri startu serveru se pro kazdy stav (kaminky, preskoceni hrace na tahu,
+ * preskoceni soupere) spocita, zda je pozice vyherni a jaky je nejlepsi tah.
+ * Stav (stones, skips[0], skips[1], current_player) se na tuto tabulku
+ * mapuje z pohledu hrace na tahu, dotaz je tedy jeden pristup do pole.
+ * Ve hre vice hracu se za soupere povazuje hrac na tahu po nem (heuristika,
+ * tabulka je presna jen pro dva hrace).
+ * Hry s vice hromadkami vyhodnocuje nim-sum (nimsum.h).
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include "game.h"
+
+/** Tah "preskocit" ve vysledku solver_best_move() */
+#define SOLVER_MOVE_SKIP 0
+
+/** Tah vybrany solverem */
+typedef struct {
+    int pile;                       /* Index hromadky */
+    int count;                      /* Pocet kaminku nebo SOLVER_MOVE_SKIP */
+} SolverMove;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Predpocita tabulky predvolenych variant (volat jednou pri startu)
+ * Tabulky vlastnich variant se spocitaji pri prvnim dotazu.
+ */
+void solver_init(void);
+
+/**
+ * Uvolni tabulky
+ */
+void solver_cleanup(void);
+
+/**
+ * Zjisti, zda solver pozici zna (stav je v mezich tabulky a tabulka
+ * pro rozsah tahu je k dispozici)
+ * @param game Hra
+ * @return false pokud by solver_is_winning()/solver_best_move() jen hadaly
+ */
+bool solver_knows(const Game *game);
+
+/**
+ * Zjisti, zda ma hrac na tahu vyhrani jistou
+ * @param game Hra
+ * @return true pokud existuje vyherni strategie
+ */
+bool solver_is_winning(const Game *game);
+
+/**
+ * Vrati nejlepsi tah pro hrace na tahu
+ * V prohrane pozici vrati tah, ktery hru co nejmene zkrati (vezme min_take,
+ * pripadne zbytek kaminku).
+ * @param game Hra
+ * @return Tah (count == SOLVER_MOVE_SKIP znamena preskoceni)
+ */
+SolverMove solver_best_move(const Game *game);
+
+#endif /* SOLVER_H */
@@ -0,0 +1,212 @@
+/**
+ * @file stats.c
+ * @brief Implementace provoznich statistik serveru
+ */
+
+/* struct tcp_info je dostupna jen s _DEFAULT_SOURCE */
+#define _DEFAULT_SOURCE
+
+#include "stats.h"
+#include "logger.h"
+#include "../include/config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+/** Horni hranice sloupcu histogramu (posledni sloupec je bez hranice) */
+static const long g_wait_bounds_ms[STATS_HIST_BUCKETS - 1] = {
+    1000, 2000, 5000, 10000, 30000, 60000
+};
+static const long g_diff_bounds[STATS_HIST_BUCKETS - 1] = {
+    25, 50, 100, 150, 200, 300
+};
+
+static void hist_add(unsigned long *hist, const long *bounds, long value) {
+    int i = 0;
+    while (i < STATS_HIST_BUCKETS - 1 && value >= bounds[i]) i++;
+    hist[i]++;
+}
+
+/**
+ * Vypise histogram jako "<b1:n <b2:n ... >=bN:n"
+ */
+static void hist_log(const char *name, const unsigned long *hist, const long *bounds,
+                     long scale, const char *unit) {
+    char line[MAX_LOG_MESSAGE_LENGTH];
+    int written = 0;
+    for (int i = 0; i < STATS_HIST_BUCKETS - 1; i++) {
+        written += snprintf(line + written, sizeof(line) - written, "<%ld%s:%lu ",
+                            bounds[i] / scale, unit, hist[i]);
+    }
+    snprintf(line + written, sizeof(line) - written, ">=%ld%s:%lu",
+             bounds[STATS_HIST_BUCKETS - 2] / scale, unit, hist[STATS_HIST_BUCKETS - 1]);
+    LOG_INFO("Stats: quick match %s %s", name, line);
+}
+
+/**
+ * Najde index sloupce v hlavickovem radku /proc/net/netstat
+ * @return Index sloupce (0 = prvni hodnota za prefixem) nebo -1
+ */
+static int find_column(char *header, const char *name) {
+    char *saveptr;
+    int index = -1;
+
+    /* Prvni token je prefix "TcpExt:" */
+    char *token = strtok_r(header, " \n", &saveptr);
+    while (token != NULL) {
+        token = strtok_r(NULL, " \n", &saveptr);
+        index++;
+        if (token != NULL && strcmp(token, name) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Vrati hodnotu sloupce z radku s hodnotami
+ */
+static bool read_column(const char *values, int column, unsigned long *out) {
+    char copy[4096];
+    char *saveptr;
+
+    strncpy(copy, values, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = '\0';
+
+    char *token = strtok_r(copy, " \n", &saveptr); /* Prefix */
+    for (int i = 0; token != NULL && i <= column; i++) {
+        token = strtok_r(NULL, " \n", &saveptr);
+    }
+    if (token == NULL) return false;
+
+    *out = strtoul(token, NULL, 10);
+    return true;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+void stats_init(ServerStats *stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(ServerStats));
+    stats->last_log = time(NULL);
+}
+
+void stats_record_match(ServerStats *stats, long wait_ms, int rating_diff) {
+    if (stats == NULL) return;
+    hist_add(stats->match_wait, g_wait_bounds_ms, wait_ms);
+    hist_add(stats->match_diff, g_diff_bounds, rating_diff);
+    stats->matches++;
+}
+
+void stats_record_accept_batch(ServerStats *stats, unsigned int accepted, bool budget_exhausted) {
+    if (stats == NULL) return;
+
+    if (accepted > stats->accept_batch_max) {
+        stats->accept_batch_max = accepted;
+    }
+    if (budget_exhausted) {
+        stats->accept_budget_hits++;
+    }
+}
+
+bool stats_read_listen_queue(int listen_fd, unsigned int *queued, unsigned int *backlog) {
+#ifdef TCP_INFO
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+
+    memset(&info, 0, sizeof(info));
+    if (getsockopt(listen_fd, IPPROTO_TCP, TCP_INFO, &info, &len) < 0) {
+        return false;
+    }
+
+    /* U naslouchajiciho socketu Linux vraci delku fronty v tcpi_unacked
+     * a nastaveny backlog v tcpi_sacked */
+    if (queued) *queued = info.tcpi_unacked;
+    if (backlog) *backlog = info.tcpi_sacked;
+    return true;
+#else
+    (void)listen_fd;
+    (void)queued;
+    (void)backlog;
+    return false;
+#endif
+}
+
+bool stats_read_listen_overflows(unsigned long *overflows, unsigned long *drops) {
+    FILE *file = fopen("/proc/net/netstat", "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char header[4096];
+    char values[4096];
+    bool found = false;
+
+    /* Soubor obsahuje dvojice radku: hlavicka a hodnoty */
+    while (fgets(header, sizeof(header), file) != NULL) {
+        if (fgets(values, sizeof(values), file) == NULL) break;
+        if (strncmp(header, "TcpExt:", 7) != 0) continue;
+
+        char copy[4096];
+        strcpy(copy, header);
+        int col_overflows = find_column(copy, "ListenOverflows");
+        strcpy(copy, header);
+        int col_drops = find_column(copy, "ListenDrops");
+
+        found = col_overflows >= 0 && col_drops >= 0 &&
+                read_column(values, col_overflows, overflows) &&
+                read_column(values, col_drops, drops);
+        break;
+    }
+
+    fclose(file);
+    return found;
+}
+
+void stats_log_periodic(ServerStats *stats, int listen_fd, time_t now) {
+    if (stats == NULL) return;
+
+    if ((now - stats->last_log) >= STATS_LOG_INTERVAL) {
+        stats_log(stats, listen_fd);
+        stats->last_log = now;
+    }
+}
+
+void stats_log(const ServerStats *stats, int listen_fd) {
+    if (stats == NULL) return;
+
+    LOG_INFO("Stats: accepted=%lu (unix %lu, websocket %lu) rejected_full=%lu "
+             "accept_errors=%lu accept_batch_max=%u accept_budget_hits=%lu",
+             stats->accepted_total, stats->accepted_unix, stats->accepted_websocket,
+             stats->rejected_full, stats->accept_errors,
+             stats->accept_batch_max, stats->accept_budget_hits);
+
+    if (stats->moved_in > 0 || stats->moved_out > 0) {
+        LOG_INFO("Stats: shard moves in=%lu out=%lu", stats->moved_in, stats->moved_out);
+    }
+
+    unsigned int queued, backlog;
+    if (stats_read_listen_queue(listen_fd, &queued, &backlog)) {
+        LOG_INFO("Stats: listen queue %u/%u", queued, backlog);
+    }
+
+    unsigned long overflows, drops;
+    if (stats_read_listen_overflows(&overflows, &drops)) {
+        LOG_INFO("Stats: system ListenOverflows=%lu ListenDrops=%lu", overflows, drops);
+    }
+
+    if (stats->matches > 0) {
+        hist_log("wait", stats->match_wait, g_wait_bounds_ms, 1000, "s");
+        hist_log("rating diff", stats->match_diff, g_diff_bounds, 1, "");
+    }
+}
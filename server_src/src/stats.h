@@ -0,0 +1,100 @@
+/**
+ * @file stats.h
+ * @brief Provozni statistiky serveru (metriky)
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <time.h>
+
+/** Pocet sloupcu histogramu rychle hry (posledni = vse nad hranici) */
+#define STATS_HIST_BUCKETS 7
+
+/* ============================================
+ * STRUKTURA STATISTIK
+ * ============================================ */
+
+typedef struct {
+    /* Prijimani spojeni */
+    unsigned long accepted_total;           /* Pocet prijatych spojeni */
+    unsigned long accepted_unix;            /* Z toho pres AF_UNIX socket */
+    unsigned long accepted_websocket;       /* Z toho pres WebSocket listener */
+    unsigned long rejected_full;            /* Odmitnuto - server plny */
+    unsigned long accept_errors;            /* Chyby accept() */
+    unsigned long accept_budget_hits;       /* Kolikrat byl vycerpan budget na iteraci */
+    unsigned int accept_batch_max;          /* Nejvice spojeni prijatych v jedne iteraci */
+    
+    /* Shardy */
+    unsigned long moved_in;                 /* Hraci presunuti sem z jineho shardu */
+    unsigned long moved_out;                /* Hraci presunuti do jineho shardu */
+    
+    /* Rychla hra */
+    unsigned long match_wait[STATS_HIST_BUCKETS];  /* Histogram doby cekani ve fronte */
+    unsigned long match_diff[STATS_HIST_BUCKETS];  /* Histogram rozdilu ELO dvojic */
+    unsigned long matches;                  /* Pocet sparovanych dvojic */
+
+    /* Pomocne */
+    time_t last_log;                        /* Cas posledniho vypisu */
+} ServerStats;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Inicializuje statistiky
+ * @param stats Ukazatel na statistiky
+ */
+void stats_init(ServerStats *stats);
+
+/**
+ * Zaznamena vysledek jedne davky accept()
+ * @param stats Statistiky
+ * @param accepted Pocet prijatych spojeni v davce
+ * @param budget_exhausted Byl vycerpan budget (fronta nemusi byt prazdna)?
+ */
+void stats_record_accept_batch(ServerStats *stats, unsigned int accepted, bool budget_exhausted);
+
+/**
+ * Zaznamena sparovani rychle hry do histogramu
+ * @param stats Statistiky
+ * @param wait_ms Doba cekani dele cekajiciho hrace (ms)
+ * @param rating_diff Rozdil ELO hracu
+ */
+void stats_record_match(ServerStats *stats, long wait_ms, int rating_diff);
+
+/**
+ * Zjisti aktualni delku accept fronty naslouchajiciho socketu (TCP_INFO)
+ * @param listen_fd Naslouchajici socket
+ * @param queued Vystup - pocet spojeni cekajicich na accept()
+ * @param backlog Vystup - efektivni velikost fronty
+ * @return true pri uspechu
+ */
+bool stats_read_listen_queue(int listen_fd, unsigned int *queued, unsigned int *backlog);
+
+/**
+ * Precte systemove citace preteceni accept fronty (/proc/net/netstat)
+ * @param overflows Vystup - TcpExt ListenOverflows
+ * @param drops Vystup - TcpExt ListenDrops
+ * @return true pri uspechu
+ */
+bool stats_read_listen_overflows(unsigned long *overflows, unsigned long *drops);
+
+/**
+ * Vypise statistiky do logu, pokud uplynul STATS_LOG_INTERVAL
+ * @param stats Statistiky
+ * @param listen_fd Naslouchajici socket (pro TCP_INFO)
+ * @param now Aktualni cas
+ */
+void stats_log_periodic(ServerStats *stats, int listen_fd, time_t now);
+
+/**
+ * Vypise statistiky do logu
+ * @param stats Statistiky
+ * @param listen_fd Naslouchajici socket (pro TCP_INFO)
+ */
+void stats_log(const ServerStats *stats, int listen_fd);
+
+#endif /* STATS_H */
@@ -0,0 +1,113 @@
+/**
+ * @file sysio.c
+ * @brief Implementace zdroje casu a operaci se sockety klientu
+ */
+
+#include "sysio.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ============================================
+ * VYCHOZI OPERACE (JADRO)
+ * ============================================ */
+
+static time_t os_time_now(void) {
+    return time(NULL);
+}
+
+static int64_t os_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int os_poll(struct pollfd *fds, nfds_t count, int timeout_ms) {
+    return poll(fds, count, timeout_ms);
+}
+
+static int os_accept(int listen_fd, struct sockaddr_storage *addr) {
+    socklen_t len = sizeof(*addr);
+    int fd = accept(listen_fd, (struct sockaddr *)addr, &len);
+    if (fd < 0) return -1;
+
+    /* Pri upgradu se sockety predavaji explicitne pres SCM_RIGHTS */
+    int flags = fcntl(fd, F_GETFL, 0);
+    int fd_flags = fcntl(fd, F_GETFD, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 ||
+        fd_flags == -1 || fcntl(fd, F_SETFD, fd_flags | FD_CLOEXEC) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static ssize_t os_recv(int fd, void *buffer, size_t len) {
+    return recv(fd, buffer, len, 0);
+}
+
+static ssize_t os_send(int fd, const void *data, size_t len) {
+    return send(fd, data, len, MSG_NOSIGNAL);
+}
+
+static ssize_t os_writev(int fd, const struct iovec *iov, int count) {
+    return writev(fd, iov, count);
+}
+
+static int os_close(int fd) {
+    return close(fd);
+}
+
+static const SysIoOps g_os_ops = {
+    .time_now = os_time_now,
+    .monotonic_ms = os_monotonic_ms,
+    .poll = os_poll,
+    .accept = os_accept,
+    .recv = os_recv,
+    .send = os_send,
+    .writev = os_writev,
+    .close = os_close
+};
+
+/** Aktualni operace */
+static const SysIoOps *g_ops = &g_os_ops;
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+void sysio_set_ops(const SysIoOps *ops) {
+    g_ops = ops != NULL ? ops : &g_os_ops;
+}
+
+time_t sysio_time(void) {
+    return g_ops->time_now();
+}
+
+int64_t sysio_now_ms(void) {
+    return g_ops->monotonic_ms();
+}
+
+int sysio_poll(struct pollfd *fds, nfds_t count, int timeout_ms) {
+    return g_ops->poll(fds, count, timeout_ms);
+}
+
+int sysio_accept(int listen_fd, struct sockaddr_storage *addr) {
+    return g_ops->accept(listen_fd, addr);
+}
+
+ssize_t sysio_recv(int fd, void *buffer, size_t len) {
+    return g_ops->recv(fd, buffer, len);
+}
+
+ssize_t sysio_send(int fd, const void *data, size_t len) {
+    return g_ops->send(fd, data, len);
+}
+
+ssize_t sysio_writev(int fd, const struct iovec *iov, int count) {
+    return g_ops->writev(fd, iov, count);
+}
+
+int sysio_close(int fd) {
+    return g_ops->close(fd);
+}
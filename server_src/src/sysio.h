@@ -0,0 +1,102 @@
+/**
+ * @file sysio.h
+ * @brief Zdroj casu a operace se sockety klientu (vymenitelne pro simulaci)
+ *
+ * Server cte cas a pracuje se sockety klientu jen pres tyto funkce.
+ * Vychozi operace volaji primo jadro; simulace (tools/nim_sim.c) je nahradi
+ * virtualnimi hodinami a socketu v pameti a prehraje tak odpojeni,
+ * reconnecty a timeouty bez cekani na skutecny cas.
+ *
+ * Naslouchajici sockety, kanaly shardu a upgrade pracuji s jadrem primo.
+ */
+
+#ifndef SYSIO_H
+#define SYSIO_H
+
+#include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/* ============================================
+ * OPERACE
+ * ============================================ */
+
+typedef struct {
+    time_t (*time_now)(void);                                       /* time(NULL) */
+    int64_t (*monotonic_ms)(void);                                  /* CLOCK_MONOTONIC v ms */
+    int (*poll)(struct pollfd *fds, nfds_t count, int timeout_ms);
+    int (*accept)(int listen_fd, struct sockaddr_storage *addr);    /* Neblokujici, CLOEXEC */
+    ssize_t (*recv)(int fd, void *buffer, size_t len);
+    ssize_t (*send)(int fd, const void *data, size_t len);          /* Bez SIGPIPE */
+    ssize_t (*writev)(int fd, const struct iovec *iov, int count);
+    int (*close)(int fd);
+} SysIoOps;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Nahradi operace (pred server_init)
+ * @param ops Operace nebo NULL pro vychozi operace jadra
+ */
+void sysio_set_ops(const SysIoOps *ops);
+
+/**
+ * Aktualni cas v sekundach
+ * @return Cas (jako time(NULL))
+ */
+time_t sysio_time(void);
+
+/**
+ * Monotonni cas v milisekundach (terminy hodin tahu, fronta rychle hry)
+ * @return Cas v ms
+ */
+int64_t sysio_now_ms(void);
+
+/**
+ * Pocka na udalosti socketu (jako poll())
+ * @param fds Sledovane sockety
+ * @param count Pocet socketu
+ * @param timeout_ms Nejdelsi cekani
+ * @return Pocet socketu s udalosti, 0 = timeout, -1 = chyba (errno)
+ */
+int sysio_poll(struct pollfd *fds, nfds_t count, int timeout_ms);
+
+/**
+ * Prijme spojeni z naslouchajiciho socketu; vraceny socket je neblokujici
+ * a s FD_CLOEXEC
+ * @param listen_fd Naslouchajici socket
+ * @param addr Vystup - adresa protistrany
+ * @return Socket klienta nebo -1 (errno)
+ */
+int sysio_accept(int listen_fd, struct sockaddr_storage *addr);
+
+/**
+ * Precte data ze socketu klienta
+ * @return Pocet bajtu, 0 = spojeni zavreno, -1 = chyba (errno)
+ */
+ssize_t sysio_recv(int fd, void *buffer, size_t len);
+
+/**
+ * Zapise data do socketu klienta (bez SIGPIPE)
+ * @return Pocet zapsanych bajtu nebo -1 (errno)
+ */
+ssize_t sysio_send(int fd, const void *data, size_t len);
+
+/**
+ * Zapise vice bloku dat jednim volanim (jako writev())
+ * @return Pocet zapsanych bajtu nebo -1 (errno)
+ */
+ssize_t sysio_writev(int fd, const struct iovec *iov, int count);
+
+/**
+ * Zavre socket klienta
+ * @return 0 pri uspechu, -1 pri chybe
+ */
+int sysio_close(int fd);
+
+#endif /* SYSIO_H */
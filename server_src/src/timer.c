@@ -0,0 +1,142 @@
+/**
+ * @file timer.c
+ * @brief Implementace casovacu (indexovana min-halda)
+ */
+
+#include "timer.h"
+#include "sysio.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================
+ * PRACE S HALDOU
+ * ============================================ */
+
+static void place(TimerHeap *timers, int index, TimerEntry entry) {
+    timers->heap[index] = entry;
+    timers->positions[entry.id] = index;
+}
+
+static void sift_up(TimerHeap *timers, int index) {
+    TimerEntry entry = timers->heap[index];
+
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (timers->heap[parent].deadline <= entry.deadline) break;
+        place(timers, index, timers->heap[parent]);
+        index = parent;
+    }
+    place(timers, index, entry);
+}
+
+static void sift_down(TimerHeap *timers, int index) {
+    TimerEntry entry = timers->heap[index];
+
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= timers->count) break;
+        if (child + 1 < timers->count &&
+            timers->heap[child + 1].deadline < timers->heap[child].deadline) {
+            child++;
+        }
+        if (entry.deadline <= timers->heap[child].deadline) break;
+        place(timers, index, timers->heap[child]);
+        index = child;
+    }
+    place(timers, index, entry);
+}
+
+/**
+ * Odebere polozku haldy na dane pozici
+ */
+static void remove_at(TimerHeap *timers, int index) {
+    timers->positions[timers->heap[index].id] = -1;
+    timers->count--;
+    if (index == timers->count) return;
+
+    /* Posledni polozka na uvolnene misto, pak ji posun spravnym smerem */
+    place(timers, index, timers->heap[timers->count]);
+    if (index > 0 && timers->heap[index].deadline < timers->heap[(index - 1) / 2].deadline) {
+        sift_up(timers, index);
+    } else {
+        sift_down(timers, index);
+    }
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+int64_t timer_now_ms(void) {
+    return sysio_now_ms();
+}
+
+bool timer_init(TimerHeap *timers, int capacity) {
+    memset(timers, 0, sizeof(TimerHeap));
+
+    timers->heap = malloc(capacity * sizeof(TimerEntry));
+    timers->positions = malloc(capacity * sizeof(int));
+    if (timers->heap == NULL || timers->positions == NULL) {
+        timer_destroy(timers);
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        timers->positions[i] = -1;
+    }
+    timers->capacity = capacity;
+    return true;
+}
+
+void timer_destroy(TimerHeap *timers) {
+    free(timers->heap);
+    free(timers->positions);
+    memset(timers, 0, sizeof(TimerHeap));
+}
+
+void timer_schedule(TimerHeap *timers, int id, int64_t deadline) {
+    if (id < 0 || id >= timers->capacity) return;
+
+    int index = timers->positions[id];
+    if (index < 0) {
+        index = timers->count++;
+        place(timers, index, (TimerEntry){ deadline, id });
+        sift_up(timers, index);
+        return;
+    }
+
+    int64_t old = timers->heap[index].deadline;
+    timers->heap[index].deadline = deadline;
+    if (deadline < old) {
+        sift_up(timers, index);
+    } else {
+        sift_down(timers, index);
+    }
+}
+
+void timer_cancel(TimerHeap *timers, int id) {
+    if (id < 0 || id >= timers->capacity || timers->positions[id] < 0) return;
+    remove_at(timers, timers->positions[id]);
+}
+
+int64_t timer_deadline(const TimerHeap *timers, int id) {
+    if (id < 0 || id >= timers->capacity || timers->positions[id] < 0) return -1;
+    return timers->heap[timers->positions[id]].deadline;
+}
+
+int timer_poll_timeout(const TimerHeap *timers, int64_t now, int max_timeout) {
+    if (timers->count == 0) return max_timeout;
+
+    int64_t wait = timers->heap[0].deadline - now;
+    if (wait <= 0) return 0;
+    return wait < max_timeout ? (int)wait : max_timeout;
+}
+
+int timer_pop_expired(TimerHeap *timers, int64_t now) {
+    if (timers->count == 0 || timers->heap[0].deadline > now) return -1;
+
+    int id = timers->heap[0].id;
+    remove_at(timers, 0);
+    return id;
+}
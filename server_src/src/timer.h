@@ -0,0 +1,100 @@
+/**
+ * @file timer.h
+ * @brief Casovace s terminem - indexovana binarni halda
+ *
+ * Kazdy casovac je urcen cislem 0..capacity-1 (napr. slot mistnosti).
+ * Halda drzi jen naplanovane casovace, takze nejblizsi termin je v O(1)
+ * a naplanovani, presun i zruseni v O(log n). Hlavni smycka podle
+ * nejblizsiho terminu zkrati timeout poll() a vyprsele casovace vybira
+ * z vrcholu haldy - nic se neprochazi periodicky.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ============================================
+ * STRUKTURY
+ * ============================================ */
+
+typedef struct {
+    int64_t deadline;               /* Termin (ms, monotonni hodiny) */
+    int id;                         /* Cislo casovace */
+} TimerEntry;
+
+typedef struct {
+    TimerEntry *heap;               /* Min-halda podle terminu */
+    int *positions;                 /* Pozice casovace v halde (-1 = nenaplanovan) */
+    int count;                      /* Pocet naplanovanych casovacu */
+    int capacity;                   /* Pocet cisel casovacu */
+} TimerHeap;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Vrati aktualni cas monotonnich hodin v milisekundach
+ * (hodiny jsou spolecne pro cely system, plati i po upgradu procesu;
+ * zdrojem je sysio, v simulaci virtualni hodiny)
+ * @return Cas v ms
+ */
+int64_t timer_now_ms(void);
+
+/**
+ * Inicializuje prazdnou haldu
+ * @param timers Halda
+ * @param capacity Pocet cisel casovacu
+ * @return true pri uspechu
+ */
+bool timer_init(TimerHeap *timers, int capacity);
+
+/**
+ * Uvolni haldu
+ * @param timers Halda
+ */
+void timer_destroy(TimerHeap *timers);
+
+/**
+ * Naplanuje casovac (uz naplanovany se presune na novy termin)
+ * @param timers Halda
+ * @param id Cislo casovace
+ * @param deadline Termin v ms
+ */
+void timer_schedule(TimerHeap *timers, int id, int64_t deadline);
+
+/**
+ * Zrusi casovac (nenaplanovany se ignoruje)
+ * @param timers Halda
+ * @param id Cislo casovace
+ */
+void timer_cancel(TimerHeap *timers, int id);
+
+/**
+ * Vrati termin casovace
+ * @param timers Halda
+ * @param id Cislo casovace
+ * @return Termin v ms nebo -1, pokud neni naplanovan
+ */
+int64_t timer_deadline(const TimerHeap *timers, int id);
+
+/**
+ * Spocita timeout pro poll() podle nejblizsiho terminu
+ * @param timers Halda
+ * @param now Aktualni cas v ms
+ * @param max_timeout Nejdelsi timeout v ms
+ * @return Timeout v ms (0 = nektery casovac uz vyprsel)
+ */
+int timer_poll_timeout(const TimerHeap *timers, int64_t now, int max_timeout);
+
+/**
+ * Vyjme z haldy jeden vyprsely casovac
+ * @param timers Halda
+ * @param now Aktualni cas v ms
+ * @return Cislo casovace nebo -1, pokud zadny nevyprsel
+ */
+int timer_pop_expired(TimerHeap *timers, int64_t now);
+
+#endif /* TIMER_H */
@@ -0,0 +1,128 @@
+/**
+ * @file tournament.c
+ * @brief Implementace turnajoveho pavouka
+ */
+
+#include "tournament.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+bool tournament_init(Tournament *tournament, int capacity) {
+    memset(tournament, 0, sizeof(Tournament));
+    tournament->organizer = -1;
+    tournament->capacity = capacity;
+    tournament->entrants = calloc((size_t)capacity, sizeof(int));
+    tournament->advanced = calloc((size_t)capacity, sizeof(int));
+    if (tournament->entrants == NULL || tournament->advanced == NULL) {
+        tournament_destroy(tournament);
+        return false;
+    }
+    return true;
+}
+
+void tournament_destroy(Tournament *tournament) {
+    free(tournament->entrants);
+    free(tournament->advanced);
+    tournament->entrants = NULL;
+    tournament->advanced = NULL;
+    tournament->state = TOURNAMENT_IDLE;
+}
+
+bool tournament_open(Tournament *tournament, const char *name, const GameRules *rules,
+                     int organizer) {
+    if (tournament->state != TOURNAMENT_IDLE || tournament->capacity < 1) return false;
+
+    tournament_close(tournament);
+    strncpy(tournament->name, name, MAX_ROOM_NAME_LENGTH);
+    tournament->name[MAX_ROOM_NAME_LENGTH] = '\0';
+    tournament->rules = *rules;
+    tournament->rules.player_count = 2;
+    tournament->organizer = organizer;
+    tournament->state = TOURNAMENT_REGISTERING;
+    tournament->entrants[tournament->entrant_count++] = organizer;
+    return true;
+}
+
+bool tournament_register(Tournament *tournament, int slot) {
+    if (tournament->state != TOURNAMENT_REGISTERING ||
+        tournament->entrant_count >= tournament->capacity) {
+        return false;
+    }
+    tournament->entrants[tournament->entrant_count++] = slot;
+    return true;
+}
+
+bool tournament_unregister(Tournament *tournament, int slot) {
+    if (tournament->state != TOURNAMENT_REGISTERING) return false;
+
+    for (int i = 0; i < tournament->entrant_count; i++) {
+        if (tournament->entrants[i] == slot) {
+            memmove(&tournament->entrants[i], &tournament->entrants[i + 1],
+                    (size_t)(tournament->entrant_count - i - 1) * sizeof(int));
+            tournament->entrant_count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+int tournament_begin_round(Tournament *tournament) {
+    if (tournament->round > 0) {
+        memcpy(tournament->entrants, tournament->advanced,
+               (size_t)tournament->advanced_count * sizeof(int));
+        tournament->entrant_count = tournament->advanced_count;
+    }
+
+    tournament->state = TOURNAMENT_RUNNING;
+    tournament->round++;
+    tournament->next_pair = 0;
+    tournament->pair_end = tournament->entrant_count & ~1;
+    tournament->matches_running = 0;
+    tournament->advanced_count = 0;
+
+    /* Lichy pocet - posledni nasazeny postupuje bez zapasu */
+    if (tournament->entrant_count % 2 != 0) {
+        int bye = tournament->entrants[tournament->entrant_count - 1];
+        tournament_advance(tournament, bye);
+        return bye;
+    }
+    return -1;
+}
+
+bool tournament_next_match(Tournament *tournament, int *first, int *second) {
+    if (tournament->next_pair >= tournament->pair_end) return false;
+
+    *first = tournament->entrants[tournament->next_pair];
+    *second = tournament->entrants[tournament->next_pair + 1];
+    tournament->next_pair += 2;
+    return true;
+}
+
+void tournament_advance(Tournament *tournament, int slot) {
+    if (tournament->advanced_count < tournament->capacity) {
+        tournament->advanced[tournament->advanced_count++] = slot;
+    }
+}
+
+bool tournament_round_done(const Tournament *tournament) {
+    return tournament->state == TOURNAMENT_RUNNING &&
+           tournament->next_pair >= tournament->pair_end &&
+           tournament->matches_running == 0;
+}
+
+void tournament_close(Tournament *tournament) {
+    tournament->state = TOURNAMENT_IDLE;
+    tournament->name[0] = '\0';
+    tournament->organizer = -1;
+    tournament->round = 0;
+    tournament->entrant_count = 0;
+    tournament->next_pair = 0;
+    tournament->pair_end = 0;
+    tournament->matches_running = 0;
+    tournament->advanced_count = 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file tournament.h
+ * @brief Turnaj - vyrazovaci pavouk nad beznymi mistnostmi
+ *
+ * Ucastnici jsou ulozeni jako sloty hracu v poradi nasazeni. Zapasy kola
+ * jsou dvojice sousednich slotu (0-1, 2-3, ...), pri lichem poctu postupuje
+ * posledni volnym losem. Parovani je tak jen posun indexu a nic se pri nem
+ * nealokuje - zapasy se vybiraji po jednom, dokud jsou volne mistnosti,
+ * a zbytek pocka na mistnosti uvolnene dohranymi zapasy.
+ */
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <stdbool.h>
+#include "game.h"
+#include "../include/config.h"
+
+/* ============================================
+ * STAVY TURNAJE
+ * ============================================ */
+
+typedef enum {
+    TOURNAMENT_IDLE,            /* Zadny turnaj */
+    TOURNAMENT_REGISTERING,     /* Registrace ucastniku */
+    TOURNAMENT_RUNNING          /* Hraje se pavouk */
+} TournamentState;
+
+/* ============================================
+ * STRUKTURA TURNAJE
+ * ============================================ */
+
+typedef struct {
+    TournamentState state;                  /* Stav turnaje */
+    char name[MAX_ROOM_NAME_LENGTH + 1];    /* Nazev (zaklad nazvu mistnosti) */
+    GameRules rules;                        /* Pravidla vsech zapasu */
+    int organizer;                          /* Slot hrace, ktery turnaj zalozil */
+    int capacity;                           /* Nejvetsi pocet ucastniku */
+    int round;                              /* Aktualni kolo (od 1, 0 = registrace) */
+    int entrant_count;                      /* Ucastnici aktualniho kola */
+    int next_pair;                          /* Index prvniho hrace dalsiho zapasu */
+    int pair_end;                           /* Konec sparovanych hracu (sudy) */
+    int matches_running;                    /* Rozehrane zapasy kola */
+    int advanced_count;                     /* Postupujici do dalsiho kola */
+    int *entrants;                          /* Sloty ucastniku kola (capacity) */
+    int *advanced;                          /* Sloty postupujicich (capacity) */
+} Tournament;
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Inicializuje turnaj (bez probihajiciho turnaje)
+ * @param tournament Turnaj
+ * @param capacity Nejvetsi pocet ucastniku (pocet slotu klientu)
+ * @return true pri uspechu
+ */
+bool tournament_init(Tournament *tournament, int capacity);
+
+/**
+ * Uvolni pole turnaje
+ * @param tournament Turnaj
+ */
+void tournament_destroy(Tournament *tournament);
+
+/**
+ * Zahaji registraci noveho turnaje
+ * @param tournament Turnaj
+ * @param name Nazev turnaje
+ * @param rules Pravidla zapasu (hraje se vzdy ve dvou)
+ * @param organizer Slot zakladajiciho hrace (je rovnou registrovan)
+ * @return false pokud uz turnaj probiha
+ */
+bool tournament_open(Tournament *tournament, const char *name, const GameRules *rules,
+                     int organizer);
+
+/**
+ * Zaregistruje ucastnika
+ * @param tournament Turnaj
+ * @param slot Slot hrace
+ * @return false pokud registrace nebezi nebo je turnaj plny
+ */
+bool tournament_register(Tournament *tournament, int slot);
+
+/**
+ * Zrusi registraci ucastnika (poradi ostatnich se zachova)
+ * @param tournament Turnaj
+ * @param slot Slot hrace
+ * @return true pokud byl registrovan
+ */
+bool tournament_unregister(Tournament *tournament, int slot);
+
+/**
+ * Zacne dalsi kolo - postupujici se stanou ucastniky a rozdeli se do dvojic
+ * (prvni kolo hraji registrovani)
+ * @param tournament Turnaj
+ * @return Slot hrace s volnym losem (postupuje rovnou) nebo -1
+ */
+int tournament_begin_round(Tournament *tournament);
+
+/**
+ * Vybere dalsi zapas kola, ktery jeste nema mistnost
+ * @param tournament Turnaj
+ * @param first Vystup - slot prvniho hrace
+ * @param second Vystup - slot druheho hrace
+ * @return false pokud uz vsechny zapasy kola maji mistnost
+ */
+bool tournament_next_match(Tournament *tournament, int *first, int *second);
+
+/**
+ * Zaznamena postup hrace do dalsiho kola
+ * @param tournament Turnaj
+ * @param slot Slot hrace
+ */
+void tournament_advance(Tournament *tournament, int slot);
+
+/**
+ * Zkontroluje, zda jsou dohrany vsechny zapasy kola
+ * @param tournament Turnaj
+ * @return true pokud kolo skoncilo
+ */
+bool tournament_round_done(const Tournament *tournament);
+
+/**
+ * Ukonci turnaj (zpet do stavu bez turnaje)
+ * @param tournament Turnaj
+ */
+void tournament_close(Tournament *tournament);
+
+#endif /* TOURNAMENT_H */
@@ -0,0 +1,597 @@
+/**
+ * @file upgrade.c
+ * @brief Implementace upgradu serveru za behu
+ *
+ * Prubeh predani (stary proces -> novy proces):
+ *   1. hlavicka (verze formatu, velikosti struktur) + naslouchajici sockety
+ *      (TCP, pripadne AF_UNIX a WebSocket - v tomto poradi)
+ *   2. tabulka hracu (vcetne prijimacich bufferu a slotu botu)
+ *   3. tabulka mistnosti (vcetne stavu her) a turnajovy pavouk
+ *   4. davky klientskych socketu (SCM_RIGHTS) s indexy slotu hracu
+ *   5. novy proces potvrdi jednim bajtem UPGRADE_ACK
+ *
+ * Tabulky se prenaseji binarne, novy binarni soubor proto musi mit stejne
+ * rozlozeni struktur (kontroluje se verze formatu a velikosti). Pri
+ * nesouladu novy proces skonci a stary pokracuje beze zmeny.
+ */
+
+#include "upgrade.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+
+/* ============================================
+ * FORMAT PREDAVANYCH DAT
+ * ============================================ */
+
+#define UPGRADE_MAGIC 0x4E494D55u   /* "NIMU" */
+#define UPGRADE_FORMAT_VERSION 18
+#define UPGRADE_ACK 'K'
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t player_size;           /* sizeof(Player) */
+    uint32_t room_size;             /* sizeof(Room) */
+    int32_t max_clients;
+    int32_t max_rooms;
+    int32_t fd_count;               /* Pocet klientskych socketu */
+    int32_t listener_count;         /* Pocet naslouchajicich socketu (1-3) */
+    int32_t first_room_id;          /* ID mistnosti v prvnim slotu */
+    uint64_t players_base;          /* Adresa pole hracu ve starem procesu */
+} UpgradeHeader;
+
+typedef struct {
+    int32_t count;                  /* Pocet socketu v teto davce */
+    int32_t slots[UPGRADE_FD_BATCH];/* Index hrace pro kazdy socket */
+} UpgradeFdBatch;
+
+/* ============================================
+ * PRIVATNI PROMENNE
+ * ============================================ */
+
+static int g_argc = 0;
+static char **g_argv = NULL;
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 +
+           (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Zapise cely buffer (socket je blokujici, s SO_SNDTIMEO)
+ */
+static bool write_all(int fd, const void *data, size_t len) {
+    const char *ptr = data;
+    while (len > 0) {
+        ssize_t n = send(fd, ptr, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * Precte presne len bajtu
+ */
+static bool read_all(int fd, void *data, size_t len) {
+    char *ptr = data;
+    while (len > 0) {
+        ssize_t n = recv(fd, ptr, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        ptr += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * Odesle data spolu s file descriptory (SCM_RIGHTS)
+ */
+static bool send_with_fds(int channel, const void *data, size_t len,
+                          const int *fds, int fd_count) {
+    char control[CMSG_SPACE(sizeof(int) * UPGRADE_FD_BATCH)];
+    struct iovec iov;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    iov.iov_base = (void *)data;
+    iov.iov_len = len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (fd_count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(channel, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent < 0) return false;
+
+    /* Zbytek dat (pokud se neodeslala najednou) uz bez deskriptoru */
+    return write_all(channel, (const char *)data + sent, len - (size_t)sent);
+}
+
+/**
+ * Prijme data spolu s file descriptory (SCM_RIGHTS)
+ * @return Pocet prijatych deskriptoru nebo -1 pri chybe
+ */
+static int recv_with_fds(int channel, void *data, size_t len, int *fds, int max_fds) {
+    char control[CMSG_SPACE(sizeof(int) * UPGRADE_FD_BATCH)];
+    struct iovec iov;
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = data;
+    iov.iov_len = len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(channel, &msg, 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received <= 0 || (msg.msg_flags & MSG_CTRUNC)) {
+        return -1;
+    }
+
+    int fd_count = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            int n = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            if (n > max_fds) n = max_fds;
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * n);
+            fd_count = n;
+        }
+    }
+
+    /* Docti zbytek dat */
+    if (!read_all(channel, (char *)data + received, len - (size_t)received)) {
+        for (int i = 0; i < fd_count; i++) close(fds[i]);
+        return -1;
+    }
+
+    return fd_count;
+}
+
+static void close_all(const int *fds, int count) {
+    for (int i = 0; i < count; i++) {
+        close(fds[i]);
+    }
+}
+
+static void set_cloexec(int fd) {
+    int flags = fcntl(fd, F_GETFD, 0);
+    if (flags != -1) {
+        fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+    }
+}
+
+/**
+ * V detskem procesu spusti novy binarni soubor s --upgrade-fd
+ * (vraci se jen pri chybe)
+ */
+static void exec_new_binary(int channel_fd) {
+    char fd_arg[16];
+    snprintf(fd_arg, sizeof(fd_arg), "%d", channel_fd);
+
+    char **argv = calloc((size_t)g_argc + 3, sizeof(char *));
+    if (argv == NULL) return;
+
+    /* Zkopiruj argumenty bez pripadneho --upgrade-fd z predchoziho upgradu */
+    int argc = 0;
+    for (int i = 0; i < g_argc; i++) {
+        if (strcmp(g_argv[i], "--upgrade-fd") == 0) {
+            i++;
+            continue;
+        }
+        if (strncmp(g_argv[i], "--upgrade-fd=", 13) == 0) {
+            continue;
+        }
+        argv[argc++] = g_argv[i];
+    }
+    argv[argc++] = "--upgrade-fd";
+    argv[argc++] = fd_arg;
+    argv[argc] = NULL;
+
+    execvp(argv[0], argv);
+    free(argv);
+}
+
+/**
+ * Odesle cely stav serveru novemu procesu
+ */
+static bool send_state(Server *server, int channel, int *sent_fds) {
+    int max_clients = server->config.max_clients;
+    UpgradeHeader header;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = UPGRADE_MAGIC;
+    header.version = UPGRADE_FORMAT_VERSION;
+    header.player_size = sizeof(Player);
+    header.room_size = sizeof(Room);
+    header.max_clients = max_clients;
+    header.max_rooms = server->config.max_rooms;
+    header.first_room_id = room_slot_to_id(0);
+    header.players_base = (uint64_t)(uintptr_t)server->players;
+
+    for (int i = 0; i < max_clients; i++) {
+        if (server->players[i].is_active && server->players[i].socket_fd >= 0) {
+            header.fd_count++;
+        }
+    }
+
+    /* 1. Hlavicka + naslouchajici sockety */
+    int listeners[3];
+    listeners[header.listener_count++] = server->listen_fd;
+    if (server->unix_listen_fd >= 0) listeners[header.listener_count++] = server->unix_listen_fd;
+    if (server->ws_listen_fd >= 0) listeners[header.listener_count++] = server->ws_listen_fd;
+    if (!send_with_fds(channel, &header, sizeof(header), listeners, header.listener_count)) {
+        return false;
+    }
+
+    /* 2. + 3. Tabulky hracu (vcetne slotu botu), mistnosti a turnaj */
+    size_t player_slots = (size_t)max_clients + (size_t)server->config.max_rooms;
+    const Tournament *t = &server->tournament;
+    if (!write_all(channel, server->players, sizeof(Player) * player_slots) ||
+        !write_all(channel, server->rooms, sizeof(Room) * (size_t)server->config.max_rooms) ||
+        !write_all(channel, t, sizeof(Tournament)) ||
+        !write_all(channel, t->entrants, sizeof(int) * (size_t)t->capacity) ||
+        !write_all(channel, t->advanced, sizeof(int) * (size_t)t->capacity)) {
+        return false;
+    }
+
+    /* 4. Klientske sockety po davkach */
+    UpgradeFdBatch batch;
+    int fds[UPGRADE_FD_BATCH];
+    memset(&batch, 0, sizeof(batch));
+
+    for (int i = 0; i < max_clients; i++) {
+        if (!server->players[i].is_active || server->players[i].socket_fd < 0) continue;
+
+        batch.slots[batch.count] = i;
+        fds[batch.count] = server->players[i].socket_fd;
+        batch.count++;
+
+        if (batch.count == UPGRADE_FD_BATCH) {
+            if (!send_with_fds(channel, &batch, sizeof(batch), fds, batch.count)) {
+                return false;
+            }
+            *sent_fds += batch.count;
+            batch.count = 0;
+        }
+    }
+
+    if (batch.count > 0) {
+        if (!send_with_fds(channel, &batch, sizeof(batch), fds, batch.count)) {
+            return false;
+        }
+        *sent_fds += batch.count;
+    }
+
+    return true;
+}
+
+/**
+ * Pocka na potvrzeni od noveho procesu
+ */
+static bool wait_for_ack(int channel) {
+    struct pollfd pfd;
+    pfd.fd = channel;
+    pfd.events = POLLIN;
+
+    int ready;
+    do {
+        ready = poll(&pfd, 1, UPGRADE_ACK_TIMEOUT_MS);
+    } while (ready < 0 && errno == EINTR);
+
+    if (ready <= 0) {
+        LOG_ERROR("Upgrade: no acknowledgement from the new process");
+        return false;
+    }
+
+    char ack = 0;
+    if (!read_all(channel, &ack, 1) || ack != UPGRADE_ACK) {
+        LOG_ERROR("Upgrade: new process rejected the handover");
+        return false;
+    }
+    return true;
+}
+
+/* ============================================
+ * IMPLEMENTACE VEREJNYCH FUNKCI
+ * ============================================ */
+
+void upgrade_save_args(int argc, char *argv[]) {
+    g_argc = argc;
+    g_argv = argv;
+}
+
+bool upgrade_handover(Server *server) {
+    if (server == NULL || g_argv == NULL) return false;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    LOG_INFO("Upgrade requested, starting new process '%s'", g_argv[0]);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        LOG_ERROR("Upgrade: socketpair failed: %s", strerror(errno));
+        return false;
+    }
+
+    /* Nasi stranu kanalu nove spusteny proces nezdedi */
+    set_cloexec(sv[0]);
+
+    /* Novy proces, ktery se zasekne, nesmi zablokovat stary navzdy */
+    struct timeval timeout;
+    timeout.tv_sec = UPGRADE_ACK_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (UPGRADE_ACK_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(sv[0], SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("Upgrade: fork failed: %s", strerror(errno));
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        /* Detsky proces */
+        close(sv[0]);
+        exec_new_binary(sv[1]);
+        _exit(127);
+    }
+
+    close(sv[1]);
+
+    int sent_fds = 0;
+    bool ok = send_state(server, sv[0], &sent_fds) && wait_for_ack(sv[0]);
+    close(sv[0]);
+
+    if (!ok) {
+        LOG_ERROR("Upgrade failed, continuing with the current process");
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        return false;
+    }
+
+    LOG_INFO("Upgrade: handed over %d connections to pid %d in %.2f ms",
+             sent_fds, (int)pid, elapsed_ms(&start));
+    return true;
+}
+
+bool upgrade_receive(Server *server, int channel_fd) {
+    if (server == NULL || channel_fd < 0) return false;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    UpgradeHeader header;
+    int listeners[3];
+
+    /* 1. Hlavicka + naslouchajici sockety */
+    int listener_count = recv_with_fds(channel_fd, &header, sizeof(header), listeners, 3);
+    if (listener_count < 1) {
+        LOG_ERROR("Upgrade: failed to receive header");
+        close(channel_fd);
+        return false;
+    }
+
+    if (header.magic != UPGRADE_MAGIC ||
+        header.version != UPGRADE_FORMAT_VERSION ||
+        header.player_size != sizeof(Player) ||
+        header.room_size != sizeof(Room) ||
+        header.max_clients != server->config.max_clients ||
+        header.max_rooms != server->config.max_rooms) {
+        LOG_ERROR("Upgrade: incompatible state (version %u, player %u/%zu B, room %u/%zu B, "
+                  "clients %d/%d, rooms %d/%d)",
+                  header.version, header.player_size, sizeof(Player),
+                  header.room_size, sizeof(Room),
+                  header.max_clients, server->config.max_clients,
+                  header.max_rooms, server->config.max_rooms);
+        close_all(listeners, listener_count);
+        close(channel_fd);
+        return false;
+    }
+
+    /* ID mistnosti uz znaji klienti i tabulky (room_id, watch_room_id) - plati
+     * dal, i kdyz novy proces dostal od registru jiny uzel nebo zadny */
+    if (header.first_room_id != room_slot_to_id(0)) {
+        LOG_WARNING("Upgrade: keeping room IDs from %d (this process would start at %d)",
+                    header.first_room_id, room_slot_to_id(0));
+        room_set_first_id(header.first_room_id);
+    }
+
+    /* Dalsi listenery se prebiraji jen se stejnou konfiguraci (stejne
+     * argumenty) - jinak by soubor AF_UNIX socketu zustal bez uklidu */
+    bool unix_expected = server->config.unix_socket_path[0] != '\0';
+    bool ws_expected = server->config.websocket_port > 0;
+    if (listener_count != header.listener_count ||
+        listener_count != 1 + unix_expected + ws_expected) {
+        LOG_ERROR("Upgrade: listener mismatch (%d received, %d expected)",
+                  listener_count, 1 + unix_expected + ws_expected);
+        close_all(listeners, listener_count);
+        close(channel_fd);
+        return false;
+    }
+
+    /* 2. + 3. Tabulky hracu (vcetne slotu botu), mistnosti a turnaj
+     * (pole pavouka maji stejnou kapacitu, ukazatele na ne zustavaji nase) */
+    size_t player_slots = (size_t)header.max_clients + (size_t)header.max_rooms;
+    Tournament *t = &server->tournament;
+    int *entrants = t->entrants;
+    int *advanced = t->advanced;
+    bool tables_ok = read_all(channel_fd, server->players, sizeof(Player) * player_slots) &&
+        read_all(channel_fd, server->rooms, sizeof(Room) * (size_t)header.max_rooms) &&
+        read_all(channel_fd, t, sizeof(Tournament));
+    t->entrants = entrants;
+    t->advanced = advanced;
+    if (!tables_ok ||
+        !read_all(channel_fd, t->entrants, sizeof(int) * (size_t)header.max_clients) ||
+        !read_all(channel_fd, t->advanced, sizeof(int) * (size_t)header.max_clients)) {
+        LOG_ERROR("Upgrade: failed to receive tables");
+        close_all(listeners, listener_count);
+        close(channel_fd);
+        return false;
+    }
+
+    /* Ukazatele na hrace v mistnostech prepocitej na nove pole */
+    for (int i = 0; i < header.max_rooms; i++) {
+        Room *room = &server->rooms[i];
+        for (int j = 0; j < ROOM_MAX_PLAYERS; j++) {
+            if (room->players[j] == NULL) continue;
+
+            uint64_t offset = (uint64_t)(uintptr_t)room->players[j] - header.players_base;
+            uint64_t index = offset / sizeof(Player);
+            if (offset % sizeof(Player) != 0 || index >= (uint64_t)player_slots) {
+                LOG_ERROR("Upgrade: invalid player reference in room %d", i);
+                room->players[j] = NULL;
+                continue;
+            }
+            room->players[j] = &server->players[index];
+        }
+        game_update_preset(&room->game);
+    }
+
+    /* Stare cislo socketu ani ukazatele odchozich front v novem procesu neplati;
+     * divak dostane po prvnim flushi cerstvy stav (WATCH_OK) */
+    time_t now = time(NULL);
+    for (int i = 0; i < header.max_clients; i++) {
+        Player *player = &server->players[i];
+        player->socket_fd = -1;
+        outqueue_init(&player->out_queue);
+        player->resync_pending = player->watch_room_id >= 0;
+        player->lag_since = now;
+    }
+
+    /* 4. Klientske sockety */
+    int received = 0;
+    UpgradeFdBatch batch;
+    int fds[UPGRADE_FD_BATCH];
+
+    while (received < header.fd_count) {
+        int n = recv_with_fds(channel_fd, &batch, sizeof(batch), fds, UPGRADE_FD_BATCH);
+        if (n < 0 || n != batch.count) {
+            LOG_ERROR("Upgrade: failed to receive client sockets (%d/%d)",
+                      received, header.fd_count);
+            for (int i = 0; i < n; i++) close(fds[i]);
+            for (int i = 0; i < header.max_clients; i++) {
+                if (server->players[i].socket_fd >= 0) close(server->players[i].socket_fd);
+            }
+            close_all(listeners, listener_count);
+            close(channel_fd);
+            return false;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int slot = batch.slots[i];
+            set_cloexec(fds[i]);
+            if (slot < 0 || slot >= header.max_clients) {
+                close(fds[i]);
+                continue;
+            }
+            server->players[slot].socket_fd = fds[i];
+        }
+        received += n;
+    }
+
+    for (int i = 0; i < listener_count; i++) {
+        set_cloexec(listeners[i]);
+    }
+    int next = 0;
+    server->listen_fd = listeners[next++];
+    if (unix_expected) server->unix_listen_fd = listeners[next++];
+    if (ws_expected) server->ws_listen_fd = listeners[next++];
+
+    upgrade_release_orphans(server);
+    int restored_rooms = 0;
+    for (int i = 0; i < header.max_rooms; i++) {
+        if (server->rooms[i].is_active) restored_rooms++;
+    }
+
+    /* 5. Potvrzeni */
+    char ack = UPGRADE_ACK;
+    if (!write_all(channel_fd, &ack, 1)) {
+        LOG_ERROR("Upgrade: failed to acknowledge handover");
+        for (int i = 0; i < header.max_clients; i++) {
+            if (server->players[i].socket_fd >= 0) close(server->players[i].socket_fd);
+        }
+        close_all(listeners, listener_count);
+        close(channel_fd);
+        return false;
+    }
+    close(channel_fd);
+
+    LOG_INFO("Upgrade: took over %d connections and %d rooms in %.2f ms",
+             received, restored_rooms, elapsed_ms(&start));
+    return true;
+}
+
+void upgrade_release_orphans(Server *server) {
+    if (server == NULL) return;
+
+    for (int i = 0; i < server->config.max_clients; i++) {
+        Player *player = &server->players[i];
+        if (!player->is_active || player->socket_fd >= 0 ||
+            player->state == PLAYER_STATE_DISCONNECTED) {
+            continue;
+        }
+
+        /* watch_room_id je ID mistnosti, ne index - s prvnim ID od registru
+         * nebo shardu se musi prevest na slot */
+        int slot = room_id_to_slot(player->watch_room_id);
+        if (player->watch_room_id >= 0 && slot >= 0 && slot < server->config.max_rooms) {
+            room_remove_spectator(&server->rooms[slot], server->players, player);
+        }
+        player->watch_room_id = -1;
+        player->next_spectator = -1;
+
+        if (player->state == PLAYER_STATE_TOURNAMENT) {
+            tournament_unregister(&server->tournament, i);
+        }
+        player_reset(player, player->room_id >= 0);
+    }
+}
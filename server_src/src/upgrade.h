@@ -0,0 +1,54 @@
+/**
+ * @file upgrade.h
+ * @brief Upgrade serveru za behu bez preruseni her (SIGUSR2)
+ *
+ * Stary proces spusti novy binarni soubor (fork + exec) a pres
+ * socketpair mu preda naslouchajici socket, vsechny klientske sockety
+ * (SCM_RIGHTS) a tabulky hracu a mistnosti vcetne stavu her
+ * a prijimacich bufferu. Po potvrzeni od noveho procesu stary skonci,
+ * aniz by klientum poslal SERVER_SHUTDOWN.
+ */
+
+#ifndef UPGRADE_H
+#define UPGRADE_H
+
+#include <stdbool.h>
+#include "server.h"
+
+/* ============================================
+ * VEREJNE FUNKCE
+ * ============================================ */
+
+/**
+ * Ulozi argumenty prikazove radky pro pozdejsi spusteni noveho procesu
+ * @param argc Pocet argumentu
+ * @param argv Argumenty (musi zustat platne po celou dobu behu)
+ */
+void upgrade_save_args(int argc, char *argv[]);
+
+/**
+ * Spusti novy binarni soubor a preda mu vsechna spojeni a stav
+ * @param server Server (stary proces)
+ * @return true pokud novy proces stav prevzal a stary ma skoncit,
+ *         false pokud upgrade selhal a stary proces pokracuje
+ */
+bool upgrade_handover(Server *server);
+
+/**
+ * Prevezme spojeni a stav od predchoziho procesu
+ * Volano ze server_init() misto vytvoreni naslouchajiciho socketu.
+ * @param server Server (novy proces, tabulky uz jsou alokovane)
+ * @param channel_fd Kanal od stareho procesu (--upgrade-fd)
+ * @return true pri uspechu
+ */
+bool upgrade_receive(Server *server, int channel_fd);
+
+/**
+ * Uvolni hrace, jejichz socket pri predani nedorazil (nesmi zustat
+ * "pripojeni"); divaky odebere ze sledovane mistnosti
+ * Volano z upgrade_receive(), nim_sim ho pouziva k simulaci predani.
+ * @param server Server (tabulky uz prevzate)
+ */
+void upgrade_release_orphans(Server *server);
+
+#endif /* UPGRADE_H */
@@ -0,0 +1,425 @@
+/**
+ * @file websocket.c
+ * @brief Implementace WebSocket handshaku a ramcu
+ */
+
+#include "websocket.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** Konstanta pro Sec-WebSocket-Accept (RFC 6455, 1.3) */
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/** Delka Sec-WebSocket-Key (base64 16 bajtu) */
+#define WS_KEY_LENGTH 24
+
+/* Casti handshaku, ktere musi pozadavek obsahovat */
+#define WS_SEEN_REQUEST 0x01
+#define WS_SEEN_UPGRADE 0x02
+#define WS_SEEN_KEY     0x04
+#define WS_SEEN_VERSION 0x08
+#define WS_SEEN_ALL     0x0F
+
+/* ============================================
+ * SHA-1 A BASE64 (JEN PRO Sec-WebSocket-Accept)
+ * ============================================ */
+
+static uint32_t rotl32(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+static void sha1_block(uint32_t h[5], const unsigned char *block) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+               (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999u; }
+        else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1u; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDCu; }
+        else             { f = b ^ c ^ d;                    k = 0xCA62C1D6u; }
+        uint32_t t = rotl32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rotl32(b, 30);
+        b = a;
+        a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void sha1(const unsigned char *data, size_t len, unsigned char digest[20]) {
+    uint32_t h[5] = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u };
+    unsigned char block[64];
+    size_t pos = 0;
+
+    for (; pos + 64 <= len; pos += 64) {
+        sha1_block(h, data + pos);
+    }
+
+    /* Posledni blok: zbytek dat, 0x80, nuly a delka v bitech */
+    size_t rest = len - pos;
+    memset(block, 0, sizeof(block));
+    memcpy(block, data + pos, rest);
+    block[rest] = 0x80;
+    if (rest >= 56) {
+        sha1_block(h, block);
+        memset(block, 0, sizeof(block));
+    }
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) {
+        block[63 - i] = (unsigned char)(bits >> (8 * i));
+    }
+    sha1_block(h, block);
+
+    for (int i = 0; i < 5; i++) {
+        digest[4 * i] = (unsigned char)(h[i] >> 24);
+        digest[4 * i + 1] = (unsigned char)(h[i] >> 16);
+        digest[4 * i + 2] = (unsigned char)(h[i] >> 8);
+        digest[4 * i + 3] = (unsigned char)h[i];
+    }
+}
+
+/**
+ * Base64 (s doplnenim '=')
+ * @param out Buffer alespon 4 * ceil(len / 3) + 1 bajtu
+ */
+static void base64_encode(const unsigned char *data, size_t len, char *out) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t chunk = (uint32_t)data[i] << 16;
+        if (i + 1 < len) chunk |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) chunk |= data[i + 2];
+
+        *out++ = alphabet[(chunk >> 18) & 0x3F];
+        *out++ = alphabet[(chunk >> 12) & 0x3F];
+        *out++ = i + 1 < len ? alphabet[(chunk >> 6) & 0x3F] : '=';
+        *out++ = i + 2 < len ? alphabet[chunk & 0x3F] : '=';
+    }
+    *out = '\0';
+}
+
+/* ============================================
+ * HANDSHAKE
+ * ============================================ */
+
+/**
+ * Porovna nazev hlavicky bez ohledu na velikost pismen
+ */
+static bool header_is(const char *name, size_t name_len, const char *expected) {
+    return name_len == strlen(expected) && strncasecmp(name, expected, name_len) == 0;
+}
+
+WsHandshakeResult ws_handshake_line(WsConnection *ws, const char *line, size_t len) {
+    /* Pozadavek: "GET /cesta HTTP/1.1" */
+    if (!(ws->handshake & WS_SEEN_REQUEST)) {
+        static const char version[] = " HTTP/1.1";
+        size_t version_len = sizeof(version) - 1;
+        if (len < 4 + version_len || strncmp(line, "GET ", 4) != 0 ||
+            memcmp(line + len - version_len, version, version_len) != 0) {
+            return WS_HANDSHAKE_BAD;
+        }
+        ws->handshake |= WS_SEEN_REQUEST;
+        return WS_HANDSHAKE_MORE;
+    }
+
+    if (len == 0) {
+        return ws->handshake == WS_SEEN_ALL ? WS_HANDSHAKE_DONE : WS_HANDSHAKE_BAD;
+    }
+
+    const char *colon = memchr(line, ':', len);
+    if (colon == NULL) return WS_HANDSHAKE_BAD;
+
+    size_t name_len = (size_t)(colon - line);
+    const char *value = colon + 1;
+    const char *end = line + len;
+    while (value < end && (*value == ' ' || *value == '\t')) value++;
+    while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    size_t value_len = (size_t)(end - value);
+
+    if (header_is(line, name_len, "Upgrade")) {
+        if (value_len == 9 && strncasecmp(value, "websocket", 9) == 0) {
+            ws->handshake |= WS_SEEN_UPGRADE;
+        }
+    } else if (header_is(line, name_len, "Sec-WebSocket-Version")) {
+        if (value_len == 2 && memcmp(value, "13", 2) == 0) {
+            ws->handshake |= WS_SEEN_VERSION;
+        }
+    } else if (header_is(line, name_len, "Sec-WebSocket-Key")) {
+        if (value_len != WS_KEY_LENGTH) return WS_HANDSHAKE_BAD;
+
+        unsigned char input[WS_KEY_LENGTH + sizeof(WS_GUID) - 1];
+        unsigned char digest[20];
+        memcpy(input, value, WS_KEY_LENGTH);
+        memcpy(input + WS_KEY_LENGTH, WS_GUID, sizeof(WS_GUID) - 1);
+        sha1(input, sizeof(input), digest);
+        base64_encode(digest, sizeof(digest), ws->accept);
+        ws->handshake |= WS_SEEN_KEY;
+    }
+    return WS_HANDSHAKE_MORE;
+}
+
+bool ws_handshake_skip_line(WsConnection *ws) {
+    if (!(ws->handshake & WS_SEEN_REQUEST)) return false;
+    ws->skip_line = true;
+    return true;
+}
+
+int ws_create_handshake_response(const WsConnection *ws, char *buffer, int size) {
+    int len = snprintf(buffer, size,
+                       "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n"
+                       "\r\n", ws->accept);
+    return len < size ? len : size - 1;
+}
+
+int ws_create_http_error(char *buffer, int size, const char *status) {
+    int len = snprintf(buffer, size,
+                       "HTTP/1.1 %s\r\n"
+                       "Sec-WebSocket-Version: 13\r\n"
+                       "Connection: close\r\n"
+                       "Content-Length: 0\r\n"
+                       "\r\n", status);
+    return len < size ? len : size - 1;
+}
+
+/* ============================================
+ * DEKODOVANI RAMCU
+ * ============================================ */
+
+/**
+ * Zkopiruje payload a odmaskuje ho (XOR s opakovanou 4bajtovou maskou)
+ * Maska se natoci podle faze (kolik dat ramce uz bylo zpracovano), pak se
+ * XORuje po 16 bajtech (SSE2), po 8 bajtech a zbytek po bajtech - vsechny
+ * kroky jsou nasobky 4, takze natocena maska plati po celou dobu.
+ */
+static void unmask_copy(char *dst, const char *src, size_t len, const uint8_t mask[4],
+                        uint32_t phase) {
+    uint8_t rotated[4];
+    for (int i = 0; i < 4; i++) {
+        rotated[i] = mask[(phase + (uint32_t)i) & 3];
+    }
+
+    uint32_t mask32;
+    memcpy(&mask32, rotated, sizeof(mask32));
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i mask128 = _mm_set1_epi32((int)mask32);
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(chunk, mask128));
+    }
+#endif
+
+    uint64_t mask64 = (uint64_t)mask32 << 32 | mask32;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, src + i, sizeof(chunk));
+        chunk ^= mask64;
+        memcpy(dst + i, &chunk, sizeof(chunk));
+    }
+
+    for (; i < len; i++) {
+        dst[i] = (char)(src[i] ^ rotated[i & 3]);
+    }
+}
+
+/**
+ * Delka cele hlavicky podle prvnich dvou bajtu
+ */
+static size_t header_length(const uint8_t *header) {
+    uint8_t len7 = header[1] & 0x7F;
+    return 2 + (len7 == 126 ? 2 : len7 == 127 ? 8 : 0) + 4;
+}
+
+/**
+ * Overi hlavicku a pripravi cteni payloadu
+ */
+static WsDecodeResult start_frame(WsConnection *ws, int out_len, int out_size) {
+    const uint8_t *h = ws->header;
+    uint8_t opcode = h[0] & 0x0F;
+    bool fin = (h[0] & 0x80) != 0;
+    bool control = (opcode & 0x08) != 0;
+    uint8_t len7 = h[1] & 0x7F;
+
+    /* Rozsireni (RSV) se nevyjednavaji, klient musi maskovat */
+    if ((h[0] & 0x70) != 0 || (h[1] & 0x80) == 0) return WS_DECODE_ERROR;
+
+    if (control) {
+        if (!fin || len7 > WS_MAX_CONTROL_PAYLOAD) return WS_DECODE_ERROR;
+        if (opcode != WS_OPCODE_CLOSE && opcode != WS_OPCODE_PING &&
+            opcode != WS_OPCODE_PONG) {
+            return WS_DECODE_ERROR;
+        }
+    } else if (opcode == WS_OPCODE_CONTINUATION) {
+        if (!ws->in_message) return WS_DECODE_ERROR;
+    } else if (opcode == WS_OPCODE_TEXT) {
+        if (ws->in_message) return WS_DECODE_ERROR;
+    } else {
+        /* Binarni ramce protokol nema (binarni rezim je jen pro TCP) */
+        return WS_DECODE_ERROR;
+    }
+
+    uint32_t payload;
+    size_t offset = 2;
+    if (len7 == 127) {
+        return WS_DECODE_TOO_BIG;
+    } else if (len7 == 126) {
+        payload = (uint32_t)h[2] << 8 | h[3];
+        offset = 4;
+    } else {
+        payload = len7;
+    }
+    memcpy(ws->mask, h + offset, 4);
+
+    /* Cela zprava vcetne doplneneho '\n' se musi vejit do bufferu */
+    if (!control && (int64_t)out_len + payload + (fin ? 1 : 0) > out_size) {
+        return WS_DECODE_TOO_BIG;
+    }
+
+    ws->opcode = control ? opcode : WS_OPCODE_TEXT;
+    ws->fin = fin;
+    ws->payload_left = payload;
+    ws->payload_done = 0;
+    ws->control_len = 0;
+    ws->in_payload = true;
+    return WS_DECODE_DATA;
+}
+
+/**
+ * Dokonci ramec
+ * @return DATA, nebo udalost ridiciho ramce
+ */
+static WsDecodeResult finish_frame(WsConnection *ws, char *out, int *out_len) {
+    ws->in_payload = false;
+    ws->header_len = 0;
+
+    switch (ws->opcode) {
+        case WS_OPCODE_PING:
+            return WS_DECODE_PING;
+        case WS_OPCODE_CLOSE:
+            return WS_DECODE_CLOSE;
+        case WS_OPCODE_PONG:
+            return WS_DECODE_DATA;
+        default:
+            break;
+    }
+
+    if (!ws->fin) {
+        ws->in_message = true;
+        return WS_DECODE_DATA;
+    }
+
+    /* Konec zpravy - oddelovac radku, pokud ho klient neposlal */
+    if (ws->message_len > 0 && out[*out_len - 1] != '\n') {
+        out[(*out_len)++] = '\n';
+    }
+    ws->in_message = false;
+    ws->message_len = 0;
+    return WS_DECODE_DATA;
+}
+
+WsDecodeResult ws_decode(WsConnection *ws, const char *data, size_t len, size_t *consumed,
+                         char *out, int *out_len, int out_size) {
+    size_t pos = 0;
+    WsDecodeResult result = WS_DECODE_DATA;
+
+    while (pos < len && result == WS_DECODE_DATA) {
+        if (!ws->in_payload) {
+            /* Hlavicka muze prijit po castech */
+            size_t need = ws->header_len < 2 ? 2 : header_length(ws->header);
+            size_t take = need - ws->header_len;
+            if (take > len - pos) take = len - pos;
+            memcpy(ws->header + ws->header_len, data + pos, take);
+            ws->header_len += (uint8_t)take;
+            pos += take;
+
+            if (ws->header_len < 2 || ws->header_len < header_length(ws->header)) continue;
+
+            result = start_frame(ws, *out_len, out_size);
+            if (result == WS_DECODE_DATA && ws->payload_left == 0) {
+                result = finish_frame(ws, out, out_len);
+            }
+            continue;
+        }
+
+        size_t chunk = ws->payload_left;
+        if (chunk > len - pos) chunk = len - pos;
+
+        if (ws->opcode == WS_OPCODE_TEXT) {
+            unmask_copy(out + *out_len, data + pos, chunk, ws->mask, ws->payload_done);
+            *out_len += (int)chunk;
+            ws->message_len += (uint32_t)chunk;
+        } else {
+            unmask_copy(ws->control + ws->control_len, data + pos, chunk, ws->mask,
+                        ws->payload_done);
+            ws->control_len += (uint8_t)chunk;
+        }
+        pos += chunk;
+        ws->payload_done += (uint32_t)chunk;
+        ws->payload_left -= (uint32_t)chunk;
+
+        if (ws->payload_left == 0) {
+            result = finish_frame(ws, out, out_len);
+        }
+    }
+
+    *consumed = pos;
+    return result;
+}
+
+/* ============================================
+ * KODOVANI RAMCU
+ * ============================================ */
+
+/**
+ * Zapise nemaskovany ramec serveru
+ */
+static int encode_frame(int opcode, const char *payload, size_t len, char *out, int size) {
+    size_t header = len < 126 ? 2 : 4;
+    if (len > 0xFFFF || (size_t)size < header + len) return -1;
+
+    out[0] = (char)(0x80 | opcode);
+    if (len < 126) {
+        out[1] = (char)len;
+    } else {
+        out[1] = 126;
+        out[2] = (char)(len >> 8);
+        out[3] = (char)(len & 0xFF);
+    }
+    memcpy(out + header, payload, len);
+    return (int)(header + len);
+}
+
+int ws_encode_text(const char *message, size_t len, char *out, int size) {
+    if (len > 0 && message[len - 1] == '\n') len--;
+    return encode_frame(WS_OPCODE_TEXT, message, len, out, size);
+}
+
+int ws_encode_control(int opcode, const char *payload, size_t len, char *out, int size) {
+    if (len > WS_MAX_CONTROL_PAYLOAD) return -1;
+    return encode_frame(opcode, payload, len, out, size);
+}
+
+int ws_create_close(char *out, int size, int status) {
+    char payload[2] = { (char)(status >> 8), (char)(status & 0xFF) };
+    return ws_encode_control(WS_OPCODE_CLOSE, payload, sizeof(payload), out, size);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file websocket.h
+ * @brief WebSocket (RFC 6455) pro prohlizecove klienty
+ *
+ * Spojeni z WebSocket listeneru projde HTTP handshakem a pak nese stejny
+ * textovy protokol jako TCP. Kazda zprava serveru odejde jako jeden textovy
+ * ramec (bez '\n'), textove zpravy klienta se rozbali primo do prijimaciho
+ * bufferu hrace a na konci kazde se doplni '\n'.
+ *
+ * Dekoder je proudovy - rozpracovany ramec (hlavicka, maska, zbyvajici
+ * delka) drzi WsConnection mezi volanimi recv(), payload se odmaskuje
+ * rovnou pri kopii do bufferu hrace. Zadny ramec se nealokuje.
+ */
+
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================
+ * KONSTANTY PROTOKOLU
+ * ============================================ */
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT         0x1
+#define WS_OPCODE_BINARY       0x2
+#define WS_OPCODE_CLOSE        0x8
+#define WS_OPCODE_PING         0x9
+#define WS_OPCODE_PONG         0xA
+
+/** Nejdelsi payload ridiciho ramce */
+#define WS_MAX_CONTROL_PAYLOAD 125
+
+/** Nejdelsi hlavicka ramce serveru (nemaskovany, payload do 64 KiB) */
+#define WS_SERVER_HEADER_MAX 4
+
+/** Nejdelsi hlavicka ramce klienta (64bit delka + maska) */
+#define WS_CLIENT_HEADER_MAX 14
+
+/** Delka Sec-WebSocket-Accept (base64 SHA-1) */
+#define WS_ACCEPT_LENGTH 28
+
+/** Stavove kody CLOSE */
+#define WS_CLOSE_NORMAL        1000
+#define WS_CLOSE_GOING_AWAY    1001
+#define WS_CLOSE_PROTOCOL      1002
+#define WS_CLOSE_TOO_BIG       1009
+
+/* ============================================
+ * STAV SPOJENI
+ * ============================================ */
+
+typedef enum {
+    WS_STATE_NONE = 0,          /* Obycejne spojeni (TCP, AF_UNIX) */
+    WS_STATE_HANDSHAKE,         /* Ceka se na HTTP pozadavek */
+    WS_STATE_OPEN               /* Handshake hotov, data jdou v ramcich */
+} WsState;
+
+typedef enum {
+    WS_HANDSHAKE_MORE,          /* Hlavicka zpracovana, cekaji se dalsi */
+    WS_HANDSHAKE_DONE,          /* Platny pozadavek ukonceny prazdnym radkem */
+    WS_HANDSHAKE_BAD            /* Neplatny pozadavek - odpovedet 400 */
+} WsHandshakeResult;
+
+typedef enum {
+    WS_DECODE_DATA,             /* Vstup spotrebovan, text je v cilovem bufferu */
+    WS_DECODE_PING,             /* PING - odpovedet PONG s payloadem ws->control */
+    WS_DECODE_CLOSE,            /* Klient zavira spojeni */
+    WS_DECODE_TOO_BIG,          /* Zprava se nevejde do bufferu */
+    WS_DECODE_ERROR             /* Poruseni protokolu */
+} WsDecodeResult;
+
+typedef struct {
+    WsState state;
+    uint8_t handshake;                      /* Bity prijatych casti handshaku */
+    bool skip_line;                         /* Zahazuje se zbytek dlouheho radku hlavicky */
+    bool in_message;                        /* Textova zprava pokracuje dalsim ramcem */
+    bool in_payload;                        /* Hlavicka ramce je cela, ctou se data */
+    uint8_t opcode;                         /* Opcode rozpracovaneho ramce */
+    bool fin;                               /* Posledni ramec zpravy */
+    uint8_t header_len;                     /* Nactena cast hlavicky */
+    uint8_t header[WS_CLIENT_HEADER_MAX];
+    uint8_t mask[4];
+    uint32_t payload_left;                  /* Zbyvajici data ramce */
+    uint32_t payload_done;                  /* Odmaskovana data ramce (faze masky) */
+    uint32_t message_len;                   /* Delka rozbalovane textove zpravy */
+    uint8_t control_len;
+    char control[WS_MAX_CONTROL_PAYLOAD];   /* Payload ridiciho ramce */
+    char accept[WS_ACCEPT_LENGTH + 1];      /* Sec-WebSocket-Accept pro odpoved */
+} WsConnection;
+
+/* ============================================
+ * HANDSHAKE
+ * ============================================ */
+
+/**
+ * Zpracuje jeden radek HTTP pozadavku (bez \r\n)
+ * @param ws Stav spojeni
+ * @param line Radek
+ * @param len Delka radku
+ * @return Vysledek - DONE po prazdnem radku platneho pozadavku
+ */
+WsHandshakeResult ws_handshake_line(WsConnection *ws, const char *line, size_t len);
+
+/**
+ * Radek hlavicky se nevesel do bufferu - jeho zbytek se zahodi az po \n.
+ * Dlouhe jsou jen hlavicky, ktere handshake nepotrebuje (Cookie apod.).
+ * @param ws Stav spojeni
+ * @return false pokud jde o radek pozadavku (GET), ten preskocit nelze
+ */
+bool ws_handshake_skip_line(WsConnection *ws);
+
+/**
+ * Vytvori odpoved 101 Switching Protocols
+ * @return Delka odpovedi
+ */
+int ws_create_handshake_response(const WsConnection *ws, char *buffer, int size);
+
+/**
+ * Vytvori HTTP chybu, po ktere server spojeni zavre
+ * @param status Stavovy radek bez verze ("400 Bad Request")
+ * @return Delka odpovedi
+ */
+int ws_create_http_error(char *buffer, int size, const char *status);
+
+/* ============================================
+ * RAMCE
+ * ============================================ */
+
+/**
+ * Rozbali ramce klienta - text pripoji do out, u ridiciho ramce skonci
+ * @param ws Stav spojeni (rozpracovany ramec mezi volanimi)
+ * @param data Prijata data
+ * @param len Delka dat
+ * @param consumed Vystup - kolik bajtu dat bylo zpracovano
+ * @param out Buffer textu (prijimaci buffer hrace)
+ * @param out_len Obsazena cast out, na vystupu vcetne nove rozbalenych dat
+ * @param out_size Kapacita out
+ * @return DATA pokud bylo zpracovano vse, jinak udalost, na ktere dekoder skoncil
+ */
+WsDecodeResult ws_decode(WsConnection *ws, const char *data, size_t len, size_t *consumed,
+                         char *out, int *out_len, int out_size);
+
+/**
+ * Zabali zpravu protokolu do textoveho ramce (koncove '\n' vynecha)
+ * @return Delka ramce nebo -1, pokud se nevejde
+ */
+int ws_encode_text(const char *message, size_t len, char *out, int size);
+
+/**
+ * Vytvori ridici ramec (PONG, CLOSE)
+ * @return Delka ramce nebo -1
+ */
+int ws_encode_control(int opcode, const char *payload, size_t len, char *out, int size);
+
+/**
+ * Vytvori ramec CLOSE se stavovym kodem
+ * @return Delka ramce
+ */
+int ws_create_close(char *out, int size, int status);
+
+#endif /* WEBSOCKET_H */
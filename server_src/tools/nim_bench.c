@@ -0,0 +1,407 @@
+/**
+ * @file nim_bench.c
+ * @brief Mereni latence jedne zpravy pres TCP a AF_UNIX
+ *
+ * Otevre N prihlasenych spojeni a v kolech posila na kazde z nich PING,
+ * cekajici na PONG - vzdy jen jedna zprava na ceste, takze cas odpovedi je
+ * cista latence transportu a obsluhy. Kola jsou rozlozena tak, aby zadne
+ * spojeni neprekrocilo rate limit serveru (MAX_MESSAGES_PER_SECOND).
+ *
+ * Se zadanym -p i -u se zmeri oba transporty po sobe na stejnem serveru.
+ *
+ * Pres nim_proxy (zpozdeni, fragmentace, resety) meri i skladani zprav
+ * v read_from_client a obnovu spojeni: s -g jsou spojeni po dvojicich
+ * ve hre (spadle spojeni server drzi pro RESUME), s -R se spadle spojeni
+ * obnovi - RESUME se session tokenem, po ztrate session novy LOGIN.
+ *
+ * Pouziti: nim_bench [-a ADDRESS] [-p PORT] [-u PATH] [-c CONNECTIONS] [-n ROUNDS]
+ *                    [-g] [-R]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "config.h"
+
+/** Rozestup kol na jednom spojeni - rezerva pro LOGIN a odpovedi na PING serveru */
+#define ROUND_INTERVAL_NS (1000000000L / (MAX_MESSAGES_PER_SECOND - 4))
+
+/** Pokusy o obnovu jednoho spojeni (proxy muze shodit i nove spojeni) */
+#define RECONNECT_ATTEMPTS 5
+
+/* ============================================
+ * SPOJENI
+ * ============================================ */
+
+typedef struct {
+    int fd;
+    char buffer[BUFFER_SIZE];
+    size_t len;
+    char nickname[64];
+    char token[SESSION_TOKEN_BYTES * 2 + 1];   /* Z LOGIN_OK (pro RESUME) */
+} Connection;
+
+/** Jedno mereni (transport a rezim) */
+typedef struct {
+    const char *label;              /* Nazev ve vypisu (a zacatek prezdivek) */
+    const char *address;
+    int port;
+    const char *path;               /* AF_UNIX (NULL = TCP) */
+    int connections;
+    int rounds;
+    bool games;                     /* Spojeni po dvojicich ve hre (-g) */
+    bool reconnect;                 /* Obnovovat spadla spojeni (-R) */
+} Bench;
+
+/** Souhrn obnov spojeni */
+typedef struct {
+    int resumed;                    /* RESUME_OK */
+    int relogged;                   /* Session propadla - novy LOGIN */
+    long long total_ns;
+    long long max_ns;
+} Reconnects;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int connect_tcp(const char *address, int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &addr.sin_addr) <= 0) {
+        fprintf(stderr, "Invalid address: %s\n", address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return fd;
+}
+
+static int connect_unix(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Unix socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_line(Connection *conn, const char *line) {
+    size_t len = strlen(line);
+    while (len > 0) {
+        ssize_t sent = send(conn->fd, line, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        line += sent;
+        len -= (size_t)sent;
+    }
+    return true;
+}
+
+/**
+ * Precte dalsi radek zpravy (bez \n) do line
+ * @return false pri chybe nebo uzavreni spojeni
+ */
+static bool read_line(Connection *conn, char *line, size_t size) {
+    for (;;) {
+        char *end = memchr(conn->buffer, MSG_TERMINATOR, conn->len);
+        if (end != NULL) {
+            size_t line_len = (size_t)(end - conn->buffer);
+            size_t copy = line_len < size - 1 ? line_len : size - 1;
+            memcpy(line, conn->buffer, copy);
+            line[copy] = '\0';
+            conn->len -= line_len + 1;
+            memmove(conn->buffer, end + 1, conn->len);
+            return true;
+        }
+        if (conn->len == sizeof(conn->buffer)) return false;
+
+        ssize_t received = recv(conn->fd, conn->buffer + conn->len,
+                                sizeof(conn->buffer) - conn->len, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        conn->len += (size_t)received;
+    }
+}
+
+/**
+ * Pocka na zpravu s danym zacatkem; PING serveru cestou zodpovi
+ * @param line Vystup - nalezena zprava (alespon BUFFER_SIZE bajtu) nebo NULL
+ */
+static bool wait_for(Connection *conn, const char *prefix, char *line) {
+    char buffer[BUFFER_SIZE];
+    size_t prefix_len = strlen(prefix);
+    if (line == NULL) line = buffer;
+
+    while (read_line(conn, line, BUFFER_SIZE)) {
+        if (strncmp(line, prefix, prefix_len) == 0) return true;
+        if (strcmp(line, "PING") == 0 && !send_line(conn, "PONG\n")) return false;
+    }
+    return false;
+}
+
+static int open_connection(const Bench *bench) {
+    return bench->path != NULL ? connect_unix(bench->path)
+                               : connect_tcp(bench->address, bench->port);
+}
+
+/**
+ * Prihlasi spojeni a ulozi session token
+ */
+static bool login(Connection *conn) {
+    char line[BUFFER_SIZE];
+    snprintf(line, sizeof(line), "LOGIN;%s\n", conn->nickname);
+    if (!send_line(conn, line) || !wait_for(conn, "LOGIN_", line)) return false;
+    if (strncmp(line, "LOGIN_OK;", 9) != 0) return false;
+    snprintf(conn->token, sizeof(conn->token), "%.*s", (int)sizeof(conn->token) - 1, line + 9);
+    return true;
+}
+
+/**
+ * Obnovi spadle spojeni - RESUME se session tokenem, a kdyz session
+ * propadla (hrac v lobby), nove prihlaseni pod stejnou prezdivkou
+ */
+static bool reconnect(const Bench *bench, Connection *conn, Reconnects *stats) {
+    char line[BUFFER_SIZE];
+    long long start = now_ns();
+
+    for (int attempt = 0; attempt < RECONNECT_ATTEMPTS; attempt++) {
+        close(conn->fd);
+        conn->len = 0;
+        conn->fd = open_connection(bench);
+        if (conn->fd < 0) return false;
+
+        snprintf(line, sizeof(line), "RESUME;%s\n", conn->token);
+        if (!send_line(conn, line) || !wait_for(conn, "RESUME_", line)) continue;
+
+        if (strncmp(line, "RESUME_OK", 9) == 0) {
+            stats->resumed++;
+        } else if (login(conn)) {
+            stats->relogged++;
+        } else {
+            continue;
+        }
+
+        long long took = now_ns() - start;
+        stats->total_ns += took;
+        if (took > stats->max_ns) stats->max_ns = took;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Rozdeli spojeni do dvojic a rozehraje jim hry (CREATE_ROOM / JOIN_ROOM)
+ */
+static bool start_games(const Bench *bench, Connection *conns) {
+    char line[BUFFER_SIZE];
+
+    for (int i = 0; i + 1 < bench->connections; i += 2) {
+        snprintf(line, sizeof(line), "CREATE_ROOM;%s\n", conns[i].nickname);
+        if (!send_line(&conns[i], line) || !wait_for(&conns[i], "ROOM_", line) ||
+            strncmp(line, "ROOM_CREATED;", 13) != 0) {
+            fprintf(stderr, "%s: CREATE_ROOM failed (%s) - server -r too low?\n",
+                    bench->label, line);
+            return false;
+        }
+
+        char join[64];
+        snprintf(join, sizeof(join), "JOIN_ROOM;%d\n", atoi(line + 13));
+        if (!send_line(&conns[i + 1], join) || !wait_for(&conns[i + 1], "GAME_START", NULL) ||
+            !wait_for(&conns[i], "GAME_START", NULL)) {
+            fprintf(stderr, "%s: game %d did not start\n", bench->label, i / 2);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================
+ * MERENI
+ * ============================================ */
+
+static int compare_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const long long *sorted, int count, double p) {
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+/**
+ * Zmeri jeden transport
+ * @return EXIT_SUCCESS nebo EXIT_FAILURE
+ */
+static int run(const Bench *bench) {
+    int connections = bench->connections;
+    Connection *conns = calloc((size_t)connections, sizeof(Connection));
+    long long *samples = malloc((size_t)connections * (size_t)bench->rounds * sizeof(long long));
+    Reconnects reconnects = { 0, 0, 0, 0 };
+    int opened = 0;
+    int count = 0;
+    int result = EXIT_FAILURE;
+
+    if (conns == NULL || samples == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        goto done;
+    }
+
+    for (; opened < connections; opened++) {
+        Connection *conn = &conns[opened];
+        conn->fd = open_connection(bench);
+        if (conn->fd < 0) goto done;
+
+        snprintf(conn->nickname, sizeof(conn->nickname), "%s%d_%d", bench->label,
+                 (int)getpid() % 10000, opened);
+        if (!login(conn)) {
+            fprintf(stderr, "%s: login %d failed (server full or rate limited?)\n",
+                    bench->label, opened);
+            close(conn->fd);
+            goto done;
+        }
+    }
+
+    if (bench->games && !start_games(bench, conns)) goto done;
+
+    for (int round = 0; round < bench->rounds; round++) {
+        long long round_start = now_ns();
+
+        for (int i = 0; i < connections; i++) {
+            long long start = now_ns();
+            int attempts = 0;
+            while (!send_line(&conns[i], "PING\n") || !wait_for(&conns[i], "PONG", NULL)) {
+                /* Ztraceny vzorek se meri znovu az na obnovenem spojeni */
+                if (!bench->reconnect || attempts++ == RECONNECT_ATTEMPTS ||
+                    !reconnect(bench, &conns[i], &reconnects)) {
+                    fprintf(stderr, "%s: connection %d lost\n", bench->label, i);
+                    goto done;
+                }
+                start = now_ns();
+            }
+            samples[count++] = now_ns() - start;
+        }
+
+        long long left = ROUND_INTERVAL_NS - (now_ns() - round_start);
+        if (left > 0) {
+            struct timespec pause = { left / 1000000000LL, left % 1000000000LL };
+            nanosleep(&pause, NULL);
+        }
+    }
+
+    qsort(samples, (size_t)count, sizeof(long long), compare_ll);
+    long long total = 0;
+    for (int i = 0; i < count; i++) total += samples[i];
+
+    printf("%-5s %8d %9.1f %9.1f %9.1f %9.1f %9.1f\n", bench->label, count,
+           total / 1000.0 / count,
+           percentile_us(samples, count, 0.50),
+           percentile_us(samples, count, 0.90),
+           percentile_us(samples, count, 0.99),
+           samples[count - 1] / 1000.0);
+
+    if (bench->reconnect) {
+        int restored = reconnects.resumed + reconnects.relogged;
+        printf("%-5s reconnects %d (resumed %d, new login %d), avg %.1f ms, max %.1f ms\n",
+               bench->label, restored, reconnects.resumed, reconnects.relogged,
+               restored > 0 ? reconnects.total_ns / 1e6 / restored : 0.0,
+               reconnects.max_ns / 1e6);
+    }
+    result = EXIT_SUCCESS;
+
+done:
+    for (int i = 0; i < opened; i++) {
+        send_line(&conns[i], "LOGOUT\n");
+        close(conns[i].fd);
+    }
+    free(conns);
+    free(samples);
+    return result;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-a ADDRESS] [-p PORT] [-u PATH] [-c CONNECTIONS] [-n ROUNDS]\n",
+            program);
+    fprintf(stderr, "  -a ADDRESS      TCP address (default: 127.0.0.1)\n");
+    fprintf(stderr, "  -p PORT         Measure loopback TCP on this port\n");
+    fprintf(stderr, "  -u PATH         Measure the server's --unix-socket\n");
+    fprintf(stderr, "  -c CONNECTIONS  Logged-in connections (default: 16)\n");
+    fprintf(stderr, "  -n ROUNDS       PING rounds per connection (default: 100)\n");
+    fprintf(stderr, "  -g              Pair connections into games first (needs -r >= CONNECTIONS/2)\n");
+    fprintf(stderr, "  -R              Reconnect dropped connections (RESUME, else LOGIN)\n");
+}
+
+int main(int argc, char *argv[]) {
+    Bench bench = { "tcp", "127.0.0.1", 0, NULL, 16, 100, false, false };
+    const char *path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:p:u:c:n:gRh")) != -1) {
+        switch (opt) {
+            case 'a': bench.address = optarg; break;
+            case 'p': bench.port = atoi(optarg); break;
+            case 'u': path = optarg; break;
+            case 'c': bench.connections = atoi(optarg); break;
+            case 'n': bench.rounds = atoi(optarg); break;
+            case 'g': bench.games = true; break;
+            case 'R': bench.reconnect = true; break;
+            default:  usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    if ((bench.port <= 0 && path == NULL) || bench.connections <= 0 || bench.rounds <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-5s %8s %9s %9s %9s %9s %9s\n",
+           "", "samples", "avg us", "p50 us", "p90 us", "p99 us", "max us");
+
+    int result = EXIT_SUCCESS;
+    if (bench.port > 0 && run(&bench) != EXIT_SUCCESS) {
+        result = EXIT_FAILURE;
+    }
+    if (path != NULL) {
+        bench.label = "unix";
+        bench.path = path;
+        if (run(&bench) != EXIT_SUCCESS) result = EXIT_FAILURE;
+    }
+    return result;
+}
@@ -0,0 +1,633 @@
+/**
+ * @file nim_proxy.c
+ * @brief Proxy se zhorsenou siti mezi klienty a nim_server
+ *
+ * Nahrada InTCPtoru bez LD_PRELOAD: stoji pred serverem a data obou smeru
+ * preposila se zpozdenim (DELAY +- JITTER ms), cast bloku rozseka na kusy
+ * po 1-2 bajtech (kazdy kus samostatnym send()) a vybrana spojeni po
+ * nahodne dobe shodi resetem (RST) na obe strany. Poradi dat v ramci smeru
+ * zustava zachovano - kus nikdy nepredbehne predchozi.
+ *
+ * Jedna smycka poll(), spojeni k serveru se navazuje neblokujicim connect().
+ * Po SIGINT / SIGTERM vypise souhrn (spojeni, resety, bajty, kusy).
+ *
+ * Pouziti: nim_proxy -l PORT -t ADDRESS:PORT [-d MS] [-j MS] [-f PERCENT]
+ *                    [-r PERCENT] [-w MIN-MAX] [-s SEED] [-c CONNECTIONS]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/** Nejvic bajtu cekajicich v jednom smeru - pak se zdroj prestane cist */
+#define PROXY_QUEUE_LIMIT (256 * 1024)
+
+/** Velikost jednoho cteni ze socketu */
+#define PROXY_READ_SIZE 4096
+
+/* ============================================
+ * KONFIGURACE
+ * ============================================ */
+
+typedef struct {
+    char listen_address[64];
+    int listen_port;
+    struct sockaddr_in target;
+    int delay_ms;               /* Stredni zpozdeni bloku */
+    int jitter_ms;              /* Rozptyl zpozdeni (rovnomerne +-) */
+    int fragment_percent;       /* Sance, ze se blok rozseka na 1-2 bajty */
+    int reset_percent;          /* Sance, ze spojeni skonci resetem */
+    int reset_min_ms;           /* Okno resetu od navazani spojeni */
+    int reset_max_ms;
+    int max_connections;
+    uint64_t seed;
+} ProxyConfig;
+
+/* ============================================
+ * SPOJENI
+ * ============================================ */
+
+/** Kus dat cekajici na odeslani */
+typedef struct {
+    int64_t release_ms;         /* Nejdrive odeslat v */
+    size_t len;
+} Segment;
+
+/** Jeden smer spojeni (data ze src se posilaji do dst) */
+typedef struct {
+    char *data;                 /* Cekajici bajty vsech kusu za sebou */
+    size_t head;                /* Odeslano z prvniho kusu / zacatek dat */
+    size_t len;
+    size_t capacity;
+    Segment *segments;
+    int seg_head;
+    int seg_count;
+    int seg_capacity;
+    int64_t last_release;       /* Kusy se neprebihaji */
+    bool eof;                   /* Zdroj zavrel spojeni */
+    bool shut;                  /* Cil uz dostal shutdown(SHUT_WR) */
+} Direction;
+
+typedef struct {
+    bool active;
+    bool connecting;            /* Ceka se na connect() k serveru */
+    int client_fd;
+    int server_fd;
+    int64_t reset_at;           /* Cas resetu (0 = bez resetu) */
+    Direction up;               /* Klient -> server */
+    Direction down;             /* Server -> klient */
+} Pair;
+
+typedef struct {
+    unsigned long long connections;
+    unsigned long long resets;
+    unsigned long long failed_connects;
+    unsigned long long bytes_up;
+    unsigned long long bytes_down;
+    unsigned long long segments;
+    unsigned long long fragments;   /* Kusy po 1-2 bajtech */
+} ProxyStats;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void stop_handler(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** Nahodne cislo z <min, max> */
+static int rng_range(uint64_t *state, int min, int max) {
+    return min + (int)(splitmix64(state) % (uint64_t)(max - min + 1));
+}
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+static void set_nodelay(int fd) {
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+}
+
+/**
+ * Zavre socket resetem (SO_LINGER s nulovym timeoutem posle RST)
+ */
+static void close_with_reset(int fd) {
+    struct linger linger = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    close(fd);
+}
+
+/* ============================================
+ * FRONTA SMERU
+ * ============================================ */
+
+static void direction_free(Direction *dir) {
+    free(dir->data);
+    free(dir->segments);
+    memset(dir, 0, sizeof(Direction));
+}
+
+static bool direction_push(Direction *dir, const char *data, size_t len, int64_t release_ms) {
+    /* Odeslany zacatek se zahodi az pred rozsirenim bufferu */
+    if (dir->head + dir->len + len > dir->capacity && dir->head > 0) {
+        memmove(dir->data, dir->data + dir->head, dir->len);
+        dir->head = 0;
+    }
+    if (dir->head + dir->len + len > dir->capacity) {
+        size_t capacity = dir->capacity ? dir->capacity : PROXY_READ_SIZE;
+        while (capacity < dir->len + len) capacity *= 2;
+        char *grown = realloc(dir->data, capacity);
+        if (grown == NULL) return false;
+        dir->data = grown;
+        dir->capacity = capacity;
+    }
+
+    if (dir->seg_count == dir->seg_capacity) {
+        int capacity = dir->seg_capacity ? dir->seg_capacity * 2 : 64;
+        Segment *grown = malloc(sizeof(Segment) * (size_t)capacity);
+        if (grown == NULL) return false;
+        for (int i = 0; i < dir->seg_count; i++) {
+            grown[i] = dir->segments[(dir->seg_head + i) % dir->seg_capacity];
+        }
+        free(dir->segments);
+        dir->segments = grown;
+        dir->seg_head = 0;
+        dir->seg_capacity = capacity;
+    }
+
+    memcpy(dir->data + dir->head + dir->len, data, len);
+    dir->len += len;
+
+    if (release_ms < dir->last_release) release_ms = dir->last_release;
+    dir->last_release = release_ms;
+    int tail = (dir->seg_head + dir->seg_count) % dir->seg_capacity;
+    dir->segments[tail].release_ms = release_ms;
+    dir->segments[tail].len = len;
+    dir->seg_count++;
+    return true;
+}
+
+static int64_t direction_next_release(const Direction *dir) {
+    return dir->seg_count > 0 ? dir->segments[dir->seg_head].release_ms : INT64_MAX;
+}
+
+/**
+ * Odesle nejvys jeden zraly kus - dalsi kusy jdou az v dalsich
+ * iteracich, aby je prijemce nedostal slite do jednoho recv()
+ * @return false pri chybe spojeni
+ */
+static bool direction_flush(Direction *dir, int fd, int64_t now) {
+    if (dir->seg_count == 0 || dir->segments[dir->seg_head].release_ms > now) return true;
+
+    Segment *seg = &dir->segments[dir->seg_head];
+    ssize_t sent = send(fd, dir->data + dir->head, seg->len, MSG_NOSIGNAL);
+    if (sent < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    dir->head += (size_t)sent;
+    dir->len -= (size_t)sent;
+    seg->len -= (size_t)sent;
+    if (seg->len == 0) {
+        dir->seg_head = (dir->seg_head + 1) % dir->seg_capacity;
+        dir->seg_count--;
+    }
+    if (dir->len == 0) dir->head = 0;
+    return true;
+}
+
+/**
+ * Zaradi prectena data - s danou sanci rozsekana na kusy po 1-2 bajtech
+ */
+static bool direction_enqueue(Direction *dir, const ProxyConfig *config, uint64_t *rng,
+                              ProxyStats *stats, const char *data, size_t len, int64_t now) {
+    int64_t release = now + config->delay_ms;
+    if (config->jitter_ms > 0) {
+        release += rng_range(rng, -config->jitter_ms, config->jitter_ms);
+    }
+
+    if (config->fragment_percent > 0 && rng_range(rng, 1, 100) <= config->fragment_percent) {
+        size_t offset = 0;
+        while (offset < len) {
+            size_t piece = (size_t)rng_range(rng, 1, 2);
+            if (piece > len - offset) piece = len - offset;
+            if (!direction_push(dir, data + offset, piece, release)) return false;
+            offset += piece;
+            stats->fragments++;
+            stats->segments++;
+        }
+        return true;
+    }
+
+    stats->segments++;
+    return direction_push(dir, data, len, release);
+}
+
+/* ============================================
+ * PROXY
+ * ============================================ */
+
+typedef struct {
+    ProxyConfig config;
+    ProxyStats stats;
+    uint64_t rng;
+    int listen_fd;
+    Pair *pairs;
+    struct pollfd *poll_fds;
+    int *poll_pairs;            /* Spojeni ke kazdemu zaznamu (-1 = listener) */
+} Proxy;
+
+static void pair_close(Pair *pair, bool reset) {
+    if (reset) {
+        close_with_reset(pair->client_fd);
+        close_with_reset(pair->server_fd);
+    } else {
+        close(pair->client_fd);
+        close(pair->server_fd);
+    }
+    direction_free(&pair->up);
+    direction_free(&pair->down);
+    pair->active = false;
+}
+
+static void accept_clients(Proxy *proxy) {
+    for (;;) {
+        int client_fd = accept(proxy->listen_fd, NULL, NULL);
+        if (client_fd < 0) return;
+
+        int slot = -1;
+        for (int i = 0; i < proxy->config.max_connections; i++) {
+            if (!proxy->pairs[i].active) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0 || !set_nonblocking(client_fd)) {
+            close(client_fd);
+            continue;
+        }
+
+        int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (server_fd < 0 || !set_nonblocking(server_fd)) {
+            if (server_fd >= 0) close(server_fd);
+            close(client_fd);
+            continue;
+        }
+        set_nodelay(client_fd);
+        set_nodelay(server_fd);
+
+        int rc = connect(server_fd, (const struct sockaddr *)&proxy->config.target,
+                         sizeof(proxy->config.target));
+        if (rc < 0 && errno != EINPROGRESS) {
+            proxy->stats.failed_connects++;
+            close(server_fd);
+            close_with_reset(client_fd);
+            continue;
+        }
+
+        Pair *pair = &proxy->pairs[slot];
+        memset(pair, 0, sizeof(Pair));
+        pair->active = true;
+        pair->connecting = rc < 0;
+        pair->client_fd = client_fd;
+        pair->server_fd = server_fd;
+        if (proxy->config.reset_percent > 0 &&
+            rng_range(&proxy->rng, 1, 100) <= proxy->config.reset_percent) {
+            pair->reset_at = now_ms() + rng_range(&proxy->rng, proxy->config.reset_min_ms,
+                                                  proxy->config.reset_max_ms);
+        }
+        proxy->stats.connections++;
+    }
+}
+
+/**
+ * Precte data ze zdroje smeru
+ * @return false pri chybe spojeni
+ */
+static bool pump_read(Proxy *proxy, Direction *dir, int fd, unsigned long long *bytes,
+                      int64_t now) {
+    char buffer[PROXY_READ_SIZE];
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (n == 0) {
+        dir->eof = true;
+        return true;
+    }
+    *bytes += (unsigned long long)n;
+    return direction_enqueue(dir, &proxy->config, &proxy->rng, &proxy->stats,
+                             buffer, (size_t)n, now);
+}
+
+/**
+ * Posle zrala data a po EOF zdroje a vyprazdneni fronty zavre cil pro zapis
+ * @return false pri chybe spojeni
+ */
+static bool pump_write(Direction *dir, int fd, int64_t now) {
+    if (!direction_flush(dir, fd, now)) return false;
+    if (dir->eof && dir->seg_count == 0 && !dir->shut) {
+        shutdown(fd, SHUT_WR);
+        dir->shut = true;
+    }
+    return true;
+}
+
+static short read_events(const Direction *dir) {
+    return (!dir->eof && dir->len < PROXY_QUEUE_LIMIT) ? POLLIN : 0;
+}
+
+static short write_events(const Direction *dir, int64_t now) {
+    return direction_next_release(dir) <= now ? POLLOUT : 0;
+}
+
+static int build_poll_set(Proxy *proxy, int64_t now, int64_t *wake) {
+    int nfds = 0;
+    proxy->poll_fds[nfds] = (struct pollfd){ proxy->listen_fd, POLLIN, 0 };
+    proxy->poll_pairs[nfds++] = -1;
+
+    for (int i = 0; i < proxy->config.max_connections; i++) {
+        Pair *pair = &proxy->pairs[i];
+        if (!pair->active) continue;
+
+        /* Zrale kusy hlida POLLOUT, casovac jen budouci */
+        int64_t up_release = direction_next_release(&pair->up);
+        int64_t down_release = direction_next_release(&pair->down);
+        if (pair->reset_at > 0 && pair->reset_at < *wake) *wake = pair->reset_at;
+        if (up_release > now && up_release < *wake) *wake = up_release;
+        if (down_release > now && down_release < *wake) *wake = down_release;
+
+        short client_events = read_events(&pair->up) | write_events(&pair->down, now);
+        short server_events = pair->connecting
+                              ? POLLOUT
+                              : (short)(read_events(&pair->down) | write_events(&pair->up, now));
+
+        /* Socket bez zajmu se nesleduje - POLLHUP po EOF by jinak budil smycku */
+        proxy->poll_fds[nfds] = (struct pollfd){ client_events ? pair->client_fd : -1,
+                                                 client_events, 0 };
+        proxy->poll_pairs[nfds++] = i;
+        proxy->poll_fds[nfds] = (struct pollfd){ server_events ? pair->server_fd : -1,
+                                                 server_events, 0 };
+        proxy->poll_pairs[nfds++] = i;
+    }
+    return nfds;
+}
+
+/**
+ * Obslouzi udalosti jednoho spojeni (oba sockety)
+ */
+static void service_pair(Proxy *proxy, Pair *pair, short client_revents, short server_revents,
+                         int64_t now) {
+    bool ok = true;
+
+    if (pair->connecting) {
+        if (server_revents == 0) return;
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(pair->server_fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        if (error != 0) {
+            proxy->stats.failed_connects++;
+            pair_close(pair, true);
+            return;
+        }
+        pair->connecting = false;
+        server_revents = 0;
+    }
+
+    if (client_revents & (POLLIN | POLLHUP | POLLERR)) {
+        ok = pump_read(proxy, &pair->up, pair->client_fd, &proxy->stats.bytes_up, now);
+    }
+    if (ok && (server_revents & (POLLIN | POLLHUP | POLLERR))) {
+        ok = pump_read(proxy, &pair->down, pair->server_fd, &proxy->stats.bytes_down, now);
+    }
+    if (ok && !pair->connecting) {
+        ok = pump_write(&pair->up, pair->server_fd, now) &&
+             pump_write(&pair->down, pair->client_fd, now);
+    }
+
+    /* Chyba nebo obe strany dorucene a zavrene */
+    if (!ok) {
+        pair_close(pair, true);
+    } else if (pair->up.shut && pair->down.shut) {
+        pair_close(pair, false);
+    }
+}
+
+static void print_stats(const Proxy *proxy) {
+    const ProxyStats *s = &proxy->stats;
+    printf("connections %llu (failed %llu), resets %llu\n",
+           s->connections, s->failed_connects, s->resets);
+    printf("bytes up %llu, down %llu; segments %llu (1-2 B fragments %llu)\n",
+           s->bytes_up, s->bytes_down, s->segments, s->fragments);
+}
+
+static int run(Proxy *proxy) {
+    int result = EXIT_SUCCESS;
+
+    while (!g_stop) {
+        int64_t now = now_ms();
+        int64_t wake = INT64_MAX;
+        int nfds = build_poll_set(proxy, now, &wake);
+
+        int timeout = -1;
+        if (wake != INT64_MAX) {
+            timeout = wake <= now ? 0 : (int)(wake - now);
+        }
+        if (poll(proxy->poll_fds, (nfds_t)nfds, timeout) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            result = EXIT_FAILURE;
+            break;
+        }
+
+        now = now_ms();
+        for (int i = 0; i < nfds; i++) {
+            int slot = proxy->poll_pairs[i];
+            if (slot < 0) {
+                if (proxy->poll_fds[i].revents & POLLIN) accept_clients(proxy);
+                continue;
+            }
+            /* Klient a server jednoho spojeni jsou v poli za sebou */
+            Pair *pair = &proxy->pairs[slot];
+            short client_revents = proxy->poll_fds[i].revents;
+            short server_revents = proxy->poll_fds[i + 1].revents;
+            i++;
+            if (!pair->active) continue;
+
+            if (pair->reset_at > 0 && now >= pair->reset_at) {
+                proxy->stats.resets++;
+                pair_close(pair, true);
+                continue;
+            }
+            service_pair(proxy, pair, client_revents, server_revents, now);
+        }
+    }
+
+    print_stats(proxy);
+    return result;
+}
+
+/* ============================================
+ * HLAVNI PROGRAM
+ * ============================================ */
+
+static bool parse_target(const char *text, struct sockaddr_in *target) {
+    char host[64];
+    const char *colon = strrchr(text, ':');
+    if (colon == NULL || (size_t)(colon - text) >= sizeof(host)) return false;
+
+    memcpy(host, text, (size_t)(colon - text));
+    host[colon - text] = '\0';
+    int port = atoi(colon + 1);
+    if (port <= 0 || port > 65535) return false;
+
+    memset(target, 0, sizeof(*target));
+    target->sin_family = AF_INET;
+    target->sin_port = htons((uint16_t)port);
+    return inet_pton(AF_INET, host, &target->sin_addr) == 1;
+}
+
+static int open_listener(const ProxyConfig *config) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)config->listen_port);
+    if (inet_pton(AF_INET, config->listen_address, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", config->listen_address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int optval = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0 ||
+        !set_nonblocking(fd)) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s -l PORT -t ADDRESS:PORT [options]\n", program);
+    fprintf(stderr, "  -a ADDRESS      Listen address (default: 127.0.0.1)\n");
+    fprintf(stderr, "  -l PORT         Listen port for clients\n");
+    fprintf(stderr, "  -t ADDRESS:PORT nim_server to forward to\n");
+    fprintf(stderr, "  -d MS           Delay of each chunk (default: 0)\n");
+    fprintf(stderr, "  -j MS           Uniform jitter +-MS (default: 0)\n");
+    fprintf(stderr, "  -f PERCENT      Chance a chunk is split into 1-2 byte sends (default: 0)\n");
+    fprintf(stderr, "  -r PERCENT      Chance a connection is reset (default: 0)\n");
+    fprintf(stderr, "  -w MIN-MAX      Reset window after connect in ms (default: 5000-15000)\n");
+    fprintf(stderr, "  -s SEED         Random seed (default: 1)\n");
+    fprintf(stderr, "  -c CONNECTIONS  Max proxied connections (default: 1024)\n");
+}
+
+int main(int argc, char *argv[]) {
+    Proxy proxy;
+    memset(&proxy, 0, sizeof(proxy));
+    ProxyConfig *config = &proxy.config;
+    snprintf(config->listen_address, sizeof(config->listen_address), "127.0.0.1");
+    config->reset_min_ms = 5000;
+    config->reset_max_ms = 15000;
+    config->max_connections = 1024;
+    config->seed = 1;
+    bool have_target = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:l:t:d:j:f:r:w:s:c:h")) != -1) {
+        switch (opt) {
+            case 'a':
+                snprintf(config->listen_address, sizeof(config->listen_address), "%s", optarg);
+                break;
+            case 'l': config->listen_port = atoi(optarg); break;
+            case 't': have_target = parse_target(optarg, &config->target); break;
+            case 'd': config->delay_ms = atoi(optarg); break;
+            case 'j': config->jitter_ms = atoi(optarg); break;
+            case 'f': config->fragment_percent = atoi(optarg); break;
+            case 'r': config->reset_percent = atoi(optarg); break;
+            case 'w':
+                if (sscanf(optarg, "%d-%d", &config->reset_min_ms, &config->reset_max_ms) != 2) {
+                    config->reset_min_ms = -1;
+                }
+                break;
+            case 's': config->seed = strtoull(optarg, NULL, 10); break;
+            case 'c': config->max_connections = atoi(optarg); break;
+            default:  usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    if (config->listen_port <= 0 || !have_target || config->delay_ms < 0 ||
+        config->jitter_ms < 0 || config->fragment_percent < 0 || config->fragment_percent > 100 ||
+        config->reset_percent < 0 || config->reset_percent > 100 || config->reset_min_ms < 0 ||
+        config->reset_max_ms < config->reset_min_ms || config->max_connections <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    proxy.rng = config->seed;
+    proxy.pairs = calloc((size_t)config->max_connections, sizeof(Pair));
+    proxy.poll_fds = calloc((size_t)config->max_connections * 2 + 1, sizeof(struct pollfd));
+    proxy.poll_pairs = calloc((size_t)config->max_connections * 2 + 1, sizeof(int));
+    if (proxy.pairs == NULL || proxy.poll_fds == NULL || proxy.poll_pairs == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    proxy.listen_fd = open_listener(config);
+    if (proxy.listen_fd < 0) return EXIT_FAILURE;
+
+    signal(SIGINT, stop_handler);
+    signal(SIGTERM, stop_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    char target[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &config->target.sin_addr, target, sizeof(target));
+    printf("nim_proxy %s:%d -> %s:%d (delay %d+-%d ms, fragment %d%%, reset %d%% in %d-%d ms)\n",
+           config->listen_address, config->listen_port, target, ntohs(config->target.sin_port),
+           config->delay_ms, config->jitter_ms, config->fragment_percent,
+           config->reset_percent, config->reset_min_ms, config->reset_max_ms);
+    fflush(stdout);
+
+    int result = run(&proxy);
+
+    for (int i = 0; i < config->max_connections; i++) {
+        if (proxy.pairs[i].active) pair_close(&proxy.pairs[i], false);
+    }
+    close(proxy.listen_fd);
+    free(proxy.pairs);
+    free(proxy.poll_fds);
+    free(proxy.poll_pairs);
+    return result;
+}
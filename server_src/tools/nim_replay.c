@@ -0,0 +1,461 @@
+/**
+ * @file nim_replay.c
+ * @brief Prehravani zurnalu hernich udalosti
+ *
+ * Bez parametru -g projde vsechny segmenty a vypise souhrnne statistiky
+ * (pocty udalosti, zpusoby ukonceni her, nejuspesnejsi hraci).
+ * S parametrem -g ID zrekonstruuje prubeh jedne hry a overi, ze pocty
+ * kaminku v zaznamech odpovidaji odehranym tahum.
+ *
+ * Pouziti: nim_replay [-g GAME_ID] [-t TOP] JOURNAL_DIR
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+
+/* ============================================
+ * SEGMENTY
+ * ============================================ */
+
+typedef struct {
+    const unsigned char *map;
+    size_t size;
+    unsigned int index;
+} Segment;
+
+static int compare_segments(const void *a, const void *b) {
+    unsigned int ia = ((const Segment *)a)->index;
+    unsigned int ib = ((const Segment *)b)->index;
+    return (ia > ib) - (ia < ib);
+}
+
+/**
+ * Namapuje vsechny segmenty v adresari, serazene podle cisla
+ * @return Pocet segmentu (-1 pri chybe)
+ */
+static int load_segments(const char *dir, Segment **out) {
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        perror(dir);
+        return -1;
+    }
+
+    int count = 0, capacity = 16;
+    Segment *segments = malloc(capacity * sizeof(Segment));
+    struct dirent *entry;
+
+    while (segments != NULL && (entry = readdir(d)) != NULL) {
+        unsigned int index;
+        char tail;
+        if (sscanf(entry->d_name, "journal-%u.n%c", &index, &tail) != 2) continue;
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) continue;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(JournalSegmentHeader)) {
+            close(fd);
+            continue;
+        }
+
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) continue;
+
+        const JournalSegmentHeader *header = map;
+        if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION) {
+            fprintf(stderr, "Skipping %s: not a journal segment\n", path);
+            munmap(map, (size_t)st.st_size);
+            continue;
+        }
+        posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+        if (count == capacity) {
+            capacity *= 2;
+            Segment *grown = realloc(segments, capacity * sizeof(Segment));
+            if (grown == NULL) break;
+            segments = grown;
+        }
+        segments[count].map = map;
+        segments[count].size = (size_t)st.st_size;
+        segments[count].index = index;
+        count++;
+    }
+    closedir(d);
+
+    if (segments == NULL) return -1;
+    qsort(segments, count, sizeof(Segment), compare_segments);
+    *out = segments;
+    return count;
+}
+
+/**
+ * Vrati dalsi platny zaznam segmentu nebo NULL na konci dat
+ */
+static const JournalRecord* next_record(const Segment *segment, size_t *offset) {
+    if (*offset + sizeof(JournalRecord) > segment->size) return NULL;
+
+    const JournalRecord *record = (const JournalRecord *)(segment->map + *offset);
+    if (record->size < sizeof(JournalRecord) || *offset + record->size > segment->size) {
+        return NULL;
+    }
+    *offset += record->size;
+    return record;
+}
+
+/* ============================================
+ * STATISTIKY HRACU
+ * ============================================ */
+
+typedef struct {
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    unsigned long games;
+    unsigned long wins;
+} PlayerStats;
+
+typedef struct {
+    PlayerStats *entries;
+    size_t capacity;            /* Mocnina dvou */
+    size_t count;
+} PlayerTable;
+
+static size_t hash_nickname(const char *s) {
+    size_t h = 1469598103934665603ULL;
+    while (*s) {
+        h = (h ^ (unsigned char)*s++) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static PlayerStats* player_lookup(PlayerTable *table, const char *nickname) {
+    if (table->count * 2 >= table->capacity) {
+        size_t old_capacity = table->capacity;
+        PlayerStats *old = table->entries;
+        table->capacity = old_capacity ? old_capacity * 2 : 1024;
+        table->entries = calloc(table->capacity, sizeof(PlayerStats));
+        if (table->entries == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        table->count = 0;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old[i].nickname[0] != '\0') {
+                *player_lookup(table, old[i].nickname) = old[i];
+            }
+        }
+        free(old);
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t i = hash_nickname(nickname) & mask;
+    while (table->entries[i].nickname[0] != '\0') {
+        if (strcmp(table->entries[i].nickname, nickname) == 0) {
+            return &table->entries[i];
+        }
+        i = (i + 1) & mask;
+    }
+
+    strncpy(table->entries[i].nickname, nickname, MAX_NICKNAME_LENGTH);
+    table->count++;
+    return &table->entries[i];
+}
+
+static int compare_wins(const void *a, const void *b) {
+    const PlayerStats *pa = a, *pb = b;
+    if (pa->wins != pb->wins) return pa->wins < pb->wins ? 1 : -1;
+    return strcmp(pa->nickname, pb->nickname);
+}
+
+/* ============================================
+ * REZIMY
+ * ============================================ */
+
+static const char* end_reason_name(int reason) {
+    switch (reason) {
+        case JOURNAL_END_NORMAL:     return "normal";
+        case JOURNAL_END_LEAVE:      return "leave";
+        case JOURNAL_END_DISCONNECT: return "disconnect";
+        case JOURNAL_END_TIMEOUT:    return "timeout";
+        case JOURNAL_END_ABANDONED:  return "abandoned";
+        case JOURNAL_END_CLOCK:      return "clock";
+        default:                     return "unknown";
+    }
+}
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/**
+ * Souhrnne statistiky pres cely zurnal
+ */
+static void aggregate(const Segment *segments, int count, int top) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    unsigned long per_type[8] = { 0 };
+    unsigned long end_reasons[8] = { 0 };
+    unsigned long events = 0, stones_taken = 0, first_mover_wins = 0, decided = 0;
+
+    /* Zaznam zacatku kazde hry podle ID (segmenty zustavaji namapovane) */
+    const JournalStartRecord **starts = NULL;
+    size_t starts_capacity = 0;
+    PlayerTable players = { NULL, 0, 0 };
+
+    for (int s = 0; s < count; s++) {
+        size_t offset = sizeof(JournalSegmentHeader);
+        const JournalRecord *record;
+
+        while ((record = next_record(&segments[s], &offset)) != NULL) {
+            events++;
+            per_type[record->type & 7]++;
+
+            switch (record->type) {
+                case JOURNAL_EV_GAME_START: {
+                    if (record->game_id >= starts_capacity) {
+                        size_t capacity = starts_capacity ? starts_capacity : 1024;
+                        while (capacity <= record->game_id) capacity *= 2;
+                        const JournalStartRecord **grown = realloc(starts, capacity * sizeof(*starts));
+                        if (grown == NULL) {
+                            fprintf(stderr, "Out of memory\n");
+                            exit(EXIT_FAILURE);
+                        }
+                        memset(grown + starts_capacity, 0, (capacity - starts_capacity) * sizeof(*starts));
+                        starts = grown;
+                        starts_capacity = capacity;
+                    }
+                    const JournalStartRecord *game = (const JournalStartRecord *)record;
+                    starts[record->game_id] = game;
+                    for (int i = 0; i < journal_start_players(game); i++) {
+                        player_lookup(&players, journal_start_nickname(game, i))->games++;
+                    }
+                    break;
+                }
+                case JOURNAL_EV_TAKE:
+                    stones_taken += JOURNAL_TAKE_COUNT(record->value);
+                    break;
+                case JOURNAL_EV_GAME_OVER:
+                    end_reasons[record->value & 7]++;
+                    if (record->actor != JOURNAL_NO_ACTOR) {
+                        decided++;
+                        if (record->actor == 0) first_mover_wins++;
+                        const JournalStartRecord *game = record->game_id < starts_capacity ?
+                                                         starts[record->game_id] : NULL;
+                        if (game != NULL && record->actor < journal_start_players(game)) {
+                            const char *winner = journal_start_nickname(game, record->actor);
+                            player_lookup(&players, winner)->wins++;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    double ms = elapsed_ms(&start);
+    unsigned long games = per_type[JOURNAL_EV_GAME_START];
+    unsigned long moves = per_type[JOURNAL_EV_TAKE] + per_type[JOURNAL_EV_SKIP];
+
+    printf("Segments:        %d\n", count);
+    printf("Events:          %lu\n", events);
+    printf("Games started:   %lu\n", games);
+    printf("Games finished:  %lu\n", per_type[JOURNAL_EV_GAME_OVER]);
+    for (int r = JOURNAL_END_NORMAL; r <= JOURNAL_END_CLOCK; r++) {
+        printf("  %-14s %lu\n", end_reason_name(r), end_reasons[r]);
+    }
+    printf("Moves:           %lu (TAKE %lu, SKIP %lu)\n",
+           moves, per_type[JOURNAL_EV_TAKE], per_type[JOURNAL_EV_SKIP]);
+    printf("Pauses/resumes:  %lu/%lu\n", per_type[JOURNAL_EV_PAUSE], per_type[JOURNAL_EV_RESUME]);
+    if (games > 0) {
+        printf("Moves per game:  %.2f\n", (double)moves / games);
+    }
+    printf("Stones taken:    %lu\n", stones_taken);
+    if (decided > 0) {
+        printf("First mover won: %.1f %%\n", 100.0 * first_mover_wins / decided);
+    }
+
+    if (top > 0 && players.count > 0) {
+        PlayerStats *list = malloc(players.count * sizeof(PlayerStats));
+        size_t n = 0;
+        for (size_t i = 0; list != NULL && i < players.capacity; i++) {
+            if (players.entries[i].nickname[0] != '\0') list[n++] = players.entries[i];
+        }
+        qsort(list, n, sizeof(PlayerStats), compare_wins);
+        printf("Top players:\n");
+        for (size_t i = 0; i < n && i < (size_t)top; i++) {
+            printf("  %-32s %lu wins / %lu games\n", list[i].nickname, list[i].wins, list[i].games);
+        }
+        free(list);
+    }
+
+    printf("Replayed in %.1f ms (%.1f M events/s)\n", ms,
+           ms > 0 ? events / ms / 1000.0 : 0.0);
+
+    free(starts);
+    free(players.entries);
+}
+
+/**
+ * Rekonstrukce jedne hry
+ * @return 0 pokud zaznamy odpovidaji pravidlum, jinak 1
+ */
+static int replay_game(const Segment *segments, int count, unsigned int game_id) {
+    const JournalStartRecord *game = NULL;
+    int stones = 0, errors = 0;
+    int piles[GAME_MAX_PILES] = { 0 };
+    int pile_count = 1;
+    bool found = false;
+
+    for (int s = 0; s < count; s++) {
+        size_t offset = sizeof(JournalSegmentHeader);
+        const JournalRecord *record;
+
+        while ((record = next_record(&segments[s], &offset)) != NULL) {
+            if (record->game_id != game_id) continue;
+
+            time_t ts = (time_t)record->timestamp;
+            char when[32];
+            strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&ts));
+            const char *actor = "-";
+            if (game != NULL && record->actor < journal_start_players(game)) {
+                actor = journal_start_nickname(game, record->actor);
+            }
+
+            switch (record->type) {
+                case JOURNAL_EV_GAME_START:
+                    game = (const JournalStartRecord *)record;
+                    stones = record->stones;
+                    found = true;
+                    printf("[%s] START room %d: %s vs %s, %d stones, take %u-%u, %u skips\n", when,
+                           game->room_id, game->nicknames[0], game->nicknames[1],
+                           stones, game->min_take, game->max_take, game->skips_per_player);
+                    if (journal_start_players(game) > JOURNAL_START_NICKNAMES) {
+                        printf("                      also:");
+                        for (int i = JOURNAL_START_NICKNAMES; i < journal_start_players(game); i++) {
+                            printf(" %s", journal_start_nickname(game, i));
+                        }
+                        printf("\n");
+                    }
+
+                    /* Hromadky maji jen novejsi (delsi) zaznamy */
+                    pile_count = 1;
+                    piles[0] = stones;
+                    if (record->size >= sizeof(JournalStartRecord) && game->pile_count > 1 &&
+                        game->pile_count <= GAME_MAX_PILES) {
+                        pile_count = game->pile_count;
+                        printf("                      piles:");
+                        for (int i = 0; i < pile_count; i++) {
+                            piles[i] = game->piles[i];
+                            printf(" %d", piles[i]);
+                        }
+                        printf("\n");
+                    }
+                    break;
+                case JOURNAL_EV_TAKE: {
+                    int pile = JOURNAL_TAKE_PILE(record->value);
+                    int taken = JOURNAL_TAKE_COUNT(record->value);
+                    stones -= taken;
+                    if (pile_count > 1) {
+                        printf("[%s] TAKE  %-16s %d from pile %d -> %u\n", when, actor, taken, pile,
+                               record->stones);
+                    } else {
+                        printf("[%s] TAKE  %-16s %d -> %u\n", when, actor, taken, record->stones);
+                    }
+                    if (pile >= pile_count || taken > piles[pile]) {
+                        printf("  !! invalid take from pile %d\n", pile);
+                        errors++;
+                    } else {
+                        piles[pile] -= taken;
+                    }
+                    break;
+                }
+                case JOURNAL_EV_SKIP:
+                    printf("[%s] SKIP  %-16s    -> %u\n", when, actor, record->stones);
+                    break;
+                case JOURNAL_EV_PAUSE:
+                    printf("[%s] PAUSE %s disconnected\n", when, actor);
+                    break;
+                case JOURNAL_EV_RESUME:
+                    printf("[%s] RESUME %s reconnected\n", when, actor);
+                    break;
+                case JOURNAL_EV_GAME_OVER:
+                    printf("[%s] OVER  winner: %s (%s)\n", when, actor, end_reason_name(record->value));
+                    break;
+                default:
+                    printf("[%s] unknown event type %u\n", when, record->type);
+                    break;
+            }
+
+            if (found && record->stones != stones) {
+                printf("  !! stones mismatch: replayed %d, recorded %u\n", stones, record->stones);
+                errors++;
+            }
+        }
+    }
+
+    if (!found) {
+        fprintf(stderr, "Game %u not found\n", game_id);
+        return 1;
+    }
+    printf(errors == 0 ? "Replay consistent\n" : "Replay found %d inconsistencies\n", errors);
+    return errors == 0 ? 0 : 1;
+}
+
+/* ============================================
+ * MAIN
+ * ============================================ */
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-g GAME_ID] [-t TOP] JOURNAL_DIR\n", program);
+    fprintf(stderr, "  -g GAME_ID  Replay a single game\n");
+    fprintf(stderr, "  -t TOP      Number of top players to list (default: 10)\n");
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int game_id = 0;
+    int top = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:t:h")) != -1) {
+        switch (opt) {
+            case 'g': game_id = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 't': top = atoi(optarg); break;
+            default:  usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Segment *segments = NULL;
+    int count = load_segments(argv[optind], &segments);
+    if (count < 0) return EXIT_FAILURE;
+
+    int result = EXIT_SUCCESS;
+    if (game_id > 0) {
+        result = replay_game(segments, count, game_id);
+    } else {
+        aggregate(segments, count, top);
+    }
+
+    for (int i = 0; i < count; i++) {
+        munmap((void *)segments[i].map, segments[i].size);
+    }
+    free(segments);
+    return result;
+}
@@ -0,0 +1,1229 @@
+/**
+ * @file nim_sim.c
+ * @brief Deterministicka simulace klientu nad skutecnou smyckou serveru
+ *
+ * Nahradi zdroj casu a sockety klientu (sysio.h) virtualnimi hodinami
+ * a spojenimi v pameti a pusti nezmeneny server_run(). Kdyz server ceka
+ * v poll() a zadne spojeni neni pripravene, virtualni cas skoci rovnou
+ * na dalsi krok skriptu nebo na konec timeoutu poll() - odpojeni,
+ * PING a reconnect timeouty tak probehnou bez cekani.
+ *
+ * Skriptovani klienti:
+ *   browse            LOGIN, LIST_ROOMS, LOGOUT
+ *   idle              po LOGIN ceka 14-25 s a odpovida na PING
+ *   silent            na PING neodpovi - server ho musi odpojit
+ *                     za PING_TIMEOUT az PING_TIMEOUT + 2 s
+ *   watch/handover    sleduje hru dvojice; pak simuluje upgrade, pri kterem
+ *                     jeho socket nedorazil - novy proces ho musi uvolnit
+ *                     a odebrat ze seznamu divaku (upgrade_release_orphans)
+ *   match/resume      dvojice ve hre, jeden vypadne a vrati se pres RESUME
+ *                     s ID pozadavku; ID smi nest jen odpoved, PING po navratu
+ *                     prijde bez nej
+ *   match/login-race  vypadly se hned vraci LOGIN na svou prezdivku
+ *                     (LOGIN_ERR), pak RESUME
+ *   match/half-open   RESUME, zatimco stare spojeni jeste nikdo nezavrel
+ *   match/late        RESUME az po SHORT_DISCONNECT_TIMEOUT (RESUME_ERR)
+ *
+ * Vse je odvozene ze seedu - stejny seed dava stejny prubeh i stejny
+ * kontrolni soucet prijatych zprav (session tokeny jsou z nej vynechany).
+ *
+ * Pred simulaci se porovnaji bajty vsech *_ERR odpovedi s formatem
+ * "NAZEV;kod;duvod\n" a prazdny radek od serveru je chyba.
+ *
+ * S -F zacinaji ID mistnosti jinde nez 0 (jako s registrem nebo shardy),
+ * takze se proveri i prevod ID na slot.
+ *
+ * Pouziti: nim_sim [-n CLIENTS] [-c SLOTS] [-s SEED] [-F FIRST_ROOM_ID] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "server.h"
+#include "upgrade.h"
+#include "logger.h"
+
+/** Cisla virtualnich spojeni (nad vsemi skutecnymi deskriptory) */
+#define SIM_FD_BASE (1 << 20)
+
+/** Pocatek virtualnich hodin (time_t) */
+#define SIM_EPOCH 1700000000
+
+/** Kroky skriptu se zaokrouhluji na tik - mene iteraci serveru */
+#define SIM_TICK_MS 10
+
+/** Klient, ktery do teto doby nedokonci scenar, se pocita jako chyba */
+#define SIM_WATCHDOG_MS 120000
+
+/** Kapacity bufferu spojeni (klient -> server, server -> klient) */
+#define SIM_IN_BUFFER  512
+#define SIM_OUT_BUFFER 2048
+
+/** Kolik chyb vypsat podrobne */
+#define SIM_REPORT_FAILURES 10
+
+/* ============================================
+ * VIRTUALNI SPOJENI
+ * ============================================ */
+
+typedef struct {
+    bool server_open;               /* Server ho jeste nezavrel */
+    bool client_open;               /* Klient ho jeste nezavrel */
+    bool dirty;                     /* Ceka na doruceni klientovi */
+    int client;                     /* Slot klienta */
+    size_t in_len;
+    size_t out_len;
+    char in[SIM_IN_BUFFER];         /* Klient -> server */
+    char out[SIM_OUT_BUFFER];       /* Server -> klient */
+} Conn;
+
+/* ============================================
+ * SKRIPTOVANI KLIENTI
+ * ============================================ */
+
+typedef enum {
+    ROLE_BROWSE,
+    ROLE_IDLE,
+    ROLE_SILENT,
+    ROLE_WATCH,
+    ROLE_RESUME,
+    ROLE_LOGIN_RACE,
+    ROLE_HALF_OPEN,
+    ROLE_LATE,
+    ROLE_COUNT
+} Role;
+
+static const char *const g_role_names[ROLE_COUNT] = {
+    "browse", "idle", "silent", "watch/handover",
+    "match/resume", "match/login-race", "match/half-open", "match/late"
+};
+
+typedef enum {
+    PHASE_LOGIN,        /* Ceka na LOGIN_OK */
+    PHASE_LOBBY,
+    PHASE_IN_GAME,
+    PHASE_WATCHING,
+    PHASE_DROPPED,      /* Vypadl, ceka na reconnect */
+    PHASE_RESUMING,     /* Nove spojeni, ceka na RESUME_OK / RESUME_ERR */
+    PHASE_RESUMED,
+    PHASE_LEAVING       /* Poslal LOGOUT, ceka na zavreni spojeni */
+} Phase;
+
+typedef struct {
+    bool active;
+    unsigned int gen;               /* Generace slotu (zneplatni stare udalosti) */
+    int id;                         /* Poradove cislo klienta */
+    Role role;
+    Phase phase;
+    uint64_t rng;
+    int conn;                       /* Aktualni spojeni (-1 = zadne) */
+    int stale_conn;                 /* half-open: puvodni spojeni (-1 = zadne) */
+    char nickname[MAX_NICKNAME_LENGTH + 1];
+    char token[SESSION_TOKEN_HEX_LENGTH + 1];
+    int peer;                       /* Slot protihrace (-1 = neni) */
+    unsigned int peer_gen;
+    int watcher;                    /* Hostitel: slot divaka (-1 = neni) */
+    unsigned int watcher_gen;
+    bool host;                      /* Zaklada mistnost */
+    bool dropper;                   /* Vypadne ze hry */
+    int room_id;                    /* Mistnost ke vstupu (-1 = zatim neni) */
+    int64_t ping_at;                /* Posledni PING (ms, -1 = nebyl) */
+    bool saw_disconnected;
+    bool saw_reconnected;
+    bool saw_game_over;
+    bool stale_closed;
+    bool failed;
+} Client;
+
+/* ============================================
+ * UDALOSTI (min-halda podle casu a poradi)
+ * ============================================ */
+
+typedef enum {
+    EV_START,           /* Pripojeni a LOGIN */
+    EV_LIST,            /* LIST_ROOMS */
+    EV_JOIN,            /* JOIN_ROOM, divak WATCH */
+    EV_DROP,            /* Vypadek spojeni ve hre */
+    EV_RECONNECT,       /* Nove spojeni po vypadku */
+    EV_HANDOVER,        /* Upgrade bez socketu divaka */
+    EV_LOGOUT,
+    EV_WATCHDOG
+} EventKind;
+
+typedef struct {
+    int64_t at;
+    uint64_t seq;
+    int client;
+    unsigned int gen;
+    EventKind kind;
+} Event;
+
+typedef struct {
+    Event *items;
+    int count;
+    int capacity;
+    uint64_t next_seq;
+} EventHeap;
+
+/* ============================================
+ * STAV SIMULACE
+ * ============================================ */
+
+typedef struct {
+    int total;                      /* Klientu celkem (-n) */
+    int population;                 /* Nejvys soucasne bezicich klientu */
+    uint64_t seed;
+    uint64_t rng;                   /* Volba scenaru */
+
+    int64_t now_ms;                 /* Virtualni cas */
+    Server *server;
+
+    Conn *conns;
+    int conn_count;
+    int *free_conns;                /* Zasobnik volnych spojeni */
+    int free_conn_count;
+    int *accept_queue;              /* Spojeni cekajici na accept (kruhova fronta) */
+    int accept_head;
+    int accept_len;
+    int *dirty;                     /* Spojeni s daty nebo EOF pro klienta */
+    int dirty_count;
+    int *delivering;                /* Kopie seznamu pri doruceni */
+
+    Client *clients;
+    int *free_clients;
+    int free_client_count;
+    int spawned;                    /* Zalozenych klientu */
+    int running;                    /* Prave bezicich klientu */
+    EventHeap events;
+
+    unsigned long polls;
+    uint64_t trace;                 /* Kontrolni soucet prijatych zprav */
+    int runs[ROLE_COUNT];
+    int failures[ROLE_COUNT];
+    int reported;
+} Sim;
+
+static Sim g_sim;
+
+/* ============================================
+ * POMOCNE FUNKCE
+ * ============================================ */
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** Nahodne cislo z <min, max> */
+static int64_t rng_range(uint64_t *state, int64_t min, int64_t max) {
+    return min + (int64_t)(splitmix64(state) % (uint64_t)(max - min + 1));
+}
+
+/** FNV-1a pres prijate zpravy */
+static void trace_mix(const void *data, size_t len) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        g_sim.trace ^= bytes[i];
+        g_sim.trace *= 1099511628211ULL;
+    }
+}
+
+static void *xmalloc(size_t size) {
+    void *ptr = calloc(1, size);
+    if (ptr == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static void fail(Client *c, const char *reason, const char *detail) {
+    if (c->failed) return;
+    c->failed = true;
+    if (g_sim.reported++ < SIM_REPORT_FAILURES) {
+        fprintf(stderr, "FAIL %s #%d (%s) at %.2f s: %s%s%s\n", g_role_names[c->role], c->id,
+                c->nickname, g_sim.now_ms / 1000.0, reason,
+                detail != NULL ? ": " : "", detail != NULL ? detail : "");
+    }
+}
+
+static bool starts_with(const char *line, const char *prefix) {
+    return strncmp(line, prefix, strlen(prefix)) == 0;
+}
+
+/* ============================================
+ * UDALOSTI
+ * ============================================ */
+
+static bool event_before(const Event *a, const Event *b) {
+    return a->at < b->at || (a->at == b->at && a->seq < b->seq);
+}
+
+static void schedule(Client *c, EventKind kind, int64_t delay_ms) {
+    EventHeap *heap = &g_sim.events;
+    if (heap->count == heap->capacity) {
+        heap->capacity = heap->capacity ? heap->capacity * 2 : 4096;
+        heap->items = realloc(heap->items, sizeof(Event) * (size_t)heap->capacity);
+        if (heap->items == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int64_t at = g_sim.now_ms + delay_ms;
+    Event ev = {
+        .at = (at + SIM_TICK_MS - 1) / SIM_TICK_MS * SIM_TICK_MS,
+        .seq = heap->next_seq++,
+        .client = (int)(c - g_sim.clients),
+        .gen = c->gen,
+        .kind = kind
+    };
+
+    int i = heap->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (event_before(&heap->items[parent], &ev)) break;
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->items[i] = ev;
+}
+
+static Event pop_event(void) {
+    EventHeap *heap = &g_sim.events;
+    Event top = heap->items[0];
+    Event last = heap->items[--heap->count];
+
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && event_before(&heap->items[child + 1], &heap->items[child])) {
+            child++;
+        }
+        if (event_before(&last, &heap->items[child])) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->items[i] = last;
+    return top;
+}
+
+/* ============================================
+ * SPOJENI - STRANA KLIENTA
+ * ============================================ */
+
+static Conn* conn_of_fd(int fd) {
+    int index = fd - SIM_FD_BASE;
+    if (index < 0 || index >= g_sim.conn_count) return NULL;
+    Conn *conn = &g_sim.conns[index];
+    return conn->server_open ? conn : NULL;
+}
+
+static void mark_dirty(Conn *conn) {
+    if (!conn->dirty) {
+        conn->dirty = true;
+        g_sim.dirty[g_sim.dirty_count++] = (int)(conn - g_sim.conns);
+    }
+}
+
+/**
+ * Vrati spojeni mezi volna, az ho zavrou obe strany a nic uz neceka
+ */
+static void conn_release_if_done(int index) {
+    Conn *conn = &g_sim.conns[index];
+    if (!conn->server_open && !conn->client_open && !conn->dirty && conn->client >= 0) {
+        conn->client = -1;
+        g_sim.free_conns[g_sim.free_conn_count++] = index;
+    }
+}
+
+/**
+ * Klient otevre spojeni - zaradi se do fronty accept serveru
+ */
+static int client_connect(Client *c) {
+    if (g_sim.free_conn_count == 0) {
+        fprintf(stderr, "nim_sim: out of connections\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int index = g_sim.free_conns[--g_sim.free_conn_count];
+    Conn *conn = &g_sim.conns[index];
+    conn->server_open = true;
+    conn->client_open = true;
+    conn->dirty = false;
+    conn->client = (int)(c - g_sim.clients);
+    conn->in_len = 0;
+    conn->out_len = 0;
+
+    int tail = (g_sim.accept_head + g_sim.accept_len) % g_sim.conn_count;
+    g_sim.accept_queue[tail] = index;
+    g_sim.accept_len++;
+    return index;
+}
+
+static void conn_append(Client *c, int index, const char *line) {
+    Conn *conn = &g_sim.conns[index];
+    size_t len = strlen(line);
+    if (conn->in_len + len + 1 > sizeof(conn->in)) {
+        fail(c, "send buffer full", line);
+        return;
+    }
+    memcpy(conn->in + conn->in_len, line, len);
+    conn->in[conn->in_len + len] = '\n';
+    conn->in_len += len + 1;
+}
+
+static void client_send(Client *c, const char *line) {
+    conn_append(c, c->conn, line);
+}
+
+static void client_close(int index) {
+    Conn *conn = &g_sim.conns[index];
+    conn->client_open = false;
+    conn->out_len = 0;
+    conn_release_if_done(index);
+}
+
+/* ============================================
+ * SCENARE
+ * ============================================ */
+
+static void spawn_more(void);
+
+static void client_finish(Client *c) {
+    if (c->conn >= 0) client_close(c->conn);
+    if (c->stale_conn >= 0) client_close(c->stale_conn);
+    c->conn = -1;
+    c->stale_conn = -1;
+
+    g_sim.runs[c->role]++;
+    if (c->failed) g_sim.failures[c->role]++;
+    c->active = false;
+    c->gen++;
+    g_sim.running--;
+    g_sim.free_clients[g_sim.free_client_count++] = (int)(c - g_sim.clients);
+
+    spawn_more();
+}
+
+static Client* peer_of(const Client *c) {
+    if (c->peer < 0) return NULL;
+    Client *peer = &g_sim.clients[c->peer];
+    return (peer->active && peer->gen == c->peer_gen) ? peer : NULL;
+}
+
+static Client* watcher_of(const Client *c) {
+    if (c->watcher < 0) return NULL;
+    Client *watcher = &g_sim.clients[c->watcher];
+    return (watcher->active && watcher->gen == c->watcher_gen) ? watcher : NULL;
+}
+
+/**
+ * Upgrade, pri kterem socket divaka nedorazil: spojeni zustalo ve starem
+ * procesu (klient uvidi EOF) a novy proces musi hrace uvolnit
+ */
+static void handover_lose_socket(Client *c) {
+    Server *server = g_sim.server;
+    Player *player = player_find_by_nickname(server->players, server->config.max_clients,
+                                             c->nickname);
+    if (player == NULL || player->socket_fd != SIM_FD_BASE + c->conn) {
+        fail(c, "watching player not found", NULL);
+        return;
+    }
+
+    int index = (int)(player - server->players);
+    int watched = player->watch_room_id;
+    int slot = room_id_to_slot(watched);
+
+    Conn *conn = &g_sim.conns[c->conn];
+    conn->server_open = false;
+    conn->in_len = 0;
+    mark_dirty(conn);
+    player->socket_fd = -1;
+    c->phase = PHASE_LEAVING;
+
+    upgrade_release_orphans(server);
+
+    if (player->is_active || player->watch_room_id >= 0) {
+        fail(c, "orphan not released after handover", NULL);
+    }
+    if (watched >= 0 && slot >= 0 && slot < server->config.max_rooms) {
+        for (int s = server->rooms[slot].spectator_head; s >= 0;
+             s = server->players[s].next_spectator) {
+            if (s == index) {
+                fail(c, "orphan left in spectator list", NULL);
+                break;
+            }
+        }
+    }
+}
+
+static bool is_match(const Client *c) {
+    return c->role >= ROLE_RESUME;
+}
+
+/**
+ * Vyhodnoti hrace dvojice pri odchodu
+ */
+static void check_match(Client *c) {
+    if (c->dropper) {
+        if (c->role == ROLE_HALF_OPEN && !c->stale_closed) {
+            fail(c, "stale connection not closed by RESUME", NULL);
+        }
+        return;
+    }
+
+    bool want_disconnected = c->role != ROLE_HALF_OPEN;
+    bool want_reconnected = c->role != ROLE_LATE;
+    if (c->saw_disconnected != want_disconnected) {
+        fail(c, want_disconnected ? "missing PLAYER_STATUS DISCONNECTED"
+                                  : "unexpected PLAYER_STATUS DISCONNECTED", NULL);
+    }
+    if (c->saw_reconnected != want_reconnected) {
+        fail(c, want_reconnected ? "missing PLAYER_STATUS RECONNECTED"
+                                 : "unexpected PLAYER_STATUS RECONNECTED", NULL);
+    }
+    if (!c->saw_game_over) {
+        fail(c, "missing GAME_OVER", NULL);
+    }
+}
+
+static void on_login(Client *c) {
+    char line[64];
+
+    switch (c->role) {
+        case ROLE_BROWSE:
+            schedule(c, EV_LIST, rng_range(&c->rng, 50, 500));
+            break;
+        case ROLE_IDLE:
+            schedule(c, EV_LOGOUT, rng_range(&c->rng, 14000, 25000));
+            break;
+        case ROLE_SILENT:
+            break;
+        case ROLE_WATCH:
+            if (c->room_id >= 0) {
+                schedule(c, EV_JOIN, rng_range(&c->rng, 10, 200));
+            }
+            break;
+        default:
+            if (c->host) {
+                snprintf(line, sizeof(line), "CREATE_ROOM;m%d", c->id);
+                client_send(c, line);
+            } else if (c->room_id >= 0) {
+                schedule(c, EV_JOIN, rng_range(&c->rng, 10, 200));
+            }
+            break;
+    }
+}
+
+/**
+ * Spojeni zavrel server (klient uz precetl vsechna data)
+ */
+static void on_closed(Client *c, int index) {
+    if (index == c->stale_conn) {
+        c->stale_closed = true;
+        c->stale_conn = -1;
+        client_close(index);
+        return;
+    }
+
+    if (c->role == ROLE_SILENT) {
+        int64_t after = c->ping_at >= 0 ? g_sim.now_ms - c->ping_at : -1;
+        if (after < PING_TIMEOUT * 1000 || after > (PING_TIMEOUT + 2) * 1000) {
+            char detail[64];
+            snprintf(detail, sizeof(detail), "%lld ms after PING", (long long)after);
+            fail(c, "PONG timeout out of range", c->ping_at >= 0 ? detail : "no PING");
+        }
+    } else if (c->phase != PHASE_LEAVING) {
+        fail(c, "connection closed by server", NULL);
+    } else if (c->role == ROLE_IDLE && c->ping_at < 0) {
+        fail(c, "no PING while idle", NULL);
+    } else if (is_match(c)) {
+        check_match(c);
+    }
+    client_finish(c);
+}
+
+static void on_line(Client *c, int index, const char *line) {
+    char reply[96];
+
+    /* Session token se meni beh od behu */
+    trace_mix(&c->id, sizeof(c->id));
+    if (starts_with(line, "LOGIN_OK;")) {
+        trace_mix("LOGIN_OK", 8);
+    } else {
+        trace_mix(line, strlen(line));
+    }
+
+    /* Kazda zprava konci prave jednim \n - prazdny radek je chyba formatu */
+    if (line[0] == '\0') {
+        fail(c, "empty line from server", NULL);
+        return;
+    }
+
+    /* ID pozadavku nese jen odpoved na RESUME (RESUME_OK, GAME_RESUMED) */
+    bool tagged = false;
+    if (line[0] == '#') {
+        const char *message = strchr(line, ';');
+        if (c->role != ROLE_RESUME || message == NULL ||
+            !(starts_with(message + 1, "RESUME_OK;") || starts_with(message + 1, "GAME_RESUMED;"))) {
+            fail(c, "unexpected request ID", line);
+            return;
+        }
+        line = message + 1;
+        tagged = true;
+    }
+
+    if (strcmp(line, "PING") == 0) {
+        c->ping_at = g_sim.now_ms;
+        if (c->role != ROLE_SILENT) {
+            conn_append(c, index, "PONG");
+        }
+        /* match/resume odchazi az po PING, ktery prisel bez ID */
+        if (c->role == ROLE_RESUME && c->phase == PHASE_RESUMED && index == c->conn) {
+            schedule(c, EV_LOGOUT, rng_range(&c->rng, 10, 300));
+        }
+        return;
+    }
+
+    /* Stare spojeni half-open klienta uz jen ceka na zavreni */
+    if (index == c->stale_conn) return;
+
+    if (starts_with(line, "LOGIN_OK;")) {
+        if (c->phase != PHASE_LOGIN) {
+            fail(c, "unexpected", line);
+            return;
+        }
+        snprintf(c->token, sizeof(c->token), "%s", line + strlen("LOGIN_OK;"));
+        if (c->token[0] == '\0') fail(c, "no session token", NULL);
+        c->phase = PHASE_LOBBY;
+        on_login(c);
+    } else if (starts_with(line, "LOGIN_ERR;")) {
+        /* Prezdivku drzi odpojeny hrac - zpet jen pres RESUME */
+        if (c->role == ROLE_LOGIN_RACE && c->phase == PHASE_RESUMING &&
+            starts_with(line, "LOGIN_ERR;6")) {
+            snprintf(reply, sizeof(reply), "RESUME;%s", c->token);
+            client_send(c, reply);
+        } else {
+            fail(c, "unexpected", line);
+            client_finish(c);
+        }
+    } else if (starts_with(line, "ROOMS;")) {
+        if (c->role == ROLE_BROWSE) {
+            schedule(c, EV_LOGOUT, rng_range(&c->rng, 50, 500));
+        }
+    } else if (starts_with(line, "ROOM_CREATED;")) {
+        Client *guest = peer_of(c);
+        if (guest != NULL) {
+            guest->room_id = atoi(line + strlen("ROOM_CREATED;"));
+            if (guest->phase == PHASE_LOBBY) {
+                schedule(guest, EV_JOIN, rng_range(&guest->rng, 10, 200));
+            }
+        }
+        Client *watcher = watcher_of(c);
+        if (watcher != NULL) {
+            watcher->room_id = atoi(line + strlen("ROOM_CREATED;"));
+            if (watcher->phase == PHASE_LOBBY) {
+                schedule(watcher, EV_JOIN, rng_range(&watcher->rng, 10, 200));
+            }
+        }
+    } else if (starts_with(line, "WATCH_OK;")) {
+        if (c->role != ROLE_WATCH || c->phase != PHASE_LOBBY) return;
+        c->phase = PHASE_WATCHING;
+        schedule(c, EV_HANDOVER, rng_range(&c->rng, 10, 500));
+    } else if (starts_with(line, "GAME_START;")) {
+        c->phase = PHASE_IN_GAME;
+        if (c->dropper) {
+            schedule(c, EV_DROP, rng_range(&c->rng, 100, 2000));
+        }
+    } else if (starts_with(line, "PLAYER_STATUS;")) {
+        const char *status = strrchr(line, ';');
+        if (strcmp(status, ";DISCONNECTED") == 0) {
+            c->saw_disconnected = true;
+        } else if (strcmp(status, ";RECONNECTED") == 0) {
+            c->saw_reconnected = true;
+        }
+    } else if (starts_with(line, "GAME_OVER;")) {
+        if (!c->dropper && c->phase == PHASE_IN_GAME) {
+            c->saw_game_over = true;
+            schedule(c, EV_LOGOUT, rng_range(&c->rng, 10, 300));
+        }
+    } else if (starts_with(line, "RESUME_OK;")) {
+        if (c->role == ROLE_LATE) {
+            fail(c, "session resumed after SHORT_DISCONNECT_TIMEOUT", NULL);
+        }
+        c->phase = PHASE_RESUMED;
+        if (c->role != ROLE_RESUME) {
+            schedule(c, EV_LOGOUT, rng_range(&c->rng, 100, 1000));
+        } else if (!tagged) {
+            fail(c, "RESUME_OK without request ID", NULL);
+        }
+    } else if (starts_with(line, "RESUME_ERR;")) {
+        if (c->role != ROLE_LATE || !starts_with(line, "RESUME_ERR;20")) {
+            fail(c, "unexpected", line);
+        }
+        client_finish(c);
+    } else if (starts_with(line, "ROOM_ERR;") || starts_with(line, "WATCH_ERR;") ||
+               starts_with(line, "ERROR;")) {
+        fail(c, "unexpected", line);
+        client_finish(c);
+    }
+}
+
+static void on_event(Client *c, EventKind kind) {
+    char line[96];
+
+    switch (kind) {
+        case EV_START:
+            c->conn = client_connect(c);
+            snprintf(line, sizeof(line), "LOGIN;%s", c->nickname);
+            client_send(c, line);
+            schedule(c, EV_WATCHDOG, SIM_WATCHDOG_MS);
+            break;
+
+        case EV_LIST:
+            client_send(c, "LIST_ROOMS");
+            break;
+
+        case EV_JOIN:
+            snprintf(line, sizeof(line), c->role == ROLE_WATCH ? "WATCH;%d" : "JOIN_ROOM;%d",
+                     c->room_id);
+            client_send(c, line);
+            break;
+
+        case EV_HANDOVER:
+            if (c->phase == PHASE_WATCHING) handover_lose_socket(c);
+            break;
+
+        case EV_DROP:
+            if (c->phase != PHASE_IN_GAME) break;
+            if (c->role == ROLE_HALF_OPEN) {
+                /* Stare spojeni zustava otevrene, server o vypadku nevi */
+                c->stale_conn = c->conn;
+                c->conn = client_connect(c);
+                c->phase = PHASE_RESUMING;
+                snprintf(line, sizeof(line), "RESUME;%s", c->token);
+                client_send(c, line);
+                break;
+            }
+            client_close(c->conn);
+            c->conn = -1;
+            c->phase = PHASE_DROPPED;
+            if (c->role == ROLE_LATE) {
+                schedule(c, EV_RECONNECT, rng_range(&c->rng, (SHORT_DISCONNECT_TIMEOUT + 2) * 1000,
+                                                    (SHORT_DISCONNECT_TIMEOUT + 5) * 1000));
+            } else if (c->role == ROLE_LOGIN_RACE) {
+                /* Novy LOGIN muze prijit v teze iteraci jako EOF stareho spojeni */
+                schedule(c, EV_RECONNECT, rng_range(&c->rng, 0, 50));
+            } else {
+                schedule(c, EV_RECONNECT, rng_range(&c->rng, 200,
+                                                    (SHORT_DISCONNECT_TIMEOUT - 5) * 1000));
+            }
+            break;
+
+        case EV_RECONNECT:
+            c->conn = client_connect(c);
+            c->phase = PHASE_RESUMING;
+            if (c->role == ROLE_LOGIN_RACE) {
+                snprintf(line, sizeof(line), "LOGIN;%s", c->nickname);
+            } else if (c->role == ROLE_RESUME) {
+                snprintf(line, sizeof(line), "#r%d;RESUME;%s", c->id, c->token);
+            } else {
+                snprintf(line, sizeof(line), "RESUME;%s", c->token);
+            }
+            client_send(c, line);
+            break;
+
+        case EV_LOGOUT:
+            if (c->conn < 0) break;
+            client_send(c, "LOGOUT");
+            c->phase = PHASE_LEAVING;
+            break;
+
+        case EV_WATCHDOG: {
+            char detail[32];
+            snprintf(detail, sizeof(detail), "phase %d", (int)c->phase);
+            fail(c, "scenario did not finish", detail);
+            client_finish(c);
+            break;
+        }
+    }
+}
+
+/* ============================================
+ * ZAKLADANI KLIENTU
+ * ============================================ */
+
+static Client* new_client(Role role, int64_t start_delay) {
+    int slot = g_sim.free_clients[--g_sim.free_client_count];
+    Client *c = &g_sim.clients[slot];
+    unsigned int gen = c->gen;
+
+    memset(c, 0, sizeof(Client));
+    c->active = true;
+    c->gen = gen;
+    c->id = g_sim.spawned++;
+    c->role = role;
+    c->phase = PHASE_LOGIN;
+    c->rng = g_sim.seed ^ ((uint64_t)c->id * 0xD1B54A32D192ED03ULL);
+    c->conn = -1;
+    c->stale_conn = -1;
+    c->peer = -1;
+    c->watcher = -1;
+    c->room_id = -1;
+    c->ping_at = -1;
+    snprintf(c->nickname, sizeof(c->nickname), "sim%d", c->id);
+    g_sim.running++;
+
+    schedule(c, EV_START, start_delay);
+    return c;
+}
+
+/**
+ * Doplni bezici klienty do populace (dvojice ve hre s divakem zabira tri mista)
+ */
+static void spawn_more(void) {
+    int64_t window = g_sim.now_ms == 0 ? 1000 : 200;
+
+    while (g_sim.spawned < g_sim.total && g_sim.running + 3 <= g_sim.population) {
+        int64_t pick = rng_range(&g_sim.rng, 0, 99);
+        int64_t delay = rng_range(&g_sim.rng, 0, window);
+
+        if (pick < 45 && g_sim.total - g_sim.spawned >= 2) {
+            Role role = (Role)(ROLE_RESUME + rng_range(&g_sim.rng, 0, 3));
+            bool host_drops = rng_range(&g_sim.rng, 0, 1) == 0;
+            Client *host = new_client(role, delay);
+            Client *guest = new_client(role, delay + rng_range(&g_sim.rng, 0, 100));
+            host->host = true;
+            host->dropper = host_drops;
+            guest->dropper = !host_drops;
+            host->peer = (int)(guest - g_sim.clients);
+            host->peer_gen = guest->gen;
+            guest->peer = (int)(host - g_sim.clients);
+            guest->peer_gen = host->gen;
+
+            /* Kazda ctvrta hra ma divaka */
+            if (rng_range(&g_sim.rng, 0, 3) == 0 && g_sim.spawned < g_sim.total) {
+                Client *watcher = new_client(ROLE_WATCH, delay + rng_range(&g_sim.rng, 0, 100));
+                host->watcher = (int)(watcher - g_sim.clients);
+                host->watcher_gen = watcher->gen;
+            }
+        } else if (pick < 75) {
+            new_client(ROLE_BROWSE, delay);
+        } else if (pick < 90) {
+            new_client(ROLE_IDLE, delay);
+        } else {
+            new_client(ROLE_SILENT, delay);
+        }
+    }
+}
+
+/* ============================================
+ * DORUCOVANI A UDALOSTI
+ * ============================================ */
+
+/**
+ * Preda klientum data (po radcich) a zavreni spojeni od serveru
+ */
+static void deliver(void) {
+    while (g_sim.dirty_count > 0) {
+        int count = g_sim.dirty_count;
+        memcpy(g_sim.delivering, g_sim.dirty, sizeof(int) * (size_t)count);
+        g_sim.dirty_count = 0;
+
+        for (int i = 0; i < count; i++) {
+            int index = g_sim.delivering[i];
+            Conn *conn = &g_sim.conns[index];
+            conn->dirty = false;
+
+            if (conn->client_open) {
+                Client *c = &g_sim.clients[conn->client];
+                size_t start = 0;
+                while (conn->client_open && start < conn->out_len) {
+                    char *end = memchr(conn->out + start, '\n', conn->out_len - start);
+                    if (end == NULL) break;
+                    *end = '\0';
+                    on_line(c, index, conn->out + start);
+                    start = (size_t)(end - conn->out) + 1;
+                }
+                if (conn->client_open) {
+                    memmove(conn->out, conn->out + start, conn->out_len - start);
+                    conn->out_len -= start;
+                    if (!conn->server_open && conn->out_len == 0) {
+                        on_closed(c, index);
+                    }
+                }
+            }
+            conn_release_if_done(index);
+        }
+    }
+}
+
+static void run_due_events(void) {
+    while (g_sim.events.count > 0 && g_sim.events.items[0].at <= g_sim.now_ms) {
+        Event ev = pop_event();
+        Client *c = &g_sim.clients[ev.client];
+        if (c->active && c->gen == ev.gen) {
+            on_event(c, ev.kind);
+        }
+    }
+}
+
+/* ============================================
+ * OPERACE SYSIO
+ * ============================================ */
+
+static time_t sim_time_now(void) {
+    return (time_t)(SIM_EPOCH + g_sim.now_ms / 1000);
+}
+
+static int64_t sim_monotonic_ms(void) {
+    return g_sim.now_ms;
+}
+
+static short conn_revents(const struct pollfd *pfd) {
+    short revents = 0;
+    Conn *conn = conn_of_fd(pfd->fd);
+
+    if (conn != NULL) {
+        if ((pfd->events & POLLIN) && (conn->in_len > 0 || !conn->client_open)) {
+            revents |= POLLIN;
+        }
+        if ((pfd->events & POLLOUT) && conn->out_len < sizeof(conn->out)) {
+            revents |= POLLOUT;
+        }
+    } else if (pfd->fd == g_sim.server->listen_fd && (pfd->events & POLLIN) &&
+               g_sim.accept_len > 0) {
+        revents = POLLIN;
+    }
+    return revents;
+}
+
+/**
+ * Virtualni poll - kdyz neni nic pripraveno, posune cas na dalsi krok
+ * skriptu nebo na konec timeoutu
+ */
+static int sim_poll(struct pollfd *fds, nfds_t count, int timeout_ms) {
+    int64_t deadline = timeout_ms < 0 ? INT64_MAX : g_sim.now_ms + timeout_ms;
+    g_sim.polls++;
+
+    for (;;) {
+        deliver();
+        run_due_events();
+
+        int ready = 0;
+        for (nfds_t i = 0; i < count; i++) {
+            fds[i].revents = conn_revents(&fds[i]);
+            if (fds[i].revents != 0) ready++;
+        }
+        if (ready > 0) return ready;
+
+        if (g_sim.spawned == g_sim.total && g_sim.running == 0) {
+            server_request_shutdown();
+            return 0;
+        }
+
+        int64_t next = g_sim.events.count > 0 ? g_sim.events.items[0].at : INT64_MAX;
+        if (deadline <= next) {
+            if (deadline > g_sim.now_ms) g_sim.now_ms = deadline;
+            return 0;
+        }
+        g_sim.now_ms = next;
+    }
+}
+
+static int sim_accept(int listen_fd, struct sockaddr_storage *addr) {
+    (void)listen_fd;
+    if (g_sim.accept_len == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    int index = g_sim.accept_queue[g_sim.accept_head];
+    g_sim.accept_head = (g_sim.accept_head + 1) % g_sim.conn_count;
+    g_sim.accept_len--;
+
+    struct sockaddr_in *in = (struct sockaddr_in *)addr;
+    memset(addr, 0, sizeof(*addr));
+    in->sin_family = AF_INET;
+    in->sin_port = htons((uint16_t)(40000 + index % 20000));
+    in->sin_addr.s_addr = htonl(0x0A000000u | (uint32_t)index);
+    return SIM_FD_BASE + index;
+}
+
+static ssize_t sim_recv(int fd, void *buffer, size_t len) {
+    Conn *conn = conn_of_fd(fd);
+    if (conn == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    if (conn->in_len == 0) {
+        if (!conn->client_open) return 0;
+        errno = EAGAIN;
+        return -1;
+    }
+
+    size_t n = conn->in_len < len ? conn->in_len : len;
+    memcpy(buffer, conn->in, n);
+    memmove(conn->in, conn->in + n, conn->in_len - n);
+    conn->in_len -= n;
+    return (ssize_t)n;
+}
+
+static ssize_t sim_writev(int fd, const struct iovec *iov, int count) {
+    Conn *conn = conn_of_fd(fd);
+    if (conn == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    if (!conn->client_open) {
+        errno = EPIPE;
+        return -1;
+    }
+
+    size_t written = 0;
+    for (int i = 0; i < count; i++) {
+        size_t room = sizeof(conn->out) - conn->out_len;
+        size_t n = iov[i].iov_len < room ? iov[i].iov_len : room;
+        memcpy(conn->out + conn->out_len, iov[i].iov_base, n);
+        conn->out_len += n;
+        written += n;
+        if (n < iov[i].iov_len) break;
+    }
+    if (written == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    mark_dirty(conn);
+    return (ssize_t)written;
+}
+
+static ssize_t sim_send(int fd, const void *data, size_t len) {
+    struct iovec iov = { (void *)data, len };
+    return sim_writev(fd, &iov, 1);
+}
+
+static int sim_close(int fd) {
+    Conn *conn = conn_of_fd(fd);
+    if (conn == NULL) {
+        if (fd >= SIM_FD_BASE) {
+            errno = EBADF;
+            return -1;
+        }
+        return close(fd);
+    }
+
+    /* Klient uvidi EOF, az docte data */
+    conn->server_open = false;
+    conn->in_len = 0;
+    mark_dirty(conn);
+    return 0;
+}
+
+static const SysIoOps g_sim_ops = {
+    .time_now = sim_time_now,
+    .monotonic_ms = sim_monotonic_ms,
+    .poll = sim_poll,
+    .accept = sim_accept,
+    .recv = sim_recv,
+    .send = sim_send,
+    .writev = sim_writev,
+    .close = sim_close
+};
+
+/* ============================================
+ * HLAVNI PROGRAM
+ * ============================================ */
+
+static void sim_init(int total, int slots, uint64_t seed) {
+    g_sim.total = total;
+    g_sim.population = slots * 2 / 5;
+    g_sim.seed = seed;
+    g_sim.rng = seed;
+
+    /* Klient ma nejvys dve spojeni, dalsi mohou cekat na zavreni serverem */
+    g_sim.conn_count = slots * 3;
+    g_sim.conns = xmalloc(sizeof(Conn) * (size_t)g_sim.conn_count);
+    g_sim.free_conns = xmalloc(sizeof(int) * (size_t)g_sim.conn_count);
+    g_sim.accept_queue = xmalloc(sizeof(int) * (size_t)g_sim.conn_count);
+    g_sim.dirty = xmalloc(sizeof(int) * (size_t)g_sim.conn_count);
+    g_sim.delivering = xmalloc(sizeof(int) * (size_t)g_sim.conn_count);
+    for (int i = g_sim.conn_count - 1; i >= 0; i--) {
+        g_sim.conns[i].client = -1;
+        g_sim.free_conns[g_sim.free_conn_count++] = i;
+    }
+
+    g_sim.clients = xmalloc(sizeof(Client) * (size_t)g_sim.population);
+    g_sim.free_clients = xmalloc(sizeof(int) * (size_t)g_sim.population);
+    for (int i = g_sim.population - 1; i >= 0; i--) {
+        g_sim.free_clients[g_sim.free_client_count++] = i;
+    }
+}
+
+static void report(const Server *server, double cpu_seconds) {
+    int runs = 0;
+    int failures = 0;
+
+    printf("%-18s %8s %8s %8s\n", "scenario", "runs", "ok", "failed");
+    for (int r = 0; r < ROLE_COUNT; r++) {
+        printf("%-18s %8d %8d %8d\n", g_role_names[r], g_sim.runs[r],
+               g_sim.runs[r] - g_sim.failures[r], g_sim.failures[r]);
+        runs += g_sim.runs[r];
+        failures += g_sim.failures[r];
+    }
+    printf("%-18s %8d %8d %8d\n", "total", runs, runs - failures, failures);
+    printf("\nvirtual time %.1f s, cpu %.2f s, %lu polls, %llu connections accepted\n",
+           g_sim.now_ms / 1000.0, cpu_seconds, g_sim.polls,
+           (unsigned long long)server->stats.accepted_total);
+    printf("trace %016llx\n", (unsigned long long)g_sim.trace);
+}
+
+/** Tvurce chybove odpovedi "NAZEV;kod;duvod" */
+typedef int (*ErrorBuilder)(char *buffer, int size, ErrorCode code, const char *reason);
+
+/**
+ * Porovna bajty vsech *_ERR a ERROR odpovedi s vychozim duvodem i bez nej
+ * s formatem "NAZEV;kod;duvod\n" - zmena predpripravenych textu se chyti
+ * jeste pred simulaci
+ * @return Pocet nesouhlasicich odpovedi
+ */
+static int check_error_replies(void) {
+    static const struct {
+        const char *name;
+        ErrorBuilder build;
+    } builders[] = {
+        { "LOGIN_ERR", protocol_create_login_err },
+        { "RESUME_ERR", protocol_create_resume_err },
+        { "ROOM_ERR", protocol_create_room_err },
+        { "TAKE_ERR", protocol_create_take_err },
+        { "SKIP_ERR", protocol_create_skip_err },
+        { "ERROR", protocol_create_error },
+        { "HINT_ERR", protocol_create_hint_err },
+        { "WATCH_ERR", protocol_create_watch_err },
+        { "TOURNAMENT_ERR", protocol_create_tournament_err },
+        { "QUICK_MATCH_ERR", protocol_create_quick_match_err },
+    };
+    static const struct {
+        ErrorCode code;
+        const char *text;
+    } errors[] = {
+#define X(name, code, text) { name, text },
+        PROTOCOL_ERRORS(X)
+#undef X
+    };
+    int mismatches = 0;
+
+    for (size_t b = 0; b < sizeof(builders) / sizeof(builders[0]); b++) {
+        for (size_t e = 0; e < sizeof(errors) / sizeof(errors[0]); e++) {
+            for (int custom = 0; custom < 2; custom++) {
+                const char *reason = custom ? "Custom reason" : errors[e].text;
+                char expected[256];
+                char actual[256];
+                int expected_len = snprintf(expected, sizeof(expected), "%s;%d;%s\n",
+                                            builders[b].name, (int)errors[e].code, reason);
+                int len = builders[b].build(actual, sizeof(actual), errors[e].code,
+                                            custom ? reason : NULL);
+                if (len != expected_len || memcmp(actual, expected, (size_t)len) != 0) {
+                    if (mismatches < SIM_REPORT_FAILURES) {
+                        fprintf(stderr, "nim_sim: %s;%d: expected \"%.*s\\n\", got %d bytes\n",
+                                builders[b].name, (int)errors[e].code,
+                                expected_len - 1, expected, len);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n CLIENTS] [-c SLOTS] [-s SEED] [-F FIRST_ROOM_ID] [-v]\n",
+            program);
+    fprintf(stderr, "  -n  scripted clients in total (default 100000)\n");
+    fprintf(stderr, "  -c  server client slots (default 4000)\n");
+    fprintf(stderr, "  -s  seed (default 1)\n");
+    fprintf(stderr, "  -F  ID of the first room (default 0)\n");
+    fprintf(stderr, "  -v  server warnings to stdout\n");
+}
+
+int main(int argc, char *argv[]) {
+    int total = 100000;
+    int slots = 4000;
+    uint64_t seed = 1;
+    int first_room_id = 0;
+    bool verbose = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:s:F:vh")) != -1) {
+        switch (opt) {
+            case 'n': total = atoi(optarg); break;
+            case 'c': slots = atoi(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+            case 'F': first_room_id = atoi(optarg); break;
+            case 'v': verbose = true; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (total < 1 || slots < 10 || first_room_id < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    logger_init(NULL, verbose ? LOG_WARNING : LOG_ERROR);
+
+    if (check_error_replies() > 0) {
+        fprintf(stderr, "nim_sim: error replies differ from \"NAME;code;reason\\n\"\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Vychozi konfigurace, jen skutecny listener na nahodnem portu
+     * (do poll() se nedostane) a bez souboru hodnoceni */
+    static Server server;
+    ServerConfig config;
+    char *no_args[] = { argv[0], NULL };
+    optind = 1;
+    if (!server_parse_args(1, no_args, &config)) {
+        return EXIT_FAILURE;
+    }
+    snprintf(config.bind_address, sizeof(config.bind_address), "127.0.0.1");
+    config.port = 0;
+    config.max_clients = slots;
+    config.max_rooms = slots / 2;
+    config.ratings_path[0] = '\0';
+
+    sim_init(total, slots, seed);
+    g_sim.server = &server;
+    sysio_set_ops(&g_sim_ops);
+
+    if (!server_init(&server, &config)) {
+        fprintf(stderr, "nim_sim: server_init failed\n");
+        return EXIT_FAILURE;
+    }
+    room_set_first_id(first_room_id);
+
+    spawn_more();
+    clock_t started = clock();
+    server_run(&server);
+    double cpu = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+    sysio_set_ops(NULL);
+    report(&server, cpu);
+    logger_close();
+
+    for (int r = 0; r < ROLE_COUNT; r++) {
+        if (g_sim.failures[r] > 0) return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}